@@ -30,7 +30,7 @@ Item {
         width: parent.width
         placeholderText: "Filter processes"
         onTextChanged: {
-            processes.filterRegExp = new RegExp(processFilterInput.text)
+            processes.filterText = processFilterInput.text
         }
     }
     TreeView {
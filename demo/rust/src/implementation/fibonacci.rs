@@ -16,33 +16,41 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-use std::thread;
 use interface::*;
 use std::sync::atomic::AtomicUsize;
 use std::sync::atomic::Ordering;
 use std::sync::Arc;
 
-fn fibonacci(input: u32) -> usize {
+/// Compute the Fibonacci number or give up when `cancelled` returns true.
+fn fibonacci_until<F: Fn() -> bool>(input: u32, cancelled: F) -> Option<usize> {
     if input <= 1 {
-        return input as usize;
+        return Some(input as usize);
     }
     let mut i = 0;
     let mut sum = 0;
     let mut last = 0;
     let mut cur = 1;
     while i < input - 1 {
+        if cancelled() {
+            return None;
+        }
         sum = last + cur;
         last = cur;
         cur = sum;
         i += 1;
     }
-    sum
+    Some(sum)
+}
+
+fn fibonacci(input: u32) -> usize {
+    fibonacci_until(input, || false).unwrap()
 }
 
 pub struct Fibonacci {
     emit: FibonacciEmitter,
     input: u32,
     result: Arc<AtomicUsize>,
+    generations: Generations,
 }
 
 impl FibonacciTrait for Fibonacci {
@@ -51,6 +59,7 @@ impl FibonacciTrait for Fibonacci {
             emit,
             input: 0,
             result: Arc::new(AtomicUsize::new(0)),
+            generations: Generations::new(),
         }
     }
     fn emit(&mut self) -> &mut FibonacciEmitter {
@@ -62,14 +71,19 @@ impl FibonacciTrait for Fibonacci {
     fn set_input(&mut self, value: u32) {
         self.input = value;
         self.emit.input_changed();
+        // a computation for an older input stops and its result is dropped
+        let token = self.generations.next();
         let mut emit = self.emit.clone();
         let result = self.result.clone();
         result.swap(0, Ordering::SeqCst);
         emit.result_changed();
-        thread::spawn(move || {
-            let r = fibonacci(value);
-            result.swap(r, Ordering::SeqCst);
-            emit.result_changed();
+        self.emit.thread_pool().spawn(move || {
+            if let Some(r) = fibonacci_until(value, || token.is_cancelled()) {
+                token.finish(|| {
+                    result.swap(r, Ordering::SeqCst);
+                    emit.result_changed();
+                });
+            }
         });
     }
     fn result(&self) -> u64 {
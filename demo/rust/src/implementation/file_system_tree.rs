@@ -23,6 +23,7 @@ use std::path::PathBuf;
 use std::ffi::OsString;
 use std::default::Default;
 use std::thread;
+use std::sync::Arc;
 use std::sync::mpsc::{Receiver, Sender, channel};
 use std::marker::Sync;
 
@@ -30,7 +31,7 @@ pub struct DirEntry {
     name: OsString,
     metadata: Option<Metadata>,
     path: Option<PathBuf>,
-    icon: Vec<u8>,
+    icon: Arc<[u8]>,
 }
 
 impl Item for DirEntry {
@@ -39,7 +40,7 @@ impl Item for DirEntry {
             name: OsString::from(name),
             metadata: metadata(name).ok(),
             path: None,
-            icon: Vec::new(),
+            icon: Arc::from(&[][..]),
         }
     }
     fn can_fetch_more(&self) -> bool {
@@ -60,8 +61,8 @@ impl Item for DirEntry {
     fn file_size(&self) -> Option<u64> {
         self.metadata.as_ref().map(|m| m.len())
     }
-    fn icon(&self) -> &[u8] {
-        &self.icon
+    fn icon(&self) -> Arc<[u8]> {
+        self.icon.clone()
     }
     fn retrieve(id: usize, parents: Vec<&Self>, outgoing: &Sender<(usize, PathBuf)>) {
         let path: PathBuf = parents.into_iter().map(|e| &e.name).collect();
@@ -82,7 +83,7 @@ impl Item for DirEntry {
                         name: i.file_name(),
                         metadata: i.metadata().ok(),
                         path: Some(i.path()),
-                        icon: Vec::new(),
+                        icon: Arc::from(&[][..]),
                     };
                     v.push(de);
                 }
@@ -103,7 +104,7 @@ impl Default for DirEntry {
             name: OsString::new(),
             metadata: None,
             path: None,
-            icon: Vec::new(),
+            icon: Arc::from(&[][..]),
         }
     }
 }
@@ -122,22 +123,20 @@ pub trait Item: Default {
     fn file_permissions(&self) -> i32;
     fn file_type(&self) -> i32;
     fn file_size(&self) -> Option<u64>;
-    fn icon(&self) -> &[u8];
+    fn icon(&self) -> Arc<[u8]>;
 }
 
 pub type FileSystemTree = RGeneralItemModel<DirEntry>;
 
 struct Entry<T: Item> {
-    parent: Option<usize>,
-    row: usize,
-    children: Option<Vec<usize>>,
+    fetched: bool,
     data: T,
 }
 
 pub struct RGeneralItemModel<T: Item> {
     emit: FileSystemTreeEmitter,
     model: FileSystemTreeTree,
-    entries: Vec<Entry<T>>,
+    entries: TreeNodes<Entry<T>>,
     path: Option<String>,
     outgoing: Sender<(usize, PathBuf)>,
     incoming: Receiver<(usize, Vec<T>)>,
@@ -149,20 +148,23 @@ where
 {
     fn reset(&mut self) {
         self.model.begin_reset_model();
+        // ids handed out before the reset stay invalid, so late answers
+        // from the reading thread are dropped
         self.entries.clear();
         if let Some(ref path) = self.path {
             let root = Entry {
-                parent: None,
-                row: 0,
-                children: None,
+                fetched: false,
                 data: T::new(path),
             };
-            self.entries.push(root);
+            self.entries.insert(None, 0, root);
         }
         self.model.end_reset_model();
     }
+    fn root(&self) -> usize {
+        self.entries.index(None, 0)
+    }
     fn get(&self, index: usize) -> &Entry<T> {
-        &self.entries[index]
+        self.entries.get(index).unwrap()
     }
     fn retrieve(&self, index: usize) {
         let parents = self.get_parents(index);
@@ -170,30 +172,26 @@ where
     }
     fn process_incoming(&mut self) {
         while let Ok((id, entries)) = self.incoming.try_recv() {
-            if self.entries[id].children.is_some() {
-                continue;
-            }
-            let mut new_entries = Vec::new();
-            let mut children = Vec::new();
-            for (r, d) in entries.into_iter().enumerate() {
-                new_entries.push(Entry {
-                    parent: Some(id),
-                    row: r,
-                    children: None,
-                    data: d,
-                });
-                children.push(self.entries.len() + r);
+            match self.entries.get(id) {
+                Some(entry) if !entry.fetched => {}
+                _ => continue,
             }
-            if new_entries.is_empty() {
-                self.entries[id].children = Some(children);
+            if entries.is_empty() {
+                self.entries.get_mut(id).unwrap().fetched = true;
             } else {
                 self.model.begin_insert_rows(
                     Some(id),
                     0,
-                    new_entries.len() - 1,
+                    entries.len() - 1,
                 );
-                self.entries[id].children = Some(children);
-                self.entries.append(&mut new_entries);
+                self.entries.get_mut(id).unwrap().fetched = true;
+                for (r, d) in entries.into_iter().enumerate() {
+                    let entry = Entry {
+                        fetched: false,
+                        data: d,
+                    };
+                    self.entries.insert(Some(id), r, entry);
+                }
                 self.model.end_insert_rows();
             }
         }
@@ -203,9 +201,9 @@ where
         let mut e = Vec::new();
         while let Some(p) = pos {
             e.push(p);
-            pos = self.entries[p].parent;
+            pos = self.entries.parent(p);
         }
-        e.into_iter().rev().map(|i| &self.entries[i].data).collect()
+        e.into_iter().rev().map(|i| &self.get(i).data).collect()
     }
 }
 
@@ -220,7 +218,7 @@ where
         let mut tree: RGeneralItemModel<T> = RGeneralItemModel {
             emit,
             model,
-            entries: Vec::new(),
+            entries: TreeNodes::new(),
             path: None,
             outgoing,
             incoming,
@@ -242,51 +240,56 @@ where
         }
     }
     fn can_fetch_more(&self, index: Option<usize>) -> bool {
-        let entry = self.get(index.unwrap_or(0));
-        entry.children.is_none() && entry.data.can_fetch_more()
+        if self.entries.is_empty() {
+            return false;
+        }
+        let entry = self.get(index.unwrap_or_else(|| self.root()));
+        !entry.fetched && entry.data.can_fetch_more()
     }
     fn fetch_more(&mut self, index: Option<usize>) {
         self.process_incoming();
         if !self.can_fetch_more(index) {
             return;
         }
-        self.retrieve(index.unwrap_or(0));
+        let index = index.unwrap_or_else(|| self.root());
+        self.retrieve(index);
     }
     fn row_count(&self, index: Option<usize>) -> usize {
-        if self.entries.is_empty() {
-            return 0;
-        }
         if let Some(i) = index {
-            let entry = self.get(i);
-            if let Some(ref children) = entry.children {
-                children.len()
+            if self.get(i).fetched {
+                self.entries.row_count(index)
             } else {
                 self.retrieve(i);
                 0
             }
         } else {
-            1
+            self.entries.row_count(None)
         }
     }
-    fn index(&self, index: Option<usize>, row: usize) -> usize {
-        if let Some(index) = index {
-            self.get(index).children.as_ref().unwrap()[row]
+    fn has_children(&self, index: Option<usize>) -> bool {
+        if let Some(i) = index {
+            // a directory that has not been read may have children
+            let entry = self.get(i);
+            if entry.fetched {
+                self.entries.row_count(index) > 0
+            } else {
+                entry.data.can_fetch_more()
+            }
         } else {
-            0
+            !self.entries.is_empty()
         }
     }
+    fn index(&self, index: Option<usize>, row: usize) -> usize {
+        self.entries.index(index, row)
+    }
     fn parent(&self, index: usize) -> Option<usize> {
-        self.entries[index].parent
+        self.entries.parent(index)
     }
     fn row(&self, index: usize) -> usize {
-        self.entries[index].row
+        self.entries.row(index)
     }
     fn check_row(&self, index: usize, _row: usize) -> Option<usize> {
-        if index < self.entries.len() {
-            Some(self.row(index))
-        } else {
-            None
-        }
+        self.entries.check_row(index)
     }
     fn file_name(&self, index: usize) -> String {
         self.get(index).data.file_name()
@@ -295,7 +298,7 @@ where
         self.get(index).data.file_permissions()
     }
     #[allow(unused_variables)]
-    fn file_icon(&self, index: usize) -> &[u8] {
+    fn file_icon(&self, index: usize) -> Arc<[u8]> {
         self.get(index).data.icon()
     }
     fn file_path(&self, index: usize) -> Option<String> {
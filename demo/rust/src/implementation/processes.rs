@@ -238,28 +238,29 @@ fn cmp_f32(a: f32, b: f32) -> bool {
 }
 
 fn sync_row(model: &mut ProcessesTree, pid: pid_t, a: &mut Process, b: &Process) -> f32 {
-    let mut changed = a.name != b.name;
-    if changed {
+    let mut changed = Vec::new();
+    if a.name != b.name {
         a.name.clone_from(&b.name);
+        changed.push(ProcessesProperty::Name);
     }
     if !cmp_f32(a.cpu_usage, b.cpu_usage) {
         a.cpu_usage = b.cpu_usage;
-        changed = true;
+        changed.push(ProcessesProperty::CpuUsage);
+        changed.push(ProcessesProperty::CpuPercentage);
     }
     if a.cmd != b.cmd {
         a.cmd.clone_from(&b.cmd);
-        changed = true;
+        changed.push(ProcessesProperty::Cmd);
     }
     if a.exe != b.exe {
         a.exe.clone_from(&b.exe);
-        changed = true;
     }
     if a.memory != b.memory {
         a.memory = b.memory;
-        changed = true;
+        changed.push(ProcessesProperty::Memory);
     }
-    if changed {
-        model.data_changed(pid as usize, pid as usize);
+    if !changed.is_empty() {
+        model.properties_changed(pid as usize, pid as usize, &changed);
     }
     b.cpu_usage
 }
@@ -315,7 +316,11 @@ fn sync_tree(
     }
     if !cmp_f32(cpu_total, bmap[&parent].process.cpu_usage) {
         amap.get_mut(&parent).unwrap().process.cpu_usage = cpu_total;
-        model.data_changed(parent as usize, parent as usize);
+        model.properties_changed(
+            parent as usize,
+            parent as usize,
+            &[ProcessesProperty::CpuUsage, ProcessesProperty::CpuPercentage],
+        );
     }
     assert_eq!(a, b);
     cpu_total
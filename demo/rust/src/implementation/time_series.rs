@@ -18,27 +18,20 @@
 
 use interface::*;
 
-#[derive(Default, Clone)]
-struct TimeSeriesItem {
-    time: f32,
-    sin: f32,
-    cos: f32,
-}
-
 pub struct TimeSeries {
     emit: TimeSeriesEmitter,
-    list: Vec<TimeSeriesItem>,
+    columns: TimeSeriesColumns,
 }
 
 impl TimeSeriesTrait for TimeSeries {
     fn new(emit: TimeSeriesEmitter, _: TimeSeriesList) -> TimeSeries {
         let mut series = TimeSeries {
             emit,
-            list: Vec::new(),
+            columns: TimeSeriesColumns::new(),
         };
         for i in 0..101 {
             let x = i as f32 / 10.;
-            series.list.push(TimeSeriesItem {
+            series.columns.push(TimeSeriesRow {
                 time: x,
                 sin: x.sin(),
                 cos: x.cos(),
@@ -50,27 +43,36 @@ impl TimeSeriesTrait for TimeSeries {
         &mut self.emit
     }
     fn row_count(&self) -> usize {
-        self.list.len() as usize
+        self.columns.len()
     }
     fn time(&self, row: usize) -> f32 {
-        self.list[row as usize].time
+        self.columns.time()[row]
+    }
+    fn time_column(&self, first: usize, column: &mut [f32]) {
+        column.copy_from_slice(&self.columns.time()[first..first + column.len()]);
     }
     fn set_time(&mut self, row: usize, v: f32) -> bool {
-        self.list[row as usize].time = v;
+        self.columns.time_mut()[row] = v;
         true
     }
     fn sin(&self, row: usize) -> f32 {
-        self.list[row as usize].sin
+        self.columns.sin()[row]
+    }
+    fn sin_column(&self, first: usize, column: &mut [f32]) {
+        column.copy_from_slice(&self.columns.sin()[first..first + column.len()]);
     }
     fn set_sin(&mut self, row: usize, v: f32) -> bool {
-        self.list[row as usize].sin = v;
+        self.columns.sin_mut()[row] = v;
         true
     }
     fn cos(&self, row: usize) -> f32 {
-        self.list[row as usize].cos
+        self.columns.cos()[row]
+    }
+    fn cos_column(&self, first: usize, column: &mut [f32]) {
+        column.copy_from_slice(&self.columns.cos()[first..first + column.len()]);
     }
     fn set_cos(&mut self, row: usize, v: f32) -> bool {
-        self.list[row as usize].cos = v;
+        self.columns.cos_mut()[row] = v;
         true
     }
 }
@@ -10,6 +10,7 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 #[repr(C)]
 pub struct COption<T> {
     data: T,
@@ -50,11 +51,35 @@ where
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -75,6 +100,600 @@ pub struct QModelIndex {
     internal_id: usize,
 }
 
+/// A model signal sent by `sync_rows`.
+enum SyncSignal<'a> {
+    BeginRemove(usize, usize),
+    EndRemove,
+    BeginMove(usize, usize),
+    EndMove,
+    BeginInsert(usize, usize),
+    EndInsert,
+    BeginLayout,
+    /// The old row of every row.
+    EndLayout(&'a [usize]),
+    Changed(usize, usize),
+}
+
+/// Most ranges of removed rows, ranges of inserted rows or moved rows that
+/// `sync_rows` signals one by one. Each of them shifts the rows, so more
+/// moves are sent as one layout change and more removes or inserts as a
+/// replacement of all rows. That keeps a sync O(n log n).
+const SYNC_MAX_SIGNALS: usize = 64;
+
+/// The number of runs of `true` in `flags`.
+fn count_runs<I: Iterator<Item = bool>>(flags: I) -> usize {
+    let mut runs = 0;
+    let mut previous = false;
+    for flag in flags {
+        if flag && !previous {
+            runs += 1;
+        }
+        previous = flag;
+    }
+    runs
+}
+
+/// Indexes into `seq` of a longest increasing subsequence, O(n log n).
+fn longest_increasing(seq: &[usize]) -> Vec<usize> {
+    let mut tails: Vec<usize> = Vec::new();
+    let mut prev = vec![usize::max_value(); seq.len()];
+    for (i, &v) in seq.iter().enumerate() {
+        let pos = match tails.binary_search_by(|&t| seq[t].cmp(&v)) {
+            Ok(pos) | Err(pos) => pos,
+        };
+        if pos > 0 {
+            prev[i] = tails[pos - 1];
+        }
+        if pos == tails.len() {
+            tails.push(i);
+        } else {
+            tails[pos] = i;
+        }
+    }
+    let mut lis = vec![0; tails.len()];
+    let mut i = tails.last().cloned().unwrap_or(0);
+    for slot in lis.iter_mut().rev() {
+        *slot = i;
+        i = prev[i];
+    }
+    lis
+}
+
+/// Turn `rows` into `new` with removes, moves, inserts and changes of
+/// the rows that have the same key. Rows that are not moved keep their
+/// place, so views keep their selection and scroll position. `signal` gets
+/// the rows as they are when the signal is sent.
+fn sync_rows<T, K, F, S>(rows: &mut Vec<T>, new: Vec<T>, key: F, mut signal: S)
+where
+    T: PartialEq,
+    K: ::std::hash::Hash + Eq,
+    F: Fn(&T) -> K,
+    S: FnMut(SyncSignal, &[T]),
+{
+    let new_rows: ::std::collections::HashMap<K, usize> =
+        new.iter().enumerate().map(|(i, t)| (key(t), i)).collect();
+    let mut seen = vec![false; new.len()];
+    let mut duplicate = new_rows.len() != new.len();
+    // the row in `new` of every old row, if it is still there
+    let targets: Vec<Option<usize>> = rows
+        .iter()
+        .map(|t| {
+            let target = new_rows.get(&key(t)).cloned();
+            if let Some(target) = target {
+                duplicate |= seen[target];
+                seen[target] = true;
+            }
+            target
+        })
+        .collect();
+    drop(new_rows);
+    if duplicate
+        || count_runs(targets.iter().map(|t| t.is_none())) > SYNC_MAX_SIGNALS
+        || count_runs(seen.iter().map(|s| !s)) > SYNC_MAX_SIGNALS
+    {
+        // keys are not unique or the rows changed too much, so replace all
+        if !rows.is_empty() {
+            signal(SyncSignal::BeginRemove(0, rows.len() - 1), rows);
+            rows.clear();
+            signal(SyncSignal::EndRemove, rows);
+        }
+        if !new.is_empty() {
+            signal(SyncSignal::BeginInsert(0, new.len() - 1), rows);
+            *rows = new;
+            signal(SyncSignal::EndInsert, rows);
+        }
+        return;
+    }
+    // remove rows that are gone, back to front, one range at a time
+    let mut end = targets.len();
+    while end > 0 {
+        if targets[end - 1].is_some() {
+            end -= 1;
+            continue;
+        }
+        let mut first = end - 1;
+        while first > 0 && targets[first - 1].is_none() {
+            first -= 1;
+        }
+        signal(SyncSignal::BeginRemove(first, end - 1), rows);
+        rows.drain(first..end);
+        signal(SyncSignal::EndRemove, rows);
+        end = first;
+    }
+    let mut current: Vec<usize> = targets.into_iter().filter_map(|t| t).collect();
+    // rows in a longest increasing run of targets stay, the others move
+    let lis = longest_increasing(&current);
+    if current.len() - lis.len() > SYNC_MAX_SIGNALS {
+        // order the rows by target in one pass
+        let mut by_target = vec![usize::max_value(); new.len()];
+        for (row, &target) in current.iter().enumerate() {
+            by_target[target] = row;
+        }
+        let old_rows: Vec<usize> = by_target
+            .into_iter()
+            .filter(|&row| row != usize::max_value())
+            .collect();
+        signal(SyncSignal::BeginLayout, rows);
+        let mut old: Vec<Option<T>> = rows.drain(..).map(Some).collect();
+        rows.extend(old_rows.iter().map(|&row| old[row].take().unwrap()));
+        signal(SyncSignal::EndLayout(&old_rows), rows);
+    } else if current.len() > lis.len() {
+        // at most SYNC_MAX_SIGNALS moves, each shifts the rows once
+        let mut placed = vec![false; new.len()];
+        for i in lis {
+            placed[current[i]] = true;
+        }
+        let mut previous: Option<usize> = None;
+        for target in 0..new.len() {
+            if !seen[target] {
+                continue;
+            }
+            if !placed[target] {
+                let from = current.iter().position(|&t| t == target).unwrap();
+                let to = previous
+                    .map(|p| current.iter().position(|&t| t == p).unwrap() + 1)
+                    .unwrap_or(0);
+                if to != from && to != from + 1 {
+                    signal(SyncSignal::BeginMove(from, to), rows);
+                    let row = rows.remove(from);
+                    let t = current.remove(from);
+                    let to = if to > from { to - 1 } else { to };
+                    rows.insert(to, row);
+                    current.insert(to, t);
+                    signal(SyncSignal::EndMove, rows);
+                }
+                placed[target] = true;
+            }
+            previous = Some(target);
+        }
+    }
+    // insert new rows and update the rows that stayed; there are at most
+    // SYNC_MAX_SIGNALS inserted ranges and each shifts the rows once
+    let mut new: Vec<Option<T>> = new.into_iter().map(Some).collect();
+    let mut row = 0;
+    while row < new.len() {
+        if seen[row] {
+            let mut last = row;
+            while last < new.len() && seen[last] && rows[last] != *new[last].as_ref().unwrap() {
+                rows[last] = new[last].take().unwrap();
+                last += 1;
+            }
+            if last > row {
+                signal(SyncSignal::Changed(row, last - 1), rows);
+                row = last;
+            } else {
+                row += 1;
+            }
+            continue;
+        }
+        let mut last = row;
+        while last + 1 < new.len() && !seen[last + 1] {
+            last += 1;
+        }
+        signal(SyncSignal::BeginInsert(row, last), rows);
+        let tail = rows.split_off(row);
+        rows.extend(new[row..=last].iter_mut().map(|t| t.take().unwrap()));
+        rows.extend(tail);
+        signal(SyncSignal::EndInsert, rows);
+        row = last + 1;
+    }
+}
+
+/// Sort `rows` by their `keys`. The sort is stable in both orders.
+fn sort_rows<K, F>(rows: &mut Vec<usize>, keys: Vec<K>, order: SortOrder, cmp: F)
+where
+    F: Fn(&K, &K) -> ::std::cmp::Ordering,
+{
+    let mut keyed: Vec<(usize, K)> = rows.drain(..).zip(keys).collect();
+    if order == SortOrder::Ascending {
+        keyed.sort_by(|a, b| cmp(&a.1, &b.1));
+    } else {
+        keyed.sort_by(|a, b| cmp(&b.1, &a.1));
+    }
+    rows.extend(keyed.into_iter().map(|(row, _)| row));
+}
+
+/// Find the position of `row` among `rows`, which do not contain it and
+/// are sorted like sort_rows() sorts them.
+fn place_row<K, G, F>(rows: &[c_int], row: usize, key: G, order: SortOrder, cmp: F) -> usize
+where
+    G: Fn(usize) -> K,
+    F: Fn(&K, &K) -> ::std::cmp::Ordering,
+{
+    let k = key(row);
+    let (mut low, mut high) = (0, rows.len());
+    while low < high {
+        let mid = low + (high - low) / 2;
+        let r = to_usize(rows[mid]);
+        let kr = key(r);
+        let ord = if order == SortOrder::Ascending {
+            cmp(&kr, &k)
+        } else {
+            cmp(&k, &kr)
+        };
+        // rows with equal keys keep the order of the source
+        if ord == ::std::cmp::Ordering::Less || (ord == ::std::cmp::Ordering::Equal && r < row) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    low
+}
+
+type Job = Box<dyn FnOnce() + Send>;
+
+thread_local! {
+    static WORKER: ::std::cell::Cell<Option<usize>> = ::std::cell::Cell::new(None);
+}
+
+/// A pool of threads that is shared by all objects.
+///
+/// There is one thread per core. Every thread has its own queue. A job that
+/// is spawned from a job goes to the queue of its thread; other jobs go to
+/// a shared queue. A thread runs the newest job of its own queue, then the
+/// oldest job of the shared queue and otherwise steals the oldest job of
+/// another thread.
+pub struct ThreadPool {
+    shared: ::std::sync::Mutex<::std::collections::VecDeque<Job>>,
+    queues: Vec<::std::sync::Mutex<::std::collections::VecDeque<Job>>>,
+    pending: ::std::sync::Mutex<usize>,
+    wake: ::std::sync::Condvar,
+}
+
+impl ThreadPool {
+    /// The pool. The threads are started on the first call.
+    pub fn global() -> &'static ThreadPool {
+        static POOL: AtomicPtr<ThreadPool> = AtomicPtr::new(0 as *mut ThreadPool);
+        static START: ::std::sync::Once = ::std::sync::Once::new();
+        START.call_once(|| {
+            let threads = ::std::thread::available_parallelism().map_or(2, |n| n.get());
+            let pool: &'static ThreadPool = Box::leak(Box::new(ThreadPool {
+                shared: ::std::sync::Mutex::new(::std::collections::VecDeque::new()),
+                queues: (0..threads)
+                    .map(|_| ::std::sync::Mutex::new(::std::collections::VecDeque::new()))
+                    .collect(),
+                pending: ::std::sync::Mutex::new(0),
+                wake: ::std::sync::Condvar::new(),
+            }));
+            for worker in 0..threads {
+                ::std::thread::spawn(move || pool.run(worker));
+            }
+            POOL.store(pool as *const ThreadPool as *mut ThreadPool, Ordering::SeqCst);
+        });
+        unsafe { &*POOL.load(Ordering::SeqCst) }
+    }
+    pub fn threads(&self) -> usize {
+        self.queues.len()
+    }
+    pub fn spawn<F>(&self, job: F)
+    where
+        F: FnOnce() + Send + 'static,
+    {
+        let job: Job = Box::new(job);
+        match WORKER.with(|w| w.get()) {
+            Some(worker) => self.queues[worker].lock().unwrap().push_back(job),
+            None => self.shared.lock().unwrap().push_back(job),
+        }
+        *self.pending.lock().unwrap() += 1;
+        self.wake.notify_one();
+    }
+    fn find_job(&self, worker: usize) -> Option<Job> {
+        if let Some(job) = self.queues[worker].lock().unwrap().pop_back() {
+            return Some(job);
+        }
+        if let Some(job) = self.shared.lock().unwrap().pop_front() {
+            return Some(job);
+        }
+        let n = self.queues.len();
+        (1..n).find_map(|i| self.queues[(worker + i) % n].lock().unwrap().pop_front())
+    }
+    fn run(&self, worker: usize) {
+        WORKER.with(|w| w.set(Some(worker)));
+        loop {
+            {
+                let mut pending = self.pending.lock().unwrap();
+                while *pending == 0 {
+                    pending = self.wake.wait(pending).unwrap();
+                }
+                *pending -= 1;
+            }
+            // one job is reserved for this thread, so a queue has a job
+            loop {
+                if let Some(job) = self.find_job(worker) {
+                    // a panic ends the job, not the thread
+                    let _ = ::std::panic::catch_unwind(::std::panic::AssertUnwindSafe(job));
+                    break;
+                }
+                ::std::thread::yield_now();
+            }
+        }
+    }
+}
+
+struct Generation {
+    current: ::std::sync::atomic::AtomicUsize,
+    finish: ::std::sync::Mutex<()>,
+}
+
+impl Generation {
+    /// Lock out other tokens. The lock holds no data, so it is still good
+    /// after `f` in `finish` panicked.
+    fn lock(&self) -> ::std::sync::MutexGuard<'_, ()> {
+        self.finish.lock().unwrap_or_else(|e| e.into_inner())
+    }
+}
+
+/// Hands out cancellation tokens. A new token cancels all earlier ones.
+#[derive(Clone)]
+pub struct Generations {
+    generation: Arc<Generation>,
+}
+
+impl Generations {
+    pub fn new() -> Generations {
+        Generations {
+            generation: Arc::new(Generation {
+                current: ::std::sync::atomic::AtomicUsize::new(0),
+                finish: ::std::sync::Mutex::new(()),
+            }),
+        }
+    }
+    /// Cancel the earlier tokens and return a new one.
+    pub fn next(&self) -> CancelToken {
+        let _finish = self.generation.lock();
+        let value = self.generation.current.fetch_add(1, Ordering::SeqCst) + 1;
+        CancelToken {
+            generation: self.generation.clone(),
+            value,
+        }
+    }
+    /// Cancel all tokens.
+    pub fn cancel(&self) {
+        let _finish = self.generation.lock();
+        self.generation.current.fetch_add(1, Ordering::SeqCst);
+    }
+}
+
+impl Default for Generations {
+    fn default() -> Generations {
+        Generations::new()
+    }
+}
+
+/// Tells a computation if a newer one has replaced it.
+#[derive(Clone)]
+pub struct CancelToken {
+    generation: Arc<Generation>,
+    value: usize,
+}
+
+impl CancelToken {
+    pub fn is_cancelled(&self) -> bool {
+        self.generation.current.load(Ordering::SeqCst) != self.value
+    }
+    /// Call `f` if the token is not cancelled, e.g. to store a result and
+    /// emit a signal. A newer token is handed out only after `f` returns,
+    /// so an old result never replaces a newer one.
+    pub fn finish<F: FnOnce()>(&self, f: F) -> bool {
+        let _finish = self.generation.lock();
+        if self.is_cancelled() {
+            return false;
+        }
+        f();
+        true
+    }
+}
+
+/// Number of bits of a tree item id that select the slot. The other bits
+/// hold the generation of the slot. On 32 bit targets the generation gets
+/// 8 bits, so a slot is retired after 255 reuses but a tree can hold 2^24
+/// items.
+#[cfg(target_pointer_width = "64")]
+const TREE_SLOT_BITS: usize = 32;
+#[cfg(not(target_pointer_width = "64"))]
+const TREE_SLOT_BITS: usize = 24;
+const TREE_SLOT_MASK: usize = (1 << TREE_SLOT_BITS) - 1;
+const TREE_MAX_GENERATION: usize = ::std::usize::MAX >> TREE_SLOT_BITS;
+
+struct TreeNode<T> {
+    parent: Option<usize>,
+    row: usize,
+    children: Vec<usize>,
+    data: T,
+}
+
+struct TreeSlot<T> {
+    generation: usize,
+    node: Option<TreeNode<T>>,
+}
+
+/// Storage for the items of a Tree model.
+///
+/// The ids of the items can be used as the ids of the Tree trait. An id
+/// holds a slot and the generation of that slot. Removing an item frees
+/// its slot for reuse and increases the generation, so an id of a removed
+/// item is never valid again.
+pub struct TreeNodes<T> {
+    slots: Vec<TreeSlot<T>>,
+    free: Vec<usize>,
+    roots: Vec<usize>,
+    len: usize,
+}
+
+impl<T> Default for TreeNodes<T> {
+    fn default() -> TreeNodes<T> {
+        TreeNodes {
+            slots: Vec::new(),
+            free: Vec::new(),
+            roots: Vec::new(),
+            len: 0,
+        }
+    }
+}
+
+impl<T> TreeNodes<T> {
+    pub fn new() -> TreeNodes<T> {
+        TreeNodes::default()
+    }
+    fn node(&self, id: usize) -> Option<&TreeNode<T>> {
+        match self.slots.get(id & TREE_SLOT_MASK) {
+            Some(slot) if slot.generation == id >> TREE_SLOT_BITS => slot.node.as_ref(),
+            _ => None,
+        }
+    }
+    fn node_mut(&mut self, id: usize) -> Option<&mut TreeNode<T>> {
+        match self.slots.get_mut(id & TREE_SLOT_MASK) {
+            Some(slot) if slot.generation == id >> TREE_SLOT_BITS => slot.node.as_mut(),
+            _ => None,
+        }
+    }
+    fn siblings_mut(&mut self, parent: Option<usize>) -> &mut Vec<usize> {
+        match parent {
+            Some(parent) => &mut self.node_mut(parent).expect("invalid tree id").children,
+            None => &mut self.roots,
+        }
+    }
+    /// Set the rows of the children of `parent`, starting at `first`.
+    fn update_rows(&mut self, parent: Option<usize>, first: usize) {
+        let siblings = ::std::mem::replace(self.siblings_mut(parent), Vec::new());
+        for (row, &id) in siblings.iter().enumerate().skip(first) {
+            self.slots[id & TREE_SLOT_MASK].node.as_mut().unwrap().row = row;
+        }
+        *self.siblings_mut(parent) = siblings;
+    }
+    /// Number of items in the tree.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+    /// Tell if `id` belongs to an item that has not been removed.
+    pub fn contains(&self, id: usize) -> bool {
+        self.node(id).is_some()
+    }
+    pub fn get(&self, id: usize) -> Option<&T> {
+        self.node(id).map(|n| &n.data)
+    }
+    pub fn get_mut(&mut self, id: usize) -> Option<&mut T> {
+        self.node_mut(id).map(|n| &mut n.data)
+    }
+    pub fn parent(&self, id: usize) -> Option<usize> {
+        self.node(id).and_then(|n| n.parent)
+    }
+    pub fn row(&self, id: usize) -> usize {
+        self.node(id).map_or(0, |n| n.row)
+    }
+    /// The row of `id`, or `None` if the item was removed.
+    pub fn check_row(&self, id: usize) -> Option<usize> {
+        self.node(id).map(|n| n.row)
+    }
+    /// The ids of the children of `parent`, or of the top level items.
+    pub fn children(&self, parent: Option<usize>) -> &[usize] {
+        match parent {
+            Some(parent) => self.node(parent).map_or(&[], |n| &n.children[..]),
+            None => &self.roots,
+        }
+    }
+    pub fn row_count(&self, parent: Option<usize>) -> usize {
+        self.children(parent).len()
+    }
+    pub fn index(&self, parent: Option<usize>, row: usize) -> usize {
+        self.children(parent)[row]
+    }
+    /// Add an item at `row` under `parent` and return its id.
+    pub fn insert(&mut self, parent: Option<usize>, row: usize, data: T) -> usize {
+        let node = TreeNode {
+            parent,
+            row,
+            children: Vec::new(),
+            data,
+        };
+        let slot = match self.free.pop() {
+            Some(slot) => {
+                self.slots[slot].node = Some(node);
+                slot
+            }
+            None => {
+                // a larger slot would overwrite the generation bits of the id
+                assert!(
+                    self.slots.len() <= TREE_SLOT_MASK,
+                    "TreeNodes cannot hold more than {} items",
+                    TREE_SLOT_MASK + 1
+                );
+                self.slots.push(TreeSlot {
+                    generation: 0,
+                    node: Some(node),
+                });
+                self.slots.len() - 1
+            }
+        };
+        let id = self.slots[slot].generation << TREE_SLOT_BITS | slot;
+        self.siblings_mut(parent).insert(row, id);
+        self.update_rows(parent, row + 1);
+        self.len += 1;
+        id
+    }
+    /// Remove an item and all of its descendants and return its data.
+    pub fn remove(&mut self, id: usize) -> Option<T> {
+        let (parent, row) = match self.node(id) {
+            Some(node) => (node.parent, node.row),
+            None => return None,
+        };
+        self.siblings_mut(parent).remove(row);
+        self.update_rows(parent, row);
+        let node = self.free_slot(id);
+        let mut descendants = node.children;
+        while let Some(id) = descendants.pop() {
+            descendants.extend(self.free_slot(id).children);
+        }
+        Some(node.data)
+    }
+    fn free_slot(&mut self, id: usize) -> TreeNode<T> {
+        let slot = id & TREE_SLOT_MASK;
+        let s = &mut self.slots[slot];
+        // a slot whose generation is used up is not used again
+        if s.generation < TREE_MAX_GENERATION {
+            s.generation += 1;
+            self.free.push(slot);
+        }
+        self.len -= 1;
+        s.node.take().unwrap()
+    }
+    /// Remove all items. Old ids stay invalid.
+    pub fn clear(&mut self) {
+        let roots = ::std::mem::replace(&mut self.roots, Vec::new());
+        for id in roots {
+            let node = self.free_slot(id);
+            let mut descendants = node.children;
+            while let Some(id) = descendants.pop() {
+                descendants.extend(self.free_slot(id).children);
+            }
+        }
+    }
+}
+
 
 fn to_usize(n: c_int) -> usize {
     if n < 0 {
@@ -142,13 +761,13 @@ pub trait DemoTrait {
 pub extern "C" fn demo_new(
     demo: *mut DemoQObject,
     fibonacci: *mut FibonacciQObject,
-    fibonacci_input_changed: extern fn(*mut FibonacciQObject),
-    fibonacci_result_changed: extern fn(*mut FibonacciQObject),
+    fibonacci_changes_pending: extern fn(*mut FibonacciQObject),
     fibonacci_list: *mut FibonacciListQObject,
     fibonacci_list_new_data_ready: extern fn(*mut FibonacciListQObject),
     fibonacci_list_layout_about_to_be_changed: extern fn(*mut FibonacciListQObject),
     fibonacci_list_layout_changed: extern fn(*mut FibonacciListQObject),
     fibonacci_list_data_changed: extern fn(*mut FibonacciListQObject, usize, usize),
+    fibonacci_list_properties_changed: extern fn(*mut FibonacciListQObject, usize, usize, u64),
     fibonacci_list_begin_reset_model: extern fn(*mut FibonacciListQObject),
     fibonacci_list_end_reset_model: extern fn(*mut FibonacciListQObject),
     fibonacci_list_begin_insert_rows: extern fn(*mut FibonacciListQObject, usize, usize),
@@ -157,12 +776,14 @@ pub extern "C" fn demo_new(
     fibonacci_list_end_move_rows: extern fn(*mut FibonacciListQObject),
     fibonacci_list_begin_remove_rows: extern fn(*mut FibonacciListQObject, usize, usize),
     fibonacci_list_end_remove_rows: extern fn(*mut FibonacciListQObject),
+    fibonacci_list_layout_changed_with_permutation: extern fn(*mut FibonacciListQObject, *const usize, usize),
     file_system_tree: *mut FileSystemTreeQObject,
     file_system_tree_path_changed: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_new_data_ready: extern fn(*mut FileSystemTreeQObject, index: COption<usize>),
     file_system_tree_layout_about_to_be_changed: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_layout_changed: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_data_changed: extern fn(*mut FileSystemTreeQObject, usize, usize),
+    file_system_tree_properties_changed: extern fn(*mut FileSystemTreeQObject, usize, usize, u64),
     file_system_tree_begin_reset_model: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_end_reset_model: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_begin_insert_rows: extern fn(*mut FileSystemTreeQObject, index: COption<usize>, usize, usize),
@@ -177,6 +798,7 @@ pub extern "C" fn demo_new(
     processes_layout_about_to_be_changed: extern fn(*mut ProcessesQObject),
     processes_layout_changed: extern fn(*mut ProcessesQObject),
     processes_data_changed: extern fn(*mut ProcessesQObject, usize, usize),
+    processes_properties_changed: extern fn(*mut ProcessesQObject, usize, usize, u64),
     processes_begin_reset_model: extern fn(*mut ProcessesQObject),
     processes_end_reset_model: extern fn(*mut ProcessesQObject),
     processes_begin_insert_rows: extern fn(*mut ProcessesQObject, index: COption<usize>, usize, usize),
@@ -190,6 +812,7 @@ pub extern "C" fn demo_new(
     time_series_layout_about_to_be_changed: extern fn(*mut TimeSeriesQObject),
     time_series_layout_changed: extern fn(*mut TimeSeriesQObject),
     time_series_data_changed: extern fn(*mut TimeSeriesQObject, usize, usize),
+    time_series_properties_changed: extern fn(*mut TimeSeriesQObject, usize, usize, u64),
     time_series_begin_reset_model: extern fn(*mut TimeSeriesQObject),
     time_series_end_reset_model: extern fn(*mut TimeSeriesQObject),
     time_series_begin_insert_rows: extern fn(*mut TimeSeriesQObject, usize, usize),
@@ -198,11 +821,12 @@ pub extern "C" fn demo_new(
     time_series_end_move_rows: extern fn(*mut TimeSeriesQObject),
     time_series_begin_remove_rows: extern fn(*mut TimeSeriesQObject, usize, usize),
     time_series_end_remove_rows: extern fn(*mut TimeSeriesQObject),
+    time_series_layout_changed_with_permutation: extern fn(*mut TimeSeriesQObject, *const usize, usize),
 ) -> *mut Demo {
     let fibonacci_emit = FibonacciEmitter {
         qobject: Arc::new(AtomicPtr::new(fibonacci)),
-        input_changed: fibonacci_input_changed,
-        result_changed: fibonacci_result_changed,
+        changes: Arc::new(::std::sync::atomic::AtomicU64::new(0)),
+        changes_pending: fibonacci_changes_pending,
     };
     let d_fibonacci = Fibonacci::new(fibonacci_emit);
     let fibonacci_list_emit = FibonacciListEmitter {
@@ -214,6 +838,7 @@ pub extern "C" fn demo_new(
         layout_about_to_be_changed: fibonacci_list_layout_about_to_be_changed,
         layout_changed: fibonacci_list_layout_changed,
         data_changed: fibonacci_list_data_changed,
+        properties_changed: fibonacci_list_properties_changed,
         begin_reset_model: fibonacci_list_begin_reset_model,
         end_reset_model: fibonacci_list_end_reset_model,
         begin_insert_rows: fibonacci_list_begin_insert_rows,
@@ -222,6 +847,7 @@ pub extern "C" fn demo_new(
         end_move_rows: fibonacci_list_end_move_rows,
         begin_remove_rows: fibonacci_list_begin_remove_rows,
         end_remove_rows: fibonacci_list_end_remove_rows,
+        layout_changed_with_permutation: fibonacci_list_layout_changed_with_permutation,
     };
     let d_fibonacci_list = FibonacciList::new(fibonacci_list_emit, model);
     let file_system_tree_emit = FileSystemTreeEmitter {
@@ -234,6 +860,7 @@ pub extern "C" fn demo_new(
         layout_about_to_be_changed: file_system_tree_layout_about_to_be_changed,
         layout_changed: file_system_tree_layout_changed,
         data_changed: file_system_tree_data_changed,
+        properties_changed: file_system_tree_properties_changed,
         begin_reset_model: file_system_tree_begin_reset_model,
         end_reset_model: file_system_tree_end_reset_model,
         begin_insert_rows: file_system_tree_begin_insert_rows,
@@ -254,6 +881,7 @@ pub extern "C" fn demo_new(
         layout_about_to_be_changed: processes_layout_about_to_be_changed,
         layout_changed: processes_layout_changed,
         data_changed: processes_data_changed,
+        properties_changed: processes_properties_changed,
         begin_reset_model: processes_begin_reset_model,
         end_reset_model: processes_end_reset_model,
         begin_insert_rows: processes_begin_insert_rows,
@@ -273,6 +901,7 @@ pub extern "C" fn demo_new(
         layout_about_to_be_changed: time_series_layout_about_to_be_changed,
         layout_changed: time_series_layout_changed,
         data_changed: time_series_data_changed,
+        properties_changed: time_series_properties_changed,
         begin_reset_model: time_series_begin_reset_model,
         end_reset_model: time_series_end_reset_model,
         begin_insert_rows: time_series_begin_insert_rows,
@@ -281,6 +910,7 @@ pub extern "C" fn demo_new(
         end_move_rows: time_series_end_move_rows,
         begin_remove_rows: time_series_begin_remove_rows,
         end_remove_rows: time_series_end_remove_rows,
+        layout_changed_with_permutation: time_series_layout_changed_with_permutation,
     };
     let d_time_series = TimeSeries::new(time_series_emit, model);
     let demo_emit = DemoEmitter {
@@ -329,8 +959,9 @@ pub struct FibonacciQObject {}
 
 pub struct FibonacciEmitter {
     qobject: Arc<AtomicPtr<FibonacciQObject>>,
-    input_changed: extern fn(*mut FibonacciQObject),
-    result_changed: extern fn(*mut FibonacciQObject),
+    /// One bit per property that changed since the last notification.
+    changes: Arc<::std::sync::atomic::AtomicU64>,
+    changes_pending: extern fn(*mut FibonacciQObject),
 }
 
 unsafe impl Send for FibonacciEmitter {}
@@ -345,24 +976,32 @@ impl FibonacciEmitter {
     pub fn clone(&mut self) -> FibonacciEmitter {
         FibonacciEmitter {
             qobject: self.qobject.clone(),
-            input_changed: self.input_changed,
-            result_changed: self.result_changed,
+            changes: self.changes.clone(),
+            changes_pending: self.changes_pending,
         }
     }
     fn clear(&self) {
         let n: *const FibonacciQObject = null();
         self.qobject.store(n as *mut FibonacciQObject, Ordering::SeqCst);
     }
+    /// The pool of threads that is shared by all objects.
+    pub fn thread_pool(&self) -> &'static ThreadPool {
+        ThreadPool::global()
+    }
     pub fn input_changed(&mut self) {
-        let ptr = self.qobject.load(Ordering::SeqCst);
-        if !ptr.is_null() {
-            (self.input_changed)(ptr);
+        if self.changes.fetch_or(1 << 0, Ordering::SeqCst) == 0 {
+            let ptr = self.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {
+                (self.changes_pending)(ptr);
+            }
         }
     }
     pub fn result_changed(&mut self) {
-        let ptr = self.qobject.load(Ordering::SeqCst);
-        if !ptr.is_null() {
-            (self.result_changed)(ptr);
+        if self.changes.fetch_or(1 << 1, Ordering::SeqCst) == 0 {
+            let ptr = self.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {
+                (self.changes_pending)(ptr);
+            }
         }
     }
 }
@@ -378,13 +1017,12 @@ pub trait FibonacciTrait {
 #[no_mangle]
 pub extern "C" fn fibonacci_new(
     fibonacci: *mut FibonacciQObject,
-    fibonacci_input_changed: extern fn(*mut FibonacciQObject),
-    fibonacci_result_changed: extern fn(*mut FibonacciQObject),
+    fibonacci_changes_pending: extern fn(*mut FibonacciQObject),
 ) -> *mut Fibonacci {
     let fibonacci_emit = FibonacciEmitter {
         qobject: Arc::new(AtomicPtr::new(fibonacci)),
-        input_changed: fibonacci_input_changed,
-        result_changed: fibonacci_result_changed,
+        changes: Arc::new(::std::sync::atomic::AtomicU64::new(0)),
+        changes_pending: fibonacci_changes_pending,
     };
     let d_fibonacci = Fibonacci::new(fibonacci_emit);
     Box::into_raw(Box::new(d_fibonacci))
@@ -395,6 +1033,17 @@ pub unsafe extern "C" fn fibonacci_free(ptr: *mut Fibonacci) {
     Box::from_raw(ptr).emit().clear();
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn fibonacci_take_changes(ptr: *mut Fibonacci) -> u64 {
+    (&mut *ptr).emit().changes.swap(0, Ordering::SeqCst)
+}
+
+/// The properties that changed since the last call of take_changes.
+#[no_mangle]
+pub unsafe extern "C" fn fibonacci_pending_changes(ptr: *mut Fibonacci) -> u64 {
+    (&mut *ptr).emit().changes.load(Ordering::SeqCst)
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn fibonacci_input_get(ptr: *const Fibonacci) -> u32 {
     (&*ptr).input()
@@ -444,12 +1093,20 @@ impl FibonacciListEmitter {
     }
 }
 
+/// The item properties of FibonacciList, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum FibonacciListProperty {
+    FibonacciNumber = 0,
+    Row = 1,
+}
+
 #[derive(Clone)]
 pub struct FibonacciListList {
     qobject: *mut FibonacciListQObject,
     layout_about_to_be_changed: extern fn(*mut FibonacciListQObject),
     layout_changed: extern fn(*mut FibonacciListQObject),
     data_changed: extern fn(*mut FibonacciListQObject, usize, usize),
+    properties_changed: extern fn(*mut FibonacciListQObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut FibonacciListQObject),
     end_reset_model: extern fn(*mut FibonacciListQObject),
     begin_insert_rows: extern fn(*mut FibonacciListQObject, usize, usize),
@@ -458,6 +1115,7 @@ pub struct FibonacciListList {
     end_move_rows: extern fn(*mut FibonacciListQObject),
     begin_remove_rows: extern fn(*mut FibonacciListQObject, usize, usize),
     end_remove_rows: extern fn(*mut FibonacciListQObject),
+    layout_changed_with_permutation: extern fn(*mut FibonacciListQObject, *const usize, usize),
 }
 
 impl FibonacciListList {
@@ -470,6 +1128,14 @@ impl FibonacciListList {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[FibonacciListProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -494,6 +1160,34 @@ impl FibonacciListList {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
 }
 
 pub trait FibonacciListTrait {
@@ -508,7 +1202,19 @@ pub trait FibonacciListTrait {
     fn fetch_more(&mut self) {}
     fn sort(&mut self, _: u8, _: SortOrder) {}
     fn fibonacci_number(&self, index: usize) -> u64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn fibonacci_number_column(&self, first: usize, column: &mut [u64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.fibonacci_number(first + row);
+        }
+    }
     fn row(&self, index: usize) -> u64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn row_column(&self, first: usize, column: &mut [u64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.row(first + row);
+        }
+    }
 }
 
 #[no_mangle]
@@ -518,6 +1224,7 @@ pub extern "C" fn fibonacci_list_new(
     fibonacci_list_layout_about_to_be_changed: extern fn(*mut FibonacciListQObject),
     fibonacci_list_layout_changed: extern fn(*mut FibonacciListQObject),
     fibonacci_list_data_changed: extern fn(*mut FibonacciListQObject, usize, usize),
+    fibonacci_list_properties_changed: extern fn(*mut FibonacciListQObject, usize, usize, u64),
     fibonacci_list_begin_reset_model: extern fn(*mut FibonacciListQObject),
     fibonacci_list_end_reset_model: extern fn(*mut FibonacciListQObject),
     fibonacci_list_begin_insert_rows: extern fn(*mut FibonacciListQObject, usize, usize),
@@ -526,6 +1233,7 @@ pub extern "C" fn fibonacci_list_new(
     fibonacci_list_end_move_rows: extern fn(*mut FibonacciListQObject),
     fibonacci_list_begin_remove_rows: extern fn(*mut FibonacciListQObject, usize, usize),
     fibonacci_list_end_remove_rows: extern fn(*mut FibonacciListQObject),
+    fibonacci_list_layout_changed_with_permutation: extern fn(*mut FibonacciListQObject, *const usize, usize),
 ) -> *mut FibonacciList {
     let fibonacci_list_emit = FibonacciListEmitter {
         qobject: Arc::new(AtomicPtr::new(fibonacci_list)),
@@ -536,6 +1244,7 @@ pub extern "C" fn fibonacci_list_new(
         layout_about_to_be_changed: fibonacci_list_layout_about_to_be_changed,
         layout_changed: fibonacci_list_layout_changed,
         data_changed: fibonacci_list_data_changed,
+        properties_changed: fibonacci_list_properties_changed,
         begin_reset_model: fibonacci_list_begin_reset_model,
         end_reset_model: fibonacci_list_end_reset_model,
         begin_insert_rows: fibonacci_list_begin_insert_rows,
@@ -544,6 +1253,7 @@ pub extern "C" fn fibonacci_list_new(
         end_move_rows: fibonacci_list_end_move_rows,
         begin_remove_rows: fibonacci_list_begin_remove_rows,
         end_remove_rows: fibonacci_list_end_remove_rows,
+        layout_changed_with_permutation: fibonacci_list_layout_changed_with_permutation,
     };
     let d_fibonacci_list = FibonacciList::new(fibonacci_list_emit, model);
     Box::into_raw(Box::new(d_fibonacci_list))
@@ -583,18 +1293,63 @@ pub unsafe extern "C" fn fibonacci_list_sort(
     (&mut *ptr).sort(column, order)
 }
 
+#[repr(C)]
+pub struct FibonacciListDataRange {
+    fibonacci_number: *mut u64,
+    row: *mut u64,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn fibonacci_list_data_range(
+    ptr: *const FibonacciList,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut FibonacciListDataRange,
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        let column = slice::from_raw_parts_mut(range.fibonacci_number, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.fibonacci_number(index);
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        let column = slice::from_raw_parts_mut(range.row, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.row(index);
+        }
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn fibonacci_list_data_fibonacci_number(ptr: *const FibonacciList, row: c_int) -> u64 {
     let o = &*ptr;
     o.fibonacci_number(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn fibonacci_list_column_fibonacci_number(ptr: *const FibonacciList, first: c_int, count: c_int, column: *mut u64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).fibonacci_number_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn fibonacci_list_data_row(ptr: *const FibonacciList, row: c_int) -> u64 {
     let o = &*ptr;
     o.row(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn fibonacci_list_column_row(ptr: *const FibonacciList, first: c_int, count: c_int, column: *mut u64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).row_column(to_usize(first), column);
+}
+
 pub struct FileSystemTreeQObject {}
 
 pub struct FileSystemTreeEmitter {
@@ -637,12 +1392,24 @@ impl FileSystemTreeEmitter {
     }
 }
 
+/// The item properties of FileSystemTree, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum FileSystemTreeProperty {
+    FileIcon = 0,
+    FileName = 1,
+    FilePath = 2,
+    FilePermissions = 3,
+    FileSize = 4,
+    FileType = 5,
+}
+
 #[derive(Clone)]
 pub struct FileSystemTreeTree {
     qobject: *mut FileSystemTreeQObject,
     layout_about_to_be_changed: extern fn(*mut FileSystemTreeQObject),
     layout_changed: extern fn(*mut FileSystemTreeQObject),
     data_changed: extern fn(*mut FileSystemTreeQObject, usize, usize),
+    properties_changed: extern fn(*mut FileSystemTreeQObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut FileSystemTreeQObject),
     end_reset_model: extern fn(*mut FileSystemTreeQObject),
     begin_insert_rows: extern fn(*mut FileSystemTreeQObject, index: COption<usize>, usize, usize),
@@ -663,6 +1430,14 @@ impl FileSystemTreeTree {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[FileSystemTreeProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -687,6 +1462,39 @@ impl FileSystemTreeTree {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Replace `rows`, the children of `index`, with `new` with as few
+    /// removes, moves and inserts as possible. Rows with the same `key`
+    /// are kept and, if they differ, updated and signalled with
+    /// data_changed() for the items given by `id`. `row()` has to agree
+    /// with `rows` while the signals are sent.
+    pub fn sync_from<T, K, F, I>(
+        &mut self,
+        index: Option<usize>,
+        rows: &mut Vec<T>,
+        new: Vec<T>,
+        key: F,
+        id: I,
+    ) where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+        I: Fn(&T) -> usize,
+    {
+        sync_rows(rows, new, key, |signal, current| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(index, first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(index, from, from, index, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(index, first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            // persistent indexes are found again by id
+            SyncSignal::EndLayout(_old_rows) => self.layout_changed(),
+            SyncSignal::Changed(first, last) => {
+                self.data_changed(id(&current[first]), id(&current[last]))
+            }
+        });
+    }
 }
 
 pub trait FileSystemTreeTrait {
@@ -695,6 +1503,11 @@ pub trait FileSystemTreeTrait {
     fn path(&self) -> Option<&str>;
     fn set_path(&mut self, value: Option<String>);
     fn row_count(&self, _: Option<usize>) -> usize;
+    /// Tell if an item has or may have children. Override this when
+    /// row_count() starts loading data that is not needed to answer.
+    fn has_children(&self, index: Option<usize>) -> bool {
+        self.row_count(index) > 0
+    }
     fn can_fetch_more(&self, _: Option<usize>) -> bool {
         false
     }
@@ -704,7 +1517,7 @@ pub trait FileSystemTreeTrait {
     fn index(&self, item: Option<usize>, row: usize) -> usize;
     fn parent(&self, index: usize) -> Option<usize>;
     fn row(&self, index: usize) -> usize;
-    fn file_icon(&self, index: usize) -> &[u8];
+    fn file_icon(&self, index: usize) -> Arc<[u8]>;
     fn file_name(&self, index: usize) -> String;
     fn file_path(&self, index: usize) -> Option<String>;
     fn file_permissions(&self, index: usize) -> i32;
@@ -720,6 +1533,7 @@ pub extern "C" fn file_system_tree_new(
     file_system_tree_layout_about_to_be_changed: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_layout_changed: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_data_changed: extern fn(*mut FileSystemTreeQObject, usize, usize),
+    file_system_tree_properties_changed: extern fn(*mut FileSystemTreeQObject, usize, usize, u64),
     file_system_tree_begin_reset_model: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_end_reset_model: extern fn(*mut FileSystemTreeQObject),
     file_system_tree_begin_insert_rows: extern fn(*mut FileSystemTreeQObject, index: COption<usize>, usize, usize),
@@ -739,6 +1553,7 @@ pub extern "C" fn file_system_tree_new(
         layout_about_to_be_changed: file_system_tree_layout_about_to_be_changed,
         layout_changed: file_system_tree_layout_changed,
         data_changed: file_system_tree_data_changed,
+        properties_changed: file_system_tree_properties_changed,
         begin_reset_model: file_system_tree_begin_reset_model,
         end_reset_model: file_system_tree_end_reset_model,
         begin_insert_rows: file_system_tree_begin_insert_rows,
@@ -793,6 +1608,13 @@ pub unsafe extern "C" fn file_system_tree_row_count(
     to_c_int((&*ptr).row_count(index.into()))
 }
 #[no_mangle]
+pub unsafe extern "C" fn file_system_tree_has_children(
+    ptr: *const FileSystemTree,
+    index: COption<usize>,
+) -> bool {
+    (&*ptr).has_children(index.into())
+}
+#[no_mangle]
 pub unsafe extern "C" fn file_system_tree_can_fetch_more(
     ptr: *const FileSystemTree,
     index: COption<usize>,
@@ -811,13 +1633,21 @@ pub unsafe extern "C" fn file_system_tree_sort(
 ) {
     (&mut *ptr).sort(column, order)
 }
+/// Replace each row in `rows` with the current row of the item in `ids`
+/// or with -1 if the item is gone.
 #[no_mangle]
-pub unsafe extern "C" fn file_system_tree_check_row(
+pub unsafe extern "C" fn file_system_tree_check_rows(
     ptr: *const FileSystemTree,
-    index: usize,
-    row: c_int,
-) -> COption<usize> {
-    (&*ptr).check_row(index, to_usize(row)).into()
+    ids: *const usize,
+    rows: *mut c_int,
+    len: c_int,
+) {
+    let o = &*ptr;
+    let ids = slice::from_raw_parts(ids, to_usize(len));
+    let rows = slice::from_raw_parts_mut(rows, to_usize(len));
+    for (id, row) in ids.iter().zip(rows.iter_mut()) {
+        *row = o.check_row(*id, to_usize(*row)).map_or(-1, to_c_int);
+    }
 }
 #[no_mangle]
 pub unsafe extern "C" fn file_system_tree_index(
@@ -827,6 +1657,20 @@ pub unsafe extern "C" fn file_system_tree_index(
 ) -> usize {
     (&*ptr).index(index.into(), to_usize(row))
 }
+/// The item at `row` below `index` or `None` if there is no such row.
+#[no_mangle]
+pub unsafe extern "C" fn file_system_tree_index_checked(
+    ptr: *const FileSystemTree,
+    index: COption<usize>,
+    row: c_int,
+) -> COption<usize> {
+    let o = &*ptr;
+    let index = index.into();
+    if row < 0 || to_usize(row) >= o.row_count(index) {
+        return None.into();
+    }
+    Some(o.index(index, to_usize(row))).into()
+}
 #[no_mangle]
 pub unsafe extern "C" fn file_system_tree_parent(ptr: *const FileSystemTree, index: usize) -> QModelIndex {
     if let Some(parent) = (&*ptr).parent(index) {
@@ -846,16 +1690,83 @@ pub unsafe extern "C" fn file_system_tree_row(ptr: *const FileSystemTree, index:
     to_c_int((&*ptr).row(index))
 }
 
+#[repr(C)]
+pub struct FileSystemTreeDataRange {
+    id: *mut usize,
+    file_name: *mut QString,
+    file_path: *mut QString,
+    file_permissions: *mut i32,
+    file_size: *mut COption<u64>,
+    file_type: *mut i32,
+}
+
 #[no_mangle]
-pub unsafe extern "C" fn file_system_tree_data_file_icon(
-    ptr: *const FileSystemTree, index: usize,
-    d: *mut QByteArray,
-    set: extern fn(*mut QByteArray, *const c_char, len: c_int),
+pub unsafe extern "C" fn file_system_tree_data_range(
+    ptr: *const FileSystemTree,
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut FileSystemTreeDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
 ) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let parent = parent.into();
+    let ids: Vec<usize> = (first..first + len).map(|row| o.index(parent, row)).collect();
+    if !range.id.is_null() {
+        slice::from_raw_parts_mut(range.id, len).copy_from_slice(&ids);
+    }
+    let rows = ids.iter().cloned();
+    if mask & (1 << 1) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.file_name(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.file_name, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 2) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            if let Some(data) = o.file_path(index) {
+                let s: *const c_char = data.as_ptr() as *const c_char;
+                set_qstring(range.file_path, to_c_int(i), s, to_c_int(data.len()));
+            }
+        }
+    }
+    if mask & (1 << 3) != 0 {
+        let column = slice::from_raw_parts_mut(range.file_permissions, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.file_permissions(index);
+        }
+    }
+    if mask & (1 << 4) != 0 {
+        let column = slice::from_raw_parts_mut(range.file_size, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.file_size(index).into();
+        }
+    }
+    if mask & (1 << 5) != 0 {
+        let column = slice::from_raw_parts_mut(range.file_type, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.file_type(index);
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn file_system_tree_release_arc(data: *const c_char, len: c_int) {
+    let data = slice::from_raw_parts(data as *const u8, to_usize(len));
+    drop(Arc::from_raw(data as *const [u8]));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn file_system_tree_data_file_icon(ptr: *const FileSystemTree, index: usize, len: *mut c_int) -> *const c_char {
     let o = &*ptr;
     let data = o.file_icon(index);
-    let s: *const c_char = data.as_ptr() as *const c_char;
-    set(d, s, to_c_int(data.len()));
+    *len = to_c_int(data.len());
+    Arc::into_raw(data) as *const c_char
 }
 
 #[no_mangle]
@@ -944,12 +1855,25 @@ impl ProcessesEmitter {
     }
 }
 
+/// The item properties of Processes, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum ProcessesProperty {
+    Cmd = 0,
+    CpuPercentage = 1,
+    CpuUsage = 2,
+    Memory = 3,
+    Name = 4,
+    Pid = 5,
+    Uid = 6,
+}
+
 #[derive(Clone)]
 pub struct ProcessesTree {
     qobject: *mut ProcessesQObject,
     layout_about_to_be_changed: extern fn(*mut ProcessesQObject),
     layout_changed: extern fn(*mut ProcessesQObject),
     data_changed: extern fn(*mut ProcessesQObject, usize, usize),
+    properties_changed: extern fn(*mut ProcessesQObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut ProcessesQObject),
     end_reset_model: extern fn(*mut ProcessesQObject),
     begin_insert_rows: extern fn(*mut ProcessesQObject, index: COption<usize>, usize, usize),
@@ -970,6 +1894,14 @@ impl ProcessesTree {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[ProcessesProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -994,6 +1926,39 @@ impl ProcessesTree {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Replace `rows`, the children of `index`, with `new` with as few
+    /// removes, moves and inserts as possible. Rows with the same `key`
+    /// are kept and, if they differ, updated and signalled with
+    /// data_changed() for the items given by `id`. `row()` has to agree
+    /// with `rows` while the signals are sent.
+    pub fn sync_from<T, K, F, I>(
+        &mut self,
+        index: Option<usize>,
+        rows: &mut Vec<T>,
+        new: Vec<T>,
+        key: F,
+        id: I,
+    ) where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+        I: Fn(&T) -> usize,
+    {
+        sync_rows(rows, new, key, |signal, current| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(index, first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(index, from, from, index, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(index, first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            // persistent indexes are found again by id
+            SyncSignal::EndLayout(_old_rows) => self.layout_changed(),
+            SyncSignal::Changed(first, last) => {
+                self.data_changed(id(&current[first]), id(&current[last]))
+            }
+        });
+    }
 }
 
 pub trait ProcessesTrait {
@@ -1002,6 +1967,11 @@ pub trait ProcessesTrait {
     fn active(&self) -> bool;
     fn set_active(&mut self, value: bool);
     fn row_count(&self, _: Option<usize>) -> usize;
+    /// Tell if an item has or may have children. Override this when
+    /// row_count() starts loading data that is not needed to answer.
+    fn has_children(&self, index: Option<usize>) -> bool {
+        self.row_count(index) > 0
+    }
     fn can_fetch_more(&self, _: Option<usize>) -> bool {
         false
     }
@@ -1028,6 +1998,7 @@ pub extern "C" fn processes_new(
     processes_layout_about_to_be_changed: extern fn(*mut ProcessesQObject),
     processes_layout_changed: extern fn(*mut ProcessesQObject),
     processes_data_changed: extern fn(*mut ProcessesQObject, usize, usize),
+    processes_properties_changed: extern fn(*mut ProcessesQObject, usize, usize, u64),
     processes_begin_reset_model: extern fn(*mut ProcessesQObject),
     processes_end_reset_model: extern fn(*mut ProcessesQObject),
     processes_begin_insert_rows: extern fn(*mut ProcessesQObject, index: COption<usize>, usize, usize),
@@ -1047,6 +2018,7 @@ pub extern "C" fn processes_new(
         layout_about_to_be_changed: processes_layout_about_to_be_changed,
         layout_changed: processes_layout_changed,
         data_changed: processes_data_changed,
+        properties_changed: processes_properties_changed,
         begin_reset_model: processes_begin_reset_model,
         end_reset_model: processes_end_reset_model,
         begin_insert_rows: processes_begin_insert_rows,
@@ -1083,6 +2055,13 @@ pub unsafe extern "C" fn processes_row_count(
     to_c_int((&*ptr).row_count(index.into()))
 }
 #[no_mangle]
+pub unsafe extern "C" fn processes_has_children(
+    ptr: *const Processes,
+    index: COption<usize>,
+) -> bool {
+    (&*ptr).has_children(index.into())
+}
+#[no_mangle]
 pub unsafe extern "C" fn processes_can_fetch_more(
     ptr: *const Processes,
     index: COption<usize>,
@@ -1101,13 +2080,21 @@ pub unsafe extern "C" fn processes_sort(
 ) {
     (&mut *ptr).sort(column, order)
 }
+/// Replace each row in `rows` with the current row of the item in `ids`
+/// or with -1 if the item is gone.
 #[no_mangle]
-pub unsafe extern "C" fn processes_check_row(
+pub unsafe extern "C" fn processes_check_rows(
     ptr: *const Processes,
-    index: usize,
-    row: c_int,
-) -> COption<usize> {
-    (&*ptr).check_row(index, to_usize(row)).into()
+    ids: *const usize,
+    rows: *mut c_int,
+    len: c_int,
+) {
+    let o = &*ptr;
+    let ids = slice::from_raw_parts(ids, to_usize(len));
+    let rows = slice::from_raw_parts_mut(rows, to_usize(len));
+    for (id, row) in ids.iter().zip(rows.iter_mut()) {
+        *row = o.check_row(*id, to_usize(*row)).map_or(-1, to_c_int);
+    }
 }
 #[no_mangle]
 pub unsafe extern "C" fn processes_index(
@@ -1117,6 +2104,20 @@ pub unsafe extern "C" fn processes_index(
 ) -> usize {
     (&*ptr).index(index.into(), to_usize(row))
 }
+/// The item at `row` below `index` or `None` if there is no such row.
+#[no_mangle]
+pub unsafe extern "C" fn processes_index_checked(
+    ptr: *const Processes,
+    index: COption<usize>,
+    row: c_int,
+) -> COption<usize> {
+    let o = &*ptr;
+    let index = index.into();
+    if row < 0 || to_usize(row) >= o.row_count(index) {
+        return None.into();
+    }
+    Some(o.index(index, to_usize(row))).into()
+}
 #[no_mangle]
 pub unsafe extern "C" fn processes_parent(ptr: *const Processes, index: usize) -> QModelIndex {
     if let Some(parent) = (&*ptr).parent(index) {
@@ -1136,6 +2137,84 @@ pub unsafe extern "C" fn processes_row(ptr: *const Processes, index: usize) -> c
     to_c_int((&*ptr).row(index))
 }
 
+#[repr(C)]
+pub struct ProcessesDataRange {
+    id: *mut usize,
+    cmd: *mut QString,
+    cpu_percentage: *mut u8,
+    cpu_usage: *mut f32,
+    memory: *mut u64,
+    name: *mut QString,
+    pid: *mut u32,
+    uid: *mut u32,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn processes_data_range(
+    ptr: *const Processes,
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut ProcessesDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let parent = parent.into();
+    let ids: Vec<usize> = (first..first + len).map(|row| o.index(parent, row)).collect();
+    if !range.id.is_null() {
+        slice::from_raw_parts_mut(range.id, len).copy_from_slice(&ids);
+    }
+    let rows = ids.iter().cloned();
+    if mask & (1 << 0) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.cmd(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.cmd, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        let column = slice::from_raw_parts_mut(range.cpu_percentage, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.cpu_percentage(index);
+        }
+    }
+    if mask & (1 << 2) != 0 {
+        let column = slice::from_raw_parts_mut(range.cpu_usage, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.cpu_usage(index);
+        }
+    }
+    if mask & (1 << 3) != 0 {
+        let column = slice::from_raw_parts_mut(range.memory, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.memory(index);
+        }
+    }
+    if mask & (1 << 4) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.name(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.name, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 5) != 0 {
+        let column = slice::from_raw_parts_mut(range.pid, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.pid(index);
+        }
+    }
+    if mask & (1 << 6) != 0 {
+        let column = slice::from_raw_parts_mut(range.uid, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.uid(index);
+        }
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn processes_data_cmd(
     ptr: *const Processes, index: usize,
@@ -1224,12 +2303,21 @@ impl TimeSeriesEmitter {
     }
 }
 
+/// The item properties of TimeSeries, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum TimeSeriesProperty {
+    Cos = 0,
+    Sin = 1,
+    Time = 2,
+}
+
 #[derive(Clone)]
 pub struct TimeSeriesList {
     qobject: *mut TimeSeriesQObject,
     layout_about_to_be_changed: extern fn(*mut TimeSeriesQObject),
     layout_changed: extern fn(*mut TimeSeriesQObject),
     data_changed: extern fn(*mut TimeSeriesQObject, usize, usize),
+    properties_changed: extern fn(*mut TimeSeriesQObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut TimeSeriesQObject),
     end_reset_model: extern fn(*mut TimeSeriesQObject),
     begin_insert_rows: extern fn(*mut TimeSeriesQObject, usize, usize),
@@ -1238,6 +2326,7 @@ pub struct TimeSeriesList {
     end_move_rows: extern fn(*mut TimeSeriesQObject),
     begin_remove_rows: extern fn(*mut TimeSeriesQObject, usize, usize),
     end_remove_rows: extern fn(*mut TimeSeriesQObject),
+    layout_changed_with_permutation: extern fn(*mut TimeSeriesQObject, *const usize, usize),
 }
 
 impl TimeSeriesList {
@@ -1250,6 +2339,14 @@ impl TimeSeriesList {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[TimeSeriesProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -1274,6 +2371,34 @@ impl TimeSeriesList {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
 }
 
 pub trait TimeSeriesTrait {
@@ -1288,10 +2413,28 @@ pub trait TimeSeriesTrait {
     fn fetch_more(&mut self) {}
     fn sort(&mut self, _: u8, _: SortOrder) {}
     fn cos(&self, index: usize) -> f32;
+    /// Copy the values for the rows from `first` into `column`.
+    fn cos_column(&self, first: usize, column: &mut [f32]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.cos(first + row);
+        }
+    }
     fn set_cos(&mut self, index: usize, _: f32) -> bool;
     fn sin(&self, index: usize) -> f32;
+    /// Copy the values for the rows from `first` into `column`.
+    fn sin_column(&self, first: usize, column: &mut [f32]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.sin(first + row);
+        }
+    }
     fn set_sin(&mut self, index: usize, _: f32) -> bool;
     fn time(&self, index: usize) -> f32;
+    /// Copy the values for the rows from `first` into `column`.
+    fn time_column(&self, first: usize, column: &mut [f32]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.time(first + row);
+        }
+    }
     fn set_time(&mut self, index: usize, _: f32) -> bool;
 }
 
@@ -1302,6 +2445,7 @@ pub extern "C" fn time_series_new(
     time_series_layout_about_to_be_changed: extern fn(*mut TimeSeriesQObject),
     time_series_layout_changed: extern fn(*mut TimeSeriesQObject),
     time_series_data_changed: extern fn(*mut TimeSeriesQObject, usize, usize),
+    time_series_properties_changed: extern fn(*mut TimeSeriesQObject, usize, usize, u64),
     time_series_begin_reset_model: extern fn(*mut TimeSeriesQObject),
     time_series_end_reset_model: extern fn(*mut TimeSeriesQObject),
     time_series_begin_insert_rows: extern fn(*mut TimeSeriesQObject, usize, usize),
@@ -1310,6 +2454,7 @@ pub extern "C" fn time_series_new(
     time_series_end_move_rows: extern fn(*mut TimeSeriesQObject),
     time_series_begin_remove_rows: extern fn(*mut TimeSeriesQObject, usize, usize),
     time_series_end_remove_rows: extern fn(*mut TimeSeriesQObject),
+    time_series_layout_changed_with_permutation: extern fn(*mut TimeSeriesQObject, *const usize, usize),
 ) -> *mut TimeSeries {
     let time_series_emit = TimeSeriesEmitter {
         qobject: Arc::new(AtomicPtr::new(time_series)),
@@ -1320,6 +2465,7 @@ pub extern "C" fn time_series_new(
         layout_about_to_be_changed: time_series_layout_about_to_be_changed,
         layout_changed: time_series_layout_changed,
         data_changed: time_series_data_changed,
+        properties_changed: time_series_properties_changed,
         begin_reset_model: time_series_begin_reset_model,
         end_reset_model: time_series_end_reset_model,
         begin_insert_rows: time_series_begin_insert_rows,
@@ -1328,6 +2474,7 @@ pub extern "C" fn time_series_new(
         end_move_rows: time_series_end_move_rows,
         begin_remove_rows: time_series_begin_remove_rows,
         end_remove_rows: time_series_end_remove_rows,
+        layout_changed_with_permutation: time_series_layout_changed_with_permutation,
     };
     let d_time_series = TimeSeries::new(time_series_emit, model);
     Box::into_raw(Box::new(d_time_series))
@@ -1367,12 +2514,58 @@ pub unsafe extern "C" fn time_series_sort(
     (&mut *ptr).sort(column, order)
 }
 
+#[repr(C)]
+pub struct TimeSeriesDataRange {
+    cos: *mut f32,
+    sin: *mut f32,
+    time: *mut f32,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn time_series_data_range(
+    ptr: *const TimeSeries,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut TimeSeriesDataRange,
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        let column = slice::from_raw_parts_mut(range.cos, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.cos(index);
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        let column = slice::from_raw_parts_mut(range.sin, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.sin(index);
+        }
+    }
+    if mask & (1 << 2) != 0 {
+        let column = slice::from_raw_parts_mut(range.time, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.time(index);
+        }
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn time_series_data_cos(ptr: *const TimeSeries, row: c_int) -> f32 {
     let o = &*ptr;
     o.cos(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn time_series_column_cos(ptr: *const TimeSeries, first: c_int, count: c_int, column: *mut f32) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).cos_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn time_series_set_data_cos(
     ptr: *mut TimeSeries, row: c_int,
@@ -1387,6 +2580,12 @@ pub unsafe extern "C" fn time_series_data_sin(ptr: *const TimeSeries, row: c_int
     o.sin(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn time_series_column_sin(ptr: *const TimeSeries, first: c_int, count: c_int, column: *mut f32) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).sin_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn time_series_set_data_sin(
     ptr: *mut TimeSeries, row: c_int,
@@ -1401,6 +2600,12 @@ pub unsafe extern "C" fn time_series_data_time(ptr: *const TimeSeries, row: c_in
     o.time(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn time_series_column_time(ptr: *const TimeSeries, first: c_int, count: c_int, column: *mut f32) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).time_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn time_series_set_data_time(
     ptr: *mut TimeSeries, row: c_int,
@@ -1408,3 +2613,347 @@ pub unsafe extern "C" fn time_series_set_data_time(
 ) -> bool {
     (&mut *ptr).set_time(to_usize(row), v)
 }
+
+/// The rows of TimeSeries with one `Vec` per item property.
+///
+/// All columns have the same length. Each column is available as a slice,
+/// so a scan over one property does not touch the others.
+#[derive(Default, Clone)]
+pub struct TimeSeriesColumns {
+    rows: usize,
+    cos: Vec<f32>,
+    sin: Vec<f32>,
+    time: Vec<f32>,
+}
+
+/// The values of one row of TimeSeriesColumns.
+#[derive(Default, Clone)]
+pub struct TimeSeriesRow {
+    pub cos: f32,
+    pub sin: f32,
+    pub time: f32,
+}
+
+impl TimeSeriesColumns {
+    pub fn new() -> Self {
+        Self::default()
+    }
+    pub fn len(&self) -> usize {
+        self.rows
+    }
+    pub fn is_empty(&self) -> bool {
+        self.rows == 0
+    }
+    pub fn cos(&self) -> &[f32] {
+        &self.cos
+    }
+    pub fn cos_mut(&mut self) -> &mut [f32] {
+        &mut self.cos
+    }
+    pub fn sin(&self) -> &[f32] {
+        &self.sin
+    }
+    pub fn sin_mut(&mut self) -> &mut [f32] {
+        &mut self.sin
+    }
+    pub fn time(&self) -> &[f32] {
+        &self.time
+    }
+    pub fn time_mut(&mut self) -> &mut [f32] {
+        &mut self.time
+    }
+    pub fn push(&mut self, values: TimeSeriesRow) {
+        self.cos.push(values.cos);
+        self.sin.push(values.sin);
+        self.time.push(values.time);
+        self.rows += 1;
+    }
+    pub fn insert(&mut self, row: usize, values: TimeSeriesRow) {
+        self.cos.insert(row, values.cos);
+        self.sin.insert(row, values.sin);
+        self.time.insert(row, values.time);
+        self.rows += 1;
+    }
+    pub fn remove(&mut self, row: usize) {
+        self.cos.remove(row);
+        self.sin.remove(row);
+        self.time.remove(row);
+        self.rows -= 1;
+    }
+    pub fn truncate(&mut self, len: usize) {
+        self.cos.truncate(len);
+        self.sin.truncate(len);
+        self.time.truncate(len);
+        self.rows = self.rows.min(len);
+    }
+    pub fn clear(&mut self) {
+        self.truncate(0);
+    }
+    pub fn reserve(&mut self, additional: usize) {
+        self.cos.reserve(additional);
+        self.sin.reserve(additional);
+        self.time.reserve(additional);
+    }
+}
+
+pub struct SortedProcesses {
+    property: c_int,
+    filter: String,
+    // for each item that was asked for: does it or a descendant match
+    accepted: ::std::collections::HashMap<usize, bool>,
+}
+
+impl SortedProcesses {
+    /// Tell if the item property `property` contains the filter.
+    fn matches(&self, o: &Processes, index: usize) -> bool {
+        let filter = &self.filter;
+        match self.property {
+            0 => {
+                let v = o.cmd(index);
+                v.to_lowercase().contains(filter)
+            }
+            1 => {
+                let v = o.cpu_percentage(index);
+                v.to_string().contains(filter)
+            }
+            2 => {
+                let v = o.cpu_usage(index);
+                v.to_string().contains(filter)
+            }
+            3 => {
+                let v = o.memory(index);
+                v.to_string().contains(filter)
+            }
+            4 => {
+                let v = o.name(index);
+                v.to_lowercase().contains(filter)
+            }
+            5 => {
+                let v = o.pid(index);
+                v.to_string().contains(filter)
+            }
+            6 => {
+                let v = o.uid(index);
+                v.to_string().contains(filter)
+            }
+            _ => true,
+        }
+    }
+    /// Tell if the item or one of its descendants matches the filter.
+    /// Each item is visited once until the filter or the item changes.
+    /// The tree is walked with a stack of (item, next row, row count)
+    /// instead of recursion, so deep trees do not overflow the call stack.
+    fn accepts(&mut self, o: &Processes, index: usize) -> bool {
+        let mut stack: Vec<(usize, usize, usize)> = Vec::new();
+        let mut next = Some(index);
+        let mut accepted = None;
+        loop {
+            if let Some(item) = next.take() {
+                accepted = self.accepted.get(&item).cloned();
+                if accepted.is_none() {
+                    if self.matches(o, item) {
+                        accepted = Some(true);
+                    } else if o.has_children(Some(item)) {
+                        stack.push((item, 0, o.row_count(Some(item))));
+                    } else {
+                        accepted = Some(false);
+                    }
+                    if let Some(a) = accepted {
+                        self.accepted.insert(item, a);
+                    }
+                }
+            }
+            let top = match stack.last_mut() {
+                Some(top) => top,
+                None => return accepted.unwrap_or(false),
+            };
+            // an item is accepted as soon as one of its children is
+            let (item, row, row_count) = *top;
+            if accepted != Some(true) && row < row_count {
+                top.1 += 1;
+                next = Some(o.index(Some(item), row));
+                continue;
+            }
+            stack.pop();
+            let a = accepted == Some(true);
+            self.accepted.insert(item, a);
+            accepted = Some(a);
+        }
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn sorted_processes_new() -> *mut SortedProcesses {
+    Box::into_raw(Box::new(SortedProcesses {
+        property: -1,
+        filter: String::new(),
+        accepted: ::std::collections::HashMap::new(),
+    }))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn sorted_processes_free(ptr: *mut SortedProcesses) {
+    drop(Box::from_raw(ptr));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn sorted_processes_set_filter(
+    ptr: *mut SortedProcesses,
+    property: c_int,
+    filter: *const c_ushort,
+    filter_len: c_int,
+) {
+    let p = &mut *ptr;
+    p.property = property;
+    p.filter = String::from_utf16_lossy(slice::from_raw_parts(filter, to_usize(filter_len)))
+        .to_lowercase();
+    p.accepted.clear();
+}
+
+/// Write the rows that pass the filter, in sorted order, to `rows`.
+#[no_mangle]
+pub unsafe extern "C" fn sorted_processes_rows(
+    ptr: *mut SortedProcesses,
+    source: *const Processes,
+    parent: COption<usize>,
+    sort: c_int,
+    order: SortOrder,
+    rows: *mut c_int,
+) -> c_int {
+    let p = &mut *ptr;
+    let o = &*source;
+    let parent = parent.into();
+    let index = |row| o.index(parent, row);
+    let row_count = o.row_count(parent);
+    let mut accepted: Vec<usize> = (0..row_count)
+        .filter(|&row| p.filter.is_empty() || p.accepts(o, index(row)))
+        .collect();
+    match sort {
+        0 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.cmd(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        1 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.cpu_percentage(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        2 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.cpu_usage(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.partial_cmp(b).unwrap_or(::std::cmp::Ordering::Equal));
+        }
+        3 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.memory(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        4 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.name(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        5 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.pid(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        6 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.uid(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        _ => {}
+    }
+    let rows = slice::from_raw_parts_mut(rows, accepted.len());
+    for (r, a) in rows.iter_mut().zip(&accepted) {
+        *r = to_c_int(*a);
+    }
+    to_c_int(accepted.len())
+}
+
+/// Find the position of the source row `row` among `rows`, the rows that
+/// pass the filter in sorted order without `row`. Return -1 when `row`
+/// does not pass the filter.
+#[no_mangle]
+pub unsafe extern "C" fn sorted_processes_place(
+    ptr: *mut SortedProcesses,
+    source: *const Processes,
+    parent: COption<usize>,
+    sort: c_int,
+    order: SortOrder,
+    rows: *const c_int,
+    len: c_int,
+    row: c_int,
+) -> c_int {
+    let p = &mut *ptr;
+    let o = &*source;
+    let parent = parent.into();
+    let index = |row| o.index(parent, row);
+    let row = to_usize(row);
+    if !p.filter.is_empty() && !p.accepts(o, index(row)) {
+        return -1;
+    }
+    let rows = slice::from_raw_parts(rows, to_usize(len));
+    let place = match sort {
+        0 => place_row(rows, row, |r| o.cmd(index(r)), order, |a, b| a.cmp(b)),
+        1 => place_row(rows, row, |r| o.cpu_percentage(index(r)), order, |a, b| a.cmp(b)),
+        2 => place_row(rows, row, |r| o.cpu_usage(index(r)), order, |a, b| a.partial_cmp(b).unwrap_or(::std::cmp::Ordering::Equal)),
+        3 => place_row(rows, row, |r| o.memory(index(r)), order, |a, b| a.cmp(b)),
+        4 => place_row(rows, row, |r| o.name(index(r)), order, |a, b| a.cmp(b)),
+        5 => place_row(rows, row, |r| o.pid(index(r)), order, |a, b| a.cmp(b)),
+        6 => place_row(rows, row, |r| o.uid(index(r)), order, |a, b| a.cmp(b)),
+        _ => place_row(rows, row, |r| r, SortOrder::Ascending, |a, b| a.cmp(b)),
+    };
+    to_c_int(place)
+}
+
+/// Forget what is known about the rows `first` to `last` and the ancestors
+/// of these rows.
+#[no_mangle]
+pub unsafe extern "C" fn sorted_processes_changed(
+    ptr: *mut SortedProcesses,
+    source: *const Processes,
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+) {
+    let p = &mut *ptr;
+    let o = &*source;
+    let parent = parent.into();
+    for row in first..last + 1 {
+        p.accepted.remove(&o.index(parent, to_usize(row)));
+    }
+    let mut index = parent;
+    while let Some(i) = index {
+        p.accepted.remove(&i);
+        index = o.parent(i);
+    }
+}
+
+/// Forget what is known about the rows `first` to `last`, all their
+/// descendants and the ancestors of these rows. The rows are about to be
+/// removed.
+#[no_mangle]
+pub unsafe extern "C" fn sorted_processes_removed(
+    ptr: *mut SortedProcesses,
+    source: *const Processes,
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+) {
+    let p = &mut *ptr;
+    let o = &*source;
+    let parent = parent.into();
+    if p.accepted.is_empty() {
+        return;
+    }
+    let mut stack: Vec<usize> = (first..last + 1)
+        .map(|row| o.index(parent, to_usize(row)))
+        .collect();
+    while let Some(index) = stack.pop() {
+        p.accepted.remove(&index);
+        if o.has_children(Some(index)) {
+            stack.extend((0..o.row_count(Some(index))).map(|row| o.index(Some(index), row)));
+        }
+    }
+    let mut index = parent;
+    while let Some(i) = index {
+        p.accepted.remove(&i);
+        index = o.parent(i);
+    }
+}
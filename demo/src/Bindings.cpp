@@ -1,5 +1,8 @@
 /* generated by rust_qt_binding_generator */
 #include "Bindings.h"
+#include <algorithm>
+#include <iterator>
+#include <QtCore/QMutex>
 
 namespace {
 
@@ -34,16 +37,64 @@ namespace {
         *val = QString::fromUtf8(utf8, nbytes);
     }
 
-    typedef void (*qbytearray_set)(QByteArray* val, const char* bytes, int nbytes);
-    void set_qbytearray(QByteArray* v, const char* bytes, int nbytes) {
-        if (v->isNull() && nbytes == 0) {
-            *v = QByteArray(bytes, nbytes);
-        } else {
-            v->truncate(0);
-            v->append(bytes, nbytes);
+    typedef void (*qstring_set_at)(QString* val, int i, const char* bytes, int nbytes);
+    void set_qstring_at(QString* val, int i, const char* bytes, int nbytes) {
+        val[i] = QString::fromUtf8(bytes, nbytes);
+    }
+
+    typedef void (*arc_release)(const char* data, int len);
+    struct arc_entry_t {
+        QByteArray bytes;
+        arc_release release;
+    };
+    class arc_registry_t {
+        QMutex mutex;
+        QHash<const char*, arc_entry_t> entries;
+        // inserts until the next sweep; this grows with the number of
+        // buffers in use, so a sweep costs O(1) per insert
+        int sweepAfter = 64;
+        void sweep() {
+            auto i = entries.begin();
+            while (i != entries.end()) {
+                if (i.value().bytes.isDetached()) {
+                    i.value().release(i.key(), i.value().bytes.size());
+                    i = entries.erase(i);
+                } else {
+                    ++i;
+                }
+            }
+            sweepAfter = qMax(64, entries.size());
+        }
+    public:
+        QByteArray get(const char* data, int len, arc_release release) {
+            QMutexLocker lock(&mutex);
+            auto i = entries.constFind(data);
+            if (i != entries.constEnd()) {
+                release(data, len);
+                return i.value().bytes;
+            }
+            if (len == 0) {
+                release(data, len);
+                return QByteArray(data, 0);
+            }
+            if (--sweepAfter <= 0) {
+                sweep();
+            }
+            // the buffer is kept alive by Rust until no QByteArray refers to it
+            const QByteArray b = QByteArray::fromRawData(data, len);
+            entries.insert(data, arc_entry_t{b, release});
+            return b;
         }
+    };
+    arc_registry_t& arc_registry() {
+        static arc_registry_t registry;
+        return registry;
     }
 
+    struct role_name_t {
+        const char* name;
+        int role;
+    };
     struct qmodelindex_t {
         int row;
         quintptr id;
@@ -51,17 +102,9 @@ namespace {
     inline QVariant cleanNullQVariant(const QVariant& v) {
         return (v.isNull()) ?QVariant() :v;
     }
-    inline void fibonacciInputChanged(Fibonacci* o)
-    {
-        Q_EMIT o->inputChanged();
-    }
-    inline void fibonacciResultChanged(Fibonacci* o)
-    {
-        Q_EMIT o->resultChanged();
-    }
     inline void fileSystemTreePathChanged(FileSystemTree* o)
     {
-        Q_EMIT o->pathChanged();
+        QMetaObject::invokeMethod(o, "invalidatePath");
     }
     inline void processesActiveChanged(Processes* o)
     {
@@ -69,11 +112,12 @@ namespace {
     }
 }
 extern "C" {
-    Demo::Private* demo_new(Demo*, Fibonacci*, void (*)(Fibonacci*), void (*)(Fibonacci*), FibonacciList*,
+    Demo::Private* demo_new(Demo*, Fibonacci*, void (*)(Fibonacci*), FibonacciList*,
         void (*)(const FibonacciList*),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*, quintptr, quintptr),
+        void (*)(FibonacciList*, quintptr, quintptr, quint64),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*, int, int),
@@ -81,11 +125,13 @@ extern "C" {
         void (*)(FibonacciList*, int, int, int),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*, int, int),
-        void (*)(FibonacciList*), FileSystemTree*, void (*)(FileSystemTree*),
+        void (*)(FibonacciList*),
+        void (*)(FibonacciList*, const quintptr*, quintptr), FileSystemTree*, void (*)(FileSystemTree*),
         void (*)(const FileSystemTree*, option_quintptr),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*, quintptr, quintptr),
+        void (*)(FileSystemTree*, quintptr, quintptr, quint64),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*, option_quintptr, int, int),
@@ -98,6 +144,7 @@ extern "C" {
         void (*)(Processes*),
         void (*)(Processes*),
         void (*)(Processes*, quintptr, quintptr),
+        void (*)(Processes*, quintptr, quintptr, quint64),
         void (*)(Processes*),
         void (*)(Processes*),
         void (*)(Processes*, option_quintptr, int, int),
@@ -110,6 +157,7 @@ extern "C" {
         void (*)(TimeSeries*),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*, quintptr, quintptr),
+        void (*)(TimeSeries*, quintptr, quintptr, quint64),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*, int, int),
@@ -117,7 +165,8 @@ extern "C" {
         void (*)(TimeSeries*, int, int, int),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*, int, int),
-        void (*)(TimeSeries*));
+        void (*)(TimeSeries*),
+        void (*)(TimeSeries*, const quintptr*, quintptr));
     void demo_free(Demo::Private*);
     Fibonacci::Private* demo_fibonacci_get(const Demo::Private*);
     FibonacciList::Private* demo_fibonacci_list_get(const Demo::Private*);
@@ -127,16 +176,76 @@ extern "C" {
 };
 
 extern "C" {
-    Fibonacci::Private* fibonacci_new(Fibonacci*, void (*)(Fibonacci*), void (*)(Fibonacci*));
+    Fibonacci::Private* fibonacci_new(Fibonacci*, void (*)(Fibonacci*));
     void fibonacci_free(Fibonacci::Private*);
+    quint64 fibonacci_take_changes(Fibonacci::Private*);
+    quint64 fibonacci_pending_changes(Fibonacci::Private*);
     quint32 fibonacci_input_get(const Fibonacci::Private*);
     void fibonacci_input_set(Fibonacci::Private*, quint32);
     quint64 fibonacci_result_get(const Fibonacci::Private*);
 };
 
+namespace {
+    struct fibonacci_list_data_range_t {
+        quint64* fibonacciNumber;
+        quint64* row;
+    };
+    constexpr role_name_t fibonacci_list_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"fibonacciNumber", Qt::UserRole + 0},
+        {"row", Qt::UserRole + 1},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int fibonacci_list_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::DisplayRole:
+            case Qt::UserRole + 1:
+                return 1;
+            }
+            break;
+        case 1:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 0:
+                return 0;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void fibonacci_list_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 1);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void fibonacci_list_data_range(const FibonacciList::Private*, int, int, quint64, fibonacci_list_data_range_t*);
     quint64 fibonacci_list_data_fibonacci_number(const FibonacciList::Private*, int);
+    void fibonacci_list_column_fibonacci_number(const FibonacciList::Private*, int, int, quint64*);
     quint64 fibonacci_list_data_row(const FibonacciList::Private*, int);
+    void fibonacci_list_column_row(const FibonacciList::Private*, int, int, quint64*);
     void fibonacci_list_sort(FibonacciList::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
 
     int fibonacci_list_row_count(const FibonacciList::Private*);
@@ -196,6 +305,28 @@ void FibonacciList::fetchMore(const QModelIndex &parent)
 }
 void FibonacciList::updatePersistentIndexes() {}
 
+void FibonacciList::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
 void FibonacciList::sort(int column, Qt::SortOrder order)
 {
     fibonacci_list_sort(m_d, column, order);
@@ -216,45 +347,92 @@ quint64 FibonacciList::row(int row) const
     return fibonacci_list_data_row(m_d, row);
 }
 
+QVector<quint64> FibonacciList::fibonacciNumberColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint64> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        fibonacci_list_column_fibonacci_number(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<quint64> FibonacciList::rowColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint64> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        fibonacci_list_column_row(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+struct FibonacciList::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<quint64> fibonacciNumber;
+    QVector<quint64> row;
+};
+
+void FibonacciList::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int FibonacciList::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->fibonacciNumber.resize(r->count);
+        r->row.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        fibonacci_list_data_range_t columns = {
+            r->fibonacciNumber.data(),
+            r->row.data()
+        };
+        fibonacci_list_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant FibonacciList::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (fibonacci_list_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(fibonacciNumber(index.row()));
-        case Qt::DisplayRole:
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(row(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->fibonacciNumber.value(dataRangeRow(index, 0)));
     case 1:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(fibonacciNumber(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->row.value(dataRangeRow(index, 1)));
     }
     return QVariant();
 }
 
 int FibonacciList::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(fibonacci_list_role_names);
+    auto i = std::lower_bound(std::begin(fibonacci_list_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> FibonacciList::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "fibonacciNumber");
-    names.insert(Qt::UserRole + 1, "row");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: fibonacci_list_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant FibonacciList::headerData(int section, Qt::Orientation orientation, int role) const
@@ -274,12 +452,46 @@ bool FibonacciList::setHeaderData(int section, Qt::Orientation orientation, cons
     return true;
 }
 
+void FibonacciList::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void FibonacciList::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        fibonacci_list_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 extern "C" {
     FibonacciList::Private* fibonacci_list_new(FibonacciList*,
         void (*)(const FibonacciList*),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*, quintptr, quintptr),
+        void (*)(FibonacciList*, quintptr, quintptr, quint64),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*, int, int),
@@ -287,12 +499,128 @@ extern "C" {
         void (*)(FibonacciList*, int, int, int),
         void (*)(FibonacciList*),
         void (*)(FibonacciList*, int, int),
-        void (*)(FibonacciList*));
+        void (*)(FibonacciList*),
+        void (*)(FibonacciList*, const quintptr*, quintptr));
     void fibonacci_list_free(FibonacciList::Private*);
 };
 
+namespace {
+    struct file_system_tree_data_range_t {
+        quintptr* id;
+        QString* fileName;
+        QString* filePath;
+        qint32* filePermissions;
+        option_quint64* fileSize;
+        qint32* fileType;
+    };
+    constexpr role_name_t file_system_tree_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"fileIcon", Qt::UserRole + 0},
+        {"fileName", Qt::UserRole + 1},
+        {"filePath", Qt::UserRole + 2},
+        {"filePermissions", Qt::UserRole + 3},
+        {"fileSize", Qt::UserRole + 4},
+        {"fileType", Qt::UserRole + 5},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int file_system_tree_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::DecorationRole:
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::DisplayRole:
+            case Qt::UserRole + 1:
+                return 1;
+            case Qt::UserRole + 2:
+                return 2;
+            case Qt::UserRole + 3:
+                return 3;
+            case Qt::UserRole + 4:
+                return 4;
+            case Qt::UserRole + 5:
+                return 5;
+            }
+            break;
+        case 1:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 4:
+                return 4;
+            }
+            break;
+        case 2:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 2:
+                return 2;
+            }
+            break;
+        case 3:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 3:
+                return 3;
+            }
+            break;
+        case 4:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 5:
+                return 5;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void file_system_tree_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DecorationRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 2)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 2);
+            lastColumn = qMax(lastColumn, 2);
+        }
+        if (properties & (quint64(1) << 3)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 3);
+            lastColumn = qMax(lastColumn, 3);
+        }
+        if (properties & (quint64(1) << 4)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 4);
+            lastColumn = qMax(lastColumn, 1);
+        }
+        if (properties & (quint64(1) << 5)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 5);
+            lastColumn = qMax(lastColumn, 4);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
-    void file_system_tree_data_file_icon(const FileSystemTree::Private*, quintptr, QByteArray*, qbytearray_set);
+    void file_system_tree_data_range(const FileSystemTree::Private*, option_quintptr, int, int, quint64, file_system_tree_data_range_t*, qstring_set_at);
+    void file_system_tree_release_arc(const char*, int);
+    const char* file_system_tree_data_file_icon(const FileSystemTree::Private*, quintptr, int*);
     void file_system_tree_data_file_name(const FileSystemTree::Private*, quintptr, QString*, qstring_set);
     void file_system_tree_data_file_path(const FileSystemTree::Private*, quintptr, QString*, qstring_set);
     qint32 file_system_tree_data_file_permissions(const FileSystemTree::Private*, quintptr);
@@ -301,12 +629,14 @@ extern "C" {
     void file_system_tree_sort(FileSystemTree::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
 
     int file_system_tree_row_count(const FileSystemTree::Private*, option_quintptr);
+    bool file_system_tree_has_children(const FileSystemTree::Private*, option_quintptr);
     bool file_system_tree_can_fetch_more(const FileSystemTree::Private*, option_quintptr);
     void file_system_tree_fetch_more(FileSystemTree::Private*, option_quintptr);
     quintptr file_system_tree_index(const FileSystemTree::Private*, option_quintptr, int);
+    option_quintptr file_system_tree_index_checked(const FileSystemTree::Private*, option_quintptr, int);
     qmodelindex_t file_system_tree_parent(const FileSystemTree::Private*, quintptr);
     int file_system_tree_row(const FileSystemTree::Private*, quintptr);
-    option_quintptr file_system_tree_check_row(const FileSystemTree::Private*, quintptr, int);
+    void file_system_tree_check_rows(const FileSystemTree::Private*, const quintptr*, int*, int);
 }
 int FileSystemTree::columnCount(const QModelIndex &) const
 {
@@ -315,7 +645,14 @@ int FileSystemTree::columnCount(const QModelIndex &) const
 
 bool FileSystemTree::hasChildren(const QModelIndex &parent) const
 {
-    return rowCount(parent) > 0;
+    if (parent.isValid() && parent.column() != 0) {
+        return false;
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    return file_system_tree_has_children(m_d, rust_parent);
 }
 
 int FileSystemTree::rowCount(const QModelIndex &parent) const
@@ -348,15 +685,13 @@ QModelIndex FileSystemTree::index(int row, int column, const QModelIndex &parent
     if (parent.isValid() && parent.column() != 0) {
         return QModelIndex();
     }
-    if (row >= rowCount(parent)) {
-        return QModelIndex();
-    }
     const option_quintptr rust_parent = {
         parent.internalId(),
         parent.isValid()
     };
-    const quintptr id = file_system_tree_index(m_d, rust_parent, row);
-    return createIndex(row, column, id);
+    // checks the row and finds the item in one call
+    const option_quintptr id = file_system_tree_index_checked(m_d, rust_parent, row);
+    return id.some ?createIndex(row, column, id.value) :QModelIndex();
 }
 
 QModelIndex FileSystemTree::parent(const QModelIndex &index) const
@@ -390,13 +725,22 @@ void FileSystemTree::fetchMore(const QModelIndex &parent)
 }
 void FileSystemTree::updatePersistentIndexes() {
     const auto from = persistentIndexList();
+    const int len = from.size();
+    if (len == 0) {
+        return;
+    }
+    // ask Rust for the new rows of all persistent indexes at once
+    QVector<quintptr> ids(len);
+    QVector<int> rows(len);
+    for (int i = 0; i < len; ++i) {
+        ids[i] = from.at(i).internalId();
+        rows[i] = from.at(i).row();
+    }
+    file_system_tree_check_rows(m_d, ids.constData(), rows.data(), len);
     auto to = from;
-    auto len = to.size();
     for (int i = 0; i < len; ++i) {
-        auto index = to.at(i);
-        auto row = file_system_tree_check_row(m_d, index.internalId(), index.row());
-        if (row.some) {
-            to[i] = createIndex(row.value, index.column(), index.internalId());
+        if (rows.at(i) >= 0) {
+            to[i] = createIndex(rows.at(i), from.at(i).column(), ids.at(i));
         } else {
             to[i] = QModelIndex();
         }
@@ -416,9 +760,9 @@ Qt::ItemFlags FileSystemTree::flags(const QModelIndex &i) const
 
 QByteArray FileSystemTree::fileIcon(const QModelIndex& index) const
 {
-    QByteArray b;
-    file_system_tree_data_file_icon(m_d, index.internalId(), &b, set_qbytearray);
-    return b;
+    int len;
+    const char* data = file_system_tree_data_file_icon(m_d, index.internalId(), &len);
+    return arc_registry().get(data, len, file_system_tree_release_arc);
 }
 
 QString FileSystemTree::fileName(const QModelIndex& index) const
@@ -452,79 +796,95 @@ qint32 FileSystemTree::fileType(const QModelIndex& index) const
     return file_system_tree_data_file_type(m_d, index.internalId());
 }
 
+struct FileSystemTree::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    option_quintptr parent;
+    QVector<quintptr> id;
+    QVector<QString> fileName;
+    QVector<QString> filePath;
+    QVector<qint32> filePermissions;
+    QVector<option_quint64> fileSize;
+    QVector<qint32> fileType;
+};
+
+void FileSystemTree::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int FileSystemTree::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    bool fetchIds = false;
+    if (row < r->first || row >= r->first + r->count
+            || r->id.at(row - r->first) != index.internalId()) {
+        const QModelIndex parent = index.parent();
+        r->parent = { parent.internalId(), parent.isValid() };
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->id.resize(r->count);
+        fetchIds = true;
+        r->fileName.resize(r->count);
+        r->filePath.fill(QString(), r->count);
+        r->filePermissions.resize(r->count);
+        r->fileSize.resize(r->count);
+        r->fileType.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        file_system_tree_data_range_t columns = {
+            fetchIds ?r->id.data() :nullptr,
+            r->fileName.data(),
+            r->filePath.data(),
+            r->filePermissions.data(),
+            r->fileSize.data(),
+            r->fileType.data()
+        };
+        file_system_tree_data_range(m_d, r->parent, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant FileSystemTree::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (file_system_tree_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::DecorationRole:
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(fileIcon(index));
-        case Qt::DisplayRole:
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(fileName(index));
-        case Qt::UserRole + 2:
-            return cleanNullQVariant(QVariant::fromValue(filePath(index)));
-        case Qt::UserRole + 3:
-            return QVariant::fromValue(filePermissions(index));
-        case Qt::UserRole + 4:
-            return fileSize(index);
-        case Qt::UserRole + 5:
-            return QVariant::fromValue(fileType(index));
-        }
-        break;
+        return QVariant::fromValue(fileIcon(index));
     case 1:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 4:
-            return fileSize(index);
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->fileName.value(dataRangeRow(index, 1)));
     case 2:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 2:
-            return cleanNullQVariant(QVariant::fromValue(filePath(index)));
-        }
-        break;
+        return cleanNullQVariant(QVariant::fromValue(m_dataRange->filePath.value(dataRangeRow(index, 2))));
     case 3:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 3:
-            return QVariant::fromValue(filePermissions(index));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->filePermissions.value(dataRangeRow(index, 3)));
     case 4:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 5:
-            return QVariant::fromValue(fileType(index));
-        }
-        break;
+        return m_dataRange->fileSize.value(dataRangeRow(index, 4));
+    case 5:
+        return QVariant::fromValue(m_dataRange->fileType.value(dataRangeRow(index, 5)));
     }
     return QVariant();
 }
 
 int FileSystemTree::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(file_system_tree_role_names);
+    auto i = std::lower_bound(std::begin(file_system_tree_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> FileSystemTree::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "fileIcon");
-    names.insert(Qt::UserRole + 1, "fileName");
-    names.insert(Qt::UserRole + 2, "filePath");
-    names.insert(Qt::UserRole + 3, "filePermissions");
-    names.insert(Qt::UserRole + 4, "fileSize");
-    names.insert(Qt::UserRole + 5, "fileType");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: file_system_tree_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant FileSystemTree::headerData(int section, Qt::Orientation orientation, int role) const
@@ -544,12 +904,46 @@ bool FileSystemTree::setHeaderData(int section, Qt::Orientation orientation, con
     return true;
 }
 
+void FileSystemTree::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void FileSystemTree::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        file_system_tree_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 extern "C" {
     FileSystemTree::Private* file_system_tree_new(FileSystemTree*, void (*)(FileSystemTree*),
         void (*)(const FileSystemTree*, option_quintptr),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*, quintptr, quintptr),
+        void (*)(FileSystemTree*, quintptr, quintptr, quint64),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*),
         void (*)(FileSystemTree*, option_quintptr, int, int),
@@ -564,7 +958,114 @@ extern "C" {
     void file_system_tree_path_set_none(FileSystemTree::Private*);
 };
 
+namespace {
+    struct processes_data_range_t {
+        quintptr* id;
+        QString* cmd;
+        quint8* cpuPercentage;
+        float* cpuUsage;
+        quint64* memory;
+        QString* name;
+        quint32* pid;
+        quint32* uid;
+    };
+    constexpr role_name_t processes_role_names[] = {
+        {"cmd", Qt::UserRole + 0},
+        {"cpuPercentage", Qt::UserRole + 1},
+        {"cpuUsage", Qt::UserRole + 2},
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"memory", Qt::UserRole + 3},
+        {"name", Qt::UserRole + 4},
+        {"pid", Qt::UserRole + 5},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"uid", Qt::UserRole + 6},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int processes_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            case Qt::UserRole + 2:
+                return 2;
+            case Qt::UserRole + 3:
+                return 3;
+            case Qt::DisplayRole:
+            case Qt::UserRole + 4:
+                return 4;
+            case Qt::ToolTipRole:
+            case Qt::UserRole + 5:
+                return 5;
+            case Qt::UserRole + 6:
+                return 6;
+            }
+            break;
+        case 1:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 2:
+                return 2;
+            }
+            break;
+        case 2:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 3:
+                return 3;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void processes_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 2)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 2);
+            lastColumn = qMax(lastColumn, 1);
+        }
+        if (properties & (quint64(1) << 3)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 3);
+            lastColumn = qMax(lastColumn, 2);
+        }
+        if (properties & (quint64(1) << 4)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 4);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 5)) {
+            roles.append(Qt::ToolTipRole);
+            roles.append(Qt::UserRole + 5);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 6)) {
+            roles.append(Qt::UserRole + 6);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void processes_data_range(const Processes::Private*, option_quintptr, int, int, quint64, processes_data_range_t*, qstring_set_at);
     void processes_data_cmd(const Processes::Private*, quintptr, QString*, qstring_set);
     quint8 processes_data_cpu_percentage(const Processes::Private*, quintptr);
     float processes_data_cpu_usage(const Processes::Private*, quintptr);
@@ -575,12 +1076,14 @@ extern "C" {
     void processes_sort(Processes::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
 
     int processes_row_count(const Processes::Private*, option_quintptr);
+    bool processes_has_children(const Processes::Private*, option_quintptr);
     bool processes_can_fetch_more(const Processes::Private*, option_quintptr);
     void processes_fetch_more(Processes::Private*, option_quintptr);
     quintptr processes_index(const Processes::Private*, option_quintptr, int);
+    option_quintptr processes_index_checked(const Processes::Private*, option_quintptr, int);
     qmodelindex_t processes_parent(const Processes::Private*, quintptr);
     int processes_row(const Processes::Private*, quintptr);
-    option_quintptr processes_check_row(const Processes::Private*, quintptr, int);
+    void processes_check_rows(const Processes::Private*, const quintptr*, int*, int);
 }
 int Processes::columnCount(const QModelIndex &) const
 {
@@ -589,7 +1092,14 @@ int Processes::columnCount(const QModelIndex &) const
 
 bool Processes::hasChildren(const QModelIndex &parent) const
 {
-    return rowCount(parent) > 0;
+    if (parent.isValid() && parent.column() != 0) {
+        return false;
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    return processes_has_children(m_d, rust_parent);
 }
 
 int Processes::rowCount(const QModelIndex &parent) const
@@ -622,15 +1132,13 @@ QModelIndex Processes::index(int row, int column, const QModelIndex &parent) con
     if (parent.isValid() && parent.column() != 0) {
         return QModelIndex();
     }
-    if (row >= rowCount(parent)) {
-        return QModelIndex();
-    }
     const option_quintptr rust_parent = {
         parent.internalId(),
         parent.isValid()
     };
-    const quintptr id = processes_index(m_d, rust_parent, row);
-    return createIndex(row, column, id);
+    // checks the row and finds the item in one call
+    const option_quintptr id = processes_index_checked(m_d, rust_parent, row);
+    return id.some ?createIndex(row, column, id.value) :QModelIndex();
 }
 
 QModelIndex Processes::parent(const QModelIndex &index) const
@@ -664,13 +1172,22 @@ void Processes::fetchMore(const QModelIndex &parent)
 }
 void Processes::updatePersistentIndexes() {
     const auto from = persistentIndexList();
+    const int len = from.size();
+    if (len == 0) {
+        return;
+    }
+    // ask Rust for the new rows of all persistent indexes at once
+    QVector<quintptr> ids(len);
+    QVector<int> rows(len);
+    for (int i = 0; i < len; ++i) {
+        ids[i] = from.at(i).internalId();
+        rows[i] = from.at(i).row();
+    }
+    processes_check_rows(m_d, ids.constData(), rows.data(), len);
     auto to = from;
-    auto len = to.size();
     for (int i = 0; i < len; ++i) {
-        auto index = to.at(i);
-        auto row = processes_check_row(m_d, index.internalId(), index.row());
-        if (row.some) {
-            to[i] = createIndex(row.value, index.column(), index.internalId());
+        if (rows.at(i) >= 0) {
+            to[i] = createIndex(rows.at(i), from.at(i).column(), ids.at(i));
         } else {
             to[i] = QModelIndex();
         }
@@ -727,68 +1244,103 @@ quint32 Processes::uid(const QModelIndex& index) const
     return processes_data_uid(m_d, index.internalId());
 }
 
+struct Processes::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    option_quintptr parent;
+    QVector<quintptr> id;
+    QVector<QString> cmd;
+    QVector<quint8> cpuPercentage;
+    QVector<float> cpuUsage;
+    QVector<quint64> memory;
+    QVector<QString> name;
+    QVector<quint32> pid;
+    QVector<quint32> uid;
+};
+
+void Processes::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int Processes::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    bool fetchIds = false;
+    if (row < r->first || row >= r->first + r->count
+            || r->id.at(row - r->first) != index.internalId()) {
+        const QModelIndex parent = index.parent();
+        r->parent = { parent.internalId(), parent.isValid() };
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->id.resize(r->count);
+        fetchIds = true;
+        r->cmd.resize(r->count);
+        r->cpuPercentage.resize(r->count);
+        r->cpuUsage.resize(r->count);
+        r->memory.resize(r->count);
+        r->name.resize(r->count);
+        r->pid.resize(r->count);
+        r->uid.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        processes_data_range_t columns = {
+            fetchIds ?r->id.data() :nullptr,
+            r->cmd.data(),
+            r->cpuPercentage.data(),
+            r->cpuUsage.data(),
+            r->memory.data(),
+            r->name.data(),
+            r->pid.data(),
+            r->uid.data()
+        };
+        processes_data_range(m_d, r->parent, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant Processes::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (processes_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(cmd(index));
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(cpuPercentage(index));
-        case Qt::UserRole + 2:
-            return QVariant::fromValue(cpuUsage(index));
-        case Qt::UserRole + 3:
-            return QVariant::fromValue(memory(index));
-        case Qt::DisplayRole:
-        case Qt::UserRole + 4:
-            return QVariant::fromValue(name(index));
-        case Qt::ToolTipRole:
-        case Qt::UserRole + 5:
-            return QVariant::fromValue(pid(index));
-        case Qt::UserRole + 6:
-            return QVariant::fromValue(uid(index));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->cmd.value(dataRangeRow(index, 0)));
     case 1:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 2:
-            return QVariant::fromValue(cpuUsage(index));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->cpuPercentage.value(dataRangeRow(index, 1)));
     case 2:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::UserRole + 3:
-            return QVariant::fromValue(memory(index));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->cpuUsage.value(dataRangeRow(index, 2)));
+    case 3:
+        return QVariant::fromValue(m_dataRange->memory.value(dataRangeRow(index, 3)));
+    case 4:
+        return QVariant::fromValue(m_dataRange->name.value(dataRangeRow(index, 4)));
+    case 5:
+        return QVariant::fromValue(m_dataRange->pid.value(dataRangeRow(index, 5)));
+    case 6:
+        return QVariant::fromValue(m_dataRange->uid.value(dataRangeRow(index, 6)));
     }
     return QVariant();
 }
 
 int Processes::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(processes_role_names);
+    auto i = std::lower_bound(std::begin(processes_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> Processes::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "cmd");
-    names.insert(Qt::UserRole + 1, "cpuPercentage");
-    names.insert(Qt::UserRole + 2, "cpuUsage");
-    names.insert(Qt::UserRole + 3, "memory");
-    names.insert(Qt::UserRole + 4, "name");
-    names.insert(Qt::UserRole + 5, "pid");
-    names.insert(Qt::UserRole + 6, "uid");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: processes_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant Processes::headerData(int section, Qt::Orientation orientation, int role) const
@@ -808,12 +1360,46 @@ bool Processes::setHeaderData(int section, Qt::Orientation orientation, const QV
     return true;
 }
 
+void Processes::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Processes::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        processes_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 extern "C" {
     Processes::Private* processes_new(Processes*, void (*)(Processes*),
         void (*)(const Processes*, option_quintptr),
         void (*)(Processes*),
         void (*)(Processes*),
         void (*)(Processes*, quintptr, quintptr),
+        void (*)(Processes*, quintptr, quintptr, quint64),
         void (*)(Processes*),
         void (*)(Processes*),
         void (*)(Processes*, option_quintptr, int, int),
@@ -827,12 +1413,93 @@ extern "C" {
     void processes_active_set(Processes::Private*, bool);
 };
 
+namespace {
+    struct time_series_data_range_t {
+        float* cos;
+        float* sin;
+        float* time;
+    };
+    constexpr role_name_t time_series_role_names[] = {
+        {"cos", Qt::UserRole + 0},
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"sin", Qt::UserRole + 1},
+        {"statusTip", Qt::StatusTipRole},
+        {"time", Qt::UserRole + 2},
+        {"toolTip", Qt::ToolTipRole},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int time_series_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::UserRole + 2:
+                return 2;
+            }
+            break;
+        case 1:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::UserRole + 1:
+                return 1;
+            }
+            break;
+        case 2:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::UserRole + 0:
+                return 0;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void time_series_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::EditRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 2);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::EditRole);
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 1);
+        }
+        if (properties & (quint64(1) << 2)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::EditRole);
+            roles.append(Qt::UserRole + 2);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void time_series_data_range(const TimeSeries::Private*, int, int, quint64, time_series_data_range_t*);
     float time_series_data_cos(const TimeSeries::Private*, int);
+    void time_series_column_cos(const TimeSeries::Private*, int, int, float*);
     bool time_series_set_data_cos(TimeSeries::Private*, int, float);
     float time_series_data_sin(const TimeSeries::Private*, int);
+    void time_series_column_sin(const TimeSeries::Private*, int, int, float*);
     bool time_series_set_data_sin(TimeSeries::Private*, int, float);
     float time_series_data_time(const TimeSeries::Private*, int);
+    void time_series_column_time(const TimeSeries::Private*, int, int, float*);
     bool time_series_set_data_time(TimeSeries::Private*, int, float);
     void time_series_sort(TimeSeries::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
 
@@ -893,6 +1560,28 @@ void TimeSeries::fetchMore(const QModelIndex &parent)
 }
 void TimeSeries::updatePersistentIndexes() {}
 
+void TimeSeries::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
 void TimeSeries::sort(int column, Qt::SortOrder order)
 {
     time_series_sort(m_d, column, order);
@@ -922,6 +1611,7 @@ bool TimeSeries::setCos(int row, float value)
     bool set = false;
     set = time_series_set_data_cos(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -938,6 +1628,7 @@ bool TimeSeries::setSin(int row, float value)
     bool set = false;
     set = time_series_set_data_sin(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -954,64 +1645,115 @@ bool TimeSeries::setTime(int row, float value)
     bool set = false;
     set = time_series_set_data_time(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
     return set;
 }
 
+QVector<float> TimeSeries::cosColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<float> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        time_series_column_cos(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<float> TimeSeries::sinColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<float> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        time_series_column_sin(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<float> TimeSeries::timeColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<float> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        time_series_column_time(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+struct TimeSeries::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<float> cos;
+    QVector<float> sin;
+    QVector<float> time;
+};
+
+void TimeSeries::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int TimeSeries::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->cos.resize(r->count);
+        r->sin.resize(r->count);
+        r->time.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        time_series_data_range_t columns = {
+            r->cos.data(),
+            r->sin.data(),
+            r->time.data()
+        };
+        time_series_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant TimeSeries::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (time_series_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(cos(index.row()));
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(sin(index.row()));
-        case Qt::DisplayRole:
-        case Qt::EditRole:
-        case Qt::UserRole + 2:
-            return QVariant::fromValue(time(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->cos.value(dataRangeRow(index, 0)));
     case 1:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::EditRole:
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(sin(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->sin.value(dataRangeRow(index, 1)));
     case 2:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::EditRole:
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(cos(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->time.value(dataRangeRow(index, 2)));
     }
     return QVariant();
 }
 
 int TimeSeries::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(time_series_role_names);
+    auto i = std::lower_bound(std::begin(time_series_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> TimeSeries::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "cos");
-    names.insert(Qt::UserRole + 1, "sin");
-    names.insert(Qt::UserRole + 2, "time");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: time_series_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant TimeSeries::headerData(int section, Qt::Orientation orientation, int role) const
@@ -1031,38 +1773,57 @@ bool TimeSeries::setHeaderData(int section, Qt::Orientation orientation, const Q
     return true;
 }
 
-bool TimeSeries::setData(const QModelIndex &index, const QVariant &value, int role)
+void TimeSeries::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
 {
-    if (index.column() == 0) {
-        if (role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<float>())) {
-                return setCos(index.row(), value.value<float>());
-            }
-        }
-        if (role == Qt::UserRole + 1) {
-            if (value.canConvert(qMetaTypeId<float>())) {
-                return setSin(index.row(), value.value<float>());
-            }
-        }
-        if (role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole + 2) {
-            if (value.canConvert(qMetaTypeId<float>())) {
-                return setTime(index.row(), value.value<float>());
-            }
-        }
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
     }
-    if (index.column() == 1) {
-        if (role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole + 1) {
-            if (value.canConvert(qMetaTypeId<float>())) {
-                return setSin(index.row(), value.value<float>());
-            }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void TimeSeries::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
         }
+        QVector<int> roles;
+        int lastColumn = 0;
+        time_series_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
     }
-    if (index.column() == 2) {
-        if (role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<float>())) {
-                return setCos(index.row(), value.value<float>());
-            }
+}
+
+bool TimeSeries::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    switch (time_series_property(index.column(), role)) {
+    case 0:
+        if (value.canConvert(qMetaTypeId<float>())) {
+            return setCos(index.row(), value.value<float>());
         }
+        break;
+    case 1:
+        if (value.canConvert(qMetaTypeId<float>())) {
+            return setSin(index.row(), value.value<float>());
+        }
+        break;
+    case 2:
+        if (value.canConvert(qMetaTypeId<float>())) {
+            return setTime(index.row(), value.value<float>());
+        }
+        break;
     }
     return false;
 }
@@ -1073,6 +1834,7 @@ extern "C" {
         void (*)(TimeSeries*),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*, quintptr, quintptr),
+        void (*)(TimeSeries*, quintptr, quintptr, quint64),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*, int, int),
@@ -1080,10 +1842,20 @@ extern "C" {
         void (*)(TimeSeries*, int, int, int),
         void (*)(TimeSeries*),
         void (*)(TimeSeries*, int, int),
-        void (*)(TimeSeries*));
+        void (*)(TimeSeries*),
+        void (*)(TimeSeries*, const quintptr*, quintptr));
     void time_series_free(TimeSeries::Private*);
 };
 
+extern "C" {
+    SortedProcesses::Private* sorted_processes_new();
+    void sorted_processes_free(SortedProcesses::Private*);
+    void sorted_processes_set_filter(SortedProcesses::Private*, int, const ushort*, int);
+    int sorted_processes_rows(SortedProcesses::Private*, const Processes::Private*, option_quintptr, int, Qt::SortOrder, int*);
+    int sorted_processes_place(SortedProcesses::Private*, const Processes::Private*, option_quintptr, int, Qt::SortOrder, const int*, int, int);
+    void sorted_processes_changed(SortedProcesses::Private*, const Processes::Private*, option_quintptr, int, int);
+    void sorted_processes_removed(SortedProcesses::Private*, const Processes::Private*, option_quintptr, int, int);
+};
 Demo::Demo(bool /*owned*/, QObject *parent):
     QObject(parent),
     m_fibonacci(new Fibonacci(false, this)),
@@ -1104,45 +1876,71 @@ Demo::Demo(QObject *parent):
     m_processes(new Processes(false, this)),
     m_timeSeries(new TimeSeries(false, this)),
     m_d(demo_new(this, m_fibonacci,
-        fibonacciInputChanged,
-        fibonacciResultChanged, m_fibonacciList,
+        [](Fibonacci* o) {
+            QMetaObject::invokeMethod(o, "emitChanges", Qt::QueuedConnection);
+        }, m_fibonacciList,
         [](const FibonacciList* o) {
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](FibonacciList* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 1, last));
         },
+        [](FibonacciList* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](FibonacciList* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](FibonacciList* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](FibonacciList* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](FibonacciList* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](FibonacciList* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 , m_fileSystemTree,
         fileSystemTreePathChanged,
@@ -1155,25 +1953,40 @@ Demo::Demo(QObject *parent):
             }
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](FileSystemTree* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             quintptr frow = file_system_tree_row(o->m_d, first);
-            quintptr lrow = file_system_tree_row(o->m_d, first);
+            quintptr lrow = file_system_tree_row(o->m_d, last);
             o->dataChanged(o->createIndex(frow, 0, first),
                        o->createIndex(lrow, 4, last));
         },
+        [](FileSystemTree* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            const int frow = file_system_tree_row(o->m_d, first);
+            const int lrow = file_system_tree_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        },
         [](FileSystemTree* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](FileSystemTree* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = file_system_tree_row(o->m_d, id.value);
                 o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
@@ -1182,9 +1995,12 @@ Demo::Demo(QObject *parent):
             }
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](FileSystemTree* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             QModelIndex s;
             if (sourceParent.some) {
                 int row = file_system_tree_row(o->m_d, sourceParent.value);
@@ -1198,9 +2014,12 @@ Demo::Demo(QObject *parent):
             o->beginMoveRows(s, first, last, d, destination);
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](FileSystemTree* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = file_system_tree_row(o->m_d, id.value);
                 o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
@@ -1209,6 +2028,7 @@ Demo::Demo(QObject *parent):
             }
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endRemoveRows();
         }
 , m_processes,
@@ -1222,25 +2042,40 @@ Demo::Demo(QObject *parent):
             }
         },
         [](Processes* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](Processes* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             quintptr frow = processes_row(o->m_d, first);
-            quintptr lrow = processes_row(o->m_d, first);
+            quintptr lrow = processes_row(o->m_d, last);
             o->dataChanged(o->createIndex(frow, 0, first),
                        o->createIndex(lrow, 2, last));
         },
+        [](Processes* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            const int frow = processes_row(o->m_d, first);
+            const int lrow = processes_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        },
         [](Processes* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](Processes* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = processes_row(o->m_d, id.value);
                 o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
@@ -1249,9 +2084,12 @@ Demo::Demo(QObject *parent):
             }
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](Processes* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             QModelIndex s;
             if (sourceParent.some) {
                 int row = processes_row(o->m_d, sourceParent.value);
@@ -1265,9 +2103,12 @@ Demo::Demo(QObject *parent):
             o->beginMoveRows(s, first, last, d, destination);
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](Processes* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = processes_row(o->m_d, id.value);
                 o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
@@ -1276,6 +2117,7 @@ Demo::Demo(QObject *parent):
             }
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endRemoveRows();
         }
 , m_timeSeries,
@@ -1283,39 +2125,64 @@ Demo::Demo(QObject *parent):
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](TimeSeries* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 2, last));
         },
+        [](TimeSeries* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](TimeSeries* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](TimeSeries* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](TimeSeries* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](TimeSeries* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](TimeSeries* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 )),
     m_ownsPrivate(true)
@@ -1394,8 +2261,9 @@ Fibonacci::Fibonacci(bool /*owned*/, QObject *parent):
 Fibonacci::Fibonacci(QObject *parent):
     QObject(parent),
     m_d(fibonacci_new(this,
-        fibonacciInputChanged,
-        fibonacciResultChanged)),
+        [](Fibonacci* o) {
+            QMetaObject::invokeMethod(o, "emitChanges", Qt::QueuedConnection);
+        })),
     m_ownsPrivate(true)
 {
 }
@@ -1414,12 +2282,28 @@ void Fibonacci::setInput(quint32 v) {
 }
 quint64 Fibonacci::result() const
 {
-    return fibonacci_result_get(m_d);
+    if (!m_resultCached || (fibonacci_pending_changes(m_d) & (quint64(1) << 1))) {
+        m_result = fibonacci_result_get(m_d);
+        m_resultCached = true;
+    }
+    return m_result;
+}
+void Fibonacci::emitChanges()
+{
+    const quint64 changes = fibonacci_take_changes(m_d);
+    if (changes & (quint64(1) << 0)) {
+        Q_EMIT inputChanged();
+    }
+    if (changes & (quint64(1) << 1)) {
+        m_resultCached = false;
+        Q_EMIT resultChanged();
+    }
 }
 FibonacciList::FibonacciList(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -1431,42 +2315,68 @@ FibonacciList::FibonacciList(QObject *parent):
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](FibonacciList* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 1, last));
         },
+        [](FibonacciList* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](FibonacciList* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](FibonacciList* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](FibonacciList* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](FibonacciList* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](FibonacciList* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](FibonacciList* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &FibonacciList::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -1478,6 +2388,7 @@ FibonacciList::~FibonacciList() {
     if (m_ownsPrivate) {
         fibonacci_list_free(m_d);
     }
+    delete m_dataRange;
 }
 void FibonacciList::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("row"));
@@ -1486,7 +2397,8 @@ void FibonacciList::initHeaderData() {
 FileSystemTree::FileSystemTree(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -1504,25 +2416,40 @@ FileSystemTree::FileSystemTree(QObject *parent):
             }
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](FileSystemTree* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             quintptr frow = file_system_tree_row(o->m_d, first);
-            quintptr lrow = file_system_tree_row(o->m_d, first);
+            quintptr lrow = file_system_tree_row(o->m_d, last);
             o->dataChanged(o->createIndex(frow, 0, first),
                        o->createIndex(lrow, 4, last));
         },
+        [](FileSystemTree* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            const int frow = file_system_tree_row(o->m_d, first);
+            const int lrow = file_system_tree_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        },
         [](FileSystemTree* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](FileSystemTree* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = file_system_tree_row(o->m_d, id.value);
                 o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
@@ -1531,9 +2458,12 @@ FileSystemTree::FileSystemTree(QObject *parent):
             }
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](FileSystemTree* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             QModelIndex s;
             if (sourceParent.some) {
                 int row = file_system_tree_row(o->m_d, sourceParent.value);
@@ -1547,9 +2477,12 @@ FileSystemTree::FileSystemTree(QObject *parent):
             o->beginMoveRows(s, first, last, d, destination);
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](FileSystemTree* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = file_system_tree_row(o->m_d, id.value);
                 o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
@@ -1558,10 +2491,12 @@ FileSystemTree::FileSystemTree(QObject *parent):
             }
         },
         [](FileSystemTree* o) {
+            o->clearDataRange();
             o->endRemoveRows();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &FileSystemTree::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -1573,6 +2508,7 @@ FileSystemTree::~FileSystemTree() {
     if (m_ownsPrivate) {
         file_system_tree_free(m_d);
     }
+    delete m_dataRange;
 }
 void FileSystemTree::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("fileName"));
@@ -1583,9 +2519,17 @@ void FileSystemTree::initHeaderData() {
 }
 QString FileSystemTree::path() const
 {
-    QString v;
-    file_system_tree_path_get(m_d, &v, set_qstring);
-    return v;
+    if (!m_pathCached) {
+        m_path = QString();
+        file_system_tree_path_get(m_d, &m_path, set_qstring);
+        m_pathCached = true;
+    }
+    return m_path;
+}
+void FileSystemTree::invalidatePath()
+{
+    m_pathCached = false;
+    Q_EMIT pathChanged();
 }
 void FileSystemTree::setPath(const QString& v) {
     if (v.isNull()) {
@@ -1597,7 +2541,8 @@ void FileSystemTree::setPath(const QString& v) {
 Processes::Processes(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -1615,25 +2560,40 @@ Processes::Processes(QObject *parent):
             }
         },
         [](Processes* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](Processes* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             quintptr frow = processes_row(o->m_d, first);
-            quintptr lrow = processes_row(o->m_d, first);
+            quintptr lrow = processes_row(o->m_d, last);
             o->dataChanged(o->createIndex(frow, 0, first),
                        o->createIndex(lrow, 2, last));
         },
+        [](Processes* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            const int frow = processes_row(o->m_d, first);
+            const int lrow = processes_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        },
         [](Processes* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](Processes* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = processes_row(o->m_d, id.value);
                 o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
@@ -1642,9 +2602,12 @@ Processes::Processes(QObject *parent):
             }
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](Processes* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             QModelIndex s;
             if (sourceParent.some) {
                 int row = processes_row(o->m_d, sourceParent.value);
@@ -1658,9 +2621,12 @@ Processes::Processes(QObject *parent):
             o->beginMoveRows(s, first, last, d, destination);
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](Processes* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = processes_row(o->m_d, id.value);
                 o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
@@ -1669,10 +2635,12 @@ Processes::Processes(QObject *parent):
             }
         },
         [](Processes* o) {
+            o->clearDataRange();
             o->endRemoveRows();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &Processes::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -1684,6 +2652,7 @@ Processes::~Processes() {
     if (m_ownsPrivate) {
         processes_free(m_d);
     }
+    delete m_dataRange;
 }
 void Processes::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("name"));
@@ -1700,7 +2669,8 @@ void Processes::setActive(bool v) {
 TimeSeries::TimeSeries(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -1712,42 +2682,68 @@ TimeSeries::TimeSeries(QObject *parent):
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](TimeSeries* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 2, last));
         },
+        [](TimeSeries* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](TimeSeries* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](TimeSeries* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](TimeSeries* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](TimeSeries* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](TimeSeries* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](TimeSeries* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &TimeSeries::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -1759,9 +2755,712 @@ TimeSeries::~TimeSeries() {
     if (m_ownsPrivate) {
         time_series_free(m_d);
     }
+    delete m_dataRange;
 }
 void TimeSeries::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("time"));
     m_headerData.insert(qMakePair(1, Qt::DisplayRole), QVariant("sin"));
     m_headerData.insert(qMakePair(2, Qt::DisplayRole), QVariant("cos"));
 }
+
+SortedProcesses::SortedProcesses(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(sorted_processes_new()),
+    m_source(nullptr),
+    m_sortColumn(-1),
+    m_sortOrder(Qt::AscendingOrder),
+    m_sortRole(Qt::DisplayRole),
+    m_filterRole(Qt::DisplayRole),
+    m_rootMapping(nullptr)
+{
+}
+
+SortedProcesses::~SortedProcesses()
+{
+    clearMappings();
+    sorted_processes_free(m_d);
+}
+
+Processes* SortedProcesses::sourceModel() const
+{
+    return m_source;
+}
+
+void SortedProcesses::setSourceModel(Processes* source)
+{
+    if (source == m_source) {
+        return;
+    }
+    beginResetModel();
+    if (m_source) {
+        disconnect(m_source, nullptr, this, nullptr);
+    }
+    clearMappings();
+    m_source = source;
+    resetFilter();
+    if (m_source) {
+        connect(m_source, &Processes::modelAboutToBeReset, this, &SortedProcesses::beginResetModel);
+        connect(m_source, &Processes::modelReset, this, [this]() {
+            clearMappings();
+            resetFilter();
+            endResetModel();
+        });
+        connect(m_source, &Processes::layoutAboutToBeChanged, this, [this]() {
+            beginLayoutChange();
+        });
+        connect(m_source, &Processes::layoutChanged, this, [this]() {
+            clearMappings();
+            endLayoutChange();
+        });
+        connect(m_source, &Processes::rowsInserted, this, &SortedProcesses::sourceRowsInserted);
+        connect(m_source, &Processes::rowsAboutToBeRemoved, this, &SortedProcesses::sourceRowsAboutToBeRemoved);
+        connect(m_source, &Processes::rowsRemoved, this, &SortedProcesses::sourceRowsRemoved);
+        connect(m_source, &Processes::rowsAboutToBeMoved, this, &SortedProcesses::sourceRowsAboutToBeMoved);
+        connect(m_source, &Processes::rowsMoved, this, &SortedProcesses::sourceRowsMoved);
+        connect(m_source, &Processes::dataChanged, this, &SortedProcesses::sourceDataChanged);
+        connect(m_source, &Processes::headerDataChanged, this, &SortedProcesses::headerDataChanged);
+        connect(m_source, &QObject::destroyed, this, [this]() {
+            setSourceModel(nullptr);
+        });
+    }
+    endResetModel();
+    Q_EMIT sourceModelChanged();
+}
+
+int SortedProcesses::sortRole() const
+{
+    return m_sortRole;
+}
+
+void SortedProcesses::setSortRole(int role)
+{
+    if (role == m_sortRole) {
+        return;
+    }
+    m_sortRole = role;
+    if (m_sortColumn >= 0) {
+        sort(m_sortColumn, m_sortOrder);
+    }
+    Q_EMIT sortRoleChanged();
+}
+
+int SortedProcesses::filterRole() const
+{
+    return m_filterRole;
+}
+
+void SortedProcesses::setFilterRole(int role)
+{
+    if (role == m_filterRole) {
+        return;
+    }
+    m_filterRole = role;
+    if (!m_filterText.isEmpty()) {
+        refilter();
+    }
+    Q_EMIT filterRoleChanged();
+}
+
+QString SortedProcesses::filterText() const
+{
+    return m_filterText;
+}
+
+void SortedProcesses::setFilterText(const QString& text)
+{
+    if (text == m_filterText) {
+        return;
+    }
+    m_filterText = text;
+    refilter();
+    Q_EMIT filterTextChanged();
+}
+
+void SortedProcesses::sortByRole(const QString& role, Qt::SortOrder order)
+{
+    const int sortRole = m_source ? m_source->role(role.toUtf8().constData()) : -1;
+    const bool changed = sortRole != m_sortRole;
+    m_sortRole = sortRole;
+    sort(0, order);
+    if (changed) {
+        Q_EMIT sortRoleChanged();
+    }
+}
+
+void SortedProcesses::sort(int column, Qt::SortOrder order)
+{
+    beginLayoutChange();
+    m_sortColumn = column;
+    m_sortOrder = order;
+    clearMappings();
+    endLayoutChange();
+}
+
+SortedProcesses::Mapping* SortedProcesses::cachedMapping(const QModelIndex &sourceParent) const
+{
+    if (!sourceParent.isValid()) {
+        return m_rootMapping;
+    }
+    return m_mappings.value(sourceParent.internalId());
+}
+
+SortedProcesses::Mapping* SortedProcesses::mapping(const QModelIndex &sourceParent) const
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        m = new Mapping();
+        m->sourceRows = sourceRows(sourceParent);
+        updateProxyRows(m, m_source->rowCount(sourceParent));
+        if (sourceParent.isValid()) {
+            m_mappings.insert(sourceParent.internalId(), m);
+        } else {
+            m_rootMapping = m;
+        }
+    }
+    return m;
+}
+
+QVector<int> SortedProcesses::sourceRows(const QModelIndex &sourceParent) const
+{
+    QVector<int> rows(m_source->rowCount(sourceParent));
+    if (m_sortColumn < 0 && m_filterText.isEmpty()) {
+        for (int i = 0; i < rows.size(); ++i) {
+            rows[i] = i;
+        }
+        return rows;
+    }
+    const int sort = m_sortColumn < 0 ? -1 : processes_property(m_sortColumn, m_sortRole);
+    const option_quintptr rust_parent = {
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    };
+    rows.resize(sorted_processes_rows(m_d, m_source->m_d, rust_parent, sort, m_sortOrder, rows.data()));
+    return rows;
+}
+
+void SortedProcesses::updateProxyRows(Mapping* m, int sourceRowCount) const
+{
+    m->proxyRows.fill(-1, sourceRowCount);
+    for (int i = 0; i < m->sourceRows.size(); ++i) {
+        m->proxyRows[m->sourceRows.at(i)] = i;
+    }
+}
+
+void SortedProcesses::removeProxyRows(Mapping* m, const QModelIndex &sourceParent, const QVector<bool>& remove)
+{
+    // remove from the back, a contiguous block of proxy rows at a time
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    int last = m->sourceRows.size() - 1;
+    while (last >= 0) {
+        if (!remove.at(m->sourceRows.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && remove.at(m->sourceRows.at(first - 1))) {
+            --first;
+        }
+        beginRemoveRows(proxyParent, first, last);
+        for (int i = first; i <= last; ++i) {
+            dropMapping(m_source->index(m->sourceRows.at(i), 0, sourceParent));
+        }
+        m->sourceRows.remove(first, last - first + 1);
+        updateProxyRows(m, remove.size());
+        endRemoveRows();
+        last = first - 1;
+    }
+}
+
+void SortedProcesses::updateMapping(const QModelIndex &sourceParent)
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    const int count = m_source->rowCount(sourceParent);
+    const QVector<int> rows = sourceRows(sourceParent);
+    QVector<bool> remove(count, true);
+    for (int row: rows) {
+        remove[row] = false;
+    }
+    removeProxyRows(m, sourceParent, remove);
+    // put the remaining rows in their new order
+    QVector<int> kept;
+    kept.reserve(m->sourceRows.size());
+    for (int row: rows) {
+        if (m->proxyRows.at(row) >= 0) {
+            kept.append(row);
+        }
+    }
+    if (kept != m->sourceRows) {
+        beginLayoutChange();
+        m->sourceRows = kept;
+        updateProxyRows(m, count);
+        endLayoutChange();
+    }
+    // insert the new rows, a contiguous block of proxy rows at a time
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    int first = 0;
+    while (first < rows.size()) {
+        if (m->proxyRows.at(rows.at(first)) >= 0) {
+            ++first;
+            continue;
+        }
+        int last = first;
+        while (last + 1 < rows.size() && m->proxyRows.at(rows.at(last + 1)) < 0) {
+            ++last;
+        }
+        beginInsertRows(proxyParent, first, last);
+        for (int i = first; i <= last; ++i) {
+            m->sourceRows.insert(i, rows.at(i));
+        }
+        updateProxyRows(m, count);
+        endInsertRows();
+        first = last + 1;
+    }
+}
+
+void SortedProcesses::placeRows(const QModelIndex &sourceParent, int first, int last)
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    // many changed rows are cheaper to sort again together
+    if (last - first >= 64) {
+        updateMapping(sourceParent);
+        return;
+    }
+    const int count = m_source->rowCount(sourceParent);
+    const int sort = m_sortColumn < 0 ? -1 : processes_property(m_sortColumn, m_sortRole);
+    const option_quintptr rust_parent = {
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    };
+    // the rows that did not change are still in order, so the new order is
+    // found by placing each changed row among them
+    QVector<int> order;
+    order.reserve(m->sourceRows.size() + last - first + 1);
+    for (int row: m->sourceRows) {
+        if (row < first || row > last) {
+            order.append(row);
+        }
+    }
+    for (int row = first; row <= last; ++row) {
+        const int place = sorted_processes_place(m_d, m_source->m_d, rust_parent, sort, m_sortOrder,
+                order.constData(), order.size(), row);
+        if (place >= 0) {
+            order.insert(place, row);
+        }
+    }
+    QVector<int> rank(count, -1);
+    for (int i = 0; i < order.size(); ++i) {
+        rank[order.at(i)] = i;
+    }
+    QVector<bool> remove(count, false);
+    for (int row = first; row <= last; ++row) {
+        remove[row] = rank.at(row) < 0;
+    }
+    removeProxyRows(m, sourceParent, remove);
+    // move or insert each changed row behind the row before it in the new
+    // order, counting only rows that are in their place already
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    QVector<int>& rows = m->sourceRows;
+    for (int row = first; row <= last; ++row) {
+        if (rank.at(row) < 0) {
+            continue;
+        }
+        const int from = m->proxyRows.at(row);
+        int to = 0;
+        for (int i = 0; i < rows.size(); ++i) {
+            const int r = rows.at(i);
+            const bool placed = r < row || r > last;
+            if (r != row && placed && rank.at(r) < rank.at(row)) {
+                to = from >= 0 && i > from ? i : i + 1;
+            }
+        }
+        if (from < 0) {
+            beginInsertRows(proxyParent, to, to);
+            rows.insert(to, row);
+            updateProxyRows(m, count);
+            endInsertRows();
+        } else if (to != from) {
+            beginMoveRows(proxyParent, from, from, proxyParent, to > from ? to + 1 : to);
+            rows.remove(from);
+            rows.insert(to, row);
+            updateProxyRows(m, count);
+            endMoveRows();
+        }
+    }
+}
+
+void SortedProcesses::updateAncestors(const QModelIndex &sourceParent)
+{
+    // a row is shown when it or one of its descendants matches the filter
+    if (m_filterText.isEmpty()) {
+        return;
+    }
+    for (QModelIndex p = sourceParent; p.isValid(); p = p.parent()) {
+        updateMapping(p.parent());
+    }
+}
+
+void SortedProcesses::dropMapping(const QModelIndex &sourceParent)
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    if (sourceParent.isValid()) {
+        m_mappings.remove(sourceParent.internalId());
+    } else {
+        m_rootMapping = nullptr;
+    }
+    for (int row: m->sourceRows) {
+        dropMapping(m_source->index(row, 0, sourceParent));
+    }
+    delete m;
+}
+
+void SortedProcesses::clearMappings()
+{
+    qDeleteAll(m_mappings);
+    m_mappings.clear();
+    delete m_rootMapping;
+    m_rootMapping = nullptr;
+}
+
+void SortedProcesses::resetFilter()
+{
+    const int property = m_filterText.isEmpty() ? -1 : processes_property(0, m_filterRole);
+    sorted_processes_set_filter(m_d, property, m_filterText.utf16(), m_filterText.size());
+}
+
+void SortedProcesses::refilter()
+{
+    resetFilter();
+    if (!m_source) {
+        return;
+    }
+    // parents go before their children, so rows that are filtered out take
+    // the mappings below them along
+    QVector<QModelIndex> parents;
+    parents.append(QModelIndex());
+    for (int i = 0; i < parents.size(); ++i) {
+        const QModelIndex sourceParent = parents.at(i);
+        updateMapping(sourceParent);
+        const Mapping* m = cachedMapping(sourceParent);
+        if (!m) {
+            continue;
+        }
+        for (int row: m->sourceRows) {
+            const QModelIndex child = m_source->index(row, 0, sourceParent);
+            if (cachedMapping(child)) {
+                parents.append(child);
+            }
+        }
+    }
+}
+
+void SortedProcesses::beginLayoutChange()
+{
+    Q_EMIT layoutAboutToBeChanged();
+    m_layoutIndexes = persistentIndexList();
+    m_layoutSourceIndexes.clear();
+    for (const QModelIndex& index: m_layoutIndexes) {
+        m_layoutSourceIndexes.append(QPersistentModelIndex(mapToSource(index)));
+    }
+}
+
+void SortedProcesses::endLayoutChange()
+{
+    QModelIndexList to;
+    for (const QPersistentModelIndex& index: m_layoutSourceIndexes) {
+        to.append(mapFromSource(index));
+    }
+    changePersistentIndexList(m_layoutIndexes, to);
+    m_layoutIndexes.clear();
+    m_layoutSourceIndexes.clear();
+    Q_EMIT layoutChanged();
+}
+
+void SortedProcesses::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    sorted_processes_changed(m_d, m_source->m_d, rust_parent, first, last);
+    Mapping* m = cachedMapping(parent);
+    if (m) {
+        const int count = last - first + 1;
+        for (int& row: m->sourceRows) {
+            if (row >= first) {
+                row += count;
+            }
+        }
+        updateProxyRows(m, m_source->rowCount(parent));
+        updateMapping(parent);
+    }
+    updateAncestors(parent);
+}
+
+void SortedProcesses::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    sorted_processes_removed(m_d, m_source->m_d, rust_parent, first, last);
+    Mapping* m = cachedMapping(parent);
+    if (m) {
+        QVector<bool> remove(m_source->rowCount(parent), false);
+        for (int row = first; row <= last; ++row) {
+            remove[row] = true;
+        }
+        removeProxyRows(m, parent, remove);
+    }
+}
+
+void SortedProcesses::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    sorted_processes_changed(m_d, m_source->m_d, rust_parent, 0, -1);
+    Mapping* m = cachedMapping(parent);
+    if (m) {
+        const int count = last - first + 1;
+        for (int& row: m->sourceRows) {
+            if (row > last) {
+                row -= count;
+            }
+        }
+        updateProxyRows(m, m_source->rowCount(parent));
+    }
+    updateAncestors(parent);
+}
+
+void SortedProcesses::sourceRowsAboutToBeMoved(const QModelIndex &parent, int, int, const QModelIndex &destination)
+{
+    // a move to another parent can change which rows pass the filter
+    if (parent != destination) {
+        beginResetModel();
+    }
+}
+
+void SortedProcesses::sourceRowsMoved(const QModelIndex &parent, int first, int last, const QModelIndex &destination, int row)
+{
+    if (parent != destination) {
+        clearMappings();
+        resetFilter();
+        endResetModel();
+        return;
+    }
+    Mapping* m = cachedMapping(parent);
+    if (!m) {
+        return;
+    }
+    const int count = last - first + 1;
+    // the number of a source row after the move
+    const auto moved = [=](int r) {
+        if (r >= first && r <= last) {
+            return row > last ? r + row - last - 1 : r - first + row;
+        }
+        if (row > last && r > last && r < row) {
+            return r - count;
+        }
+        if (row < first && r >= row && r < first) {
+            return r + count;
+        }
+        return r;
+    };
+    if (m_sortColumn >= 0) {
+        // the order of the proxy does not depend on the order of the source
+        for (int& r: m->sourceRows) {
+            r = moved(r);
+        }
+        updateProxyRows(m, m_source->rowCount(parent));
+        return;
+    }
+    // the proxy keeps the order of the source, so the visible rows that
+    // were moved are one block that moves in the proxy too
+    int proxyFirst = m->sourceRows.size();
+    int proxyLast = -1;
+    int proxyRow = 0;
+    for (int i = 0; i < m->sourceRows.size(); ++i) {
+        const int r = m->sourceRows.at(i);
+        if (r >= first && r <= last) {
+            proxyFirst = qMin(proxyFirst, i);
+            proxyLast = i;
+        }
+        if (r < row) {
+            proxyRow = i + 1;
+        }
+    }
+    const bool move = proxyLast >= 0 && (proxyRow < proxyFirst || proxyRow > proxyLast + 1);
+    if (move) {
+        const QModelIndex proxyParent = mapFromSource(parent);
+        beginMoveRows(proxyParent, proxyFirst, proxyLast, proxyParent, proxyRow);
+    }
+    for (int& r: m->sourceRows) {
+        r = moved(r);
+    }
+    std::sort(m->sourceRows.begin(), m->sourceRows.end());
+    updateProxyRows(m, m_source->rowCount(parent));
+    if (move) {
+        endMoveRows();
+    }
+}
+
+void SortedProcesses::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    const QModelIndex sourceParent = topLeft.parent();
+    const option_quintptr rust_parent = {
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    };
+    sorted_processes_changed(m_d, m_source->m_d, rust_parent, topLeft.row(), bottomRight.row());
+    // only a change of the sort role or the filter role can move rows
+    const bool sortChanged = m_sortColumn >= 0
+            && (roles.isEmpty() || roles.contains(m_sortRole));
+    const bool filterChanged = !m_filterText.isEmpty()
+            && (roles.isEmpty() || roles.contains(m_filterRole));
+    if (sortChanged || filterChanged) {
+        placeRows(sourceParent, topLeft.row(), bottomRight.row());
+    }
+    if (filterChanged) {
+        updateAncestors(sourceParent);
+    }
+    const Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    int first = m->sourceRows.size();
+    int last = -1;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const int proxyRow = m->proxyRows.value(row, -1);
+        if (proxyRow >= 0) {
+            first = qMin(first, proxyRow);
+            last = qMax(last, proxyRow);
+        }
+    }
+    if (last >= 0) {
+        const QModelIndex proxyParent = mapFromSource(sourceParent);
+        Q_EMIT dataChanged(index(first, topLeft.column(), proxyParent),
+                index(last, bottomRight.column(), proxyParent), roles);
+    }
+}
+
+QModelIndex SortedProcesses::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!m_source || !proxyIndex.isValid()) {
+        return QModelIndex();
+    }
+    const quintptr id = proxyIndex.internalId();
+    return m_source->createIndex(processes_row(m_source->m_d, id), proxyIndex.column(), id);
+}
+
+QModelIndex SortedProcesses::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!m_source || !sourceIndex.isValid()) {
+        return QModelIndex();
+    }
+    const QModelIndex sourceParent = sourceIndex.parent();
+    if (sourceParent.isValid() && !mapFromSource(sourceParent).isValid()) {
+        return QModelIndex();
+    }
+    const int row = mapping(sourceParent)->proxyRows.value(sourceIndex.row(), -1);
+    if (row < 0) {
+        return QModelIndex();
+    }
+    return createIndex(row, sourceIndex.column(), sourceIndex.internalId());
+}
+
+int SortedProcesses::columnCount(const QModelIndex &parent) const
+{
+    return m_source ? m_source->columnCount(mapToSource(parent)) : 0;
+}
+
+QVariant SortedProcesses::data(const QModelIndex &index, int role) const
+{
+    return m_source ? m_source->data(mapToSource(index), role) : QVariant();
+}
+
+bool SortedProcesses::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    return m_source && m_source->setData(mapToSource(index), value, role);
+}
+
+QModelIndex SortedProcesses::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!m_source || row < 0 || column < 0 || column >= columnCount(parent) || parent.column() > 0) {
+        return QModelIndex();
+    }
+    const QModelIndex sourceParent = mapToSource(parent);
+    const Mapping* m = mapping(sourceParent);
+    if (row >= m->sourceRows.size()) {
+        return QModelIndex();
+    }
+    const option_quintptr rust_parent = {
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    };
+    const quintptr id = processes_index(m_source->m_d, rust_parent, m->sourceRows.at(row));
+    return createIndex(row, column, id);
+}
+
+QModelIndex SortedProcesses::parent(const QModelIndex &index) const
+{
+    if (!m_source || !index.isValid()) {
+        return QModelIndex();
+    }
+    return mapFromSource(mapToSource(index).parent());
+}
+
+bool SortedProcesses::hasChildren(const QModelIndex &parent) const
+{
+    if (!m_source) {
+        return false;
+    }
+    if (m_filterText.isEmpty()) {
+        return m_source->hasChildren(mapToSource(parent));
+    }
+    return rowCount(parent) > 0;
+}
+
+int SortedProcesses::rowCount(const QModelIndex &parent) const
+{
+    if (!m_source || parent.column() > 0) {
+        return 0;
+    }
+    return mapping(mapToSource(parent))->sourceRows.size();
+}
+
+bool SortedProcesses::canFetchMore(const QModelIndex &parent) const
+{
+    return m_source && m_source->canFetchMore(mapToSource(parent));
+}
+
+void SortedProcesses::fetchMore(const QModelIndex &parent)
+{
+    if (m_source) {
+        m_source->fetchMore(mapToSource(parent));
+    }
+}
+
+Qt::ItemFlags SortedProcesses::flags(const QModelIndex &index) const
+{
+    return m_source ? m_source->flags(mapToSource(index)) : QAbstractItemModel::flags(index);
+}
+
+QHash<int, QByteArray> SortedProcesses::roleNames() const
+{
+    return m_source ? m_source->roleNames() : QAbstractItemModel::roleNames();
+}
+
+QVariant SortedProcesses::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    return m_source ? m_source->headerData(section, orientation, role) : QVariant();
+}
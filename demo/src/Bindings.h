@@ -11,6 +11,7 @@ class FibonacciList;
 class FileSystemTree;
 class Processes;
 class TimeSeries;
+class SortedProcesses;
 
 class Demo : public QObject
 {
@@ -70,6 +71,12 @@ public:
     quint32 input() const;
     void setInput(quint32 v);
     quint64 result() const;
+private Q_SLOTS:
+    void emitChanges();
+private:
+    // property values that are read from Rust again only after a change
+    mutable quint64 m_result;
+    mutable bool m_resultCached = false;
 Q_SIGNALS:
     void inputChanged();
     void resultChanged();
@@ -106,7 +113,9 @@ public:
     Q_INVOKABLE bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
     Q_INVOKABLE bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
     Q_INVOKABLE quint64 fibonacciNumber(int row) const;
+    Q_INVOKABLE QVector<quint64> fibonacciNumberColumn(int first, int last) const;
     Q_INVOKABLE quint64 row(int row) const;
+    Q_INVOKABLE QVector<quint64> rowColumn(int first, int last) const;
 
 Q_SIGNALS:
     // new data is ready to be made available to the model with fetchMore()
@@ -115,6 +124,25 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
 Q_SIGNALS:
 };
 
@@ -165,6 +193,30 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
+private Q_SLOTS:
+    void invalidatePath();
+private:
+    // property values that are read from Rust again only after a change
+    mutable QString m_path;
+    mutable bool m_pathCached = false;
 Q_SIGNALS:
     void pathChanged();
 };
@@ -173,6 +225,7 @@ class Processes : public QAbstractItemModel
 {
     Q_OBJECT
     friend class Demo;
+    friend class SortedProcesses;
 public:
     class Private;
 private:
@@ -217,6 +270,24 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
 Q_SIGNALS:
     void activeChanged();
 };
@@ -254,10 +325,13 @@ public:
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     Q_INVOKABLE float cos(int row) const;
     Q_INVOKABLE bool setCos(int row, float value);
+    Q_INVOKABLE QVector<float> cosColumn(int first, int last) const;
     Q_INVOKABLE float sin(int row) const;
     Q_INVOKABLE bool setSin(int row, float value);
+    Q_INVOKABLE QVector<float> sinColumn(int first, int last) const;
     Q_INVOKABLE float time(int row) const;
     Q_INVOKABLE bool setTime(int row, float value);
+    Q_INVOKABLE QVector<float> timeColumn(int first, int last) const;
 
 Q_SIGNALS:
     // new data is ready to be made available to the model with fetchMore()
@@ -266,6 +340,104 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
+Q_SIGNALS:
+};
+
+class SortedProcesses : public QAbstractItemModel
+{
+    Q_OBJECT
+    Q_PROPERTY(Processes* sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged FINAL)
+    Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged FINAL)
+    Q_PROPERTY(int filterRole READ filterRole WRITE setFilterRole NOTIFY filterRoleChanged FINAL)
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged FINAL)
+public:
+    class Private;
+    explicit SortedProcesses(QObject *parent = nullptr);
+    ~SortedProcesses();
+    Processes* sourceModel() const;
+    void setSourceModel(Processes* source);
+    int sortRole() const;
+    void setSortRole(int role);
+    int filterRole() const;
+    void setFilterRole(int role);
+    QString filterText() const;
+    void setFilterText(const QString& text);
+    Q_INVOKABLE QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    Q_INVOKABLE QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
+    Q_INVOKABLE void sortByRole(const QString& role, Qt::SortOrder order);
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    QHash<int, QByteArray> roleNames() const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 Q_SIGNALS:
+    void sourceModelChanged();
+    void sortRoleChanged();
+    void filterRoleChanged();
+    void filterTextChanged();
+private:
+    // the visible rows of the source below one parent, in the order of the proxy
+    struct Mapping {
+        QVector<int> sourceRows;
+        QVector<int> proxyRows;
+    };
+    Private * m_d;
+    Processes* m_source;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    int m_sortRole;
+    int m_filterRole;
+    QString m_filterText;
+    mutable Mapping* m_rootMapping;
+    mutable QHash<quintptr, Mapping*> m_mappings;
+    QModelIndexList m_layoutIndexes;
+    QList<QPersistentModelIndex> m_layoutSourceIndexes;
+    Mapping* cachedMapping(const QModelIndex &sourceParent) const;
+    Mapping* mapping(const QModelIndex &sourceParent) const;
+    QVector<int> sourceRows(const QModelIndex &sourceParent) const;
+    void updateProxyRows(Mapping* m, int sourceRowCount) const;
+    void updateMapping(const QModelIndex &sourceParent);
+    void placeRows(const QModelIndex &sourceParent, int first, int last);
+    void updateAncestors(const QModelIndex &sourceParent);
+    void removeProxyRows(Mapping* m, const QModelIndex &sourceParent, const QVector<bool>& remove);
+    void dropMapping(const QModelIndex &sourceParent);
+    void clearMappings();
+    void resetFilter();
+    void refilter();
+    void beginLayoutChange();
+    void endLayoutChange();
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeMoved(const QModelIndex &parent, int, int, const QModelIndex &destination);
+    void sourceRowsMoved(const QModelIndex &parent, int first, int last, const QModelIndex &destination, int row);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
 };
 #endif // BINDINGS_H
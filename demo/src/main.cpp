@@ -63,7 +63,7 @@ struct Model {
     QStringListModel styles;
     Demo demo;
     SortedModel sortedFileSystem;
-    SortedModel sortedProcesses;
+    SortedProcesses sortedProcesses;
 };
 
 void setStyle(QWidget* w, QStyle* style) {
@@ -318,22 +318,35 @@ QWidget* createProcessesTab(Model* model) {
 
 using namespace QtCharts;
 
+// Copy the points of a series with one call per column instead of one
+// data() call per value.
+void setPoints(QLineSeries* series, const TimeSeries* model,
+        QVector<float> (TimeSeries::*column)(int, int) const) {
+    const int last = model->rowCount() - 1;
+    const QVector<float> x = model->timeColumn(0, last);
+    const QVector<float> y = (model->*column)(0, last);
+    QVector<QPointF> points(x.size());
+    for (int i = 0; i < x.size(); ++i) {
+        points[i] = QPointF(x[i], y[i]);
+    }
+    series->replace(points);
+}
+
 QWidget* createChartTab(Model* model) {
+    TimeSeries* timeSeries = model->demo.timeSeries();
     QLineSeries *sin = new QLineSeries();
     sin->setName("sin");
-    QVXYModelMapper *sinMapper = new QVXYModelMapper(sin);
-    sinMapper->setXColumn(0);
-    sinMapper->setYColumn(1);
-    sinMapper->setSeries(sin);
-    sinMapper->setModel(model->demo.timeSeries());
-
     QLineSeries *cos = new QLineSeries();
     cos->setName("cos");
-    QVXYModelMapper *cosMapper = new QVXYModelMapper(cos);
-    cosMapper->setXColumn(0);
-    cosMapper->setYColumn(2);
-    cosMapper->setSeries(cos);
-    cosMapper->setModel(model->demo.timeSeries());
+    auto update = [timeSeries, sin, cos]() {
+        setPoints(sin, timeSeries, &TimeSeries::sinColumn);
+        setPoints(cos, timeSeries, &TimeSeries::cosColumn);
+    };
+    update();
+    QObject::connect(timeSeries, &TimeSeries::dataChanged, sin, update);
+    QObject::connect(timeSeries, &TimeSeries::rowsInserted, sin, update);
+    QObject::connect(timeSeries, &TimeSeries::rowsRemoved, sin, update);
+    QObject::connect(timeSeries, &TimeSeries::modelReset, sin, update);
 
     QChart* chart = new QChart;
     chart->addSeries(sin);
@@ -436,7 +449,6 @@ int main (int argc, char *argv[])
     model.sortedFileSystem.setSourceModel(model.demo.fileSystemTree());
     model.sortedFileSystem.setDynamicSortFilter(true);
     model.sortedProcesses.setSourceModel(model.demo.processes());
-    model.sortedProcesses.setDynamicSortFilter(true);
 
     createMainWindow(&model, parser.value(initialStyleOption),
                              parser.value(initialTabOption));
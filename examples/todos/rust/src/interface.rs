@@ -10,6 +10,7 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 #[repr(C)]
 pub struct COption<T> {
     data: T,
@@ -50,11 +51,35 @@ where
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -72,6 +97,205 @@ pub struct QModelIndex {
     internal_id: usize,
 }
 
+/// A model signal sent by `sync_rows`.
+enum SyncSignal<'a> {
+    BeginRemove(usize, usize),
+    EndRemove,
+    BeginMove(usize, usize),
+    EndMove,
+    BeginInsert(usize, usize),
+    EndInsert,
+    BeginLayout,
+    /// The old row of every row.
+    EndLayout(&'a [usize]),
+    Changed(usize, usize),
+}
+
+/// Most ranges of removed rows, ranges of inserted rows or moved rows that
+/// `sync_rows` signals one by one. Each of them shifts the rows, so more
+/// moves are sent as one layout change and more removes or inserts as a
+/// replacement of all rows. That keeps a sync O(n log n).
+const SYNC_MAX_SIGNALS: usize = 64;
+
+/// The number of runs of `true` in `flags`.
+fn count_runs<I: Iterator<Item = bool>>(flags: I) -> usize {
+    let mut runs = 0;
+    let mut previous = false;
+    for flag in flags {
+        if flag && !previous {
+            runs += 1;
+        }
+        previous = flag;
+    }
+    runs
+}
+
+/// Indexes into `seq` of a longest increasing subsequence, O(n log n).
+fn longest_increasing(seq: &[usize]) -> Vec<usize> {
+    let mut tails: Vec<usize> = Vec::new();
+    let mut prev = vec![usize::max_value(); seq.len()];
+    for (i, &v) in seq.iter().enumerate() {
+        let pos = match tails.binary_search_by(|&t| seq[t].cmp(&v)) {
+            Ok(pos) | Err(pos) => pos,
+        };
+        if pos > 0 {
+            prev[i] = tails[pos - 1];
+        }
+        if pos == tails.len() {
+            tails.push(i);
+        } else {
+            tails[pos] = i;
+        }
+    }
+    let mut lis = vec![0; tails.len()];
+    let mut i = tails.last().cloned().unwrap_or(0);
+    for slot in lis.iter_mut().rev() {
+        *slot = i;
+        i = prev[i];
+    }
+    lis
+}
+
+/// Turn `rows` into `new` with removes, moves, inserts and changes of
+/// the rows that have the same key. Rows that are not moved keep their
+/// place, so views keep their selection and scroll position. `signal` gets
+/// the rows as they are when the signal is sent.
+fn sync_rows<T, K, F, S>(rows: &mut Vec<T>, new: Vec<T>, key: F, mut signal: S)
+where
+    T: PartialEq,
+    K: ::std::hash::Hash + Eq,
+    F: Fn(&T) -> K,
+    S: FnMut(SyncSignal, &[T]),
+{
+    let new_rows: ::std::collections::HashMap<K, usize> =
+        new.iter().enumerate().map(|(i, t)| (key(t), i)).collect();
+    let mut seen = vec![false; new.len()];
+    let mut duplicate = new_rows.len() != new.len();
+    // the row in `new` of every old row, if it is still there
+    let targets: Vec<Option<usize>> = rows
+        .iter()
+        .map(|t| {
+            let target = new_rows.get(&key(t)).cloned();
+            if let Some(target) = target {
+                duplicate |= seen[target];
+                seen[target] = true;
+            }
+            target
+        })
+        .collect();
+    drop(new_rows);
+    if duplicate
+        || count_runs(targets.iter().map(|t| t.is_none())) > SYNC_MAX_SIGNALS
+        || count_runs(seen.iter().map(|s| !s)) > SYNC_MAX_SIGNALS
+    {
+        // keys are not unique or the rows changed too much, so replace all
+        if !rows.is_empty() {
+            signal(SyncSignal::BeginRemove(0, rows.len() - 1), rows);
+            rows.clear();
+            signal(SyncSignal::EndRemove, rows);
+        }
+        if !new.is_empty() {
+            signal(SyncSignal::BeginInsert(0, new.len() - 1), rows);
+            *rows = new;
+            signal(SyncSignal::EndInsert, rows);
+        }
+        return;
+    }
+    // remove rows that are gone, back to front, one range at a time
+    let mut end = targets.len();
+    while end > 0 {
+        if targets[end - 1].is_some() {
+            end -= 1;
+            continue;
+        }
+        let mut first = end - 1;
+        while first > 0 && targets[first - 1].is_none() {
+            first -= 1;
+        }
+        signal(SyncSignal::BeginRemove(first, end - 1), rows);
+        rows.drain(first..end);
+        signal(SyncSignal::EndRemove, rows);
+        end = first;
+    }
+    let mut current: Vec<usize> = targets.into_iter().filter_map(|t| t).collect();
+    // rows in a longest increasing run of targets stay, the others move
+    let lis = longest_increasing(&current);
+    if current.len() - lis.len() > SYNC_MAX_SIGNALS {
+        // order the rows by target in one pass
+        let mut by_target = vec![usize::max_value(); new.len()];
+        for (row, &target) in current.iter().enumerate() {
+            by_target[target] = row;
+        }
+        let old_rows: Vec<usize> = by_target
+            .into_iter()
+            .filter(|&row| row != usize::max_value())
+            .collect();
+        signal(SyncSignal::BeginLayout, rows);
+        let mut old: Vec<Option<T>> = rows.drain(..).map(Some).collect();
+        rows.extend(old_rows.iter().map(|&row| old[row].take().unwrap()));
+        signal(SyncSignal::EndLayout(&old_rows), rows);
+    } else if current.len() > lis.len() {
+        // at most SYNC_MAX_SIGNALS moves, each shifts the rows once
+        let mut placed = vec![false; new.len()];
+        for i in lis {
+            placed[current[i]] = true;
+        }
+        let mut previous: Option<usize> = None;
+        for target in 0..new.len() {
+            if !seen[target] {
+                continue;
+            }
+            if !placed[target] {
+                let from = current.iter().position(|&t| t == target).unwrap();
+                let to = previous
+                    .map(|p| current.iter().position(|&t| t == p).unwrap() + 1)
+                    .unwrap_or(0);
+                if to != from && to != from + 1 {
+                    signal(SyncSignal::BeginMove(from, to), rows);
+                    let row = rows.remove(from);
+                    let t = current.remove(from);
+                    let to = if to > from { to - 1 } else { to };
+                    rows.insert(to, row);
+                    current.insert(to, t);
+                    signal(SyncSignal::EndMove, rows);
+                }
+                placed[target] = true;
+            }
+            previous = Some(target);
+        }
+    }
+    // insert new rows and update the rows that stayed; there are at most
+    // SYNC_MAX_SIGNALS inserted ranges and each shifts the rows once
+    let mut new: Vec<Option<T>> = new.into_iter().map(Some).collect();
+    let mut row = 0;
+    while row < new.len() {
+        if seen[row] {
+            let mut last = row;
+            while last < new.len() && seen[last] && rows[last] != *new[last].as_ref().unwrap() {
+                rows[last] = new[last].take().unwrap();
+                last += 1;
+            }
+            if last > row {
+                signal(SyncSignal::Changed(row, last - 1), rows);
+                row = last;
+            } else {
+                row += 1;
+            }
+            continue;
+        }
+        let mut last = row;
+        while last + 1 < new.len() && !seen[last + 1] {
+            last += 1;
+        }
+        signal(SyncSignal::BeginInsert(row, last), rows);
+        let tail = rows.split_off(row);
+        rows.extend(new[row..=last].iter_mut().map(|t| t.take().unwrap()));
+        rows.extend(tail);
+        signal(SyncSignal::EndInsert, rows);
+        row = last + 1;
+    }
+}
+
 
 fn to_usize(n: c_int) -> usize {
     if n < 0 {
@@ -89,13 +313,26 @@ fn to_c_int(n: usize) -> c_int {
 }
 
 
+extern "C" {
+    fn todos_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Todos that was made on another thread.
+enum TodosCommand {
+    Add(String),
+    ClearCompleted,
+    Remove(u64, ::std::sync::mpsc::SyncSender<bool>),
+    SetAll(bool),
+}
+
 pub struct TodosQObject {}
 
 pub struct TodosEmitter {
     qobject: Arc<AtomicPtr<TodosQObject>>,
-    active_count_changed: fn(*mut TodosQObject),
-    count_changed: fn(*mut TodosQObject),
-    new_data_ready: fn(*mut TodosQObject),
+    active_count_changed: extern fn(*mut TodosQObject),
+    count_changed: extern fn(*mut TodosQObject),
+    new_data_ready: extern fn(*mut TodosQObject),
+    commands: Arc<::std::sync::Mutex<Vec<TodosCommand>>>,
 }
 
 unsafe impl Send for TodosEmitter {}
@@ -113,11 +350,14 @@ impl TodosEmitter {
             active_count_changed: self.active_count_changed,
             count_changed: self.count_changed,
             new_data_ready: self.new_data_ready,
+            commands: self.commands.clone(),
         }
     }
     fn clear(&self) {
         let n: *const TodosQObject = null();
         self.qobject.store(n as *mut TodosQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
     }
     pub fn active_count_changed(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
@@ -131,6 +371,48 @@ impl TodosEmitter {
             (self.count_changed)(ptr);
         }
     }
+    /// Call `add` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_add(&mut self, description: String) {
+        self.command(TodosCommand::Add(description));
+    }
+    /// Call `clear_completed` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_clear_completed(&mut self) {
+        self.command(TodosCommand::ClearCompleted);
+    }
+    /// Call `remove` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_remove(&mut self, index: u64) -> ::std::sync::mpsc::Receiver<bool> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(TodosCommand::Remove(index, sender));
+        receiver
+    }
+    /// Call `set_all` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_set_all(&mut self, completed: bool) {
+        self.command(TodosCommand::SetAll(completed));
+    }
+    fn command(&mut self, command: TodosCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { todos_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
     pub fn new_data_ready(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
         if !ptr.is_null() {
@@ -139,20 +421,29 @@ impl TodosEmitter {
     }
 }
 
+/// The item properties of Todos, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum TodosProperty {
+    Completed = 0,
+    Description = 1,
+}
+
 #[derive(Clone)]
 pub struct TodosList {
     qobject: *mut TodosQObject,
-    layout_about_to_be_changed: fn(*mut TodosQObject),
-    layout_changed: fn(*mut TodosQObject),
-    data_changed: fn(*mut TodosQObject, usize, usize),
-    begin_reset_model: fn(*mut TodosQObject),
-    end_reset_model: fn(*mut TodosQObject),
-    begin_insert_rows: fn(*mut TodosQObject, usize, usize),
-    end_insert_rows: fn(*mut TodosQObject),
-    begin_move_rows: fn(*mut TodosQObject, usize, usize, usize),
-    end_move_rows: fn(*mut TodosQObject),
-    begin_remove_rows: fn(*mut TodosQObject, usize, usize),
-    end_remove_rows: fn(*mut TodosQObject),
+    layout_about_to_be_changed: extern fn(*mut TodosQObject),
+    layout_changed: extern fn(*mut TodosQObject),
+    data_changed: extern fn(*mut TodosQObject, usize, usize),
+    properties_changed: extern fn(*mut TodosQObject, usize, usize, u64),
+    begin_reset_model: extern fn(*mut TodosQObject),
+    end_reset_model: extern fn(*mut TodosQObject),
+    begin_insert_rows: extern fn(*mut TodosQObject, usize, usize),
+    end_insert_rows: extern fn(*mut TodosQObject),
+    begin_move_rows: extern fn(*mut TodosQObject, usize, usize, usize),
+    end_move_rows: extern fn(*mut TodosQObject),
+    begin_remove_rows: extern fn(*mut TodosQObject, usize, usize),
+    end_remove_rows: extern fn(*mut TodosQObject),
+    layout_changed_with_permutation: extern fn(*mut TodosQObject, *const usize, usize),
 }
 
 impl TodosList {
@@ -165,6 +456,14 @@ impl TodosList {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[TodosProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -189,6 +488,34 @@ impl TodosList {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
 }
 
 pub trait TodosTrait {
@@ -217,32 +544,36 @@ pub trait TodosTrait {
 #[no_mangle]
 pub extern "C" fn todos_new(
     todos: *mut TodosQObject,
-    todos_active_count_changed: fn(*mut TodosQObject),
-    todos_count_changed: fn(*mut TodosQObject),
-    todos_new_data_ready: fn(*mut TodosQObject),
-    todos_layout_about_to_be_changed: fn(*mut TodosQObject),
-    todos_layout_changed: fn(*mut TodosQObject),
-    todos_data_changed: fn(*mut TodosQObject, usize, usize),
-    todos_begin_reset_model: fn(*mut TodosQObject),
-    todos_end_reset_model: fn(*mut TodosQObject),
-    todos_begin_insert_rows: fn(*mut TodosQObject, usize, usize),
-    todos_end_insert_rows: fn(*mut TodosQObject),
-    todos_begin_move_rows: fn(*mut TodosQObject, usize, usize, usize),
-    todos_end_move_rows: fn(*mut TodosQObject),
-    todos_begin_remove_rows: fn(*mut TodosQObject, usize, usize),
-    todos_end_remove_rows: fn(*mut TodosQObject),
+    todos_active_count_changed: extern fn(*mut TodosQObject),
+    todos_count_changed: extern fn(*mut TodosQObject),
+    todos_new_data_ready: extern fn(*mut TodosQObject),
+    todos_layout_about_to_be_changed: extern fn(*mut TodosQObject),
+    todos_layout_changed: extern fn(*mut TodosQObject),
+    todos_data_changed: extern fn(*mut TodosQObject, usize, usize),
+    todos_properties_changed: extern fn(*mut TodosQObject, usize, usize, u64),
+    todos_begin_reset_model: extern fn(*mut TodosQObject),
+    todos_end_reset_model: extern fn(*mut TodosQObject),
+    todos_begin_insert_rows: extern fn(*mut TodosQObject, usize, usize),
+    todos_end_insert_rows: extern fn(*mut TodosQObject),
+    todos_begin_move_rows: extern fn(*mut TodosQObject, usize, usize, usize),
+    todos_end_move_rows: extern fn(*mut TodosQObject),
+    todos_begin_remove_rows: extern fn(*mut TodosQObject, usize, usize),
+    todos_end_remove_rows: extern fn(*mut TodosQObject),
+    todos_layout_changed_with_permutation: extern fn(*mut TodosQObject, *const usize, usize),
 ) -> *mut Todos {
     let todos_emit = TodosEmitter {
         qobject: Arc::new(AtomicPtr::new(todos)),
         active_count_changed: todos_active_count_changed,
         count_changed: todos_count_changed,
         new_data_ready: todos_new_data_ready,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
     };
     let model = TodosList {
         qobject: todos,
         layout_about_to_be_changed: todos_layout_about_to_be_changed,
         layout_changed: todos_layout_changed,
         data_changed: todos_data_changed,
+        properties_changed: todos_properties_changed,
         begin_reset_model: todos_begin_reset_model,
         end_reset_model: todos_end_reset_model,
         begin_insert_rows: todos_begin_insert_rows,
@@ -251,6 +582,7 @@ pub extern "C" fn todos_new(
         end_move_rows: todos_end_move_rows,
         begin_remove_rows: todos_begin_remove_rows,
         end_remove_rows: todos_end_remove_rows,
+        layout_changed_with_permutation: todos_layout_changed_with_permutation,
     };
     let d_todos = Todos::new(todos_emit, model);
     Box::into_raw(Box::new(d_todos))
@@ -297,6 +629,28 @@ pub unsafe extern "C" fn todos_set_all(ptr: *mut Todos, completed: bool) {
     o.set_all(completed)
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn todos_apply_commands(ptr: *mut Todos) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            TodosCommand::Add(description) => o.add(description),
+            TodosCommand::ClearCompleted => o.clear_completed(),
+            TodosCommand::Remove(index, sender) => {
+                let _ = sender.send(o.remove(index));
+            }
+            TodosCommand::SetAll(completed) => o.set_all(completed),
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn todos_row_count(ptr: *const Todos) -> c_int {
     to_c_int((&*ptr).row_count())
@@ -326,6 +680,41 @@ pub unsafe extern "C" fn todos_sort(
     (&mut *ptr).sort(column, order)
 }
 
+#[repr(C)]
+pub struct TodosDataRange {
+    completed: *mut bool,
+    description: *mut QString,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn todos_data_range(
+    ptr: *const Todos,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut TodosDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        let column = slice::from_raw_parts_mut(range.completed, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.completed(index);
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.description(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.description, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn todos_data_completed(ptr: *const Todos, row: c_int) -> bool {
     let o = &*ptr;
@@ -344,7 +733,7 @@ pub unsafe extern "C" fn todos_set_data_completed(
 pub unsafe extern "C" fn todos_data_description(
     ptr: *const Todos, row: c_int,
     d: *mut QString,
-    set: fn(*mut QString, *const c_char, len: c_int),
+    set: extern fn(*mut QString, *const c_char, len: c_int),
 ) {
     let o = &*ptr;
     let data = o.description(to_usize(row));
@@ -1,5 +1,7 @@
 /* generated by rust_qt_binding_generator */
 #include "Bindings.h"
+#include <algorithm>
+#include <iterator>
 
 namespace {
 
@@ -21,6 +23,15 @@ namespace {
         *val = QString::fromUtf8(utf8, nbytes);
     }
 
+    typedef void (*qstring_set_at)(QString* val, int i, const char* bytes, int nbytes);
+    void set_qstring_at(QString* val, int i, const char* bytes, int nbytes) {
+        val[i] = QString::fromUtf8(bytes, nbytes);
+    }
+
+    struct role_name_t {
+        const char* name;
+        int role;
+    };
     struct qmodelindex_t {
         int row;
         quintptr id;
@@ -37,7 +48,53 @@ namespace {
         Q_EMIT o->countChanged();
     }
 }
+namespace {
+    struct todos_data_range_t {
+        bool* completed;
+        QString* description;
+    };
+    constexpr role_name_t todos_role_names[] = {
+        {"completed", Qt::UserRole + 0},
+        {"decoration", Qt::DecorationRole},
+        {"description", Qt::UserRole + 1},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int todos_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void todos_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void todos_data_range(const Todos::Private*, int, int, quint64, todos_data_range_t*, qstring_set_at);
     bool todos_data_completed(const Todos::Private*, int);
     bool todos_set_data_completed(Todos::Private*, int, bool);
     void todos_data_description(const Todos::Private*, int, QString*, qstring_set);
@@ -101,6 +158,28 @@ void Todos::fetchMore(const QModelIndex &parent)
 }
 void Todos::updatePersistentIndexes() {}
 
+void Todos::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
 void Todos::sort(int column, Qt::SortOrder order)
 {
     todos_sort(m_d, column, order);
@@ -124,6 +203,7 @@ bool Todos::setCompleted(int row, bool value)
     bool set = false;
     set = todos_set_data_completed(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -142,43 +222,77 @@ bool Todos::setDescription(int row, const QString& value)
     bool set = false;
     set = todos_set_data_description(m_d, row, value.utf16(), value.length());
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
     return set;
 }
 
+struct Todos::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<bool> completed;
+    QVector<QString> description;
+};
+
+void Todos::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int Todos::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->completed.resize(r->count);
+        r->description.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        todos_data_range_t columns = {
+            r->completed.data(),
+            r->description.data()
+        };
+        todos_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant Todos::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (todos_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(completed(index.row()));
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(description(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->completed.value(dataRangeRow(index, 0)));
+    case 1:
+        return QVariant::fromValue(m_dataRange->description.value(dataRangeRow(index, 1)));
     }
     return QVariant();
 }
 
 int Todos::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(todos_role_names);
+    auto i = std::lower_bound(std::begin(todos_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> Todos::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "completed");
-    names.insert(Qt::UserRole + 1, "description");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: todos_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant Todos::headerData(int section, Qt::Orientation orientation, int role) const
@@ -198,19 +312,52 @@ bool Todos::setHeaderData(int section, Qt::Orientation orientation, const QVaria
     return true;
 }
 
+void Todos::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Todos::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        todos_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 bool Todos::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (index.column() == 0) {
-        if (role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<bool>())) {
-                return setCompleted(index.row(), value.value<bool>());
-            }
+    switch (todos_property(index.column(), role)) {
+    case 0:
+        if (value.canConvert(qMetaTypeId<bool>())) {
+            return setCompleted(index.row(), value.value<bool>());
         }
-        if (role == Qt::UserRole + 1) {
-            if (value.canConvert(qMetaTypeId<QString>())) {
-                return setDescription(index.row(), value.value<QString>());
-            }
+        break;
+    case 1:
+        if (value.canConvert(qMetaTypeId<QString>())) {
+            return setDescription(index.row(), value.value<QString>());
         }
+        break;
     }
     return false;
 }
@@ -221,6 +368,7 @@ extern "C" {
         void (*)(Todos*),
         void (*)(Todos*),
         void (*)(Todos*, quintptr, quintptr),
+        void (*)(Todos*, quintptr, quintptr, quint64),
         void (*)(Todos*),
         void (*)(Todos*),
         void (*)(Todos*, int, int),
@@ -228,8 +376,10 @@ extern "C" {
         void (*)(Todos*, int, int, int),
         void (*)(Todos*),
         void (*)(Todos*, int, int),
-        void (*)(Todos*));
+        void (*)(Todos*),
+        void (*)(Todos*, const quintptr*, quintptr));
     void todos_free(Todos::Private*);
+    void todos_apply_commands(Todos::Private*);
     quint64 todos_active_count_get(const Todos::Private*);
     quint64 todos_count_get(const Todos::Private*);
     void todos_add(Todos::Private*, const ushort*, int);
@@ -241,7 +391,8 @@ extern "C" {
 Todos::Todos(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -255,42 +406,68 @@ Todos::Todos(QObject *parent):
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](Todos* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](Todos* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](Todos* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 0, last));
         },
+        [](Todos* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](Todos* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](Todos* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](Todos* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](Todos* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](Todos* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](Todos* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](Todos* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](Todos* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](Todos* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &Todos::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -302,6 +479,7 @@ Todos::~Todos() {
     if (m_ownsPrivate) {
         todos_free(m_d);
     }
+    delete m_dataRange;
 }
 void Todos::initHeaderData() {
 }
@@ -313,6 +491,10 @@ quint64 Todos::count() const
 {
     return todos_count_get(m_d);
 }
+void Todos::applyCommands()
+{
+    todos_apply_commands(m_d);
+}
 void Todos::add(const QString& description)
 {
     return todos_add(m_d, description.utf16(), description.size());
@@ -329,3 +511,7 @@ void Todos::setAll(bool completed)
 {
     return todos_set_all(m_d, completed);
 }
+extern "C" void todos_commands_pending(Todos* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
@@ -57,6 +57,27 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
+private Q_SLOTS:
+    void applyCommands();
 Q_SIGNALS:
     void activeCountChanged();
     void countChanged();
@@ -34,19 +34,39 @@ mod json {
     #[derive(Deserialize)]
     #[serde(deny_unknown_fields)]
     pub struct Object {
+        #[serde(rename = "coalesceChanges", default = "false_bool")]
+        pub coalesce_changes: bool,
         #[serde(default)]
         pub functions: BTreeMap<String, super::Function>,
         #[serde(rename = "itemProperties", default)]
         pub item_properties: BTreeMap<String, super::ItemProperty>,
+        #[serde(rename = "maxChangeRate", default)]
+        pub max_change_rate: u32,
+        #[serde(rename = "pageSize", default)]
+        pub page_size: u32,
         #[serde(rename = "type", default = "object")]
         pub object_type: super::ObjectType,
         #[serde(default)]
         pub properties: BTreeMap<String, Property>,
+        #[serde(default)]
+        pub source: Option<String>,
+        #[serde(default)]
+        pub storage: super::Storage,
+        #[serde(default = "false_bool")]
+        pub stream: bool,
+        #[serde(rename = "threadPool", default = "false_bool")]
+        pub thread_pool: bool,
+        #[serde(default = "false_bool")]
+        pub transactions: bool,
     }
 
     #[derive(Deserialize)]
     #[serde(deny_unknown_fields)]
     pub struct Property {
+        #[serde(default = "false_bool")]
+        pub cached: bool,
+        #[serde(default)]
+        pub encoding: super::Encoding,
         #[serde(default = "false_bool")]
         pub optional: bool,
         #[serde(rename = "type")]
@@ -80,6 +100,7 @@ pub struct Config {
     pub config_file: PathBuf,
     pub cpp_file: PathBuf,
     pub objects: BTreeMap<String, Rc<Object>>,
+    pub proxies: BTreeMap<String, Proxy>,
     pub rust: Rust,
     pub rust_edition: RustEdition,
     pub overwrite_implementation: bool,
@@ -93,7 +114,10 @@ impl ConfigPrivate for Config {
                 ops.insert(p.type_name().into());
             }
             for p in o.item_properties.values() {
-                ops.insert(p.type_name().into());
+                // shared buffers are passed without a setter
+                if !p.rust_by_arc {
+                    ops.insert(p.type_name().into());
+                }
             }
             for f in o.functions.values() {
                 ops.insert(f.return_type.name().into());
@@ -123,6 +147,12 @@ impl ConfigPrivate for Config {
         }
         ops
     }
+    fn has_utf16_string(&self) -> bool {
+        self.objects.values().any(|o| {
+            o.properties.values().any(|p| p.encoding == Encoding::Utf16)
+                || o.item_properties.values().any(|p| p.encoding == Encoding::Utf16)
+        })
+    }
     fn has_list_or_tree(&self) -> bool {
         self.objects
             .values()
@@ -137,6 +167,22 @@ pub struct Object {
     pub item_properties: BTreeMap<String, ItemProperty>,
     pub object_type: ObjectType,
     pub properties: BTreeMap<String, Property>,
+    /// How the rows of a List are laid out in memory.
+    pub storage: Storage,
+    /// Workers can append rows through a lock-free ring buffer.
+    pub stream: bool,
+    /// Property changes are collected and signalled from the event loop.
+    pub coalesce_changes: bool,
+    /// Maximum number of change notifications per second, 0 for no limit.
+    pub max_change_rate: u32,
+    /// Other threads can change the model through transactions.
+    pub transactions: bool,
+    /// The emitter hands out the pool of threads that is shared by all
+    /// objects.
+    pub thread_pool: bool,
+    /// Number of rows that are requested from Rust together, 0 when the
+    /// rows are not paged.
+    pub page_size: u32,
 }
 
 impl ObjectPrivate for Object {
@@ -150,10 +196,23 @@ impl ObjectPrivate for Object {
         }
         column_count
     }
+    /// Tell if other threads can call the functions of the object.
+    fn has_commands(&self) -> bool {
+        self.functions.values().any(|f| !f.asynchronous)
+    }
+}
+
+/// A model that shows the rows of a List or Tree sorted and filtered.
+pub struct Proxy {
+    pub name: String,
+    pub source: Rc<Object>,
 }
 
 #[derive(PartialEq)]
 pub struct Property {
+    /// The C++ object keeps the value until Rust signals a change.
+    pub cached: bool,
+    pub encoding: Encoding,
     pub optional: bool,
     pub property_type: Type,
     pub rust_by_function: bool,
@@ -171,6 +230,18 @@ impl PropertyPrivate for Property {
         let name = self.property_type.name();
         name.to_string() + "*, " + &name.to_lowercase() + "_set"
     }
+    fn rust_type(&self) -> &str {
+        if self.encoding == Encoding::Utf16 {
+            return "Vec<u16>";
+        }
+        self.property_type.rust_type()
+    }
+    fn rust_type_init(&self) -> &str {
+        if self.encoding == Encoding::Utf16 {
+            return "Vec::new()";
+        }
+        self.property_type.rust_type_init()
+    }
 }
 
 impl TypeName for Property {
@@ -194,6 +265,40 @@ pub enum ObjectType {
     Object,
     List,
     Tree,
+    Proxy,
+}
+
+#[derive(Deserialize, Clone, Copy, PartialEq, Eq)]
+pub enum Encoding {
+    #[serde(rename = "utf8")]
+    Utf8,
+    #[serde(rename = "utf16")]
+    Utf16,
+}
+
+impl Default for Encoding {
+    fn default() -> Encoding {
+        Encoding::Utf8
+    }
+}
+
+#[derive(Deserialize, Clone, Copy, PartialEq, Eq)]
+pub enum Storage {
+    /// One struct per row.
+    #[serde(rename = "rows")]
+    Rows,
+    /// One `Vec` per item property.
+    #[serde(rename = "columnar")]
+    Columnar,
+    /// Read-only fixed size records in a file that is mapped into memory.
+    #[serde(rename = "mapped")]
+    Mapped,
+}
+
+impl Default for Storage {
+    fn default() -> Storage {
+        Storage::Rows
+    }
 }
 
 #[derive(Deserialize, Clone, Copy, PartialEq, Eq)]
@@ -345,10 +450,14 @@ impl TypePrivate for Type {
 pub struct ItemProperty {
     #[serde(rename = "type")]
     pub item_property_type: SimpleType,
+    #[serde(default)]
+    pub encoding: Encoding,
     #[serde(default = "json::false_bool")]
     pub optional: bool,
     #[serde(default)]
     pub roles: Vec<Vec<String>>,
+    #[serde(rename = "rustByArc", default = "json::false_bool")]
+    pub rust_by_arc: bool,
     #[serde(rename = "rustByValue", default = "json::false_bool")]
     pub rust_by_value: bool,
     #[serde(default = "json::false_bool")]
@@ -365,6 +474,10 @@ impl ItemPropertyPrivate for ItemProperty {
     fn is_complex(&self) -> bool {
         self.item_property_type.is_complex()
     }
+    /// A mandatory number, which has the same layout in C++ and Rust.
+    fn is_numeric(&self) -> bool {
+        !self.optional && !self.is_complex() && self.item_property_type != SimpleType::Bool
+    }
     fn cpp_set_type(&self) -> String {
         let t = self.item_property_type.cpp_set_type().to_string();
         if self.optional {
@@ -379,6 +492,12 @@ impl ItemPropertyPrivate for ItemProperty {
     fn c_set_type(&self) -> &str {
         self.item_property_type.c_set_type()
     }
+    fn rust_type(&self) -> &str {
+        if self.encoding == Encoding::Utf16 {
+            return "Vec<u16>";
+        }
+        self.item_property_type.rust_type()
+    }
 }
 
 #[derive(Deserialize, Clone, PartialEq, Eq)]
@@ -388,6 +507,11 @@ pub struct Function {
     pub return_type: SimpleType,
     #[serde(rename = "mut", default = "json::false_bool")]
     pub mutable: bool,
+    /// Run the work of the function on a shared pool of threads. The
+    /// QObject returns a request id right away and reports the result with
+    /// the signal `{name}Finished(request, result)`.
+    #[serde(rename = "async", default = "json::false_bool")]
+    pub asynchronous: bool,
     #[serde(default)]
     pub arguments: Vec<Argument>,
 }
@@ -404,6 +528,10 @@ pub struct Argument {
     pub name: String,
     #[serde(rename = "type")]
     pub argument_type: SimpleType,
+    /// Pass a QString to Rust as the borrowed UTF-16 slice `&[u16]` instead
+    /// of decoding it into a new `String` on every call.
+    #[serde(default = "json::false_bool")]
+    pub borrow: bool,
 }
 
 impl TypeName for Argument {
@@ -419,6 +547,9 @@ fn post_process_property(
 ) -> Result<Property, Box<dyn Error>> {
     let name = &a.1.property_type;
     let t = match serde_json::from_str::<SimpleType>(&format!("\"{}\"", name)) {
+        Err(_) if c.get(name).map_or(false, |o| o.object_type == ObjectType::Proxy) => {
+            return Err(format!("Proxy {} cannot be a property.", name).into());
+        }
         Err(_) => {
             if b.get(name).is_none() {
                 if let Some(object) = c.get(name) {
@@ -431,7 +562,15 @@ fn post_process_property(
         }
         Ok(simple) => Type::Simple(simple),
     };
+    if a.1.encoding == Encoding::Utf16 && t != Type::Simple(SimpleType::QString) {
+        return Err(format!("Property {} has an encoding but is not a QString.", a.0).into());
+    }
+    if a.1.cached && t.is_object() {
+        return Err(format!("Property {} is cached but is an object.", a.0).into());
+    }
     Ok(Property {
+        cached: a.1.cached,
+        encoding: a.1.encoding,
         property_type: t,
         optional: a.1.optional,
         rust_by_function: a.1.rust_by_function,
@@ -444,6 +583,86 @@ fn post_process_object(
     b: &mut BTreeMap<String, Rc<Object>>,
     c: &BTreeMap<String, json::Object>,
 ) -> Result<(), Box<dyn Error>> {
+    if a.1.source.is_some() {
+        return Err(format!("{} has a source but is not a Proxy.", a.0).into());
+    }
+    if a.1.stream && a.1.object_type == ObjectType::Object {
+        return Err(format!("{} streams rows but is not a List or Tree.", a.0).into());
+    }
+    if a.1.transactions && a.1.object_type == ObjectType::Object {
+        return Err(format!("{} has transactions but is not a List or Tree.", a.0).into());
+    }
+    if a.1.storage == Storage::Columnar && a.1.object_type != ObjectType::List {
+        return Err(format!("{} has columnar storage but is not a List.", a.0).into());
+    }
+    if a.1.page_size > 0 {
+        if a.1.object_type != ObjectType::List {
+            return Err(format!("{} has a pageSize but is not a List.", a.0).into());
+        }
+        if a.1.page_size % 64 != 0 {
+            return Err(format!("The pageSize of {} is not a multiple of 64.", a.0).into());
+        }
+        if a.1.item_properties.is_empty()
+            || a.1.item_properties.values().any(|ip| ip.rust_by_arc)
+        {
+            return Err(format!(
+                "Paged {} needs item properties and none of them can be rustByArc.",
+                a.0
+            )
+            .into());
+        }
+    }
+    if a.1.storage == Storage::Mapped {
+        if a.1.object_type != ObjectType::List {
+            return Err(format!("{} has mapped storage but is not a List.", a.0).into());
+        }
+        for (name, ip) in &a.1.item_properties {
+            if ip.write
+                || ip.optional
+                || ip.rust_by_arc
+                || ip.rust_by_value
+                || ip.encoding == Encoding::Utf16
+            {
+                return Err(format!(
+                    "Property {} of {} is mapped but is not a read-only, mandatory utf8 value.",
+                    name, a.0
+                )
+                .into());
+            }
+        }
+    }
+    let coalesce_changes = a.1.coalesce_changes || a.1.max_change_rate > 0;
+    if coalesce_changes && a.1.properties.len() > 64 {
+        return Err(format!("{} coalesces changes but has more than 64 properties.", a.0).into());
+    }
+    if a.1.item_properties.len() > 64 {
+        return Err(format!("{} has more than 64 item properties.", a.0).into());
+    }
+    for (name, ip) in &a.1.item_properties {
+        if ip.encoding == Encoding::Utf16 && ip.item_property_type != SimpleType::QString {
+            return Err(format!("Property {} has an encoding but is not a QString.", name).into());
+        }
+        if ip.rust_by_arc
+            && (ip.item_property_type != SimpleType::QByteArray || ip.optional || ip.rust_by_value)
+        {
+            return Err(format!(
+                "Property {} is rustByArc but is not a mandatory QByteArray.",
+                name
+            )
+            .into());
+        }
+    }
+    for (name, f) in &a.1.functions {
+        for arg in f.arguments.iter().filter(|arg| arg.borrow) {
+            if arg.argument_type != SimpleType::QString {
+                return Err(format!(
+                    "Argument {} of {} is borrowed but is not a QString.",
+                    arg.name, name
+                )
+                .into());
+            }
+        }
+    }
     let mut properties = BTreeMap::default();
     for p in &a.1.properties {
         properties.insert(p.0.clone(), post_process_property(p, b, c)?);
@@ -454,6 +673,13 @@ fn post_process_object(
         functions: a.1.functions.clone(),
         item_properties: a.1.item_properties.clone(),
         properties,
+        storage: a.1.storage,
+        stream: a.1.stream,
+        coalesce_changes,
+        max_change_rate: a.1.max_change_rate,
+        transactions: a.1.transactions,
+        thread_pool: a.1.thread_pool,
+        page_size: a.1.page_size,
     });
     b.insert(a.0.clone(), object);
     Ok(())
@@ -462,7 +688,41 @@ fn post_process_object(
 fn post_process(config_file: &Path, json: json::Config) -> Result<Config, Box<dyn Error>> {
     let mut objects = BTreeMap::default();
     for object in &json.objects {
-        post_process_object(object, &mut objects, &json.objects)?;
+        if object.1.object_type != ObjectType::Proxy {
+            post_process_object(object, &mut objects, &json.objects)?;
+        }
+    }
+    let mut proxies = BTreeMap::default();
+    for (name, object) in &json.objects {
+        if object.object_type != ObjectType::Proxy {
+            continue;
+        }
+        if !object.properties.is_empty()
+            || !object.item_properties.is_empty()
+            || !object.functions.is_empty()
+            || object.stream
+            || object.coalesce_changes
+            || object.max_change_rate > 0
+            || object.transactions
+            || object.thread_pool
+            || object.storage != Storage::Rows
+            || object.page_size > 0
+        {
+            return Err(format!("Proxy {} can only have a source.", name).into());
+        }
+        let source = object
+            .source
+            .as_ref()
+            .and_then(|source| objects.get(source))
+            .filter(|source| source.object_type != ObjectType::Object)
+            .ok_or_else(|| format!("Proxy {} needs a List or Tree as source.", name))?;
+        proxies.insert(
+            name.clone(),
+            Proxy {
+                name: name.clone(),
+                source: Rc::clone(source),
+            },
+        );
     }
 
     let rust_edition: RustEdition = {
@@ -484,6 +744,7 @@ fn post_process(config_file: &Path, json: json::Config) -> Result<Config, Box<dy
         config_file: config_file.into(),
         cpp_file: json.cpp_file,
         objects,
+        proxies,
         rust: json.rust,
         rust_edition,
         overwrite_implementation: json.overwrite_implementation,
@@ -3,12 +3,14 @@ use std::collections::BTreeSet;
 pub trait ConfigPrivate {
     fn types(&self) -> BTreeSet<String>;
     fn optional_types(&self) -> BTreeSet<String>;
+    fn has_utf16_string(&self) -> bool;
     fn has_list_or_tree(&self) -> bool;
 }
 
 pub trait ObjectPrivate {
     fn contains_object(&self) -> bool;
     fn column_count(&self) -> usize;
+    fn has_commands(&self) -> bool;
 }
 
 pub trait TypeName {
@@ -29,6 +31,8 @@ pub trait PropertyPrivate {
     fn is_object(&self) -> bool;
     fn is_complex(&self) -> bool;
     fn c_get_type(&self) -> String;
+    fn rust_type(&self) -> &str;
+    fn rust_type_init(&self) -> &str;
 }
 
 pub trait SimpleTypePrivate {
@@ -42,7 +46,9 @@ pub trait SimpleTypePrivate {
 
 pub trait ItemPropertyPrivate {
     fn is_complex(&self) -> bool;
+    fn is_numeric(&self) -> bool;
     fn cpp_set_type(&self) -> String;
     fn c_get_type(&self) -> String;
     fn c_set_type(&self) -> &str;
+    fn rust_type(&self) -> &str;
 }
@@ -3,7 +3,7 @@
 use configuration::*;
 use configuration_private::*;
 use std::io::{Result, Write};
-use util::{snake_case, write_if_different};
+use util::{snake_case, upper_initial, write_if_different};
 
 fn property_type(p: &ItemProperty) -> String {
     if p.optional && !p.item_property_type.is_complex() {
@@ -12,8 +12,12 @@ fn property_type(p: &ItemProperty) -> String {
     p.type_name().to_string()
 }
 
-fn upper_initial(name: &str) -> String {
-    format!("{}{}", &name[..1].to_uppercase(), &name[1..])
+/// The function with which Rust writes a QString or QByteArray value.
+fn setter(type_name: &str, encoding: Encoding) -> String {
+    if encoding == Encoding::Utf16 {
+        return "set_qstring_utf16".into();
+    }
+    format!("set_{}", type_name.to_lowercase())
 }
 
 fn lower_initial(name: &str) -> String {
@@ -31,6 +35,23 @@ fn base_type(o: &Object) -> &str {
     "QObject"
 }
 
+fn has_data_range(o: &Object) -> bool {
+    o.object_type != ObjectType::Object && !data_range_properties(o).is_empty()
+}
+
+/// The item properties that are fetched in a data range. Buffers that are
+/// shared with Rust are cached per buffer instead.
+fn data_range_properties(o: &Object) -> Vec<(&String, &ItemProperty)> {
+    o.item_properties
+        .iter()
+        .filter(|(_, ip)| !ip.rust_by_arc)
+        .collect()
+}
+
+fn has_arc(o: &Object) -> bool {
+    o.item_properties.values().any(|ip| ip.rust_by_arc)
+}
+
 fn model_is_writable(o: &Object) -> bool {
     let mut write = false;
     for p in o.item_properties.values() {
@@ -83,6 +104,13 @@ fn write_header_item_model(h: &mut Vec<u8>, o: &Object) -> Result<()> {
                     rw
                 )?;
             }
+            if ip.is_numeric() {
+                writeln!(
+                    h,
+                    "    Q_INVOKABLE QVector<{}> {}Column(int first, int last) const;",
+                    r, name
+                )?;
+            }
         } else {
             writeln!(
                 h,
@@ -110,6 +138,41 @@ private:
     void initHeaderData();
     void updatePersistentIndexes();"
     )?;
+    if o.object_type == ObjectType::List {
+        writeln!(
+            h,
+            "    void updatePersistentIndexes(const quintptr* oldRows, int len);"
+        )?;
+    }
+    if has_data_range(o) {
+        writeln!(
+            h,
+            "    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;"
+        )?;
+    }
+    if o.page_size > 0 {
+        writeln!(h, "    void requestRows(int row) const;")?;
+    }
+    writeln!(
+        h,
+        "    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {{
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    }};
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();"
+    )?;
     Ok(())
 }
 
@@ -128,6 +191,11 @@ class {} : public {}
             writeln!(h, "    friend class {};", object.name)?;
         }
     }
+    for proxy in conf.proxies.values() {
+        if proxy.source.name == o.name {
+            writeln!(h, "    friend class {};", proxy.name)?;
+        }
+    }
     writeln!(
         h,
         "public:
@@ -191,7 +259,12 @@ public:
         }
     }
     for (name, f) in &o.functions {
-        write!(h, "    Q_INVOKABLE {} {}(", f.return_type.name(), name)?;
+        let return_type = if f.asynchronous {
+            "quint64"
+        } else {
+            f.return_type.name()
+        };
+        write!(h, "    Q_INVOKABLE {} {}(", return_type, name)?;
         for (i, a) in f.arguments.iter().enumerate() {
             if i != 0 {
                 write!(h, ", ")?;
@@ -203,10 +276,68 @@ public:
     if base_type(o) == "QAbstractItemModel" {
         write_header_item_model(h, o)?;
     }
+    if o.transactions {
+        writeln!(
+            h,
+            "private Q_SLOTS:
+    void applyTransactions();"
+        )?;
+    }
+    if o.has_commands() {
+        writeln!(
+            h,
+            "private Q_SLOTS:
+    void applyCommands();"
+        )?;
+    }
+    if o.coalesce_changes {
+        writeln!(
+            h,
+            "private Q_SLOTS:
+    void emitChanges();"
+        )?;
+        if o.max_change_rate > 0 {
+            writeln!(
+                h,
+                "private:
+    QElapsedTimer m_changesTimer;"
+            )?;
+        }
+    }
+    let cached: Vec<_> = o.properties.iter().filter(|(_, p)| p.cached).collect();
+    if !cached.is_empty() {
+        if !o.coalesce_changes {
+            writeln!(h, "private Q_SLOTS:")?;
+            for (name, _) in &cached {
+                writeln!(h, "    void invalidate{}();", upper_initial(name))?;
+            }
+        }
+        writeln!(
+            h,
+            "private:
+    // property values that are read from Rust again only after a change"
+        )?;
+        for (name, p) in &cached {
+            writeln!(h, "    mutable {} m_{};", cached_type(p), name)?;
+            writeln!(h, "    mutable bool m_{}Cached = false;", name)?;
+        }
+    }
     writeln!(h, "Q_SIGNALS:")?;
     for name in o.properties.keys() {
         writeln!(h, "    void {}Changed();", name)?;
     }
+    for (name, f) in o.functions.iter().filter(|(_, f)| f.asynchronous) {
+        if f.return_type == SimpleType::Void {
+            writeln!(h, "    void {}Finished(quint64 request);", name)?;
+        } else {
+            writeln!(
+                h,
+                "    void {}Finished(quint64 request, {} result);",
+                name,
+                f.return_type.cpp_set_type()
+            )?;
+        }
+    }
     writeln!(h, "}};")?;
     Ok(())
 }
@@ -225,7 +356,9 @@ fn write_function_c_decl(
 ) -> Result<()> {
     let lc = snake_case(name);
     write!(w, "    ")?;
-    if f.return_type.is_complex() {
+    if f.asynchronous {
+        write!(w, "quint64")?;
+    } else if f.return_type.is_complex() {
         write!(w, "void")?;
     } else {
         write!(w, "{}", f.type_name())?;
@@ -235,7 +368,7 @@ fn write_function_c_decl(
         w,
         " {}({}{}::Private*",
         name,
-        if f.mutable { "" } else { "const " },
+        if f.mutable || f.asynchronous { "" } else { "const " },
         o.name
     )?;
 
@@ -253,7 +386,9 @@ fn write_function_c_decl(
     // If the return type is QString or QByteArray, append a pointer to the
     // variable that will be set to the argument list. Also add a setter
     // function.
-    if f.return_type.name() == "QString" {
+    if f.asynchronous {
+        // the result is passed to the Finished signal instead
+    } else if f.return_type.name() == "QString" {
         write!(w, ", QString*, qstring_set")?;
     } else if f.return_type.name() == "QByteArray" {
         write!(w, ", QByteArray*, qbytearray_set")?;
@@ -262,12 +397,80 @@ fn write_function_c_decl(
     Ok(())
 }
 
+/// Write the functions with which other threads call into the QObject:
+/// the wake-up for queued function calls and the functions that pass the
+/// result of an async function. Signals are emitted in the thread of the
+/// QObject.
+fn write_cpp_thread_calls(w: &mut Vec<u8>, o: &Object) -> Result<()> {
+    let lcname = snake_case(&o.name);
+    if o.has_commands() {
+        // calls from other threads are made in the thread of the QObject
+        writeln!(
+            w,
+            "extern \"C\" void {}_commands_pending({}* o)
+{{
+    QMetaObject::invokeMethod(o, \"applyCommands\", Qt::QueuedConnection);
+}}",
+            lcname, o.name
+        )?;
+    }
+    for (name, f) in o.functions.iter().filter(|(_, f)| f.asynchronous) {
+        let (params, value, arg) = match f.return_type {
+            SimpleType::Void => ("", "", String::new()),
+            SimpleType::QString => (
+                ", const char* bytes, int nbytes",
+                "    const QString result = QString::fromUtf8(bytes, nbytes);\n",
+                ",\n        Q_ARG(QString, result)".to_string(),
+            ),
+            SimpleType::QByteArray => (
+                ", const char* bytes, int nbytes",
+                "    const QByteArray result(bytes, nbytes);\n",
+                ",\n        Q_ARG(QByteArray, result)".to_string(),
+            ),
+            _ => ("", "", format!(",\n        Q_ARG({}, result)", f.type_name())),
+        };
+        let params = if params.is_empty() && f.return_type != SimpleType::Void {
+            format!(", {} result", f.type_name())
+        } else {
+            params.to_string()
+        };
+        writeln!(
+            w,
+            "extern \"C\" void {}_{}_finished({}* o, quint64 request{})
+{{
+{}    QMetaObject::invokeMethod(o, \"{}Finished\", Qt::QueuedConnection,
+        Q_ARG(quint64, request){});
+}}",
+            lcname,
+            snake_case(name),
+            o.name,
+            params,
+            value,
+            name,
+            arg
+        )?;
+    }
+    Ok(())
+}
+
 fn write_object_c_decl(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
     let lcname = snake_case(&o.name);
     write!(w, "    {}::Private* {}_new(", o.name, lcname)?;
     constructor_args_decl(w, o, conf)?;
     writeln!(w, ");")?;
     writeln!(w, "    void {}_free({}::Private*);", lcname, o.name)?;
+    if o.coalesce_changes {
+        writeln!(w, "    quint64 {}_take_changes({}::Private*);", lcname, o.name)?;
+        if o.properties.values().any(|p| p.cached) {
+            writeln!(w, "    quint64 {}_pending_changes({}::Private*);", lcname, o.name)?;
+        }
+    }
+    if o.transactions {
+        writeln!(w, "    void {}_apply_transactions({}::Private*);", lcname, o.name)?;
+    }
+    if o.has_commands() {
+        writeln!(w, "    void {}_apply_commands({}::Private*);", lcname, o.name)?;
+    }
     for (name, p) in &o.properties {
         let base = format!("{}_{}", lcname, snake_case(name));
         if p.is_object() {
@@ -366,6 +569,120 @@ fn connect(w: &mut Vec<u8>, d: &str, o: &Object, conf: &Config) -> Result<()> {
     Ok(())
 }
 
+/// Emit the change signals of the properties that changed since the last
+/// call, at most once per `1000 / maxChangeRate` ms.
+fn write_cpp_emit_changes(w: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    writeln!(w, "void {}::emitChanges()\n{{", o.name)?;
+    if o.max_change_rate > 0 {
+        writeln!(
+            w,
+            "    const qint64 wait = m_changesTimer.isValid() ? {} - m_changesTimer.elapsed() : 0;
+    if (wait > 0) {{
+        QTimer::singleShot(wait, this, SLOT(emitChanges()));
+        return;
+    }}
+    m_changesTimer.start();",
+            (1000 / o.max_change_rate).max(1)
+        )?;
+    }
+    writeln!(w, "    const quint64 changes = {}_take_changes(m_d);", lcname)?;
+    let properties = o.properties.iter().filter(|(_, p)| !p.is_object());
+    for (bit, (name, p)) in properties.enumerate() {
+        writeln!(w, "    if (changes & (quint64(1) << {})) {{", bit)?;
+        if p.cached {
+            writeln!(w, "        m_{}Cached = false;", name)?;
+        }
+        writeln!(w, "        Q_EMIT {}Changed();\n    }}", name)?;
+    }
+    writeln!(w, "}}")?;
+    Ok(())
+}
+
+/// The type of the member in which the value of a cached property is kept.
+fn cached_type(p: &Property) -> &str {
+    if p.optional && !p.is_complex() {
+        "QVariant"
+    } else {
+        p.type_name()
+    }
+}
+
+/// Write a getter that reads a property from Rust only after a change and
+/// the slot that marks the value as changed.
+fn write_cpp_cached_getter(
+    w: &mut Vec<u8>,
+    o: &Object,
+    name: &str,
+    p: &Property,
+    base: &str,
+) -> Result<()> {
+    let t = cached_type(p);
+    writeln!(w, "{} {}::{}() const\n{{", t, o.name, name)?;
+    if o.coalesce_changes {
+        // the cache is cleared in emitChanges(), so until then a change that
+        // is pending in Rust, e.g. from the setter, means it is stale
+        let bit = o
+            .properties
+            .iter()
+            .filter(|(_, p)| !p.is_object())
+            .position(|(n, _)| n == name)
+            .unwrap();
+        writeln!(
+            w,
+            "    if (!m_{}Cached || ({}_pending_changes(m_d) & (quint64(1) << {}))) {{",
+            name,
+            snake_case(&o.name),
+            bit
+        )?;
+    } else {
+        writeln!(w, "    if (!m_{}Cached) {{", name)?;
+    }
+    if p.is_complex() {
+        writeln!(w, "        m_{} = {}();", name, t)?;
+        writeln!(
+            w,
+            "        {}_get(m_d, &m_{}, {});",
+            base,
+            name,
+            setter(p.type_name(), p.encoding)
+        )?;
+    } else if p.optional {
+        writeln!(
+            w,
+            "        m_{0} = QVariant();
+        auto r = {1}_get(m_d);
+        if (r.some) {{
+            m_{0}.setValue(r.value);
+        }}",
+            name, base
+        )?;
+    } else {
+        writeln!(w, "        m_{} = {}_get(m_d);", name, base)?;
+    }
+    writeln!(
+        w,
+        "        m_{0}Cached = true;
+    }}
+    return m_{0};
+}}",
+        name
+    )?;
+    if !o.coalesce_changes {
+        writeln!(
+            w,
+            "void {}::invalidate{}()
+{{
+    m_{}Cached = false;
+    Q_EMIT {2}Changed();
+}}",
+            o.name,
+            upper_initial(name),
+            name
+        )?;
+    }
+    Ok(())
+}
+
 fn write_cpp_object_properties(w: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
     for (name, p) in &o.properties {
         let base = format!("{}_{}", lcname, snake_case(name));
@@ -384,20 +701,22 @@ fn write_cpp_object_properties(w: &mut Vec<u8>, o: &Object, lcname: &str) -> Res
                 o.name,
                 name
             )?;
+        } else if p.cached {
+            write_cpp_cached_getter(w, o, name, p, &base)?;
         } else if p.is_complex() {
             writeln!(
                 w,
                 "{} {}::{}() const
 {{
     {0} v;
-    {3}_get(m_d, &v, set_{4});
+    {3}_get(m_d, &v, {4});
     return v;
 }}",
                 p.type_name(),
                 o.name,
                 name,
                 base,
-                p.type_name().to_lowercase()
+                setter(p.type_name(), p.encoding)
             )?;
         } else if p.optional {
             writeln!(
@@ -491,12 +810,15 @@ fn write_cpp_object(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
         base_type(o)
     )?;
     initialize_members_zero(w, o)?;
-    writeln!(
+    write!(
         w,
         "    m_d(nullptr),
-    m_ownsPrivate(false)
-{{"
+    m_ownsPrivate(false)"
     )?;
+    if has_data_range(o) {
+        write!(w, ",\n    m_dataRange(new DataRange())")?;
+    }
+    writeln!(w, "\n{{")?;
     if o.object_type != ObjectType::Object {
         writeln!(w, "    initHeaderData();")?;
     }
@@ -512,12 +834,15 @@ fn write_cpp_object(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
     initialize_members_zero(w, o)?;
     write!(w, "    m_d({}_new(this", lcname)?;
     constructor_args(w, "", o, conf)?;
-    writeln!(
+    write!(
         w,
         ")),
-    m_ownsPrivate(true)
-{{"
+    m_ownsPrivate(true)"
     )?;
+    if has_data_range(o) {
+        write!(w, ",\n    m_dataRange(new DataRange())")?;
+    }
+    writeln!(w, "\n{{")?;
     initialize_members(w, "", o, conf)?;
     connect(w, "this", o, conf)?;
     if o.object_type != ObjectType::Object {
@@ -530,10 +855,13 @@ fn write_cpp_object(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
 {}::~{0}() {{
     if (m_ownsPrivate) {{
         {1}_free(m_d);
-    }}
-}}",
+    }}",
         o.name, lcname
     )?;
+    if has_data_range(o) {
+        writeln!(w, "    delete m_dataRange;")?;
+    }
+    writeln!(w, "}}")?;
     if o.object_type != ObjectType::Object {
         writeln!(w, "void {}::initHeaderData() {{", o.name)?;
         for col in 0..o.column_count() {
@@ -554,10 +882,38 @@ fn write_cpp_object(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
     }
 
     write_cpp_object_properties(w, o, &lcname)?;
+    if o.coalesce_changes {
+        write_cpp_emit_changes(w, o, &lcname)?;
+    }
+    if o.transactions {
+        writeln!(
+            w,
+            "void {}::applyTransactions()
+{{
+    {}_apply_transactions(m_d);
+}}",
+            o.name, lcname
+        )?;
+    }
+    if o.has_commands() {
+        writeln!(
+            w,
+            "void {}::applyCommands()
+{{
+    {}_apply_commands(m_d);
+}}",
+            o.name, lcname
+        )?;
+    }
 
     for (name, f) in &o.functions {
         let base = format!("{}_{}", lcname, snake_case(name));
-        write!(w, "{} {}::{}(", f.type_name(), o.name, name)?;
+        let return_type = if f.asynchronous {
+            "quint64"
+        } else {
+            f.type_name()
+        };
+        write!(w, "{} {}::{}(", return_type, o.name, name)?;
         for (i, a) in f.arguments.iter().enumerate() {
             write!(
                 w,
@@ -578,7 +934,9 @@ fn write_cpp_object(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
                 arg_list.push_str(&format!(", {}", a.name));
             }
         }
-        if f.return_type.name() == "QString" {
+        if f.asynchronous {
+            writeln!(w, "    return {}(m_d{});", base, arg_list)?;
+        } else if f.return_type.name() == "QString" {
             writeln!(
                 w,
                 "    {} s;
@@ -633,6 +991,9 @@ fn write_model_getter_setter(
     if o.object_type == ObjectType::List {
         idx = ", row";
         writeln!(w, "{} {}::{}(int row) const\n{{", r, o.name, name)?;
+        if o.page_size > 0 {
+            writeln!(w, "    requestRows(row);")?;
+        }
     } else {
         writeln!(
             w,
@@ -644,13 +1005,23 @@ fn write_model_getter_setter(
         writeln!(w, "    QString s;")?;
         writeln!(
             w,
-            "    {}_data_{}(m_d{}, &s, set_{});",
+            "    {}_data_{}(m_d{}, &s, {});",
             lcname,
             snake_case(name),
             idx,
-            ip.type_name().to_lowercase()
+            setter(ip.type_name(), ip.encoding)
         )?;
         writeln!(w, "    return s;")?;
+    } else if ip.rust_by_arc {
+        writeln!(w, "    int len;")?;
+        writeln!(
+            w,
+            "    const char* data = {}_data_{}(m_d{}, &len);",
+            lcname,
+            snake_case(name),
+            idx
+        )?;
+        writeln!(w, "    return arc_registry().get(data, len, {}_release_arc);", lcname)?;
     } else if ip.type_name() == "QByteArray" {
         writeln!(w, "    QByteArray b;")?;
         writeln!(
@@ -699,6 +1070,9 @@ fn write_model_getter_setter(
             upper_initial(name),
             r
         )?;
+        if o.page_size > 0 {
+            writeln!(w, "    requestRows(row);")?;
+        }
     } else {
         writeln!(
             w,
@@ -765,6 +1139,7 @@ fn write_model_getter_setter(
         writeln!(
             w,
             "    if (set) {{
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }}
@@ -776,6 +1151,7 @@ fn write_model_getter_setter(
         writeln!(
             w,
             "    if (set) {{
+        clearDataRange();
         Q_EMIT dataChanged(index, index);
     }}
     return set;
@@ -786,79 +1162,519 @@ fn write_model_getter_setter(
     Ok(())
 }
 
-fn write_cpp_model(w: &mut Vec<u8>, o: &Object) -> Result<()> {
-    let lcname = snake_case(&o.name);
-    let (index_decl, index) = if o.object_type == ObjectType::Tree {
-        (", quintptr", ", index.internalId()")
-    } else {
-        (", int", ", index.row()")
-    };
-    writeln!(w, "extern \"C\" {{")?;
-
-    for (name, ip) in &o.item_properties {
-        if ip.is_complex() {
-            writeln!(
-                w,
-                "    void {}_data_{}(const {}::Private*{}, {});",
-                lcname,
-                snake_case(name),
-                o.name,
-                index_decl,
-                ip.c_get_type()
-            )?;
-        } else {
-            writeln!(
-                w,
-                "    {} {}_data_{}(const {}::Private*{});",
-                ip.cpp_set_type(),
-                lcname,
-                snake_case(name),
-                o.name,
-                index_decl
-            )?;
-        }
-        if ip.write {
-            let a = format!("    bool {}_set_data_{}", lcname, snake_case(name));
-            let b = format!("({}::Private*{}", o.name, index_decl);
-            if ip.type_name() == "QString" {
-                writeln!(w, "{}{}, const ushort* s, int len);", a, b)?;
-            } else if ip.type_name() == "QByteArray" {
-                writeln!(w, "{}{}, const char* s, int len);", a, b)?;
-            } else {
-                writeln!(w, "{}{}, {});", a, b, ip.c_set_type())?;
-            }
-            if ip.optional {
-                writeln!(w, "{}_none{});", a, b)?;
-            }
-        }
+/// Write a function that copies the values of a numeric item property for a
+/// range of rows in one call.
+fn write_cpp_column(w: &mut Vec<u8>, name: &str, ip: &ItemProperty, o: &Object) -> Result<()> {
+    if o.page_size > 0 {
+        // copy one page at a time, so each page is requested once
+        return writeln!(
+            w,
+            "QVector<{0}> {1}::{2}Column(int first, int last) const
+{{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<{0}> column(qMax(0, last - first + 1));
+    for (int row = first; row <= last; row += {5} - row % {5}) {{
+        requestRows(row);
+        const int count = qMin(last + 1, row + {5} - row % {5}) - row;
+        {3}_column_{4}(m_d, row, count, column.data() + row - first);
+    }}
+    return column;
+}}
+",
+            ip.type_name(),
+            o.name,
+            name,
+            snake_case(&o.name),
+            snake_case(name),
+            o.page_size
+        );
     }
     writeln!(
         w,
-        "    void {}_sort({}::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);",
-        lcname,
-        o.name
-    )?;
-    if o.object_type == ObjectType::List {
-        writeln!(
-            w,
-            "
-    int {1}_row_count(const {0}::Private*);
-    bool {1}_insert_rows({0}::Private*, int, int);
-    bool {1}_remove_rows({0}::Private*, int, int);
-    bool {1}_can_fetch_more(const {0}::Private*);
-    void {1}_fetch_more({0}::Private*);
-}}
-int {0}::columnCount(const QModelIndex &parent) const
+        "QVector<{0}> {1}::{2}Column(int first, int last) const
 {{
-    return (parent.isValid()) ? 0 : {2};
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<{0}> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {{
+        {3}_column_{4}(m_d, first, column.size(), column.data());
+    }}
+    return column;
 }}
+",
+        ip.type_name(),
+        o.name,
+        name,
+        snake_case(&o.name),
+        snake_case(name)
+    )
+}
 
-bool {0}::hasChildren(const QModelIndex &parent) const
-{{
-    return rowCount(parent) > 0;
-}}
+/// The type in which a prefetched value of an item property is stored.
+fn data_range_type(ip: &ItemProperty) -> String {
+    if ip.optional && !ip.is_complex() {
+        return format!("option_{}", ip.type_name());
+    }
+    ip.type_name().into()
+}
 
-int {0}::rowCount(const QModelIndex &parent) const
+/// The setters with which Rust writes QString and QByteArray values into a
+/// data range.
+fn data_range_setters(o: &Object) -> (String, String) {
+    let mut decl = String::new();
+    let mut args = String::new();
+    for t in &["QString", "QByteArray"] {
+        if data_range_properties(o).iter().any(|(_, ip)| ip.type_name() == *t) {
+            decl.push_str(&format!(", {}_set_at", t.to_lowercase()));
+            args.push_str(&format!(", set_{}_at", t.to_lowercase()));
+        }
+    }
+    if o.item_properties.values().any(|ip| ip.encoding == Encoding::Utf16) {
+        decl.push_str(", qstring_set_at");
+        args.push_str(", set_qstring_utf16_at");
+    }
+    (decl, args)
+}
+
+fn write_cpp_data_range(w: &mut Vec<u8>, o: &Object) -> Result<()> {
+    let lcname = snake_case(&o.name);
+    let tree = o.object_type == ObjectType::Tree;
+    writeln!(w, "struct {}::DataRange {{", o.name)?;
+    writeln!(w, "    int first;\n    int count;")?;
+    writeln!(w, "    // bit i is set when item property i has been fetched")?;
+    writeln!(w, "    quint64 fetched;")?;
+    if tree {
+        writeln!(w, "    option_quintptr parent;")?;
+        writeln!(w, "    QVector<quintptr> id;")?;
+    }
+    for (name, ip) in data_range_properties(o) {
+        writeln!(w, "    QVector<{}> {};", data_range_type(ip), name)?;
+    }
+    if o.page_size > 0 {
+        writeln!(w, "    // first row of the page that was requested last")?;
+        writeln!(w, "    int page = -1;")?;
+    }
+    writeln!(
+        w,
+        "}};
+
+void {0}::clearDataRange() const
+{{
+    m_dataRange->count = 0;{1}
+}}
+
+int {0}::dataRangeRow(const QModelIndex &index, int property) const
+{{
+    DataRange* r = m_dataRange;
+    const int row = index.row();",
+        o.name,
+        if o.page_size > 0 {
+            "\n    // the rows of Rust may have changed, so request the page again\n    m_dataRange->page = -1;"
+        } else {
+            ""
+        }
+    )?;
+    if tree {
+        writeln!(
+            w,
+            "    bool fetchIds = false;
+    if (row < r->first || row >= r->first + r->count
+            || r->id.at(row - r->first) != index.internalId()) {{
+        const QModelIndex parent = index.parent();
+        r->parent = {{ parent.internalId(), parent.isValid() }};"
+        )?;
+    } else {
+        writeln!(
+            w,
+            "    if (row < r->first || row >= r->first + r->count) {{
+        const QModelIndex parent;"
+        )?;
+    }
+    writeln!(
+        w,
+        "        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;"
+    )?;
+    if tree {
+        writeln!(w, "        r->id.resize(r->count);")?;
+        writeln!(w, "        fetchIds = true;")?;
+    }
+    for (name, ip) in data_range_properties(o) {
+        if ip.optional && ip.is_complex() {
+            writeln!(
+                w,
+                "        r->{}.fill({}(), r->count);",
+                name,
+                ip.type_name()
+            )?;
+        } else {
+            writeln!(w, "        r->{}.resize(r->count);", name)?;
+        }
+    }
+    writeln!(
+        w,
+        "    }}
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {{
+        {}_data_range_t columns = {{",
+        lcname
+    )?;
+    let mut columns = Vec::new();
+    if tree {
+        columns.push("            fetchIds ?r->id.data() :nullptr".to_string());
+    }
+    for (name, _) in data_range_properties(o) {
+        columns.push(format!("            r->{}.data()", name));
+    }
+    writeln!(w, "{}", columns.join(",\n"))?;
+    writeln!(w, "        }};")?;
+    if o.page_size > 0 {
+        writeln!(w, "        requestRows(r->first);")?;
+    }
+    writeln!(
+        w,
+        "        {}_data_range(m_d{}, r->first, r->first + r->count - 1, bit, &columns{});
+        r->fetched |= bit;
+    }}
+    return row - r->first;
+}}",
+        lcname,
+        if tree { ", r->parent" } else { "" },
+        data_range_setters(o).1
+    )?;
+    if o.page_size > 0 {
+        writeln!(
+            w,
+            "
+void {0}::requestRows(int row) const
+{{
+    // Rust keeps the page that was requested last, so a row on that page
+    // can be read without asking again
+    const int first = row - row % {2};
+    if (m_dataRange->page != first) {{
+        {1}_request_rows(m_d, first, qMin(first + {2}, rowCount()) - 1);
+        m_dataRange->page = first;
+    }}
+}}",
+            o.name, lcname, o.page_size
+        )?;
+    }
+    Ok(())
+}
+
+/// Write the role names of a model sorted by name and a function that maps
+/// a column and role to the index of an item property.
+fn write_cpp_role_table(w: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    let mut names: Vec<(String, String)> = ["display", "decoration", "edit", "toolTip", "statusTip", "whatsThis"]
+        .iter()
+        .filter(|name| !o.item_properties.contains_key(**name))
+        .map(|name| (name.to_string(), format!("Qt::{}Role", upper_initial(name))))
+        .collect();
+    for (i, name) in o.item_properties.keys().enumerate() {
+        names.push((name.clone(), format!("Qt::UserRole + {}", i)));
+    }
+    names.sort();
+    writeln!(w, "    constexpr role_name_t {}_role_names[] = {{", lcname)?;
+    for (name, role) in &names {
+        writeln!(w, "        {{\"{}\", {}}},", name, role)?;
+    }
+    writeln!(
+        w,
+        "    }};
+    // index of the item property for a column and role or -1
+    int {}_property(int column, int role)
+    {{
+        switch (column) {{",
+        lcname
+    )?;
+    for col in 0..o.column_count() {
+        writeln!(w, "        case {}:", col)?;
+        writeln!(w, "            switch (role) {{")?;
+        for (i, ip) in o.item_properties.values().enumerate() {
+            let empty = Vec::new();
+            let roles = ip.roles.get(col).unwrap_or(&empty);
+            if col > 0 && roles.is_empty() {
+                continue;
+            }
+            for role in roles {
+                writeln!(w, "            case Qt::{}:", role_name(role))?;
+            }
+            writeln!(w, "            case Qt::UserRole + {}:", i)?;
+            writeln!(w, "                return {};", i)?;
+        }
+        writeln!(w, "            }}\n            break;")?;
+    }
+    writeln!(w, "        }}\n        return -1;\n    }}")?;
+    writeln!(
+        w,
+        "    // roles and last column that show the item properties in a mask
+    void {}_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {{",
+        lcname
+    )?;
+    for (i, ip) in o.item_properties.values().enumerate() {
+        writeln!(w, "        if (properties & (quint64(1) << {})) {{", i)?;
+        let mut last_column = 0;
+        for (col, roles) in ip.roles.iter().enumerate() {
+            for role in roles {
+                writeln!(w, "            roles.append(Qt::{});", role_name(role))?;
+            }
+            if !roles.is_empty() {
+                last_column = col;
+            }
+        }
+        writeln!(w, "            roles.append(Qt::UserRole + {});", i)?;
+        writeln!(
+            w,
+            "            lastColumn = qMax(lastColumn, {});\n        }}",
+            last_column
+        )?;
+    }
+    writeln!(
+        w,
+        "        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }}"
+    )?;
+    Ok(())
+}
+
+/// Changes that Rust reports with the changed item properties are queued
+/// and emitted as one dataChanged per contiguous block of rows.
+fn write_cpp_data_changes(w: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    writeln!(
+        w,
+        "void {0}::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{{
+    if (m_dataChanges.isEmpty()) {{
+        QMetaObject::invokeMethod(this, \"emitDataChanged\", Qt::QueuedConnection);
+    }}
+    m_dataChanges.append({{parent, first, last, properties}});
+}}
+
+void {0}::emitDataChanged()
+{{
+    if (m_dataChanges.isEmpty()) {{
+        return;
+    }}
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {{
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    }});
+    int i = 0;
+    while (i < changes.size()) {{
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {{
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }}
+        QVector<int> roles;
+        int lastColumn = 0;
+        {1}_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }}
+}}
+",
+        o.name, lcname
+    )?;
+    Ok(())
+}
+
+/// Write the registry of the buffers that Rust shares by their address.
+///
+/// A QByteArray refers to such a buffer without copying it. The registry
+/// outlives the models, so a buffer that is still in use when its model is
+/// deleted is released once no QByteArray refers to it anymore.
+fn write_cpp_arc_registry(w: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        w,
+        "
+    typedef void (*arc_release)(const char* data, int len);
+    struct arc_entry_t {{
+        QByteArray bytes;
+        arc_release release;
+    }};
+    class arc_registry_t {{
+        QMutex mutex;
+        QHash<const char*, arc_entry_t> entries;
+        // inserts until the next sweep; this grows with the number of
+        // buffers in use, so a sweep costs O(1) per insert
+        int sweepAfter = 64;
+        void sweep() {{
+            auto i = entries.begin();
+            while (i != entries.end()) {{
+                if (i.value().bytes.isDetached()) {{
+                    i.value().release(i.key(), i.value().bytes.size());
+                    i = entries.erase(i);
+                }} else {{
+                    ++i;
+                }}
+            }}
+            sweepAfter = qMax(64, entries.size());
+        }}
+    public:
+        QByteArray get(const char* data, int len, arc_release release) {{
+            QMutexLocker lock(&mutex);
+            auto i = entries.constFind(data);
+            if (i != entries.constEnd()) {{
+                release(data, len);
+                return i.value().bytes;
+            }}
+            if (len == 0) {{
+                release(data, len);
+                return QByteArray(data, 0);
+            }}
+            if (--sweepAfter <= 0) {{
+                sweep();
+            }}
+            // the buffer is kept alive by Rust until no QByteArray refers to it
+            const QByteArray b = QByteArray::fromRawData(data, len);
+            entries.insert(data, arc_entry_t{{b, release}});
+            return b;
+        }}
+    }};
+    arc_registry_t& arc_registry() {{
+        static arc_registry_t registry;
+        return registry;
+    }}"
+    )?;
+    Ok(())
+}
+
+fn write_cpp_model(w: &mut Vec<u8>, o: &Object) -> Result<()> {
+    let lcname = snake_case(&o.name);
+    let (index_decl, index) = if o.object_type == ObjectType::Tree {
+        (", quintptr", ", index.internalId()")
+    } else {
+        (", int", ", index.row()")
+    };
+    writeln!(w, "namespace {{")?;
+    if has_data_range(o) {
+        writeln!(w, "    struct {}_data_range_t {{", lcname)?;
+        if o.object_type == ObjectType::Tree {
+            writeln!(w, "        quintptr* id;")?;
+        }
+        for (name, ip) in data_range_properties(o) {
+            writeln!(w, "        {}* {};", data_range_type(ip), name)?;
+        }
+        writeln!(w, "    }};")?;
+    }
+    write_cpp_role_table(w, o, &lcname)?;
+    writeln!(w, "}}")?;
+    writeln!(w, "extern \"C\" {{")?;
+    if has_data_range(o) {
+        writeln!(
+            w,
+            "    void {}_data_range(const {}::Private*{}, int, int, quint64, {0}_data_range_t*{});",
+            lcname,
+            o.name,
+            if o.object_type == ObjectType::Tree {
+                ", option_quintptr"
+            } else {
+                ""
+            },
+            data_range_setters(o).0
+        )?;
+    }
+
+    if has_arc(o) {
+        writeln!(w, "    void {}_release_arc(const char*, int);", lcname)?;
+    }
+    for (name, ip) in &o.item_properties {
+        if ip.rust_by_arc {
+            writeln!(
+                w,
+                "    const char* {}_data_{}(const {}::Private*{}, int*);",
+                lcname,
+                snake_case(name),
+                o.name,
+                index_decl
+            )?;
+        } else if ip.is_complex() {
+            writeln!(
+                w,
+                "    void {}_data_{}(const {}::Private*{}, {});",
+                lcname,
+                snake_case(name),
+                o.name,
+                index_decl,
+                ip.c_get_type()
+            )?;
+        } else {
+            writeln!(
+                w,
+                "    {} {}_data_{}(const {}::Private*{});",
+                ip.cpp_set_type(),
+                lcname,
+                snake_case(name),
+                o.name,
+                index_decl
+            )?;
+        }
+        if o.object_type == ObjectType::List && ip.is_numeric() {
+            writeln!(
+                w,
+                "    void {}_column_{}(const {}::Private*, int, int, {}*);",
+                lcname,
+                snake_case(name),
+                o.name,
+                ip.type_name()
+            )?;
+        }
+        if ip.write {
+            let a = format!("    bool {}_set_data_{}", lcname, snake_case(name));
+            let b = format!("({}::Private*{}", o.name, index_decl);
+            if ip.type_name() == "QString" {
+                writeln!(w, "{}{}, const ushort* s, int len);", a, b)?;
+            } else if ip.type_name() == "QByteArray" {
+                writeln!(w, "{}{}, const char* s, int len);", a, b)?;
+            } else {
+                writeln!(w, "{}{}, {});", a, b, ip.c_set_type())?;
+            }
+            if ip.optional {
+                writeln!(w, "{}_none{});", a, b)?;
+            }
+        }
+    }
+    writeln!(
+        w,
+        "    void {}_sort({}::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);",
+        lcname,
+        o.name
+    )?;
+    if o.page_size > 0 {
+        writeln!(
+            w,
+            "    void {}_request_rows({}::Private*, int, int);",
+            lcname, o.name
+        )?;
+    }
+    if o.object_type == ObjectType::List {
+        writeln!(
+            w,
+            "
+    int {1}_row_count(const {0}::Private*);
+    bool {1}_insert_rows({0}::Private*, int, int);
+    bool {1}_remove_rows({0}::Private*, int, int);
+    bool {1}_can_fetch_more(const {0}::Private*);
+    void {1}_fetch_more({0}::Private*);
+}}
+int {0}::columnCount(const QModelIndex &parent) const
+{{
+    return (parent.isValid()) ? 0 : {2};
+}}
+
+bool {0}::hasChildren(const QModelIndex &parent) const
+{{
+    return rowCount(parent) > 0;
+}}
+
+int {0}::rowCount(const QModelIndex &parent) const
 {{
     return (parent.isValid()) ? 0 : {1}_row_count(m_d);
 }}
@@ -897,7 +1713,29 @@ void {0}::fetchMore(const QModelIndex &parent)
         {1}_fetch_more(m_d);
     }}
 }}
-void {0}::updatePersistentIndexes() {{}}",
+void {0}::updatePersistentIndexes() {{}}
+
+void {0}::updatePersistentIndexes(const quintptr* oldRows, int len) {{
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {{
+        size = qMax(size, oldRows[row] + 1);
+    }}
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {{
+        newRows[oldRows[row]] = row;
+    }}
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {{
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {{
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        }} else {{
+            to[i] = QModelIndex();
+        }}
+    }}
+    changePersistentIndexList(from, to);
+}}",
             o.name,
             lcname,
             o.column_count()
@@ -907,12 +1745,14 @@ void {0}::updatePersistentIndexes() {{}}",
             w,
             "
     int {1}_row_count(const {0}::Private*, option_quintptr);
+    bool {1}_has_children(const {0}::Private*, option_quintptr);
     bool {1}_can_fetch_more(const {0}::Private*, option_quintptr);
     void {1}_fetch_more({0}::Private*, option_quintptr);
     quintptr {1}_index(const {0}::Private*, option_quintptr, int);
+    option_quintptr {1}_index_checked(const {0}::Private*, option_quintptr, int);
     qmodelindex_t {1}_parent(const {0}::Private*, quintptr);
     int {1}_row(const {0}::Private*, quintptr);
-    option_quintptr {1}_check_row(const {0}::Private*, quintptr, int);
+    void {1}_check_rows(const {0}::Private*, const quintptr*, int*, int);
 }}
 int {0}::columnCount(const QModelIndex &) const
 {{
@@ -921,7 +1761,14 @@ int {0}::columnCount(const QModelIndex &) const
 
 bool {0}::hasChildren(const QModelIndex &parent) const
 {{
-    return rowCount(parent) > 0;
+    if (parent.isValid() && parent.column() != 0) {{
+        return false;
+    }}
+    const option_quintptr rust_parent = {{
+        parent.internalId(),
+        parent.isValid()
+    }};
+    return {1}_has_children(m_d, rust_parent);
 }}
 
 int {0}::rowCount(const QModelIndex &parent) const
@@ -954,15 +1801,13 @@ QModelIndex {0}::index(int row, int column, const QModelIndex &parent) const
     if (parent.isValid() && parent.column() != 0) {{
         return QModelIndex();
     }}
-    if (row >= rowCount(parent)) {{
-        return QModelIndex();
-    }}
     const option_quintptr rust_parent = {{
         parent.internalId(),
         parent.isValid()
     }};
-    const quintptr id = {1}_index(m_d, rust_parent, row);
-    return createIndex(row, column, id);
+    // checks the row and finds the item in one call
+    const option_quintptr id = {1}_index_checked(m_d, rust_parent, row);
+    return id.some ?createIndex(row, column, id.value) :QModelIndex();
 }}
 
 QModelIndex {0}::parent(const QModelIndex &index) const
@@ -996,13 +1841,22 @@ void {0}::fetchMore(const QModelIndex &parent)
 }}
 void {0}::updatePersistentIndexes() {{
     const auto from = persistentIndexList();
-    auto to = from;
-    auto len = to.size();
+    const int len = from.size();
+    if (len == 0) {{
+        return;
+    }}
+    // ask Rust for the new rows of all persistent indexes at once
+    QVector<quintptr> ids(len);
+    QVector<int> rows(len);
     for (int i = 0; i < len; ++i) {{
-        auto index = to.at(i);
-        auto row = {1}_check_row(m_d, index.internalId(), index.row());
-        if (row.some) {{
-            to[i] = createIndex(row.value, index.column(), index.internalId());
+        ids[i] = from.at(i).internalId();
+        rows[i] = from.at(i).row();
+    }}
+    {1}_check_rows(m_d, ids.constData(), rows.data(), len);
+    auto to = from;
+    for (int i = 0; i < len; ++i) {{
+        if (rows.at(i) >= 0) {{
+            to[i] = createIndex(rows.at(i), from.at(i).column(), ids.at(i));
         }} else {{
             to[i] = QModelIndex();
         }}
@@ -1036,50 +1890,42 @@ Qt::ItemFlags {0}::flags(const QModelIndex &i) const
     for ip in &o.item_properties {
         write_model_getter_setter(w, index, ip.0, ip.1, o)?;
     }
+    if o.object_type == ObjectType::List {
+        for (name, ip) in o.item_properties.iter().filter(|(_, ip)| ip.is_numeric()) {
+            write_cpp_column(w, name, ip, o)?;
+        }
+    }
+    if has_data_range(o) {
+        write_cpp_data_range(w, o)?;
+    }
     writeln!(
         w,
         "QVariant {}::data(const QModelIndex &index, int role) const
 {{
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {{",
-        o.name
+    switch ({}_property(index.column(), role)) {{",
+        o.name, lcname
     )?;
-
-    for col in 0..o.column_count() {
-        writeln!(w, "    case {}:", col)?;
-        writeln!(w, "        switch (role) {{")?;
-        for (i, (name, ip)) in o.item_properties.iter().enumerate() {
-            let empty = Vec::new();
-            let roles = ip.roles.get(col).unwrap_or(&empty);
-            if col > 0 && roles.is_empty() {
-                continue;
-            }
-            for role in roles {
-                writeln!(w, "        case Qt::{}:", role_name(role))?;
-            }
-            writeln!(w, "        case Qt::UserRole + {}:", i)?;
-            let ii = if o.object_type == ObjectType::List {
-                ".row()"
-            } else {
-                ""
-            };
-            if ip.optional && !ip.is_complex() {
-                writeln!(w, "            return {}(index{});", name, ii)?;
-            } else if ip.optional {
-                writeln!(
-                    w,
-                    "            return cleanNullQVariant(QVariant::fromValue({}(index{})));",
-                    name, ii
-                )?;
-            } else {
-                writeln!(
-                    w,
-                    "            return QVariant::fromValue({}(index{}));",
-                    name, ii
-                )?;
-            }
+    for (i, (name, ip)) in o.item_properties.iter().enumerate() {
+        writeln!(w, "    case {}:", i)?;
+        let v = if !ip.rust_by_arc {
+            format!("m_dataRange->{}.value(dataRangeRow(index, {}))", name, i)
+        } else if o.object_type == ObjectType::List {
+            format!("{}(index.row())", name)
+        } else {
+            format!("{}(index)", name)
+        };
+        if ip.optional && !ip.is_complex() {
+            writeln!(w, "        return {};", v)?;
+        } else if ip.optional {
+            writeln!(
+                w,
+                "        return cleanNullQVariant(QVariant::fromValue({}));",
+                v
+            )?;
+        } else {
+            writeln!(w, "        return QVariant::fromValue({});", v)?;
         }
-        writeln!(w, "        }}\n        break;")?;
     }
     writeln!(
         w,
@@ -1087,27 +1933,21 @@ Qt::ItemFlags {0}::flags(const QModelIndex &i) const
     return QVariant();
 }}
 
-int {}::role(const char* name) const {{
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {{
-        if (i.value() == name) {{
-            return i.key();
-        }}
-        ++i;
-    }}
-    return -1;
+int {0}::role(const char* name) const {{
+    auto end = std::end({1}_role_names);
+    auto i = std::lower_bound(std::begin({1}_role_names), end, name,
+        [](const role_name_t& r, const char* n) {{ return qstrcmp(r.name, n) < 0; }});
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }}
 QHash<int, QByteArray> {0}::roleNames() const {{
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();",
-        o.name
-    )?;
-    for (i, (name, _)) in o.item_properties.iter().enumerate() {
-        writeln!(w, "    names.insert(Qt::UserRole + {}, \"{}\");", i, name)?;
-    }
-    writeln!(
-        w,
-        "    return names;
+    static const QHash<int, QByteArray> names = [] {{
+        QHash<int, QByteArray> names;
+        for (const auto& r: {1}_role_names) {{
+            names.insert(r.role, r.name);
+        }}
+        return names;
+    }}();
+    return names;
 }}
 QVariant {0}::headerData(int section, Qt::Orientation orientation, int role) const
 {{
@@ -1126,260 +1966,1227 @@ bool {0}::setHeaderData(int section, Qt::Orientation orientation, const QVariant
     return true;
 }}
 ",
-        o.name
+        o.name, lcname
     )?;
+    write_cpp_data_changes(w, o, &lcname)?;
     if model_is_writable(o) {
         writeln!(
             w,
             "bool {}::setData(const QModelIndex &index, const QVariant &value, int role)\n{{",
             o.name
         )?;
-        for col in 0..o.column_count() {
-            if !is_column_write(o, col) {
+        writeln!(w, "    switch ({}_property(index.column(), role)) {{", lcname)?;
+        for (i, (name, ip)) in o.item_properties.iter().enumerate() {
+            if !ip.write {
                 continue;
             }
-            writeln!(w, "    if (index.column() == {}) {{", col)?;
-            for (i, (name, ip)) in o.item_properties.iter().enumerate() {
-                if !ip.write {
-                    continue;
-                }
-                let empty = Vec::new();
-                let roles = ip.roles.get(col).unwrap_or(&empty);
-                if col > 0 && roles.is_empty() {
-                    continue;
-                }
-                write!(w, "        if (")?;
-                for role in roles {
-                    write!(w, "role == Qt::{} || ", role_name(role))?;
-                }
-                writeln!(w, "role == Qt::UserRole + {}) {{", i)?;
-                let ii = if o.object_type == ObjectType::List {
-                    ".row()"
+            writeln!(w, "    case {}:", i)?;
+            let ii = if o.object_type == ObjectType::List {
+                ".row()"
+            } else {
+                ""
+            };
+            if ip.optional && !ip.is_complex() {
+                writeln!(
+                    w,
+                    "        return set{}(index{}, value);",
+                    upper_initial(name),
+                    ii
+                )?;
+            } else {
+                let pre = if ip.optional {
+                    "!value.isValid() || value.isNull() ||"
                 } else {
                     ""
                 };
-                if ip.optional && !ip.is_complex() {
-                    writeln!(
-                        w,
-                        "            return set{}(index{}, value);",
-                        upper_initial(name),
-                        ii
-                    )?;
-                } else {
-                    let pre = if ip.optional {
-                        "!value.isValid() || value.isNull() ||"
-                    } else {
-                        ""
-                    };
-                    writeln!(
-                        w,
-                        "            if ({}value.canConvert(qMetaTypeId<{}>())) {{",
-                        pre,
-                        ip.type_name()
-                    )?;
-                    writeln!(
-                        w,
-                        "                return set{}(index{}, value.value<{}>());",
-                        upper_initial(name),
-                        ii,
-                        ip.type_name()
-                    )?;
-                    writeln!(w, "            }}")?;
-                }
-                writeln!(w, "        }}")?;
+                writeln!(
+                    w,
+                    "        if ({}value.canConvert(qMetaTypeId<{}>())) {{",
+                    pre,
+                    ip.type_name()
+                )?;
+                writeln!(
+                    w,
+                    "            return set{}(index{}, value.value<{}>());",
+                    upper_initial(name),
+                    ii,
+                    ip.type_name()
+                )?;
+                writeln!(w, "        }}\n        break;")?;
             }
-            writeln!(w, "    }}")?;
         }
+        writeln!(w, "    }}")?;
         writeln!(w, "    return false;\n}}\n")?;
     }
     Ok(())
 }
 
-fn constructor_args_decl(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
-    write!(w, "{}*", o.name)?;
-    for p in o.properties.values() {
-        if let Type::Object(object) = &p.property_type {
-            write!(w, ", ")?;
-            constructor_args_decl(w, object, conf)?;
+fn constructor_args_decl(w: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
+    write!(w, "{}*", o.name)?;
+    for p in o.properties.values() {
+        if let Type::Object(object) = &p.property_type {
+            write!(w, ", ")?;
+            constructor_args_decl(w, object, conf)?;
+        } else if !o.coalesce_changes {
+            write!(w, ", void (*)({}*)", o.name)?;
+        }
+    }
+    if o.coalesce_changes {
+        write!(w, ", void (*)({}*)", o.name)?;
+    }
+    if o.object_type == ObjectType::List {
+        write!(
+            w,
+            ",
+        void (*)(const {}*),
+        void (*)({0}*),
+        void (*)({0}*),
+        void (*)({0}*, quintptr, quintptr),
+        void (*)({0}*, quintptr, quintptr, quint64),
+        void (*)({0}*),
+        void (*)({0}*),
+        void (*)({0}*, int, int),
+        void (*)({0}*),
+        void (*)({0}*, int, int, int),
+        void (*)({0}*),
+        void (*)({0}*, int, int),
+        void (*)({0}*),
+        void (*)({0}*, const quintptr*, quintptr)",
+            o.name
+        )?;
+    }
+    if o.object_type == ObjectType::Tree {
+        write!(
+            w,
+            ",
+        void (*)(const {0}*, option_quintptr),
+        void (*)({0}*),
+        void (*)({0}*),
+        void (*)({0}*, quintptr, quintptr),
+        void (*)({0}*, quintptr, quintptr, quint64),
+        void (*)({0}*),
+        void (*)({0}*),
+        void (*)({0}*, option_quintptr, int, int),
+        void (*)({0}*),
+        void (*)({0}*, option_quintptr, int, int, option_quintptr, int),
+        void (*)({0}*),
+        void (*)({0}*, option_quintptr, int, int),
+        void (*)({0}*)",
+            o.name
+        )?;
+    }
+    if o.transactions {
+        write!(w, ",\n        void (*)({}*)", o.name)?;
+    }
+    Ok(())
+}
+
+fn changed_f(o: &Object, p_name: &str) -> String {
+    lower_initial(&o.name) + &upper_initial(p_name) + "Changed"
+}
+
+fn constructor_args(w: &mut Vec<u8>, prefix: &str, o: &Object, conf: &Config) -> Result<()> {
+    let lcname = snake_case(&o.name);
+    let clear = if has_data_range(o) {
+        "            o->clearDataRange();\n"
+    } else {
+        ""
+    };
+    let transactions = if o.transactions {
+        format!(
+            ",
+        []({}* o) {{
+            QMetaObject::invokeMethod(o, \"applyTransactions\", Qt::QueuedConnection);
+        }}",
+            o.name
+        )
+    } else {
+        String::new()
+    };
+    for (name, p) in &o.properties {
+        if let Type::Object(object) = &p.property_type {
+            write!(w, ", {}m_{}", prefix, name)?;
+            constructor_args(w, &format!("m_{}->", name), object, conf)?;
+        } else if !o.coalesce_changes {
+            write!(w, ",\n        {}", changed_f(o, name))?;
+        }
+    }
+    if o.coalesce_changes {
+        write!(
+            w,
+            ",
+        []({}* o) {{
+            QMetaObject::invokeMethod(o, \"emitChanges\", Qt::QueuedConnection);
+        }}",
+            o.name
+        )?;
+    }
+    if o.object_type == ObjectType::List {
+        writeln!(
+            w,
+            ",
+        [](const {0}* o) {{
+            Q_EMIT o->newDataReady(QModelIndex());
+        }},
+        []({0}* o) {{
+{clear}            o->emitDataChanged();
+            Q_EMIT o->layoutAboutToBeChanged();
+        }},
+        []({0}* o) {{
+{clear}            o->updatePersistentIndexes();
+            Q_EMIT o->layoutChanged();
+        }},
+        []({0}* o, quintptr first, quintptr last) {{
+{clear}            o->dataChanged(o->createIndex(first, 0, first),
+                       o->createIndex(last, {1}, last));
+        }},
+        []({0}* o, quintptr first, quintptr last, quint64 properties) {{
+{clear}            o->queueDataChanged(QModelIndex(), first, last, properties);
+        }},
+        []({0}* o) {{
+{clear}            o->emitDataChanged();
+            o->beginResetModel();
+        }},
+        []({0}* o) {{
+{clear}            o->endResetModel();
+        }},
+        []({0}* o, int first, int last) {{
+{clear}            o->emitDataChanged();
+            o->beginInsertRows(QModelIndex(), first, last);
+        }},
+        []({0}* o) {{
+{clear}            o->endInsertRows();
+        }},
+        []({0}* o, int first, int last, int destination) {{
+{clear}            o->emitDataChanged();
+            o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
+        }},
+        []({0}* o) {{
+{clear}            o->endMoveRows();
+        }},
+        []({0}* o, int first, int last) {{
+{clear}            o->emitDataChanged();
+            o->beginRemoveRows(QModelIndex(), first, last);
+        }},
+        []({0}* o) {{
+{clear}            o->endRemoveRows();
+        }},
+        []({0}* o, const quintptr* oldRows, quintptr len) {{
+{clear}            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
+        }}{transactions}",
+            o.name,
+            o.column_count() - 1,
+            clear = clear,
+            transactions = transactions
+        )?;
+    }
+    if o.object_type == ObjectType::Tree {
+        writeln!(
+            w,
+            ",
+        [](const {0}* o, option_quintptr id) {{
+            if (id.some) {{
+                int row = {1}_row(o->m_d, id.value);
+                Q_EMIT o->newDataReady(o->createIndex(row, 0, id.value));
+            }} else {{
+                Q_EMIT o->newDataReady(QModelIndex());
+            }}
+        }},
+        []({0}* o) {{
+{clear}            o->emitDataChanged();
+            Q_EMIT o->layoutAboutToBeChanged();
+        }},
+        []({0}* o) {{
+{clear}            o->updatePersistentIndexes();
+            Q_EMIT o->layoutChanged();
+        }},
+        []({0}* o, quintptr first, quintptr last) {{
+{clear}            quintptr frow = {1}_row(o->m_d, first);
+            quintptr lrow = {1}_row(o->m_d, last);
+            o->dataChanged(o->createIndex(frow, 0, first),
+                       o->createIndex(lrow, {2}, last));
+        }},
+        []({0}* o, quintptr first, quintptr last, quint64 properties) {{
+{clear}            const int frow = {1}_row(o->m_d, first);
+            const int lrow = {1}_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        }},
+        []({0}* o) {{
+{clear}            o->emitDataChanged();
+            o->beginResetModel();
+        }},
+        []({0}* o) {{
+{clear}            o->endResetModel();
+        }},
+        []({0}* o, option_quintptr id, int first, int last) {{
+{clear}            o->emitDataChanged();
+            if (id.some) {{
+                int row = {1}_row(o->m_d, id.value);
+                o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
+            }} else {{
+                o->beginInsertRows(QModelIndex(), first, last);
+            }}
+        }},
+        []({0}* o) {{
+{clear}            o->endInsertRows();
+        }},
+        []({0}* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {{
+{clear}            o->emitDataChanged();
+            QModelIndex s;
+            if (sourceParent.some) {{
+                int row = {1}_row(o->m_d, sourceParent.value);
+                s = o->createIndex(row, 0, sourceParent.value);
+            }}
+            QModelIndex d;
+            if (destinationParent.some) {{
+                int row = {1}_row(o->m_d, destinationParent.value);
+                d = o->createIndex(row, 0, destinationParent.value);
+            }}
+            o->beginMoveRows(s, first, last, d, destination);
+        }},
+        []({0}* o) {{
+{clear}            o->endMoveRows();
+        }},
+        []({0}* o, option_quintptr id, int first, int last) {{
+{clear}            o->emitDataChanged();
+            if (id.some) {{
+                int row = {1}_row(o->m_d, id.value);
+                o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
+            }} else {{
+                o->beginRemoveRows(QModelIndex(), first, last);
+            }}
+        }},
+        []({0}* o) {{
+{clear}            o->endRemoveRows();
+        }}{transactions}",
+            o.name,
+            lcname,
+            o.column_count() - 1,
+            clear = clear,
+            transactions = transactions
+        )?;
+    }
+    Ok(())
+}
+
+fn write_header_proxy(h: &mut Vec<u8>, p: &Proxy) -> Result<()> {
+    writeln!(
+        h,
+        "
+class {0} : public QAbstractItemModel
+{{
+    Q_OBJECT
+    Q_PROPERTY({1}* sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged FINAL)
+    Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged FINAL)
+    Q_PROPERTY(int filterRole READ filterRole WRITE setFilterRole NOTIFY filterRoleChanged FINAL)
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged FINAL)
+public:
+    class Private;
+    explicit {0}(QObject *parent = nullptr);
+    ~{0}();
+    {1}* sourceModel() const;
+    void setSourceModel({1}* source);
+    int sortRole() const;
+    void setSortRole(int role);
+    int filterRole() const;
+    void setFilterRole(int role);
+    QString filterText() const;
+    void setFilterText(const QString& text);
+    Q_INVOKABLE QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    Q_INVOKABLE QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
+    Q_INVOKABLE void sortByRole(const QString& role, Qt::SortOrder order);
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    QHash<int, QByteArray> roleNames() const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+Q_SIGNALS:
+    void sourceModelChanged();
+    void sortRoleChanged();
+    void filterRoleChanged();
+    void filterTextChanged();
+private:
+    // the visible rows of the source below one parent, in the order of the proxy
+    struct Mapping {{
+        QVector<int> sourceRows;
+        QVector<int> proxyRows;
+    }};
+    Private * m_d;
+    {1}* m_source;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    int m_sortRole;
+    int m_filterRole;
+    QString m_filterText;
+    mutable Mapping* m_rootMapping;
+    mutable QHash<quintptr, Mapping*> m_mappings;
+    QModelIndexList m_layoutIndexes;
+    QList<QPersistentModelIndex> m_layoutSourceIndexes;
+    Mapping* cachedMapping(const QModelIndex &sourceParent) const;
+    Mapping* mapping(const QModelIndex &sourceParent) const;
+    QVector<int> sourceRows(const QModelIndex &sourceParent) const;
+    void updateProxyRows(Mapping* m, int sourceRowCount) const;
+    void updateMapping(const QModelIndex &sourceParent);
+    void placeRows(const QModelIndex &sourceParent, int first, int last);
+    void updateAncestors(const QModelIndex &sourceParent);
+    void removeProxyRows(Mapping* m, const QModelIndex &sourceParent, const QVector<bool>& remove);
+    void dropMapping(const QModelIndex &sourceParent);
+    void clearMappings();
+    void resetFilter();
+    void refilter();
+    void beginLayoutChange();
+    void endLayoutChange();
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeMoved(const QModelIndex &parent, int, int, const QModelIndex &destination);
+    void sourceRowsMoved(const QModelIndex &parent, int first, int last, const QModelIndex &destination, int row);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+}};",
+        p.name, p.source.name
+    )?;
+    Ok(())
+}
+
+fn write_proxy_c_decl(w: &mut Vec<u8>, p: &Proxy) -> Result<()> {
+    let tree = p.source.object_type == ObjectType::Tree;
+    writeln!(
+        w,
+        "    {0}::Private* {1}_new();
+    void {1}_free({0}::Private*);
+    void {1}_set_filter({0}::Private*, int, const ushort*, int);
+    int {1}_rows({0}::Private*, const {2}::Private*, {3}int, Qt::SortOrder, int*);
+    int {1}_place({0}::Private*, const {2}::Private*, {3}int, Qt::SortOrder, const int*, int, int);",
+        p.name,
+        snake_case(&p.name),
+        p.source.name,
+        if tree { "option_quintptr, " } else { "" }
+    )?;
+    if tree {
+        writeln!(
+            w,
+            "    void {0}_changed({1}::Private*, const {2}::Private*, option_quintptr, int, int);
+    void {0}_removed({1}::Private*, const {2}::Private*, option_quintptr, int, int);",
+            snake_case(&p.name),
+            p.name,
+            p.source.name
+        )?;
+    }
+    Ok(())
+}
+
+fn write_cpp_proxy(w: &mut Vec<u8>, p: &Proxy) -> Result<()> {
+    let tree = p.source.object_type == ObjectType::Tree;
+    let lcname = snake_case(&p.name);
+    let source_lcname = snake_case(&p.source.name);
+    writeln!(
+        w,
+        "
+{n}::{n}(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d({lc}_new()),
+    m_source(nullptr),
+    m_sortColumn(-1),
+    m_sortOrder(Qt::AscendingOrder),
+    m_sortRole(Qt::DisplayRole),
+    m_filterRole(Qt::DisplayRole),
+    m_rootMapping(nullptr)
+{{
+}}
+
+{n}::~{n}()
+{{
+    clearMappings();
+    {lc}_free(m_d);
+}}
+
+{s}* {n}::sourceModel() const
+{{
+    return m_source;
+}}
+
+void {n}::setSourceModel({s}* source)
+{{
+    if (source == m_source) {{
+        return;
+    }}
+    beginResetModel();
+    if (m_source) {{
+        disconnect(m_source, nullptr, this, nullptr);
+    }}
+    clearMappings();
+    m_source = source;
+    resetFilter();
+    if (m_source) {{
+        connect(m_source, &{s}::modelAboutToBeReset, this, &{n}::beginResetModel);
+        connect(m_source, &{s}::modelReset, this, [this]() {{
+            clearMappings();
+            resetFilter();
+            endResetModel();
+        }});
+        connect(m_source, &{s}::layoutAboutToBeChanged, this, [this]() {{
+            beginLayoutChange();
+        }});
+        connect(m_source, &{s}::layoutChanged, this, [this]() {{
+            clearMappings();
+            endLayoutChange();
+        }});
+        connect(m_source, &{s}::rowsInserted, this, &{n}::sourceRowsInserted);
+        connect(m_source, &{s}::rowsAboutToBeRemoved, this, &{n}::sourceRowsAboutToBeRemoved);
+        connect(m_source, &{s}::rowsRemoved, this, &{n}::sourceRowsRemoved);
+        connect(m_source, &{s}::rowsAboutToBeMoved, this, &{n}::sourceRowsAboutToBeMoved);
+        connect(m_source, &{s}::rowsMoved, this, &{n}::sourceRowsMoved);
+        connect(m_source, &{s}::dataChanged, this, &{n}::sourceDataChanged);
+        connect(m_source, &{s}::headerDataChanged, this, &{n}::headerDataChanged);
+        connect(m_source, &QObject::destroyed, this, [this]() {{
+            setSourceModel(nullptr);
+        }});
+    }}
+    endResetModel();
+    Q_EMIT sourceModelChanged();
+}}
+
+int {n}::sortRole() const
+{{
+    return m_sortRole;
+}}
+
+void {n}::setSortRole(int role)
+{{
+    if (role == m_sortRole) {{
+        return;
+    }}
+    m_sortRole = role;
+    if (m_sortColumn >= 0) {{
+        sort(m_sortColumn, m_sortOrder);
+    }}
+    Q_EMIT sortRoleChanged();
+}}
+
+int {n}::filterRole() const
+{{
+    return m_filterRole;
+}}
+
+void {n}::setFilterRole(int role)
+{{
+    if (role == m_filterRole) {{
+        return;
+    }}
+    m_filterRole = role;
+    if (!m_filterText.isEmpty()) {{
+        refilter();
+    }}
+    Q_EMIT filterRoleChanged();
+}}
+
+QString {n}::filterText() const
+{{
+    return m_filterText;
+}}
+
+void {n}::setFilterText(const QString& text)
+{{
+    if (text == m_filterText) {{
+        return;
+    }}
+    m_filterText = text;
+    refilter();
+    Q_EMIT filterTextChanged();
+}}
+
+void {n}::sortByRole(const QString& role, Qt::SortOrder order)
+{{
+    const int sortRole = m_source ? m_source->role(role.toUtf8().constData()) : -1;
+    const bool changed = sortRole != m_sortRole;
+    m_sortRole = sortRole;
+    sort(0, order);
+    if (changed) {{
+        Q_EMIT sortRoleChanged();
+    }}
+}}
+
+void {n}::sort(int column, Qt::SortOrder order)
+{{
+    beginLayoutChange();
+    m_sortColumn = column;
+    m_sortOrder = order;
+    clearMappings();
+    endLayoutChange();
+}}
+
+{n}::Mapping* {n}::cachedMapping(const QModelIndex &sourceParent) const
+{{
+    if (!sourceParent.isValid()) {{
+        return m_rootMapping;
+    }}
+    return m_mappings.value(sourceParent.internalId());
+}}
+
+{n}::Mapping* {n}::mapping(const QModelIndex &sourceParent) const
+{{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {{
+        m = new Mapping();
+        m->sourceRows = sourceRows(sourceParent);
+        updateProxyRows(m, m_source->rowCount(sourceParent));
+        if (sourceParent.isValid()) {{
+            m_mappings.insert(sourceParent.internalId(), m);
+        }} else {{
+            m_rootMapping = m;
+        }}
+    }}
+    return m;
+}}
+
+QVector<int> {n}::sourceRows(const QModelIndex &sourceParent) const
+{{
+    QVector<int> rows(m_source->rowCount(sourceParent));
+    if (m_sortColumn < 0 && m_filterText.isEmpty()) {{
+        for (int i = 0; i < rows.size(); ++i) {{
+            rows[i] = i;
+        }}
+        return rows;
+    }}
+    const int sort = m_sortColumn < 0 ? -1 : {slc}_property(m_sortColumn, m_sortRole);{parent_decl}
+    rows.resize({lc}_rows(m_d, m_source->m_d, {parent_arg}sort, m_sortOrder, rows.data()));
+    return rows;
+}}
+
+void {n}::updateProxyRows(Mapping* m, int sourceRowCount) const
+{{
+    m->proxyRows.fill(-1, sourceRowCount);
+    for (int i = 0; i < m->sourceRows.size(); ++i) {{
+        m->proxyRows[m->sourceRows.at(i)] = i;
+    }}
+}}
+
+void {n}::removeProxyRows(Mapping* m, const QModelIndex &sourceParent, const QVector<bool>& remove)
+{{
+    // remove from the back, a contiguous block of proxy rows at a time
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    int last = m->sourceRows.size() - 1;
+    while (last >= 0) {{
+        if (!remove.at(m->sourceRows.at(last))) {{
+            --last;
+            continue;
+        }}
+        int first = last;
+        while (first > 0 && remove.at(m->sourceRows.at(first - 1))) {{
+            --first;
+        }}
+        beginRemoveRows(proxyParent, first, last);{drop_children}
+        m->sourceRows.remove(first, last - first + 1);
+        updateProxyRows(m, remove.size());
+        endRemoveRows();
+        last = first - 1;
+    }}
+}}
+
+void {n}::updateMapping(const QModelIndex &sourceParent)
+{{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {{
+        return;
+    }}
+    const int count = m_source->rowCount(sourceParent);
+    const QVector<int> rows = sourceRows(sourceParent);
+    QVector<bool> remove(count, true);
+    for (int row: rows) {{
+        remove[row] = false;
+    }}
+    removeProxyRows(m, sourceParent, remove);
+    // put the remaining rows in their new order
+    QVector<int> kept;
+    kept.reserve(m->sourceRows.size());
+    for (int row: rows) {{
+        if (m->proxyRows.at(row) >= 0) {{
+            kept.append(row);
+        }}
+    }}
+    if (kept != m->sourceRows) {{
+        beginLayoutChange();
+        m->sourceRows = kept;
+        updateProxyRows(m, count);
+        endLayoutChange();
+    }}
+    // insert the new rows, a contiguous block of proxy rows at a time
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    int first = 0;
+    while (first < rows.size()) {{
+        if (m->proxyRows.at(rows.at(first)) >= 0) {{
+            ++first;
+            continue;
+        }}
+        int last = first;
+        while (last + 1 < rows.size() && m->proxyRows.at(rows.at(last + 1)) < 0) {{
+            ++last;
+        }}
+        beginInsertRows(proxyParent, first, last);
+        for (int i = first; i <= last; ++i) {{
+            m->sourceRows.insert(i, rows.at(i));
+        }}
+        updateProxyRows(m, count);
+        endInsertRows();
+        first = last + 1;
+    }}
+}}
+
+void {n}::placeRows(const QModelIndex &sourceParent, int first, int last)
+{{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {{
+        return;
+    }}
+    // many changed rows are cheaper to sort again together
+    if (last - first >= 64) {{
+        updateMapping(sourceParent);
+        return;
+    }}
+    const int count = m_source->rowCount(sourceParent);
+    const int sort = m_sortColumn < 0 ? -1 : {slc}_property(m_sortColumn, m_sortRole);{parent_decl}
+    // the rows that did not change are still in order, so the new order is
+    // found by placing each changed row among them
+    QVector<int> order;
+    order.reserve(m->sourceRows.size() + last - first + 1);
+    for (int row: m->sourceRows) {{
+        if (row < first || row > last) {{
+            order.append(row);
+        }}
+    }}
+    for (int row = first; row <= last; ++row) {{
+        const int place = {lc}_place(m_d, m_source->m_d, {parent_arg}sort, m_sortOrder,
+                order.constData(), order.size(), row);
+        if (place >= 0) {{
+            order.insert(place, row);
+        }}
+    }}
+    QVector<int> rank(count, -1);
+    for (int i = 0; i < order.size(); ++i) {{
+        rank[order.at(i)] = i;
+    }}
+    QVector<bool> remove(count, false);
+    for (int row = first; row <= last; ++row) {{
+        remove[row] = rank.at(row) < 0;
+    }}
+    removeProxyRows(m, sourceParent, remove);
+    // move or insert each changed row behind the row before it in the new
+    // order, counting only rows that are in their place already
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    QVector<int>& rows = m->sourceRows;
+    for (int row = first; row <= last; ++row) {{
+        if (rank.at(row) < 0) {{
+            continue;
+        }}
+        const int from = m->proxyRows.at(row);
+        int to = 0;
+        for (int i = 0; i < rows.size(); ++i) {{
+            const int r = rows.at(i);
+            const bool placed = r < row || r > last;
+            if (r != row && placed && rank.at(r) < rank.at(row)) {{
+                to = from >= 0 && i > from ? i : i + 1;
+            }}
+        }}
+        if (from < 0) {{
+            beginInsertRows(proxyParent, to, to);
+            rows.insert(to, row);
+            updateProxyRows(m, count);
+            endInsertRows();
+        }} else if (to != from) {{
+            beginMoveRows(proxyParent, from, from, proxyParent, to > from ? to + 1 : to);
+            rows.remove(from);
+            rows.insert(to, row);
+            updateProxyRows(m, count);
+            endMoveRows();
+        }}
+    }}
+}}
+
+void {n}::updateAncestors(const QModelIndex &sourceParent)
+{{{update_ancestors}
+}}
+
+void {n}::dropMapping(const QModelIndex &sourceParent)
+{{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {{
+        return;
+    }}
+    if (sourceParent.isValid()) {{
+        m_mappings.remove(sourceParent.internalId());
+    }} else {{
+        m_rootMapping = nullptr;
+    }}{drop_mapping_children}
+    delete m;
+}}
+
+void {n}::clearMappings()
+{{
+    qDeleteAll(m_mappings);
+    m_mappings.clear();
+    delete m_rootMapping;
+    m_rootMapping = nullptr;
+}}
+
+void {n}::resetFilter()
+{{
+    const int property = m_filterText.isEmpty() ? -1 : {slc}_property(0, m_filterRole);
+    {lc}_set_filter(m_d, property, m_filterText.utf16(), m_filterText.size());
+}}
+
+void {n}::refilter()
+{{
+    resetFilter();
+    if (!m_source) {{
+        return;
+    }}
+    // parents go before their children, so rows that are filtered out take
+    // the mappings below them along
+    QVector<QModelIndex> parents;
+    parents.append(QModelIndex());
+    for (int i = 0; i < parents.size(); ++i) {{
+        const QModelIndex sourceParent = parents.at(i);
+        updateMapping(sourceParent);{refilter_children}
+    }}
+}}
+
+void {n}::beginLayoutChange()
+{{
+    Q_EMIT layoutAboutToBeChanged();
+    m_layoutIndexes = persistentIndexList();
+    m_layoutSourceIndexes.clear();
+    for (const QModelIndex& index: m_layoutIndexes) {{
+        m_layoutSourceIndexes.append(QPersistentModelIndex(mapToSource(index)));
+    }}
+}}
+
+void {n}::endLayoutChange()
+{{
+    QModelIndexList to;
+    for (const QPersistentModelIndex& index: m_layoutSourceIndexes) {{
+        to.append(mapFromSource(index));
+    }}
+    changePersistentIndexList(m_layoutIndexes, to);
+    m_layoutIndexes.clear();
+    m_layoutSourceIndexes.clear();
+    Q_EMIT layoutChanged();
+}}
+
+void {n}::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{{{changed}
+    Mapping* m = cachedMapping(parent);
+    if (m) {{
+        const int count = last - first + 1;
+        for (int& row: m->sourceRows) {{
+            if (row >= first) {{
+                row += count;
+            }}
+        }}
+        updateProxyRows(m, m_source->rowCount(parent));
+        updateMapping(parent);
+    }}
+    updateAncestors(parent);
+}}
+
+void {n}::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{{{removed}
+    Mapping* m = cachedMapping(parent);
+    if (m) {{
+        QVector<bool> remove(m_source->rowCount(parent), false);
+        for (int row = first; row <= last; ++row) {{
+            remove[row] = true;
+        }}
+        removeProxyRows(m, parent, remove);
+    }}
+}}
+
+void {n}::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{{{changed_parent}
+    Mapping* m = cachedMapping(parent);
+    if (m) {{
+        const int count = last - first + 1;
+        for (int& row: m->sourceRows) {{
+            if (row > last) {{
+                row -= count;
+            }}
+        }}
+        updateProxyRows(m, m_source->rowCount(parent));
+    }}
+    updateAncestors(parent);
+}}
+
+void {n}::sourceRowsAboutToBeMoved(const QModelIndex &parent, int, int, const QModelIndex &destination)
+{{
+    // a move to another parent can change which rows pass the filter
+    if (parent != destination) {{
+        beginResetModel();
+    }}
+}}
+
+void {n}::sourceRowsMoved(const QModelIndex &parent, int first, int last, const QModelIndex &destination, int row)
+{{
+    if (parent != destination) {{
+        clearMappings();
+        resetFilter();
+        endResetModel();
+        return;
+    }}
+    Mapping* m = cachedMapping(parent);
+    if (!m) {{
+        return;
+    }}
+    const int count = last - first + 1;
+    // the number of a source row after the move
+    const auto moved = [=](int r) {{
+        if (r >= first && r <= last) {{
+            return row > last ? r + row - last - 1 : r - first + row;
+        }}
+        if (row > last && r > last && r < row) {{
+            return r - count;
+        }}
+        if (row < first && r >= row && r < first) {{
+            return r + count;
+        }}
+        return r;
+    }};
+    if (m_sortColumn >= 0) {{
+        // the order of the proxy does not depend on the order of the source
+        for (int& r: m->sourceRows) {{
+            r = moved(r);
+        }}
+        updateProxyRows(m, m_source->rowCount(parent));
+        return;
+    }}
+    // the proxy keeps the order of the source, so the visible rows that
+    // were moved are one block that moves in the proxy too
+    int proxyFirst = m->sourceRows.size();
+    int proxyLast = -1;
+    int proxyRow = 0;
+    for (int i = 0; i < m->sourceRows.size(); ++i) {{
+        const int r = m->sourceRows.at(i);
+        if (r >= first && r <= last) {{
+            proxyFirst = qMin(proxyFirst, i);
+            proxyLast = i;
+        }}
+        if (r < row) {{
+            proxyRow = i + 1;
+        }}
+    }}
+    const bool move = proxyLast >= 0 && (proxyRow < proxyFirst || proxyRow > proxyLast + 1);
+    if (move) {{
+        const QModelIndex proxyParent = mapFromSource(parent);
+        beginMoveRows(proxyParent, proxyFirst, proxyLast, proxyParent, proxyRow);
+    }}
+    for (int& r: m->sourceRows) {{
+        r = moved(r);
+    }}
+    std::sort(m->sourceRows.begin(), m->sourceRows.end());
+    updateProxyRows(m, m_source->rowCount(parent));
+    if (move) {{
+        endMoveRows();
+    }}
+}}
+
+void {n}::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{{
+    const QModelIndex sourceParent = topLeft.parent();{data_changed}
+    // only a change of the sort role or the filter role can move rows
+    const bool sortChanged = m_sortColumn >= 0
+            && (roles.isEmpty() || roles.contains(m_sortRole));
+    const bool filterChanged = !m_filterText.isEmpty()
+            && (roles.isEmpty() || roles.contains(m_filterRole));
+    if (sortChanged || filterChanged) {{
+        placeRows(sourceParent, topLeft.row(), bottomRight.row());
+    }}
+    if (filterChanged) {{
+        updateAncestors(sourceParent);
+    }}
+    const Mapping* m = cachedMapping(sourceParent);
+    if (!m) {{
+        return;
+    }}
+    int first = m->sourceRows.size();
+    int last = -1;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {{
+        const int proxyRow = m->proxyRows.value(row, -1);
+        if (proxyRow >= 0) {{
+            first = qMin(first, proxyRow);
+            last = qMax(last, proxyRow);
+        }}
+    }}
+    if (last >= 0) {{
+        const QModelIndex proxyParent = mapFromSource(sourceParent);
+        Q_EMIT dataChanged(index(first, topLeft.column(), proxyParent),
+                index(last, bottomRight.column(), proxyParent), roles);
+    }}
+}}
+
+QModelIndex {n}::mapToSource(const QModelIndex &proxyIndex) const
+{{
+    if (!m_source || !proxyIndex.isValid()) {{
+        return QModelIndex();
+    }}{map_to_source}
+}}
+
+QModelIndex {n}::mapFromSource(const QModelIndex &sourceIndex) const
+{{
+    if (!m_source || !sourceIndex.isValid()) {{
+        return QModelIndex();
+    }}
+    const QModelIndex sourceParent = sourceIndex.parent();{check_parent}
+    const int row = mapping(sourceParent)->proxyRows.value(sourceIndex.row(), -1);
+    if (row < 0) {{
+        return QModelIndex();
+    }}
+    return createIndex(row, sourceIndex.column(), {from_source_id});
+}}
+
+int {n}::columnCount(const QModelIndex &parent) const
+{{
+    return m_source ? m_source->columnCount(mapToSource(parent)) : 0;
+}}
+
+QVariant {n}::data(const QModelIndex &index, int role) const
+{{
+    return m_source ? m_source->data(mapToSource(index), role) : QVariant();
+}}
+
+bool {n}::setData(const QModelIndex &index, const QVariant &value, int role)
+{{
+    return m_source && m_source->setData(mapToSource(index), value, role);
+}}
+
+QModelIndex {n}::index(int row, int column, const QModelIndex &parent) const
+{{
+    if (!m_source || row < 0 || column < 0 || column >= columnCount(parent) || {no_children}) {{
+        return QModelIndex();
+    }}
+    const QModelIndex sourceParent = mapToSource(parent);
+    const Mapping* m = mapping(sourceParent);
+    if (row >= m->sourceRows.size()) {{
+        return QModelIndex();
+    }}{index}
+}}
+
+QModelIndex {n}::parent(const QModelIndex &index) const
+{{{parent}
+}}
+
+bool {n}::hasChildren(const QModelIndex &parent) const
+{{
+    if (!m_source) {{
+        return false;
+    }}
+    if (m_filterText.isEmpty()) {{
+        return m_source->hasChildren(mapToSource(parent));
+    }}
+    return rowCount(parent) > 0;
+}}
+
+int {n}::rowCount(const QModelIndex &parent) const
+{{
+    if (!m_source || {no_children}) {{
+        return 0;
+    }}
+    return mapping(mapToSource(parent))->sourceRows.size();
+}}
+
+bool {n}::canFetchMore(const QModelIndex &parent) const
+{{
+    return m_source && m_source->canFetchMore(mapToSource(parent));
+}}
+
+void {n}::fetchMore(const QModelIndex &parent)
+{{
+    if (m_source) {{
+        m_source->fetchMore(mapToSource(parent));
+    }}
+}}
+
+Qt::ItemFlags {n}::flags(const QModelIndex &index) const
+{{
+    return m_source ? m_source->flags(mapToSource(index)) : QAbstractItemModel::flags(index);
+}}
+
+QHash<int, QByteArray> {n}::roleNames() const
+{{
+    return m_source ? m_source->roleNames() : QAbstractItemModel::roleNames();
+}}
+
+QVariant {n}::headerData(int section, Qt::Orientation orientation, int role) const
+{{
+    return m_source ? m_source->headerData(section, orientation, role) : QVariant();
+}}",
+        n = p.name,
+        s = p.source.name,
+        lc = lcname,
+        slc = source_lcname,
+        parent_decl = if tree {
+            "
+    const option_quintptr rust_parent = {
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    };"
         } else {
-            write!(w, ", void (*)({}*)", o.name)?;
-        }
-    }
-    if o.object_type == ObjectType::List {
-        write!(
-            w,
-            ",
-        void (*)(const {}*),
-        void (*)({0}*),
-        void (*)({0}*),
-        void (*)({0}*, quintptr, quintptr),
-        void (*)({0}*),
-        void (*)({0}*),
-        void (*)({0}*, int, int),
-        void (*)({0}*),
-        void (*)({0}*, int, int, int),
-        void (*)({0}*),
-        void (*)({0}*, int, int),
-        void (*)({0}*)",
-            o.name
-        )?;
-    }
-    if o.object_type == ObjectType::Tree {
-        write!(
-            w,
-            ",
-        void (*)(const {0}*, option_quintptr),
-        void (*)({0}*),
-        void (*)({0}*),
-        void (*)({0}*, quintptr, quintptr),
-        void (*)({0}*),
-        void (*)({0}*),
-        void (*)({0}*, option_quintptr, int, int),
-        void (*)({0}*),
-        void (*)({0}*, option_quintptr, int, int, option_quintptr, int),
-        void (*)({0}*),
-        void (*)({0}*, option_quintptr, int, int),
-        void (*)({0}*)",
-            o.name
-        )?;
+            ""
+        },
+        parent_arg = if tree { "rust_parent, " } else { "" },
+        changed = if tree {
+            "
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    {lc}_changed(m_d, m_source->m_d, rust_parent, first, last);"
+                .replace("{lc}", &lcname)
+        } else {
+            String::new()
+        },
+        removed = if tree {
+            "
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    {lc}_removed(m_d, m_source->m_d, rust_parent, first, last);"
+                .replace("{lc}", &lcname)
+        } else {
+            String::new()
+        },
+        changed_parent = if tree {
+            "
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    {lc}_changed(m_d, m_source->m_d, rust_parent, 0, -1);"
+                .replace("{lc}", &lcname)
+        } else {
+            String::new()
+        },
+        data_changed = if tree {
+            "
+    const option_quintptr rust_parent = {
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    };
+    {lc}_changed(m_d, m_source->m_d, rust_parent, topLeft.row(), bottomRight.row());"
+                .replace("{lc}", &lcname)
+        } else {
+            String::new()
+        },
+        drop_children = if tree {
+            "
+        for (int i = first; i <= last; ++i) {
+            dropMapping(m_source->index(m->sourceRows.at(i), 0, sourceParent));
+        }"
+        } else {
+            ""
+        },
+        update_ancestors = if tree {
+            "
+    // a row is shown when it or one of its descendants matches the filter
+    if (m_filterText.isEmpty()) {
+        return;
     }
-    Ok(())
-}
-
-fn changed_f(o: &Object, p_name: &str) -> String {
-    lower_initial(&o.name) + &upper_initial(p_name) + "Changed"
-}
-
-fn constructor_args(w: &mut Vec<u8>, prefix: &str, o: &Object, conf: &Config) -> Result<()> {
-    let lcname = snake_case(&o.name);
-    for (name, p) in &o.properties {
-        if let Type::Object(object) = &p.property_type {
-            write!(w, ", {}m_{}", prefix, name)?;
-            constructor_args(w, &format!("m_{}->", name), object, conf)?;
+    for (QModelIndex p = sourceParent; p.isValid(); p = p.parent()) {
+        updateMapping(p.parent());
+    }"
         } else {
-            write!(w, ",\n        {}", changed_f(o, name))?;
+            "
+    Q_UNUSED(sourceParent);"
+        },
+        drop_mapping_children = if tree {
+            "
+    for (int row: m->sourceRows) {
+        dropMapping(m_source->index(row, 0, sourceParent));
+    }"
+        } else {
+            ""
+        },
+        refilter_children = if tree {
+            "
+        const Mapping* m = cachedMapping(sourceParent);
+        if (!m) {
+            continue;
         }
+        for (int row: m->sourceRows) {
+            const QModelIndex child = m_source->index(row, 0, sourceParent);
+            if (cachedMapping(child)) {
+                parents.append(child);
+            }
+        }"
+        } else {
+            ""
+        },
+        map_to_source = if tree {
+            format!(
+                "
+    const quintptr id = proxyIndex.internalId();
+    return m_source->createIndex({}_row(m_source->m_d, id), proxyIndex.column(), id);",
+                source_lcname
+            )
+        } else {
+            "
+    const int row = mapping(QModelIndex())->sourceRows.at(proxyIndex.row());
+    return m_source->index(row, proxyIndex.column());"
+                .to_string()
+        },
+        check_parent = if tree {
+            "
+    if (sourceParent.isValid() && !mapFromSource(sourceParent).isValid()) {
+        return QModelIndex();
+    }"
+        } else {
+            ""
+        },
+        from_source_id = if tree {
+            "sourceIndex.internalId()"
+        } else {
+            "quintptr(0)"
+        },
+        no_children = if tree {
+            "parent.column() > 0"
+        } else {
+            "parent.isValid()"
+        },
+        index = if tree {
+            format!(
+                "
+    const option_quintptr rust_parent = {{
+        sourceParent.internalId(),
+        sourceParent.isValid()
+    }};
+    const quintptr id = {}_index(m_source->m_d, rust_parent, m->sourceRows.at(row));
+    return createIndex(row, column, id);",
+                source_lcname
+            )
+        } else {
+            "
+    return createIndex(row, column, quintptr(0));"
+                .to_string()
+        },
+        parent = if tree {
+            "
+    if (!m_source || !index.isValid()) {
+        return QModelIndex();
     }
-    if o.object_type == ObjectType::List {
-        writeln!(
-            w,
-            ",
-        [](const {0}* o) {{
-            Q_EMIT o->newDataReady(QModelIndex());
-        }},
-        []({0}* o) {{
-            Q_EMIT o->layoutAboutToBeChanged();
-        }},
-        []({0}* o) {{
-            o->updatePersistentIndexes();
-            Q_EMIT o->layoutChanged();
-        }},
-        []({0}* o, quintptr first, quintptr last) {{
-            o->dataChanged(o->createIndex(first, 0, first),
-                       o->createIndex(last, {1}, last));
-        }},
-        []({0}* o) {{
-            o->beginResetModel();
-        }},
-        []({0}* o) {{
-            o->endResetModel();
-        }},
-        []({0}* o, int first, int last) {{
-            o->beginInsertRows(QModelIndex(), first, last);
-        }},
-        []({0}* o) {{
-            o->endInsertRows();
-        }},
-        []({0}* o, int first, int last, int destination) {{
-            o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
-        }},
-        []({0}* o) {{
-            o->endMoveRows();
-        }},
-        []({0}* o, int first, int last) {{
-            o->beginRemoveRows(QModelIndex(), first, last);
-        }},
-        []({0}* o) {{
-            o->endRemoveRows();
-        }}",
-            o.name,
-            o.column_count() - 1
-        )?;
-    }
-    if o.object_type == ObjectType::Tree {
-        writeln!(
-            w,
-            ",
-        [](const {0}* o, option_quintptr id) {{
-            if (id.some) {{
-                int row = {1}_row(o->m_d, id.value);
-                Q_EMIT o->newDataReady(o->createIndex(row, 0, id.value));
-            }} else {{
-                Q_EMIT o->newDataReady(QModelIndex());
-            }}
-        }},
-        []({0}* o) {{
-            Q_EMIT o->layoutAboutToBeChanged();
-        }},
-        []({0}* o) {{
-            o->updatePersistentIndexes();
-            Q_EMIT o->layoutChanged();
-        }},
-        []({0}* o, quintptr first, quintptr last) {{
-            quintptr frow = {1}_row(o->m_d, first);
-            quintptr lrow = {1}_row(o->m_d, first);
-            o->dataChanged(o->createIndex(frow, 0, first),
-                       o->createIndex(lrow, {2}, last));
-        }},
-        []({0}* o) {{
-            o->beginResetModel();
-        }},
-        []({0}* o) {{
-            o->endResetModel();
-        }},
-        []({0}* o, option_quintptr id, int first, int last) {{
-            if (id.some) {{
-                int row = {1}_row(o->m_d, id.value);
-                o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
-            }} else {{
-                o->beginInsertRows(QModelIndex(), first, last);
-            }}
-        }},
-        []({0}* o) {{
-            o->endInsertRows();
-        }},
-        []({0}* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {{
-            QModelIndex s;
-            if (sourceParent.some) {{
-                int row = {1}_row(o->m_d, sourceParent.value);
-                s = o->createIndex(row, 0, sourceParent.value);
-            }}
-            QModelIndex d;
-            if (destinationParent.some) {{
-                int row = {1}_row(o->m_d, destinationParent.value);
-                d = o->createIndex(row, 0, destinationParent.value);
-            }}
-            o->beginMoveRows(s, first, last, d, destination);
-        }},
-        []({0}* o) {{
-            o->endMoveRows();
-        }},
-        []({0}* o, option_quintptr id, int first, int last) {{
-            if (id.some) {{
-                int row = {1}_row(o->m_d, id.value);
-                o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
-            }} else {{
-                o->beginRemoveRows(QModelIndex(), first, last);
-            }}
-        }},
-        []({0}* o) {{
-            o->endRemoveRows();
-        }}",
-            o.name,
-            lcname,
-            o.column_count() - 1
-        )?;
-    }
+    return mapFromSource(mapToSource(index).parent());"
+        } else {
+            "
+    Q_UNUSED(index);
+    return QModelIndex();"
+        },
+    )?;
     Ok(())
 }
 
@@ -1404,13 +3211,19 @@ pub fn write_header(conf: &Config) -> Result<()> {
 ",
         guard
     )?;
+    if conf.objects.values().any(|o| o.max_change_rate > 0) {
+        writeln!(h, "#include <QtCore/QElapsedTimer>\n")?;
+    }
 
-    for name in conf.objects.keys() {
+    for name in conf.objects.keys().chain(conf.proxies.keys()) {
         writeln!(h, "class {};", name)?;
     }
     for object in conf.objects.values() {
         write_header_object(&mut h, object, conf)?;
     }
+    for proxy in conf.proxies.values() {
+        write_header_proxy(&mut h, proxy)?;
+    }
     writeln!(h, "#endif // {}", guard)?;
 
     write_if_different(h_file, &h)?;
@@ -1422,13 +3235,23 @@ pub fn write_cpp(conf: &Config) -> Result<()> {
     let mut h_file = conf.config_file.parent().unwrap().join(&conf.cpp_file);
     h_file.set_extension("h");
     let file_name = h_file.file_name().unwrap().to_string_lossy();
+    let mut includes = String::new();
+    if conf.has_list_or_tree() {
+        includes.push_str("#include <algorithm>\n#include <iterator>\n");
+    }
+    if conf.objects.values().any(|o| o.max_change_rate > 0) {
+        includes.push_str("#include <QtCore/QTimer>\n");
+    }
+    if conf.objects.values().any(|o| has_arc(o)) {
+        includes.push_str("#include <QtCore/QMutex>\n");
+    }
     writeln!(
         w,
         "/* generated by rust_qt_binding_generator */
 #include \"{}\"
-
+{}
 namespace {{",
-        file_name
+        file_name, includes
     )?;
     for option in conf.optional_types() {
         if option != "QString" && option != "QByteArray" {
@@ -1461,6 +3284,14 @@ namespace {{",
     }}"
         )?;
     }
+    if conf.has_utf16_string() {
+        writeln!(
+            w,
+            "    void set_qstring_utf16(QString* val, const char* utf16, int nchars) {{
+        *val = QString(reinterpret_cast<const QChar*>(utf16), nchars);
+    }}"
+        )?;
+    }
     if conf.types().contains("QByteArray") {
         writeln!(
             w,
@@ -1476,10 +3307,53 @@ namespace {{",
     }}"
         )?;
     }
+    for t in &["QString", "QByteArray"] {
+        let lc = t.to_lowercase();
+        let in_model = conf.objects.values().any(|o| {
+            o.object_type != ObjectType::Object
+                && o.item_properties.values().any(|ip| ip.type_name() == *t && !ip.rust_by_arc)
+        });
+        if in_model {
+            writeln!(
+                w,
+                "
+    typedef void (*{0}_set_at)({1}* val, int i, const char* bytes, int nbytes);
+    void set_{0}_at({1}* val, int i, const char* bytes, int nbytes) {{
+        val[i] = {2}(bytes, nbytes);
+    }}",
+                lc,
+                t,
+                if *t == "QString" {
+                    "QString::fromUtf8"
+                } else {
+                    "QByteArray"
+                }
+            )?;
+        }
+    }
+    let utf16_in_model = conf.objects.values().any(|o| {
+        o.object_type != ObjectType::Object
+            && o.item_properties.values().any(|ip| ip.encoding == Encoding::Utf16)
+    });
+    if utf16_in_model {
+        writeln!(
+            w,
+            "    void set_qstring_utf16_at(QString* val, int i, const char* utf16, int nchars) {{
+        val[i] = QString(reinterpret_cast<const QChar*>(utf16), nchars);
+    }}"
+        )?;
+    }
+    if conf.objects.values().any(|o| has_arc(o)) {
+        write_cpp_arc_registry(&mut w)?;
+    }
     if conf.has_list_or_tree() {
         writeln!(
             w,
             "
+    struct role_name_t {{
+        const char* name;
+        int role;
+    }};
     struct qmodelindex_t {{
         int row;
         quintptr id;
@@ -1491,11 +3365,20 @@ namespace {{",
     }
     for (name, o) in &conf.objects {
         for (p_name, p) in &o.properties {
-            if p.is_object() {
+            if p.is_object() || o.coalesce_changes {
                 continue;
             }
             writeln!(w, "    inline void {}({}* o)", changed_f(o, p_name), name)?;
-            writeln!(w, "    {{\n        Q_EMIT o->{}Changed();\n    }}", p_name)?;
+            if p.cached {
+                // the cache is only touched in the thread of the object
+                writeln!(
+                    w,
+                    "    {{\n        QMetaObject::invokeMethod(o, \"invalidate{}\");\n    }}",
+                    upper_initial(p_name)
+                )?;
+            } else {
+                writeln!(w, "    {{\n        Q_EMIT o->{}Changed();\n    }}", p_name)?;
+            }
         }
     }
     writeln!(w, "}}")?;
@@ -1509,15 +3392,24 @@ namespace {{",
         writeln!(w, "}};\n")?;
     }
 
+    if !conf.proxies.is_empty() {
+        writeln!(w, "extern \"C\" {{")?;
+        for p in conf.proxies.values() {
+            write_proxy_c_decl(&mut w, p)?;
+        }
+        writeln!(w, "}};")?;
+    }
+
     for o in conf.objects.values() {
         write_cpp_object(&mut w, o, conf)?;
     }
+    for p in conf.proxies.values() {
+        write_cpp_proxy(&mut w, p)?;
+    }
 
-    writeln!(w, "extern \"C\" {{
-    void qmetaobject__invokeMethod__0(QObject *obj, const char *member) {{
-        QMetaObject::invokeMethod(obj, member);
-    }}
-}}")?;
+    for o in conf.objects.values() {
+        write_cpp_thread_calls(&mut w, o)?;
+    }
 
 
     let file = conf.config_file.parent().unwrap().join(&conf.cpp_file);
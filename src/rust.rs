@@ -3,30 +3,33 @@
 use configuration::*;
 use configuration_private::*;
 use std::io::{Result, Write};
-use util::{snake_case, write_if_different};
+use util::{snake_case, upper_initial, write_if_different};
 
 fn rust_type(p: &Property) -> String {
     if p.optional {
-        return format!("Option<{}>", p.property_type.rust_type());
+        return format!("Option<{}>", p.rust_type());
     }
-    p.property_type.rust_type().to_string()
+    p.rust_type().to_string()
 }
 
 fn rust_type_(p: &ItemProperty) -> String {
     if p.optional {
-        return format!("Option<{}>", p.item_property_type.rust_type());
+        return format!("Option<{}>", p.rust_type());
     }
-    p.item_property_type.rust_type().to_string()
+    p.rust_type().to_string()
 }
 
 fn rust_return_type(p: &Property) -> String {
-    let mut type_: String = p.property_type.rust_type().to_string();
+    let mut type_: String = p.rust_type().to_string();
     if type_ == "String" {
         type_ = "str".to_string();
     }
     if type_ == "Vec<u8>" {
         type_ = "[u8]".to_string();
     }
+    if type_ == "Vec<u16>" {
+        type_ = "[u16]".to_string();
+    }
     if p.property_type.is_complex() {
         type_ = "&".to_string() + &type_;
     }
@@ -37,13 +40,19 @@ fn rust_return_type(p: &Property) -> String {
 }
 
 fn rust_return_type_(p: &ItemProperty) -> String {
-    let mut type_: String = p.item_property_type.rust_type().to_string();
+    if p.rust_by_arc {
+        return "Arc<[u8]>".to_string();
+    }
+    let mut type_: String = p.rust_type().to_string();
     if type_ == "String" && !p.rust_by_value {
         type_ = "str".to_string();
     }
     if type_ == "Vec<u8>" && !p.rust_by_value {
         type_ = "[u8]".to_string();
     }
+    if type_ == "Vec<u16>" && !p.rust_by_value {
+        type_ = "[u16]".to_string();
+    }
     if p.item_property_type.is_complex() && !p.rust_by_value {
         type_ = "&".to_string() + &type_;
     }
@@ -64,7 +73,23 @@ fn rust_type_init(p: &Property) -> &str {
     if p.optional {
         return "None";
     }
-    p.property_type.rust_type_init()
+    p.rust_type_init()
+}
+
+/// Rust code that reads the UTF-16 string `v` of length `len` that comes
+/// from a QString into the variable `s`.
+fn string_from_utf16(encoding: Encoding, s: &str, v: &str, len: &str) -> String {
+    if encoding == Encoding::Utf16 {
+        format!(
+            "let {} = slice::from_raw_parts({}, to_usize({})).to_vec();",
+            s, v, len
+        )
+    } else {
+        format!(
+            "let mut {0} = String::new();\n    set_string_from_utf16(&mut {0}, {1}, {2});",
+            s, v, len
+        )
+    }
 }
 
 fn r_constructor_args_decl(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Config) -> Result<()> {
@@ -73,7 +98,7 @@ fn r_constructor_args_decl(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Confi
         if let Type::Object(object) = &p.property_type {
             writeln!(r, ",")?;
             r_constructor_args_decl(r, p_name, object, conf)?;
-        } else {
+        } else if !o.coalesce_changes {
             write!(
                 r,
                 ",\n    {}_{}_changed: extern fn(*mut {}QObject)",
@@ -83,6 +108,14 @@ fn r_constructor_args_decl(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Confi
             )?;
         }
     }
+    if o.coalesce_changes {
+        write!(
+            r,
+            ",\n    {}_changes_pending: extern fn(*mut {}QObject)",
+            snake_case(name),
+            o.name
+        )?;
+    }
     if o.object_type == ObjectType::List {
         write!(
             r,
@@ -115,6 +148,7 @@ fn r_constructor_args_decl(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Confi
     {2}_layout_about_to_be_changed: extern fn(*mut {0}QObject),
     {2}_layout_changed: extern fn(*mut {0}QObject),
     {2}_data_changed: extern fn(*mut {0}QObject, usize, usize),
+    {2}_properties_changed: extern fn(*mut {0}QObject, usize, usize, u64),
     {2}_begin_reset_model: extern fn(*mut {0}QObject),
     {2}_end_reset_model: extern fn(*mut {0}QObject),
     {2}_begin_insert_rows: extern fn(*mut {0}QObject,{1} usize, usize),
@@ -129,6 +163,22 @@ fn r_constructor_args_decl(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Confi
             dest_decl
         )?;
     }
+    if o.object_type == ObjectType::List {
+        write!(
+            r,
+            ",\n    {}_layout_changed_with_permutation: extern fn(*mut {}QObject, *const usize, usize)",
+            snake_case(name),
+            o.name
+        )?;
+    }
+    if o.transactions {
+        write!(
+            r,
+            ",\n    {}_transactions_pending: extern fn(*mut {}QObject)",
+            snake_case(name),
+            o.name
+        )?;
+    }
     Ok(())
 }
 
@@ -138,19 +188,28 @@ fn r_constructor_args(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Config) ->
             r_constructor_args(r, name, object, conf)?;
         }
     }
+    let mut emit = Vec::new();
     writeln!(
-        r,
+        emit,
         "    let {}_emit = {}Emitter {{
         qobject: Arc::new(AtomicPtr::new({0})),",
         snake_case(name),
         o.name
     )?;
+    if o.coalesce_changes {
+        writeln!(
+            emit,
+            "        changes: Arc::new(::std::sync::atomic::AtomicU64::new(0)),
+        changes_pending: {}_changes_pending,",
+            snake_case(name)
+        )?;
+    }
     for (p_name, p) in &o.properties {
-        if p.is_object() {
+        if p.is_object() || o.coalesce_changes {
             continue;
         }
         writeln!(
-            r,
+            emit,
             "        {}_changed: {}_{0}_changed,",
             snake_case(p_name),
             snake_case(name)
@@ -158,11 +217,30 @@ fn r_constructor_args(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Config) ->
     }
     if o.object_type != ObjectType::Object {
         writeln!(
-            r,
+            emit,
             "        new_data_ready: {}_new_data_ready,",
             snake_case(name)
         )?;
     }
+    if o.has_commands() {
+        writeln!(
+            emit,
+            "        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),"
+        )?;
+    }
+    if o.transactions {
+        writeln!(
+            emit,
+            "        transactions: Arc::new({}Transactions {{
+            queue: ::std::sync::Mutex::new(Vec::new()),
+            model: model.clone(),
+            pending: {}_transactions_pending,
+        }}),",
+            o.name,
+            snake_case(name)
+        )?;
+    }
+    writeln!(emit, "    }};")?;
     let mut model = String::new();
     if o.object_type != ObjectType::Object {
         let type_ = if o.object_type == ObjectType::List {
@@ -171,14 +249,15 @@ fn r_constructor_args(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Config) ->
             "Tree"
         };
         model.push_str(", model");
+        let mut m = Vec::new();
         writeln!(
-            r,
-            "    }};
-    let model = {}{} {{
+            m,
+            "    let model = {}{} {{
         qobject: {},
         layout_about_to_be_changed: {2}_layout_about_to_be_changed,
         layout_changed: {2}_layout_changed,
         data_changed: {2}_data_changed,
+        properties_changed: {2}_properties_changed,
         begin_reset_model: {2}_begin_reset_model,
         end_reset_model: {2}_end_reset_model,
         begin_insert_rows: {2}_begin_insert_rows,
@@ -191,10 +270,28 @@ fn r_constructor_args(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Config) ->
             type_,
             snake_case(name)
         )?;
+        if o.object_type == ObjectType::List {
+            writeln!(
+                m,
+                "        layout_changed_with_permutation: {}_layout_changed_with_permutation,",
+                snake_case(name)
+            )?;
+        }
+        writeln!(m, "    }};")?;
+        // the transactions of the emitter need a copy of the model
+        if o.transactions {
+            r.extend(m);
+            r.extend(emit);
+        } else {
+            r.extend(emit);
+            r.extend(m);
+        }
+    } else {
+        r.extend(emit);
     }
     write!(
         r,
-        "    }};\n    let d_{} = {}::new({0}_emit{}",
+        "    let d_{} = {}::new({0}_emit{}",
         snake_case(name),
         o.name,
         model
@@ -207,6 +304,239 @@ fn r_constructor_args(r: &mut Vec<u8>, name: &str, o: &Object, conf: &Config) ->
     writeln!(r, ");")
 }
 
+/// Declare the C++ functions that emit the `Finished` signals of the async
+/// functions of an object.
+fn write_async_finished_decl(r: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    let functions: Vec<_> = o.functions.iter().filter(|(_, f)| f.asynchronous).collect();
+    if functions.is_empty() {
+        return Ok(());
+    }
+    writeln!(r, "\nextern \"C\" {{")?;
+    for (name, f) in functions {
+        let result = if f.return_type.is_complex() {
+            ", result: *const c_char, len: c_int".to_string()
+        } else if f.return_type == SimpleType::Void {
+            String::new()
+        } else {
+            format!(", result: {}", f.return_type.rust_type())
+        };
+        writeln!(
+            r,
+            "    fn {}_{}_finished(o: *mut ::std::ffi::c_void, request: u64{});",
+            lcname,
+            snake_case(name),
+            result
+        )?;
+    }
+    writeln!(r, "}}")?;
+    Ok(())
+}
+
+/// Write the emitter method that passes the result of an async function to
+/// the QObject.
+fn write_async_finished(r: &mut Vec<u8>, name: &str, f: &Function, lcname: &str) -> Result<()> {
+    let lc = snake_case(name);
+    let (arg, pass) = if f.return_type.is_complex() {
+        (
+            format!(", result: {}", f.return_type.rust_type()),
+            ", result.as_ptr() as *const c_char, to_c_int(result.len())",
+        )
+    } else if f.return_type == SimpleType::Void {
+        (String::new(), "")
+    } else {
+        (format!(", result: {}", f.return_type.rust_type()), ", result")
+    };
+    writeln!(
+        r,
+        "    fn {1}_finished(&mut self, request: u64{2}) {{
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {{
+            unsafe {{ {0}_{1}_finished(ptr as *mut ::std::ffi::c_void, request{3}) }};
+        }}
+    }}",
+        lcname, lc, arg, pass
+    )?;
+    Ok(())
+}
+
+/// The Rust type in which an argument is kept until the function is called
+/// on the thread of the QObject.
+fn command_type(a: &Argument) -> &str {
+    if a.borrow {
+        "Vec<u16>"
+    } else {
+        a.argument_type.rust_type()
+    }
+}
+
+/// Declare the calls of functions that other threads can make and the C++
+/// function that wakes up the QObject to make them.
+fn write_rust_commands_decl(r: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    writeln!(
+        r,
+        "
+extern \"C\" {{
+    fn {}_commands_pending(o: *mut ::std::ffi::c_void);
+}}
+
+/// A call of a function of {} that was made on another thread.
+enum {1}Command {{",
+        lcname, o.name
+    )?;
+    for (name, f) in o.functions.iter().filter(|(_, f)| !f.asynchronous) {
+        let mut fields: Vec<String> = f.arguments.iter().map(|a| command_type(a).into()).collect();
+        if f.return_type != SimpleType::Void {
+            fields.push(format!(
+                "::std::sync::mpsc::SyncSender<{}>",
+                f.return_type.rust_type()
+            ));
+        }
+        if fields.is_empty() {
+            writeln!(r, "    {},", upper_initial(name))?;
+        } else {
+            writeln!(r, "    {}({}),", upper_initial(name), fields.join(", "))?;
+        }
+    }
+    writeln!(r, "}}")?;
+    Ok(())
+}
+
+/// Write the emitter methods with which any thread can call the functions
+/// of the object on the thread of the QObject.
+fn write_rust_invoke(r: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    for (name, f) in o.functions.iter().filter(|(_, f)| !f.asynchronous) {
+        let lc = snake_case(name);
+        let mut args = String::new();
+        let mut fields = Vec::new();
+        for a in &f.arguments {
+            args.push_str(&format!(", {}: {}", a.name, command_type(a)));
+            fields.push(a.name.clone());
+        }
+        if f.return_type == SimpleType::Void {
+            writeln!(
+                r,
+                "    /// Call `{}` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_{0}(&mut self{}) {{",
+                lc, args
+            )?;
+        } else {
+            fields.push("sender".into());
+            writeln!(
+                r,
+                "    /// Call `{}` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_{0}(&mut self{}) -> ::std::sync::mpsc::Receiver<{}> {{
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);",
+                lc,
+                args,
+                f.return_type.rust_type()
+            )?;
+        }
+        if fields.is_empty() {
+            writeln!(r, "        self.command({}Command::{});", o.name, upper_initial(name))?;
+        } else {
+            writeln!(
+                r,
+                "        self.command({}Command::{}({}));",
+                o.name,
+                upper_initial(name),
+                fields.join(", ")
+            )?;
+        }
+        if f.return_type != SimpleType::Void {
+            writeln!(r, "        receiver")?;
+        }
+        writeln!(r, "    }}")?;
+    }
+    writeln!(
+        r,
+        "    fn command(&mut self, command: {}Command) {{
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {{
+            return;
+        }}
+        commands.push(command);
+        if commands.len() == 1 {{
+            unsafe {{ {}_commands_pending(ptr as *mut ::std::ffi::c_void) }};
+        }}
+    }}",
+        o.name, lcname
+    )?;
+    Ok(())
+}
+
+/// Write the function that makes the calls that other threads queued for
+/// the object.
+fn write_rust_apply_commands(r: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    writeln!(
+        r,
+        "
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_apply_commands(ptr: *mut {}) {{
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {{
+        match command {{",
+        lcname, o.name
+    )?;
+    for (name, f) in o.functions.iter().filter(|(_, f)| !f.asynchronous) {
+        let mut fields: Vec<String> = f.arguments.iter().map(|a| a.name.clone()).collect();
+        let args: Vec<String> = f
+            .arguments
+            .iter()
+            .map(|a| {
+                if a.borrow || a.argument_type == SimpleType::QByteArray {
+                    format!("&{}", a.name)
+                } else {
+                    a.name.clone()
+                }
+            })
+            .collect();
+        let call = format!("o.{}({})", snake_case(name), args.join(", "));
+        if f.return_type != SimpleType::Void {
+            fields.push("sender".into());
+        }
+        let pattern = if fields.is_empty() {
+            format!("{}Command::{}", o.name, upper_initial(name))
+        } else {
+            format!("{}Command::{}({})", o.name, upper_initial(name), fields.join(", "))
+        };
+        if f.return_type == SimpleType::Void {
+            writeln!(r, "            {} => {},", pattern, call)?;
+        } else {
+            writeln!(
+                r,
+                "            {} => {{
+                let _ = sender.send({});
+            }}",
+                pattern, call
+            )?;
+        }
+    }
+    writeln!(
+        r,
+        "        }}
+    }}
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {{
+        *queue = commands;
+    }}
+}}"
+    )?;
+    Ok(())
+}
+
 fn write_function(
     r: &mut Vec<u8>,
     (name, f): (&String, &Function),
@@ -221,7 +551,7 @@ fn write_function(
 pub unsafe extern \"C\" fn {}_{}(ptr: *{} {}",
         lcname,
         lc,
-        if f.mutable { "mut" } else { "const" },
+        if f.mutable || f.asynchronous { "mut" } else { "const" },
         o.name
     )?;
     // write all the input arguments, for QString and QByteArray, write
@@ -239,7 +569,9 @@ pub unsafe extern \"C\" fn {}_{}(ptr: *{} {}",
     // If the return type is QString or QByteArray, append a pointer to the
     // variable that will be set to the argument list. Also add a setter
     // function.
-    if f.return_type.is_complex() {
+    if f.asynchronous {
+        writeln!(r, ") -> u64 {{")?;
+    } else if f.return_type.is_complex() {
         writeln!(
             r,
             ", d: *mut {}, set: extern fn(*mut {0}, str: *const c_char, len: c_int)) {{",
@@ -251,7 +583,13 @@ pub unsafe extern \"C\" fn {}_{}(ptr: *{} {}",
         writeln!(r, ") -> {} {{", f.return_type.rust_type())?;
     }
     for a in &f.arguments {
-        if a.argument_type.name() == "QString" {
+        if a.borrow {
+            writeln!(
+                r,
+                "    let {} = slice::from_raw_parts({0}_str, to_usize({0}_len));",
+                a.name
+            )?;
+        } else if a.argument_type.name() == "QString" {
             writeln!(
                 r,
                 "    let mut {} = String::new();
@@ -266,12 +604,15 @@ pub unsafe extern \"C\" fn {}_{}(ptr: *{} {}",
             )?;
         }
     }
-    if f.mutable {
+    if f.mutable || f.asynchronous {
         writeln!(r, "    let o = &mut *ptr;")?;
     } else {
         writeln!(r, "    let o = &*ptr;")?;
     }
-    if f.return_type.is_complex() {
+    if f.asynchronous {
+        writeln!(r, "    let mut emit = o.emit().clone();")?;
+        write!(r, "    let job = o.{}(", lc)?;
+    } else if f.return_type.is_complex() {
         write!(r, "    let r = o.{}(", lc)?;
     } else {
         write!(r, "    o.{}(", lc)?;
@@ -283,7 +624,29 @@ pub unsafe extern \"C\" fn {}_{}(ptr: *{} {}",
         write!(r, "{}", a.name)?;
     }
     write!(r, ")")?;
-    if f.return_type.is_complex() {
+    if f.asynchronous {
+        // a panic in the job still finishes the request, with a default result
+        let (result, arg) = if f.return_type == SimpleType::Void {
+            ("let _ = ::std::panic::catch_unwind(::std::panic::AssertUnwindSafe(job));", "")
+        } else {
+            (
+                "let r = ::std::panic::catch_unwind(::std::panic::AssertUnwindSafe(job))
+            .unwrap_or_default();",
+                ", r",
+            )
+        };
+        writeln!(
+            r,
+            ";
+    let request = next_request();
+    ThreadPool::global().spawn(move || {{
+        {}
+        emit.{}_finished(request{});
+    }});
+    request",
+            result, lc, arg
+        )?;
+    } else if f.return_type.is_complex() {
         writeln!(r, ";")?;
         writeln!(
             r,
@@ -296,8 +659,131 @@ pub unsafe extern \"C\" fn {}_{}(ptr: *{} {}",
     writeln!(r, "}}")
 }
 
+/// Write the function that fills a block of rows for C++ in one call.
+///
+/// Each item property has a column in the block. Only the columns that are
+/// selected in `mask` are written; bit `i` corresponds to item property `i`.
+/// Properties that are shared as `Arc<[u8]>` are not part of the block.
+fn write_data_range(r: &mut Vec<u8>, o: &Object, lcname: &str) -> Result<()> {
+    let tree = o.object_type == ObjectType::Tree;
+    writeln!(r, "\n#[repr(C)]\npub struct {}DataRange {{", o.name)?;
+    if tree {
+        writeln!(r, "    id: *mut usize,")?;
+    }
+    for (name, ip) in o.item_properties.iter().filter(|(_, ip)| !ip.rust_by_arc) {
+        let t = if ip.is_complex() {
+            ip.type_name().to_string()
+        } else {
+            rust_c_type(ip)
+        };
+        writeln!(r, "    {}: *mut {},", snake_case(name), t)?;
+    }
+    writeln!(
+        r,
+        "}}
+
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_data_range(
+    ptr: *const {},{}
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut {1}DataRange,",
+        lcname,
+        o.name,
+        if tree { "\n    parent: COption<usize>," } else { "" }
+    )?;
+    for t in &["QString", "QByteArray"] {
+        if o.item_properties.values().any(|ip| ip.type_name() == *t && !ip.rust_by_arc) {
+            writeln!(
+                r,
+                "    set_{}: extern fn(*mut {}, c_int, *const c_char, c_int),",
+                t.to_lowercase(),
+                t
+            )?;
+        }
+    }
+    if o.item_properties.values().any(|ip| ip.encoding == Encoding::Utf16) {
+        writeln!(
+            r,
+            "    set_qstring_utf16: extern fn(*mut QString, c_int, *const c_char, c_int),"
+        )?;
+    }
+    writeln!(
+        r,
+        ") {{
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;"
+    )?;
+    if tree {
+        writeln!(
+            r,
+            "    let parent = parent.into();
+    let ids: Vec<usize> = (first..first + len).map(|row| o.index(parent, row)).collect();
+    if !range.id.is_null() {{
+        slice::from_raw_parts_mut(range.id, len).copy_from_slice(&ids);
+    }}
+    let rows = ids.iter().cloned();"
+        )?;
+    } else {
+        writeln!(r, "    let rows = first..first + len;")?;
+    }
+    for (i, (name, ip)) in o.item_properties.iter().enumerate() {
+        if ip.rust_by_arc {
+            continue;
+        }
+        let lc = snake_case(name);
+        writeln!(r, "    if mask & (1 << {}) != 0 {{", i)?;
+        if ip.is_complex() {
+            let set = if ip.encoding == Encoding::Utf16 {
+                "set_qstring_utf16".to_string()
+            } else {
+                format!("set_{}", ip.type_name().to_lowercase())
+            };
+            writeln!(r, "        for (i, index) in rows.clone().enumerate() {{")?;
+            if ip.optional {
+                writeln!(
+                    r,
+                    "            if let Some(data) = o.{}(index) {{
+                let s: *const c_char = data.as_ptr() as *const c_char;
+                {}(range.{0}, to_c_int(i), s, to_c_int(data.len()));
+            }}",
+                    lc, set
+                )?;
+            } else {
+                writeln!(
+                    r,
+                    "            let data = o.{}(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            {}(range.{0}, to_c_int(i), s, to_c_int(data.len()));",
+                    lc, set
+                )?;
+            }
+            writeln!(r, "        }}")?;
+        } else {
+            writeln!(
+                r,
+                "        let column = slice::from_raw_parts_mut(range.{0}, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {{
+            *v = o.{0}(index){1};
+        }}",
+                lc,
+                if ip.optional { ".into()" } else { "" }
+            )?;
+        }
+        writeln!(r, "    }}")?;
+    }
+    writeln!(r, "}}")
+}
+
 fn write_rust_interface_object(r: &mut Vec<u8>, o: &Object, conf: &Config) -> Result<()> {
     let lcname = snake_case(&o.name);
+    write_async_finished_decl(r, o, &lcname)?;
+    if o.has_commands() {
+        write_rust_commands_decl(r, o, &lcname)?;
+    }
     writeln!(
         r,
         "
@@ -307,8 +793,17 @@ pub struct {0}Emitter {{
     qobject: Arc<AtomicPtr<{0}QObject>>,",
         o.name
     )?;
+    if o.coalesce_changes {
+        writeln!(
+            r,
+            "    /// One bit per property that changed since the last notification.
+    changes: Arc<::std::sync::atomic::AtomicU64>,
+    changes_pending: extern fn(*mut {}QObject),",
+            o.name
+        )?;
+    }
     for (name, p) in &o.properties {
-        if p.is_object() {
+        if p.is_object() || o.coalesce_changes {
             continue;
         }
         writeln!(
@@ -328,6 +823,16 @@ pub struct {0}Emitter {{
             o.name
         )?;
     }
+    if o.has_commands() {
+        writeln!(
+            r,
+            "    commands: Arc<::std::sync::Mutex<Vec<{}Command>>>,",
+            o.name
+        )?;
+    }
+    if o.transactions {
+        writeln!(r, "    transactions: Arc<{}Transactions>,", o.name)?;
+    }
     writeln!(
         r,
         "}}
@@ -346,8 +851,15 @@ impl {0}Emitter {{
             qobject: self.qobject.clone(),",
         o.name
     )?;
+    if o.coalesce_changes {
+        writeln!(
+            r,
+            "            changes: self.changes.clone(),
+            changes_pending: self.changes_pending,"
+        )?;
+    }
     for (name, p) in &o.properties {
-        if p.is_object() {
+        if p.is_object() || o.coalesce_changes {
             continue;
         }
         writeln!(
@@ -359,50 +871,62 @@ impl {0}Emitter {{
     if o.object_type != ObjectType::Object {
         writeln!(r, "            new_data_ready: self.new_data_ready,")?;
     }
+    if o.has_commands() {
+        writeln!(r, "            commands: self.commands.clone(),")?;
+    }
+    if o.transactions {
+        writeln!(r, "            transactions: self.transactions.clone(),")?;
+    }
     writeln!(
         r,
         "        }}
     }}
     fn clear(&self) {{
         let n: *const {0}QObject = null();
-        self.qobject.store(n as *mut {0}QObject, Ordering::SeqCst);
+        self.qobject.store(n as *mut {0}QObject, Ordering::SeqCst);{1}
     }}",
-        o.name
-    )?;
-
-    for (name, p) in &o.properties {
-        if p.is_object() {
-            continue;
+        o.name,
+        if o.has_commands() {
+            "\n        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();"
+        } else {
+            ""
         }
+    )?;
+    if o.thread_pool {
         writeln!(
             r,
-            "    pub fn {}_changed(&mut self) {{
-        let ptr = self.qobject.load(Ordering::SeqCst);
-        if !ptr.is_null() {{
-            (self.{0}_changed)(ptr);
-        }}
-    }}",
-            snake_case(name)
+            "    /// The pool of threads that is shared by all objects.
+    pub fn thread_pool(&self) -> &'static ThreadPool {{
+        ThreadPool::global()
+    }}"
         )?;
     }
 
-    for (name, f) in &o.functions {
-        // Generate 'invoke_*' methods to call functions from the
-        // event loop using QMetaObject::invokeMethod.  Only
-        // implemented for functions with no arguments and void return.
-        if f.arguments.is_empty() && f.return_type == SimpleType::Void {
+    let properties = o.properties.iter().filter(|(_, p)| !p.is_object());
+    for (bit, (name, _)) in properties.enumerate() {
+        if o.coalesce_changes {
+            // only the first change after a notification wakes the QObject
+            writeln!(
+                r,
+                "    pub fn {}_changed(&mut self) {{
+        if self.changes.fetch_or(1 << {}, Ordering::SeqCst) == 0 {{
+            let ptr = self.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {{
+                (self.changes_pending)(ptr);
+            }}
+        }}
+    }}",
+                snake_case(name),
+                bit
+            )?;
+        } else {
             writeln!(
                 r,
-                "    /// Invoke the `{0}` function on the QObject's event loop.
-    pub fn invoke_{0}(&mut self) {{
+                "    pub fn {}_changed(&mut self) {{
         let ptr = self.qobject.load(Ordering::SeqCst);
         if !ptr.is_null() {{
-            unsafe {{
-                qmetaobject__invokeMethod__0(
-                    ptr as *const std::ffi::c_void,
-                    std::ffi::CStr::from_bytes_with_nul_unchecked(b\"{0}\\0\").as_ptr()
-                );
-            }}
+            (self.{0}_changed)(ptr);
         }}
     }}",
                 snake_case(name)
@@ -410,6 +934,14 @@ impl {0}Emitter {{
         }
     }
 
+    for (name, f) in o.functions.iter().filter(|(_, f)| f.asynchronous) {
+        write_async_finished(r, name, f, &lcname)?;
+    }
+
+    if o.has_commands() {
+        write_rust_invoke(r, o, &lcname)?;
+    }
+
     if o.object_type == ObjectType::List {
         writeln!(
             r,
@@ -431,6 +963,37 @@ impl {0}Emitter {{
     }}"
         )?;
     }
+    if o.transactions {
+        writeln!(
+            r,
+            "    /// Create a handle with which any thread can change the model.
+    pub fn handle(&mut self) -> {}Handle {{
+        {0}Handle {{
+            qobject: self.qobject.clone(),
+            transactions: self.transactions.clone(),
+        }}
+    }}",
+            o.name
+        )?;
+    }
+    if o.stream {
+        let root = if o.object_type == ObjectType::Tree {
+            "None"
+        } else {
+            ""
+        };
+        writeln!(
+            r,
+            "    /// Create a stream through which a worker thread can send rows.
+    /// Pushing a row into an empty stream calls `new_data_ready()`, so
+    /// the model can take the rows in `fetch_more()`.
+    pub fn row_stream<T>(&mut self, capacity: usize) -> (RowProducer<T>, RowConsumer<T>) {{
+        let mut emit = self.clone();
+        row_stream(capacity, Box::new(move || emit.new_data_ready({})))
+    }}",
+            root
+        )?;
+    }
 
     let mut model_struct = String::new();
     if o.object_type != ObjectType::Object {
@@ -454,16 +1017,150 @@ impl {0}Emitter {{
             dest_c_decl = " dest: COption<usize>,";
             dest = " dest.into(),";
         }
+        let mut permutation_field = String::new();
+        let mut permutation = String::new();
+        if o.object_type == ObjectType::List {
+            permutation_field = format!(
+                "
+    layout_changed_with_permutation: extern fn(*mut {}QObject, *const usize, usize),",
+                o.name
+            );
+            permutation = "
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }"
+                .to_string();
+        }
+        if o.stream {
+            permutation += &format!(
+                "
+    /// Insert the rows that are ready in `stream` at `row`, announced
+    /// with one begin_insert_rows()/end_insert_rows() pair. `insert` is
+    /// called for each row, in order, and should add it to the model.
+    pub fn insert_rows_from<T, F: FnMut(T)>(&mut self,{} row: usize, stream: &mut RowConsumer<T>, insert: F) -> usize {{
+        let n = stream.ready();
+        if n > 0 {{
+            self.begin_insert_rows({}row, row + n - 1);
+            stream.take(n, insert);
+            self.end_insert_rows();
+        }}
+        n
+    }}",
+                index_decl,
+                if o.object_type == ObjectType::Tree {
+                    "index, "
+                } else {
+                    ""
+                }
+            );
+        }
+        if o.object_type == ObjectType::List {
+            permutation += "
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }";
+        } else {
+            permutation += "
+    /// Replace `rows`, the children of `index`, with `new` with as few
+    /// removes, moves and inserts as possible. Rows with the same `key`
+    /// are kept and, if they differ, updated and signalled with
+    /// data_changed() for the items given by `id`. `row()` has to agree
+    /// with `rows` while the signals are sent.
+    pub fn sync_from<T, K, F, I>(
+        &mut self,
+        index: Option<usize>,
+        rows: &mut Vec<T>,
+        new: Vec<T>,
+        key: F,
+        id: I,
+    ) where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+        I: Fn(&T) -> usize,
+    {
+        sync_rows(rows, new, key, |signal, current| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(index, first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(index, from, from, index, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(index, first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            // persistent indexes are found again by id
+            SyncSignal::EndLayout(_old_rows) => self.layout_changed(),
+            SyncSignal::Changed(first, last) => {
+                self.data_changed(id(&current[first]), id(&current[last]))
+            }
+        });
+    }";
+        }
+        let mut properties_enum = String::new();
+        let mut properties_changed = String::new();
+        if !o.item_properties.is_empty() {
+            properties_enum = format!(
+                "
+/// The item properties of {}, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum {0}Property {{
+",
+                o.name
+            );
+            for (i, name) in o.item_properties.keys().enumerate() {
+                properties_enum += &format!(
+                    "    {}{} = {},\n",
+                    &name[..1].to_uppercase(),
+                    &name[1..],
+                    i
+                );
+            }
+            properties_enum += "}\n";
+            properties_changed = format!(
+                "
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[{}Property]) {{
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }}",
+                o.name
+            );
+        }
         writeln!(
             r,
             "}}
-
+{9}
 #[derive(Clone)]
 pub struct {0}{1} {{
     qobject: *mut {0}QObject,
     layout_about_to_be_changed: extern fn(*mut {0}QObject),
     layout_changed: extern fn(*mut {0}QObject),
     data_changed: extern fn(*mut {0}QObject, usize, usize),
+    properties_changed: extern fn(*mut {0}QObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut {0}QObject),
     end_reset_model: extern fn(*mut {0}QObject),
     begin_insert_rows: extern fn(*mut {0}QObject,{4} usize, usize),
@@ -471,7 +1168,7 @@ pub struct {0}{1} {{
     begin_move_rows: extern fn(*mut {0}QObject,{4} usize, usize,{7} usize),
     end_move_rows: extern fn(*mut {0}QObject),
     begin_remove_rows: extern fn(*mut {0}QObject,{4} usize, usize),
-    end_remove_rows: extern fn(*mut {0}QObject),
+    end_remove_rows: extern fn(*mut {0}QObject),{10}
 }}
 
 impl {0}{1} {{
@@ -483,7 +1180,7 @@ impl {0}{1} {{
     }}
     pub fn data_changed(&mut self, first: usize, last: usize) {{
         (self.data_changed)(self.qobject, first, last);
-    }}
+    }}{8}
     pub fn begin_reset_model(&mut self) {{
         (self.begin_reset_model)(self.qobject);
     }}
@@ -507,8 +1204,9 @@ impl {0}{1} {{
     }}
     pub fn end_remove_rows(&mut self) {{
         (self.end_remove_rows)(self.qobject);
-    }}",
-            o.name, type_, index_decl, index, index_c_decl, dest_decl, dest, dest_c_decl
+    }}{11}",
+            o.name, type_, index_decl, index, index_c_decl, dest_decl, dest, dest_c_decl,
+            properties_changed, properties_enum, permutation_field, permutation
         )?;
     }
 
@@ -567,19 +1265,28 @@ pub trait {}Trait {{
             for a in &f.arguments {
                 let t = if a.argument_type.name() == "QByteArray" {
                     "&[u8]"
+                } else if a.borrow {
+                    "&[u16]"
                 } else {
                     a.argument_type.rust_type()
                 };
                 arg_list.push_str(&format!(", {}: {}", a.name, t));
             }
         }
+        let return_type = if !f.asynchronous {
+            f.return_type.rust_type().to_string()
+        } else if f.return_type == SimpleType::Void {
+            "Box<dyn FnOnce() + Send>".to_string()
+        } else {
+            format!("Box<dyn FnOnce() -> {} + Send>", f.return_type.rust_type())
+        };
         writeln!(
             r,
             "    fn {}(&{}self{}) -> {};",
             lc,
             if f.mutable { "mut " } else { "" },
             arg_list,
-            f.return_type.rust_type()
+            return_type
         )?;
     }
     if o.object_type == ObjectType::List {
@@ -594,10 +1301,24 @@ pub trait {}Trait {{
     fn fetch_more(&mut self) {{}}
     fn sort(&mut self, _: u8, _: SortOrder) {{}}"
         )?;
+        if o.page_size > 0 {
+            writeln!(
+                r,
+                "    /// Make the rows from `first` to `last` available to the getters.
+    /// The rows are one page of {} rows or the last rows of the model.
+    fn request_rows(&mut self, first: usize, last: usize);",
+                o.page_size
+            )?;
+        }
     } else if o.object_type == ObjectType::Tree {
         writeln!(
             r,
             "    fn row_count(&self, _: Option<usize>) -> usize;
+    /// Tell if an item has or may have children. Override this when
+    /// row_count() starts loading data that is not needed to answer.
+    fn has_children(&self, index: Option<usize>) -> bool {{
+        self.row_count(index) > 0
+    }}
     fn can_fetch_more(&self, _: Option<usize>) -> bool {{
         false
     }}
@@ -618,6 +1339,19 @@ pub trait {}Trait {{
                 name,
                 rust_return_type_(ip)
             )?;
+            if o.object_type == ObjectType::List && ip.is_numeric() {
+                writeln!(
+                    r,
+                    "    /// Copy the values for the rows from `first` into `column`.
+    fn {0}_column(&self, first: usize, column: &mut [{1}]) {{
+        for (row, value) in column.iter_mut().enumerate() {{
+            *value = self.{0}(first + row);
+        }}
+    }}",
+                    name,
+                    ip.rust_type()
+                )?;
+            }
             if ip.write {
                 if ip.item_property_type.name() == "QByteArray" {
                     if ip.optional {
@@ -666,6 +1400,29 @@ pub unsafe extern \"C\" fn {0}_free(ptr: *mut {}) {{
 }}",
         lcname, o.name
     )?;
+    if o.coalesce_changes {
+        writeln!(
+            r,
+            "
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_take_changes(ptr: *mut {}) -> u64 {{
+    (&mut *ptr).emit().changes.swap(0, Ordering::SeqCst)
+}}",
+            lcname, o.name
+        )?;
+        if o.properties.values().any(|p| p.cached) {
+            writeln!(
+                r,
+                "
+/// The properties that changed since the last call of take_changes.
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_pending_changes(ptr: *mut {}) -> u64 {{
+    (&mut *ptr).emit().changes.load(Ordering::SeqCst)
+}}",
+                lcname, o.name
+            )?;
+        }
+    }
 
     for (name, p) in &o.properties {
         let base = format!("{}_{}", lcname, snake_case(name));
@@ -732,12 +1489,12 @@ pub unsafe extern \"C\" fn {}_get(
 #[no_mangle]
 pub unsafe extern \"C\" fn {}_set(ptr: *mut {}, v: *const c_ushort, len: c_int) {{
     let o = &mut *ptr;
-    let mut s = String::new();
-    set_string_from_utf16(&mut s, v, len);
+    {}
     o.set_{}(s);
 }}",
                     base,
                     o.name,
+                    string_from_utf16(p.encoding, "s", "v", "len"),
                     snake_case(name)
                 )?;
             } else if p.write {
@@ -784,12 +1541,12 @@ pub unsafe extern \"C\" fn {}_get(
 #[no_mangle]
 pub unsafe extern \"C\" fn {}_set(ptr: *mut {}, v: *const c_ushort, len: c_int) {{
     let o = &mut *ptr;
-    let mut s = String::new();
-    set_string_from_utf16(&mut s, v, len);
+    {}
     o.set_{}(Some(s));
 }}",
                     base,
                     o.name,
+                    string_from_utf16(p.encoding, "s", "v", "len"),
                     snake_case(name)
                 )?;
             } else if p.write {
@@ -883,6 +1640,9 @@ pub unsafe extern \"C\" fn {}_set_none(ptr: *mut {}) {{
     for f in &o.functions {
         write_function(r, f, &lcname, o)?;
     }
+    if o.has_commands() {
+        write_rust_apply_commands(r, o, &lcname)?;
+    }
     if o.object_type == ObjectType::List {
         writeln!(
             r,
@@ -917,6 +1677,16 @@ pub unsafe extern \"C\" fn {1}_sort(
 }}",
             o.name, lcname
         )?;
+        if o.page_size > 0 {
+            writeln!(
+                r,
+                "#[no_mangle]
+pub unsafe extern \"C\" fn {1}_request_rows(ptr: *mut {0}, first: c_int, last: c_int) {{
+    (&mut *ptr).request_rows(to_usize(first), to_usize(last))
+}}",
+                o.name, lcname
+            )?;
+        }
     } else if o.object_type == ObjectType::Tree {
         writeln!(
             r,
@@ -929,6 +1699,13 @@ pub unsafe extern \"C\" fn {1}_row_count(
     to_c_int((&*ptr).row_count(index.into()))
 }}
 #[no_mangle]
+pub unsafe extern \"C\" fn {1}_has_children(
+    ptr: *const {0},
+    index: COption<usize>,
+) -> bool {{
+    (&*ptr).has_children(index.into())
+}}
+#[no_mangle]
 pub unsafe extern \"C\" fn {1}_can_fetch_more(
     ptr: *const {0},
     index: COption<usize>,
@@ -947,13 +1724,21 @@ pub unsafe extern \"C\" fn {1}_sort(
 ) {{
     (&mut *ptr).sort(column, order)
 }}
+/// Replace each row in `rows` with the current row of the item in `ids`
+/// or with -1 if the item is gone.
 #[no_mangle]
-pub unsafe extern \"C\" fn {1}_check_row(
+pub unsafe extern \"C\" fn {1}_check_rows(
     ptr: *const {0},
-    index: usize,
-    row: c_int,
-) -> COption<usize> {{
-    (&*ptr).check_row(index, to_usize(row)).into()
+    ids: *const usize,
+    rows: *mut c_int,
+    len: c_int,
+) {{
+    let o = &*ptr;
+    let ids = slice::from_raw_parts(ids, to_usize(len));
+    let rows = slice::from_raw_parts_mut(rows, to_usize(len));
+    for (id, row) in ids.iter().zip(rows.iter_mut()) {{
+        *row = o.check_row(*id, to_usize(*row)).map_or(-1, to_c_int);
+    }}
 }}
 #[no_mangle]
 pub unsafe extern \"C\" fn {1}_index(
@@ -963,6 +1748,20 @@ pub unsafe extern \"C\" fn {1}_index(
 ) -> usize {{
     (&*ptr).index(index.into(), to_usize(row))
 }}
+/// The item at `row` below `index` or `None` if there is no such row.
+#[no_mangle]
+pub unsafe extern \"C\" fn {1}_index_checked(
+    ptr: *const {0},
+    index: COption<usize>,
+    row: c_int,
+) -> COption<usize> {{
+    let o = &*ptr;
+    let index = index.into();
+    if row < 0 || to_usize(row) >= o.row_count(index) {{
+        return None.into();
+    }}
+    Some(o.index(index, to_usize(row))).into()
+}}
 #[no_mangle]
 pub unsafe extern \"C\" fn {1}_parent(ptr: *const {0}, index: usize) -> QModelIndex {{
     if let Some(parent) = (&*ptr).parent(index) {{
@@ -984,14 +1783,48 @@ pub unsafe extern \"C\" fn {1}_row(ptr: *const {0}, index: usize) -> c_int {{
             o.name, lcname
         )?;
     }
+    if o.object_type != ObjectType::Object
+        && o.item_properties.values().any(|ip| !ip.rust_by_arc)
+    {
+        write_data_range(r, o, &lcname)?;
+    }
     if o.object_type != ObjectType::Object {
         let (index_decl, index) = if o.object_type == ObjectType::Tree {
             (", index: usize", "index")
         } else {
             (", row: c_int", "to_usize(row)")
         };
+        if o.item_properties.values().any(|ip| ip.rust_by_arc) {
+            writeln!(
+                r,
+                "
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_release_arc(data: *const c_char, len: c_int) {{
+    let data = slice::from_raw_parts(data as *const u8, to_usize(len));
+    drop(Arc::from_raw(data as *const [u8]));
+}}",
+                lcname
+            )?;
+        }
         for (name, ip) in &o.item_properties {
-            if ip.is_complex() && !ip.optional {
+            if ip.rust_by_arc {
+                writeln!(
+                    r,
+                    "
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_data_{}(ptr: *const {}{}, len: *mut c_int) -> *const c_char {{
+    let o = &*ptr;
+    let data = o.{1}({});
+    *len = to_c_int(data.len());
+    Arc::into_raw(data) as *const c_char
+}}",
+                    lcname,
+                    snake_case(name),
+                    o.name,
+                    index_decl,
+                    index
+                )?;
+            } else if ip.is_complex() && !ip.optional {
                 writeln!(
                     r,
                     "
@@ -1055,6 +1888,21 @@ pub unsafe extern \"C\" fn {}_data_{}(ptr: *const {}{}) -> {} {{
                     if ip.optional { ".into()" } else { "" }
                 )?;
             }
+            if o.object_type == ObjectType::List && ip.is_numeric() {
+                writeln!(
+                    r,
+                    "
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_column_{}(ptr: *const {}, first: c_int, count: c_int, column: *mut {}) {{
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).{1}_column(to_usize(first), column);
+}}",
+                    lcname,
+                    snake_case(name),
+                    o.name,
+                    ip.rust_type()
+                )?;
+            }
             if ip.write {
                 let val = if ip.optional { "Some(v)" } else { "v" };
                 if ip.type_name() == "QString" {
@@ -1067,14 +1915,14 @@ pub unsafe extern \"C\" fn {}_set_data_{}(
     s: *const c_ushort, len: c_int,
 ) -> bool {{
     let o = &mut *ptr;
-    let mut v = String::new();
-    set_string_from_utf16(&mut v, s, len);
+    {}
     o.set_{1}({}, {})
 }}",
                         lcname,
                         snake_case(name),
                         o.name,
                         index_decl,
+                        string_from_utf16(ip.encoding, "v", "s", "len"),
                         index,
                         val
                     )?;
@@ -1137,152 +1985,1897 @@ pub unsafe extern \"C\" fn {}_set_data_{}_none(ptr: *mut {}{}) -> bool {{
             }
         }
     }
+    if o.transactions {
+        write_rust_transactions(r, o)?;
+    }
+    if o.storage == Storage::Columnar {
+        write_rust_columns(r, o)?;
+    }
+    if o.storage == Storage::Mapped {
+        write_rust_records(r, o)?;
+    }
     Ok(())
 }
 
-fn write_rust_types(conf: &Config, r: &mut Vec<u8>) -> Result<()> {
-    let mut has_option = false;
-    let mut has_string = false;
-    let mut has_byte_array = false;
-    let mut has_list_or_tree = false;
-
-    for o in conf.objects.values() {
-        has_list_or_tree |= o.object_type != ObjectType::Object;
-        for p in o.properties.values() {
-            has_option |= p.optional;
-            has_string |= p.property_type == Type::Simple(SimpleType::QString);
-            has_byte_array |= p.property_type == Type::Simple(SimpleType::QByteArray);
-        }
-        for p in o.item_properties.values() {
-            has_option |= p.optional;
-            has_string |= p.item_property_type == SimpleType::QString;
-            has_byte_array |= p.item_property_type == SimpleType::QByteArray;
-        }
-        for f in o.functions.values() {
-            has_string |= f.return_type == SimpleType::QString;
-            has_byte_array |= f.return_type == SimpleType::QByteArray;
-            for a in &f.arguments {
-                has_string |= a.argument_type == SimpleType::QString;
-                has_byte_array |= a.argument_type == SimpleType::QByteArray;
-            }
-        }
+/// The number of bytes that an item property takes in a mapped record.
+fn mapped_size(ip: &ItemProperty) -> usize {
+    match ip.item_property_type {
+        SimpleType::QString | SimpleType::QByteArray => 12,
+        SimpleType::Void => 0,
+        SimpleType::Bool | SimpleType::Qint8 | SimpleType::QUint8 => 1,
+        SimpleType::Qint16 | SimpleType::QUint16 => 2,
+        SimpleType::Float | SimpleType::Qint32 | SimpleType::QUint32 => 4,
+        SimpleType::Double | SimpleType::Qint64 | SimpleType::QUint64 => 8,
     }
+}
 
-    if has_option || has_list_or_tree {
-        writeln!(
-            r,
-            "
-
-#[repr(C)]
-pub struct COption<T> {{
-    data: T,
-    some: bool,
+/// Write a reader for the rows of a List that are stored in a file.
+fn write_rust_records(r: &mut Vec<u8>, o: &Object) -> Result<()> {
+    let record_size: usize = o.item_properties.values().map(mapped_size).sum();
+    writeln!(
+        r,
+        "
+/// The rows of {0} in a file of fixed size records.
+///
+/// The file starts with the number of records as a little endian u64.
+/// The records follow without padding. A record holds the item properties
+/// in the order of their names. Numbers are little endian and a bool is
+/// one byte. A QString or QByteArray is a little endian u64 offset in the
+/// file and a u32 length. Strings are UTF-8.
+pub struct {0}Records {{
+    file: MappedFile,
+    rows: usize,
 }}
 
-impl<T> COption<T> {{
-    #![allow(dead_code)]
-    fn into(self) -> Option<T> {{
-        if self.some {{
-            Some(self.data)
-        }} else {{
-            None
+impl {0}Records {{
+    /// The size of a record in bytes.
+    pub const RECORD_SIZE: usize = {1};
+
+    pub fn open<P: AsRef<::std::path::Path>>(path: P) -> ::std::io::Result<{0}Records> {{
+        let file = MappedFile::open(path)?;
+        match mapped_rows(file.bytes(), Self::RECORD_SIZE) {{
+            Some(rows) => Ok({0}Records {{ file, rows }}),
+            None => Err(::std::io::Error::new(
+                ::std::io::ErrorKind::InvalidData,
+                \"file is too small for its records\",
+            )),
         }}
     }}
-}}
-
-impl<T> From<Option<T>> for COption<T>
-where
-    T: Default,
-{{
-    fn from(t: Option<T>) -> COption<T> {{
-        if let Some(v) = t {{
-            COption {{
-                data: v,
-                some: true,
-            }}
-        }} else {{
-            COption {{
-                data: T::default(),
-                some: false,
-            }}
+    pub fn empty() -> {0}Records {{
+        {0}Records {{
+            file: MappedFile::empty(),
+            rows: 0,
         }}
     }}
-}}"
-        )?;
+    pub fn len(&self) -> usize {{
+        self.rows
+    }}
+    pub fn is_empty(&self) -> bool {{
+        self.rows == 0
+    }}
+    fn field(&self, row: usize, offset: usize, len: usize) -> &[u8] {{
+        assert!(row < self.rows);
+        let start = 8 + row * Self::RECORD_SIZE + offset;
+        &self.file.bytes()[start..start + len]
+    }}",
+        o.name, record_size
+    )?;
+    let mut offset = 0;
+    for (name, ip) in &o.item_properties {
+        let size = mapped_size(ip);
+        let lc = snake_case(name);
+        match ip.item_property_type {
+            SimpleType::QString => writeln!(
+                r,
+                "    /// The value, or an empty string if it is not valid UTF-8.
+    pub fn {}(&self, row: usize) -> &str {{
+        let bytes = mapped_slice(self.file.bytes(), self.field(row, {}, 12));
+        ::std::str::from_utf8(bytes).unwrap_or(\"\")
+    }}",
+                lc, offset
+            )?,
+            SimpleType::QByteArray => writeln!(
+                r,
+                "    pub fn {}(&self, row: usize) -> &[u8] {{
+        mapped_slice(self.file.bytes(), self.field(row, {}, 12))
+    }}",
+                lc, offset
+            )?,
+            SimpleType::Bool => writeln!(
+                r,
+                "    pub fn {}(&self, row: usize) -> bool {{
+        self.field(row, {}, 1)[0] != 0
+    }}",
+                lc, offset
+            )?,
+            _ => writeln!(
+                r,
+                "    pub fn {0}(&self, row: usize) -> {1} {{
+        let mut value = [0u8; {3}];
+        value.copy_from_slice(self.field(row, {2}, {3}));
+        {1}::from_le_bytes(value)
+    }}",
+                lc,
+                ip.rust_type(),
+                offset,
+                size
+            )?,
+        }
+        offset += size;
     }
-    if has_string {
-        writeln!(
-            r,
-            "
-
-pub enum QString {{}}
+    writeln!(r, "}}")?;
+    Ok(())
+}
 
-fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {{
-    let utf16 = unsafe {{ slice::from_raw_parts(str, to_usize(len)) }};
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
-    s.clear();
-    s.extend(characters);
-}}
-"
-        )?;
+/// Write a store for the rows of a List with one `Vec` per item property.
+fn write_rust_columns(r: &mut Vec<u8>, o: &Object) -> Result<()> {
+    writeln!(
+        r,
+        "
+/// The rows of {0} with one `Vec` per item property.
+///
+/// All columns have the same length. Each column is available as a slice,
+/// so a scan over one property does not touch the others.
+#[derive(Default, Clone)]
+pub struct {0}Columns {{
+    rows: usize,",
+        o.name
+    )?;
+    for (name, ip) in &o.item_properties {
+        writeln!(r, "    {}: Vec<{}>,", snake_case(name), rust_type_(ip))?;
     }
-    if has_byte_array {
-        writeln!(
-            r,
-            "
+    writeln!(
+        r,
+        "}}
 
-pub enum QByteArray {{}}"
-        )?;
+/// The values of one row of {}Columns.
+#[derive(Default, Clone)]
+pub struct {0}Row {{",
+        o.name
+    )?;
+    for (name, ip) in &o.item_properties {
+        writeln!(r, "    pub {}: {},", snake_case(name), rust_type_(ip))?;
+    }
+    writeln!(
+        r,
+        "}}
+
+impl {}Columns {{
+    pub fn new() -> Self {{
+        Self::default()
+    }}
+    pub fn len(&self) -> usize {{
+        self.rows
+    }}
+    pub fn is_empty(&self) -> bool {{
+        self.rows == 0
+    }}",
+        o.name
+    )?;
+    for (name, ip) in &o.item_properties {
+        writeln!(
+            r,
+            "    pub fn {0}(&self) -> &[{1}] {{
+        &self.{0}
+    }}
+    pub fn {0}_mut(&mut self) -> &mut [{1}] {{
+        &mut self.{0}
+    }}",
+            snake_case(name),
+            rust_type_(ip)
+        )?;
+    }
+    writeln!(r, "    pub fn push(&mut self, values: {}Row) {{", o.name)?;
+    for name in o.item_properties.keys() {
+        writeln!(r, "        self.{0}.push(values.{0});", snake_case(name))?;
+    }
+    writeln!(
+        r,
+        "        self.rows += 1;
+    }}
+    pub fn insert(&mut self, row: usize, values: {}Row) {{",
+        o.name
+    )?;
+    for name in o.item_properties.keys() {
+        writeln!(r, "        self.{0}.insert(row, values.{0});", snake_case(name))?;
+    }
+    writeln!(
+        r,
+        "        self.rows += 1;
+    }}
+    pub fn remove(&mut self, row: usize) {{"
+    )?;
+    for name in o.item_properties.keys() {
+        writeln!(r, "        self.{}.remove(row);", snake_case(name))?;
+    }
+    writeln!(
+        r,
+        "        self.rows -= 1;
+    }}
+    pub fn truncate(&mut self, len: usize) {{"
+    )?;
+    for name in o.item_properties.keys() {
+        writeln!(r, "        self.{}.truncate(len);", snake_case(name))?;
+    }
+    writeln!(
+        r,
+        "        self.rows = self.rows.min(len);
+    }}
+    pub fn clear(&mut self) {{
+        self.truncate(0);
+    }}
+    pub fn reserve(&mut self, additional: usize) {{"
+    )?;
+    for name in o.item_properties.keys() {
+        writeln!(r, "        self.{}.reserve(additional);", snake_case(name))?;
+    }
+    writeln!(r, "    }}\n}}")?;
+    Ok(())
+}
+
+/// Write the types with which other threads record structural changes for
+/// the GUI thread, and the function that applies them.
+fn write_rust_transactions(r: &mut Vec<u8>, o: &Object) -> Result<()> {
+    let lcname = snake_case(&o.name);
+    let tree = o.object_type == ObjectType::Tree;
+    let (type_, index_decl, index_type, index_arg, dest_decl, dest_type, dest_arg) = if tree {
+        (
+            "Tree",
+            " index: Option<usize>,",
+            "Option<usize>, ",
+            "index, ",
+            " dest: Option<usize>,",
+            " Option<usize>,",
+            " dest,",
+        )
+    } else {
+        ("List", "", "", "", "", "", "")
+    };
+    let (index, dest) = if tree { ("index, ", "dest, ") } else { ("", "") };
+    writeln!(
+        r,
+        "
+type {0}Update = Box<dyn FnOnce(&mut {0}) + Send>;
+
+enum {0}Change {{
+    Reset({0}Update),
+    Insert({2}usize, usize, {0}Update),
+    Remove({2}usize, usize, {0}Update),
+    Move({2}usize, usize,{5} usize, {0}Update),
+    Data(usize, usize, {0}Update),
+}}
+
+struct {0}Transactions {{
+    queue: ::std::sync::Mutex<Vec<{0}Change>>,
+    model: {0}{1},
+    pending: extern fn(*mut {0}QObject),
+}}
+
+/// Handle with which any thread can change {0}.
+///
+/// Changes are recorded in a transaction. A committed transaction is
+/// applied on the GUI thread, with the model signals around each change.
+#[derive(Clone)]
+pub struct {0}Handle {{
+    qobject: Arc<AtomicPtr<{0}QObject>>,
+    transactions: Arc<{0}Transactions>,
+}}
+
+// The model in the transactions is only used on the GUI thread.
+unsafe impl Send for {0}Handle {{}}
+
+impl {0}Handle {{
+    pub fn transaction(&self) -> {0}Transaction {{
+        {0}Transaction {{
+            handle: self.clone(),
+            changes: Vec::new(),
+        }}
+    }}
+}}
+
+/// Changes to {0} that are applied together when committed.
+///
+/// Every change has a function that updates the data of the model. It is
+/// called on the GUI thread, between the begin and end signals.
+pub struct {0}Transaction {{
+    handle: {0}Handle,
+    changes: Vec<{0}Change>,
+}}
+
+impl {0}Transaction {{
+    pub fn reset<F>(&mut self, update: F)
+    where
+        F: FnOnce(&mut {0}) + Send + 'static,
+    {{
+        self.changes.push({0}Change::Reset(Box::new(update)));
+    }}
+    pub fn insert_rows<F>(&mut self,{3} first: usize, last: usize, update: F)
+    where
+        F: FnOnce(&mut {0}) + Send + 'static,
+    {{
+        self.changes
+            .push({0}Change::Insert({4}first, last, Box::new(update)));
+    }}
+    pub fn remove_rows<F>(&mut self,{3} first: usize, last: usize, update: F)
+    where
+        F: FnOnce(&mut {0}) + Send + 'static,
+    {{
+        self.changes
+            .push({0}Change::Remove({4}first, last, Box::new(update)));
+    }}
+    pub fn move_rows<F>(&mut self,{3} first: usize, last: usize,{6} destination: usize, update: F)
+    where
+        F: FnOnce(&mut {0}) + Send + 'static,
+    {{
+        self.changes.push({0}Change::Move({4}first, last,{7} destination, Box::new(update)));
+    }}
+    pub fn data_changed<F>(&mut self, first: usize, last: usize, update: F)
+    where
+        F: FnOnce(&mut {0}) + Send + 'static,
+    {{
+        self.changes
+            .push({0}Change::Data(first, last, Box::new(update)));
+    }}
+    /// Send the changes to the GUI thread.
+    pub fn commit(self) {{
+        if self.changes.is_empty() {{
+            return;
+        }}
+        let wake = {{
+            let mut queue = self.handle.transactions.queue.lock().unwrap();
+            let wake = queue.is_empty();
+            queue.extend(self.changes);
+            wake
+        }};
+        if wake {{
+            let ptr = self.handle.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {{
+                (self.handle.transactions.pending)(ptr);
+            }}
+        }}
+    }}
+}}
+
+#[no_mangle]
+pub unsafe extern \"C\" fn {8}_apply_transactions(ptr: *mut {0}) {{
+    let o = &mut *ptr;
+    let transactions = o.emit().transactions.clone();
+    let mut model = transactions.model.clone();
+    let changes = ::std::mem::replace(&mut *transactions.queue.lock().unwrap(), Vec::new());
+    for change in changes {{
+        match change {{
+            {0}Change::Reset(update) => {{
+                model.begin_reset_model();
+                update(o);
+                model.end_reset_model();
+            }}
+            {0}Change::Insert({4}first, last, update) => {{
+                model.begin_insert_rows({9}first, last);
+                update(o);
+                model.end_insert_rows();
+            }}
+            {0}Change::Remove({4}first, last, update) => {{
+                model.begin_remove_rows({9}first, last);
+                update(o);
+                model.end_remove_rows();
+            }}
+            {0}Change::Move({4}first, last,{7} destination, update) => {{
+                model.begin_move_rows({9}first, last, {10}destination);
+                update(o);
+                model.end_move_rows();
+            }}
+            {0}Change::Data(first, last, update) => {{
+                update(o);
+                model.data_changed(first, last);
+            }}
+        }}
+    }}
+}}",
+        o.name,
+        type_,
+        index_type,
+        index_decl,
+        index_arg,
+        dest_type,
+        dest_decl,
+        dest_arg,
+        lcname,
+        index,
+        dest
+    )?;
+    Ok(())
+}
+
+/// Rust code that tells if the item property `v` contains the lowercase
+/// `filter`.
+fn proxy_filter_expression(ip: &ItemProperty) -> &'static str {
+    match ip.item_property_type {
+        SimpleType::QString if ip.encoding == Encoding::Utf16 => {
+            "String::from_utf16_lossy(&v).to_lowercase().contains(filter)"
+        }
+        SimpleType::QString => "v.to_lowercase().contains(filter)",
+        SimpleType::QByteArray => "String::from_utf8_lossy(&v).to_lowercase().contains(filter)",
+        _ => "v.to_string().contains(filter)",
+    }
+}
+
+fn write_rust_proxy(r: &mut Vec<u8>, p: &Proxy) -> Result<()> {
+    let o = &p.source;
+    let tree = o.object_type == ObjectType::Tree;
+    let lcname = snake_case(&p.name);
+    writeln!(
+        r,
+        "
+pub struct {} {{
+    property: c_int,
+    filter: String,{}
+}}
+
+impl {0} {{
+    /// Tell if the item property `property` contains the filter.
+    fn matches(&self, o: &{}, index: usize) -> bool {{
+        let filter = &self.filter;
+        match self.property {{",
+        p.name,
+        if tree {
+            "
+    // for each item that was asked for: does it or a descendant match
+    accepted: ::std::collections::HashMap<usize, bool>,"
+        } else {
+            ""
+        },
+        o.name
+    )?;
+    for (i, (name, ip)) in o.item_properties.iter().enumerate() {
+        if ip.optional {
+            writeln!(
+                r,
+                "            {} => o.{}(index).map_or(false, |v| {}),",
+                i,
+                snake_case(name),
+                proxy_filter_expression(ip)
+            )?;
+        } else {
+            writeln!(
+                r,
+                "            {} => {{
+                let v = o.{}(index);
+                {}
+            }}",
+                i,
+                snake_case(name),
+                proxy_filter_expression(ip)
+            )?;
+        }
+    }
+    writeln!(r, "            _ => true,\n        }}\n    }}")?;
+    if tree {
+        writeln!(
+            r,
+            "    /// Tell if the item or one of its descendants matches the filter.
+    /// Each item is visited once until the filter or the item changes.
+    /// The tree is walked with a stack of (item, next row, row count)
+    /// instead of recursion, so deep trees do not overflow the call stack.
+    fn accepts(&mut self, o: &{}, index: usize) -> bool {{
+        let mut stack: Vec<(usize, usize, usize)> = Vec::new();
+        let mut next = Some(index);
+        let mut accepted = None;
+        loop {{
+            if let Some(item) = next.take() {{
+                accepted = self.accepted.get(&item).cloned();
+                if accepted.is_none() {{
+                    if self.matches(o, item) {{
+                        accepted = Some(true);
+                    }} else if o.has_children(Some(item)) {{
+                        stack.push((item, 0, o.row_count(Some(item))));
+                    }} else {{
+                        accepted = Some(false);
+                    }}
+                    if let Some(a) = accepted {{
+                        self.accepted.insert(item, a);
+                    }}
+                }}
+            }}
+            let top = match stack.last_mut() {{
+                Some(top) => top,
+                None => return accepted.unwrap_or(false),
+            }};
+            // an item is accepted as soon as one of its children is
+            let (item, row, row_count) = *top;
+            if accepted != Some(true) && row < row_count {{
+                top.1 += 1;
+                next = Some(o.index(Some(item), row));
+                continue;
+            }}
+            stack.pop();
+            let a = accepted == Some(true);
+            self.accepted.insert(item, a);
+            accepted = Some(a);
+        }}
+    }}",
+            o.name
+        )?;
+    } else {
+        writeln!(
+            r,
+            "    fn accepts(&mut self, o: &{}, index: usize) -> bool {{
+        self.matches(o, index)
+    }}",
+            o.name
+        )?;
+    }
+    writeln!(
+        r,
+        "}}
+
+#[no_mangle]
+pub extern \"C\" fn {1}_new() -> *mut {0} {{
+    Box::into_raw(Box::new({0} {{
+        property: -1,
+        filter: String::new(),{2}
+    }}))
+}}
+
+#[no_mangle]
+pub unsafe extern \"C\" fn {1}_free(ptr: *mut {0}) {{
+    drop(Box::from_raw(ptr));
+}}
+
+#[no_mangle]
+pub unsafe extern \"C\" fn {1}_set_filter(
+    ptr: *mut {0},
+    property: c_int,
+    filter: *const c_ushort,
+    filter_len: c_int,
+) {{
+    let p = &mut *ptr;
+    p.property = property;
+    p.filter = String::from_utf16_lossy(slice::from_raw_parts(filter, to_usize(filter_len)))
+        .to_lowercase();{3}
+}}
+
+/// Write the rows that pass the filter, in sorted order, to `rows`.
+#[no_mangle]
+pub unsafe extern \"C\" fn {1}_rows(
+    ptr: *mut {0},
+    source: *const {4},{5}
+    sort: c_int,
+    order: SortOrder,
+    rows: *mut c_int,
+) -> c_int {{
+    let p = &mut *ptr;
+    let o = &*source;",
+        p.name,
+        lcname,
+        if tree {
+            "\n        accepted: ::std::collections::HashMap::new(),"
+        } else {
+            ""
+        },
+        if tree { "\n    p.accepted.clear();" } else { "" },
+        o.name,
+        if tree { "\n    parent: COption<usize>," } else { "" }
+    )?;
+    if tree {
+        writeln!(
+            r,
+            "    let parent = parent.into();
+    let index = |row| o.index(parent, row);
+    let row_count = o.row_count(parent);"
+        )?;
+    } else {
+        writeln!(
+            r,
+            "    let index = |row| row;
+    let row_count = o.row_count();"
+        )?;
+    }
+    writeln!(
+        r,
+        "    let mut accepted: Vec<usize> = (0..row_count)
+        .filter(|&row| p.filter.is_empty() || p.accepts(o, index(row)))
+        .collect();
+    match sort {{"
+    )?;
+    for (i, (name, ip)) in o.item_properties.iter().enumerate() {
+        let cmp = match ip.item_property_type {
+            SimpleType::Float | SimpleType::Double => {
+                "a.partial_cmp(b).unwrap_or(::std::cmp::Ordering::Equal)"
+            }
+            _ => "a.cmp(b)",
+        };
+        writeln!(
+            r,
+            "        {} => {{
+            let keys: Vec<_> = accepted.iter().map(|&row| o.{}(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| {});
+        }}",
+            i,
+            snake_case(name),
+            cmp
+        )?;
+    }
+    writeln!(
+        r,
+        "        _ => {{}}
+    }}
+    let rows = slice::from_raw_parts_mut(rows, accepted.len());
+    for (r, a) in rows.iter_mut().zip(&accepted) {{
+        *r = to_c_int(*a);
+    }}
+    to_c_int(accepted.len())
+}}
+
+/// Find the position of the source row `row` among `rows`, the rows that
+/// pass the filter in sorted order without `row`. Return -1 when `row`
+/// does not pass the filter.
+#[no_mangle]
+pub unsafe extern \"C\" fn {}_place(
+    ptr: *mut {},
+    source: *const {},{}
+    sort: c_int,
+    order: SortOrder,
+    rows: *const c_int,
+    len: c_int,
+    row: c_int,
+) -> c_int {{
+    let p = &mut *ptr;
+    let o = &*source;",
+        lcname,
+        p.name,
+        o.name,
+        if tree { "\n    parent: COption<usize>," } else { "" }
+    )?;
+    if tree {
+        writeln!(
+            r,
+            "    let parent = parent.into();
+    let index = |row| o.index(parent, row);"
+        )?;
+    } else {
+        writeln!(r, "    let index = |row| row;")?;
+    }
+    writeln!(
+        r,
+        "    let row = to_usize(row);
+    if !p.filter.is_empty() && !p.accepts(o, index(row)) {{
+        return -1;
+    }}
+    let rows = slice::from_raw_parts(rows, to_usize(len));
+    let place = match sort {{"
+    )?;
+    for (i, (name, ip)) in o.item_properties.iter().enumerate() {
+        let cmp = match ip.item_property_type {
+            SimpleType::Float | SimpleType::Double => {
+                "a.partial_cmp(b).unwrap_or(::std::cmp::Ordering::Equal)"
+            }
+            _ => "a.cmp(b)",
+        };
+        writeln!(
+            r,
+            "        {} => place_row(rows, row, |r| o.{}(index(r)), order, |a, b| {}),",
+            i,
+            snake_case(name),
+            cmp
+        )?;
+    }
+    writeln!(
+        r,
+        "        _ => place_row(rows, row, |r| r, SortOrder::Ascending, |a, b| a.cmp(b)),
+    }};
+    to_c_int(place)
+}}"
+    )?;
+    if tree {
+        writeln!(
+            r,
+            "
+/// Forget what is known about the rows `first` to `last` and the ancestors
+/// of these rows.
+#[no_mangle]
+pub unsafe extern \"C\" fn {1}_changed(
+    ptr: *mut {0},
+    source: *const {2},
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+) {{
+    let p = &mut *ptr;
+    let o = &*source;
+    let parent = parent.into();
+    for row in first..last + 1 {{
+        p.accepted.remove(&o.index(parent, to_usize(row)));
+    }}
+    let mut index = parent;
+    while let Some(i) = index {{
+        p.accepted.remove(&i);
+        index = o.parent(i);
+    }}
+}}
+
+/// Forget what is known about the rows `first` to `last`, all their
+/// descendants and the ancestors of these rows. The rows are about to be
+/// removed.
+#[no_mangle]
+pub unsafe extern \"C\" fn {1}_removed(
+    ptr: *mut {0},
+    source: *const {2},
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+) {{
+    let p = &mut *ptr;
+    let o = &*source;
+    let parent = parent.into();
+    if p.accepted.is_empty() {{
+        return;
+    }}
+    let mut stack: Vec<usize> = (first..last + 1)
+        .map(|row| o.index(parent, to_usize(row)))
+        .collect();
+    while let Some(index) = stack.pop() {{
+        p.accepted.remove(&index);
+        if o.has_children(Some(index)) {{
+            stack.extend((0..o.row_count(Some(index))).map(|row| o.index(Some(index), row)));
+        }}
+    }}
+    let mut index = parent;
+    while let Some(i) = index {{
+        p.accepted.remove(&i);
+        index = o.parent(i);
+    }}
+}}",
+            p.name, lcname, o.name
+        )?;
+    }
+    Ok(())
+}
+
+fn write_rust_types(conf: &Config, r: &mut Vec<u8>) -> Result<()> {
+    let mut has_option = false;
+    let mut has_string = false;
+    let mut has_utf8_string = false;
+    let mut has_byte_array = false;
+    let mut has_list_or_tree = false;
+
+    for o in conf.objects.values() {
+        has_list_or_tree |= o.object_type != ObjectType::Object;
+        for p in o.properties.values() {
+            has_option |= p.optional;
+            has_string |= p.property_type == Type::Simple(SimpleType::QString);
+            has_utf8_string |= p.property_type == Type::Simple(SimpleType::QString)
+                && p.encoding == Encoding::Utf8;
+            has_byte_array |= p.property_type == Type::Simple(SimpleType::QByteArray);
+        }
+        for p in o.item_properties.values() {
+            has_option |= p.optional;
+            has_string |= p.item_property_type == SimpleType::QString;
+            has_utf8_string |=
+                p.item_property_type == SimpleType::QString && p.encoding == Encoding::Utf8;
+            has_byte_array |= p.item_property_type == SimpleType::QByteArray;
+        }
+        for f in o.functions.values() {
+            has_string |= f.return_type == SimpleType::QString;
+            has_utf8_string |= f.return_type == SimpleType::QString;
+            has_byte_array |= f.return_type == SimpleType::QByteArray;
+            for a in &f.arguments {
+                has_string |= a.argument_type == SimpleType::QString;
+                has_utf8_string |= a.argument_type == SimpleType::QString && !a.borrow;
+                has_byte_array |= a.argument_type == SimpleType::QByteArray;
+            }
+        }
+    }
+
+    if has_option || has_list_or_tree {
+        writeln!(
+            r,
+            "
+
+#[repr(C)]
+pub struct COption<T> {{
+    data: T,
+    some: bool,
+}}
+
+impl<T> COption<T> {{
+    #![allow(dead_code)]
+    fn into(self) -> Option<T> {{
+        if self.some {{
+            Some(self.data)
+        }} else {{
+            None
+        }}
+    }}
+}}
+
+impl<T> From<Option<T>> for COption<T>
+where
+    T: Default,
+{{
+    fn from(t: Option<T>) -> COption<T> {{
+        if let Some(v) = t {{
+            COption {{
+                data: v,
+                some: true,
+            }}
+        }} else {{
+            COption {{
+                data: T::default(),
+                some: false,
+            }}
+        }}
+    }}
+}}"
+        )?;
+    }
+    if has_string {
+        writeln!(
+            r,
+            "
+
+pub enum QString {{}}"
+        )?;
+    }
+    if has_utf8_string {
+        writeln!(
+            r,
+            "
+fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {{
+    let mut utf16 = unsafe {{ slice::from_raw_parts(str, to_usize(len)) }};
+    s.clear();
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {{
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {{
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {{
+                break;
+            }}
+            ascii += block.len();
+        }}
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {{
+            ascii += 1;
+        }}
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe {{ s.as_mut_vec() }}.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {{
+            break;
+        }}
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }}
+}}
+"
+        )?;
+    }
+    if has_byte_array {
+        writeln!(
+            r,
+            "
+
+pub enum QByteArray {{}}"
+        )?;
     }
     if has_list_or_tree {
         writeln!(
             r,
             "
 
-#[repr(C)]
-#[derive(PartialEq, Eq, Debug)]
-pub enum SortOrder {{
-    Ascending = 0,
-    Descending = 1,
+#[repr(C)]
+#[derive(PartialEq, Eq, Debug)]
+pub enum SortOrder {{
+    Ascending = 0,
+    Descending = 1,
+}}
+
+#[repr(C)]
+pub struct QModelIndex {{
+    row: c_int,
+    internal_id: usize,
+}}
+
+/// A model signal sent by `sync_rows`.
+enum SyncSignal<'a> {{
+    BeginRemove(usize, usize),
+    EndRemove,
+    BeginMove(usize, usize),
+    EndMove,
+    BeginInsert(usize, usize),
+    EndInsert,
+    BeginLayout,
+    /// The old row of every row.
+    EndLayout(&'a [usize]),
+    Changed(usize, usize),
+}}
+
+/// Most ranges of removed rows, ranges of inserted rows or moved rows that
+/// `sync_rows` signals one by one. Each of them shifts the rows, so more
+/// moves are sent as one layout change and more removes or inserts as a
+/// replacement of all rows. That keeps a sync O(n log n).
+const SYNC_MAX_SIGNALS: usize = 64;
+
+/// The number of runs of `true` in `flags`.
+fn count_runs<I: Iterator<Item = bool>>(flags: I) -> usize {{
+    let mut runs = 0;
+    let mut previous = false;
+    for flag in flags {{
+        if flag && !previous {{
+            runs += 1;
+        }}
+        previous = flag;
+    }}
+    runs
+}}
+
+/// Indexes into `seq` of a longest increasing subsequence, O(n log n).
+fn longest_increasing(seq: &[usize]) -> Vec<usize> {{
+    let mut tails: Vec<usize> = Vec::new();
+    let mut prev = vec![usize::max_value(); seq.len()];
+    for (i, &v) in seq.iter().enumerate() {{
+        let pos = match tails.binary_search_by(|&t| seq[t].cmp(&v)) {{
+            Ok(pos) | Err(pos) => pos,
+        }};
+        if pos > 0 {{
+            prev[i] = tails[pos - 1];
+        }}
+        if pos == tails.len() {{
+            tails.push(i);
+        }} else {{
+            tails[pos] = i;
+        }}
+    }}
+    let mut lis = vec![0; tails.len()];
+    let mut i = tails.last().cloned().unwrap_or(0);
+    for slot in lis.iter_mut().rev() {{
+        *slot = i;
+        i = prev[i];
+    }}
+    lis
+}}
+
+/// Turn `rows` into `new` with removes, moves, inserts and changes of
+/// the rows that have the same key. Rows that are not moved keep their
+/// place, so views keep their selection and scroll position. `signal` gets
+/// the rows as they are when the signal is sent.
+fn sync_rows<T, K, F, S>(rows: &mut Vec<T>, new: Vec<T>, key: F, mut signal: S)
+where
+    T: PartialEq,
+    K: ::std::hash::Hash + Eq,
+    F: Fn(&T) -> K,
+    S: FnMut(SyncSignal, &[T]),
+{{
+    let new_rows: ::std::collections::HashMap<K, usize> =
+        new.iter().enumerate().map(|(i, t)| (key(t), i)).collect();
+    let mut seen = vec![false; new.len()];
+    let mut duplicate = new_rows.len() != new.len();
+    // the row in `new` of every old row, if it is still there
+    let targets: Vec<Option<usize>> = rows
+        .iter()
+        .map(|t| {{
+            let target = new_rows.get(&key(t)).cloned();
+            if let Some(target) = target {{
+                duplicate |= seen[target];
+                seen[target] = true;
+            }}
+            target
+        }})
+        .collect();
+    drop(new_rows);
+    if duplicate
+        || count_runs(targets.iter().map(|t| t.is_none())) > SYNC_MAX_SIGNALS
+        || count_runs(seen.iter().map(|s| !s)) > SYNC_MAX_SIGNALS
+    {{
+        // keys are not unique or the rows changed too much, so replace all
+        if !rows.is_empty() {{
+            signal(SyncSignal::BeginRemove(0, rows.len() - 1), rows);
+            rows.clear();
+            signal(SyncSignal::EndRemove, rows);
+        }}
+        if !new.is_empty() {{
+            signal(SyncSignal::BeginInsert(0, new.len() - 1), rows);
+            *rows = new;
+            signal(SyncSignal::EndInsert, rows);
+        }}
+        return;
+    }}
+    // remove rows that are gone, back to front, one range at a time
+    let mut end = targets.len();
+    while end > 0 {{
+        if targets[end - 1].is_some() {{
+            end -= 1;
+            continue;
+        }}
+        let mut first = end - 1;
+        while first > 0 && targets[first - 1].is_none() {{
+            first -= 1;
+        }}
+        signal(SyncSignal::BeginRemove(first, end - 1), rows);
+        rows.drain(first..end);
+        signal(SyncSignal::EndRemove, rows);
+        end = first;
+    }}
+    let mut current: Vec<usize> = targets.into_iter().filter_map(|t| t).collect();
+    // rows in a longest increasing run of targets stay, the others move
+    let lis = longest_increasing(&current);
+    if current.len() - lis.len() > SYNC_MAX_SIGNALS {{
+        // order the rows by target in one pass
+        let mut by_target = vec![usize::max_value(); new.len()];
+        for (row, &target) in current.iter().enumerate() {{
+            by_target[target] = row;
+        }}
+        let old_rows: Vec<usize> = by_target
+            .into_iter()
+            .filter(|&row| row != usize::max_value())
+            .collect();
+        signal(SyncSignal::BeginLayout, rows);
+        let mut old: Vec<Option<T>> = rows.drain(..).map(Some).collect();
+        rows.extend(old_rows.iter().map(|&row| old[row].take().unwrap()));
+        signal(SyncSignal::EndLayout(&old_rows), rows);
+    }} else if current.len() > lis.len() {{
+        // at most SYNC_MAX_SIGNALS moves, each shifts the rows once
+        let mut placed = vec![false; new.len()];
+        for i in lis {{
+            placed[current[i]] = true;
+        }}
+        let mut previous: Option<usize> = None;
+        for target in 0..new.len() {{
+            if !seen[target] {{
+                continue;
+            }}
+            if !placed[target] {{
+                let from = current.iter().position(|&t| t == target).unwrap();
+                let to = previous
+                    .map(|p| current.iter().position(|&t| t == p).unwrap() + 1)
+                    .unwrap_or(0);
+                if to != from && to != from + 1 {{
+                    signal(SyncSignal::BeginMove(from, to), rows);
+                    let row = rows.remove(from);
+                    let t = current.remove(from);
+                    let to = if to > from {{ to - 1 }} else {{ to }};
+                    rows.insert(to, row);
+                    current.insert(to, t);
+                    signal(SyncSignal::EndMove, rows);
+                }}
+                placed[target] = true;
+            }}
+            previous = Some(target);
+        }}
+    }}
+    // insert new rows and update the rows that stayed; there are at most
+    // SYNC_MAX_SIGNALS inserted ranges and each shifts the rows once
+    let mut new: Vec<Option<T>> = new.into_iter().map(Some).collect();
+    let mut row = 0;
+    while row < new.len() {{
+        if seen[row] {{
+            let mut last = row;
+            while last < new.len() && seen[last] && rows[last] != *new[last].as_ref().unwrap() {{
+                rows[last] = new[last].take().unwrap();
+                last += 1;
+            }}
+            if last > row {{
+                signal(SyncSignal::Changed(row, last - 1), rows);
+                row = last;
+            }} else {{
+                row += 1;
+            }}
+            continue;
+        }}
+        let mut last = row;
+        while last + 1 < new.len() && !seen[last + 1] {{
+            last += 1;
+        }}
+        signal(SyncSignal::BeginInsert(row, last), rows);
+        let tail = rows.split_off(row);
+        rows.extend(new[row..=last].iter_mut().map(|t| t.take().unwrap()));
+        rows.extend(tail);
+        signal(SyncSignal::EndInsert, rows);
+        row = last + 1;
+    }}
+}}"
+        )?;
+    }
+
+    if !conf.proxies.is_empty() {
+        writeln!(
+            r,
+            "
+/// Sort `rows` by their `keys`. The sort is stable in both orders.
+fn sort_rows<K, F>(rows: &mut Vec<usize>, keys: Vec<K>, order: SortOrder, cmp: F)
+where
+    F: Fn(&K, &K) -> ::std::cmp::Ordering,
+{{
+    let mut keyed: Vec<(usize, K)> = rows.drain(..).zip(keys).collect();
+    if order == SortOrder::Ascending {{
+        keyed.sort_by(|a, b| cmp(&a.1, &b.1));
+    }} else {{
+        keyed.sort_by(|a, b| cmp(&b.1, &a.1));
+    }}
+    rows.extend(keyed.into_iter().map(|(row, _)| row));
+}}
+
+/// Find the position of `row` among `rows`, which do not contain it and
+/// are sorted like sort_rows() sorts them.
+fn place_row<K, G, F>(rows: &[c_int], row: usize, key: G, order: SortOrder, cmp: F) -> usize
+where
+    G: Fn(usize) -> K,
+    F: Fn(&K, &K) -> ::std::cmp::Ordering,
+{{
+    let k = key(row);
+    let (mut low, mut high) = (0, rows.len());
+    while low < high {{
+        let mid = low + (high - low) / 2;
+        let r = to_usize(rows[mid]);
+        let kr = key(r);
+        let ord = if order == SortOrder::Ascending {{
+            cmp(&kr, &k)
+        }} else {{
+            cmp(&k, &kr)
+        }};
+        // rows with equal keys keep the order of the source
+        if ord == ::std::cmp::Ordering::Less || (ord == ::std::cmp::Ordering::Equal && r < row) {{
+            low = mid + 1;
+        }} else {{
+            high = mid;
+        }}
+    }}
+    low
+}}"
+        )?;
+    }
+
+    if conf.objects.values().any(|o| o.stream) {
+        write_rust_row_stream(r)?;
+    }
+    let asynchronous = conf
+        .objects
+        .values()
+        .any(|o| o.functions.values().any(|f| f.asynchronous));
+    if asynchronous || conf.objects.values().any(|o| o.thread_pool) {
+        write_rust_thread_pool(r)?;
+    }
+    if asynchronous {
+        write_rust_requests(r)?;
+    }
+
+    if conf
+        .objects
+        .values()
+        .any(|o| o.object_type == ObjectType::Tree)
+    {
+        write_rust_tree_nodes(r)?;
+    }
+
+    if conf.objects.values().any(|o| o.storage == Storage::Mapped) {
+        write_rust_mapped_file(r)?;
+    }
+
+    if conf.objects.values().any(|o| o.page_size > 0) {
+        write_rust_row_pages(r)?;
+    }
+
+    if has_string || has_byte_array || has_list_or_tree {
+        writeln!(
+            r,
+            "
+
+fn to_usize(n: c_int) -> usize {{
+    if n < 0 {{
+        panic!(\"Cannot cast {{}} to usize\", n);
+    }}
+    n as usize
+}}
+"
+        )?;
+    }
+
+    if has_string || has_byte_array || has_list_or_tree {
+        writeln!(
+            r,
+            "
+fn to_c_int(n: usize) -> c_int {{
+    if n > c_int::max_value() as usize {{
+        panic!(\"Cannot cast {{}} to c_int\", n);
+    }}
+    n as c_int
+}}
+"
+        )?;
+    }
+    Ok(())
+}
+
+fn write_rust_tree_nodes(r: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        r,
+        "
+/// Number of bits of a tree item id that select the slot. The other bits
+/// hold the generation of the slot. On 32 bit targets the generation gets
+/// 8 bits, so a slot is retired after 255 reuses but a tree can hold 2^24
+/// items.
+#[cfg(target_pointer_width = \"64\")]
+const TREE_SLOT_BITS: usize = 32;
+#[cfg(not(target_pointer_width = \"64\"))]
+const TREE_SLOT_BITS: usize = 24;
+const TREE_SLOT_MASK: usize = (1 << TREE_SLOT_BITS) - 1;
+const TREE_MAX_GENERATION: usize = ::std::usize::MAX >> TREE_SLOT_BITS;
+
+struct TreeNode<T> {{
+    parent: Option<usize>,
+    row: usize,
+    children: Vec<usize>,
+    data: T,
+}}
+
+struct TreeSlot<T> {{
+    generation: usize,
+    node: Option<TreeNode<T>>,
+}}
+
+/// Storage for the items of a Tree model.
+///
+/// The ids of the items can be used as the ids of the Tree trait. An id
+/// holds a slot and the generation of that slot. Removing an item frees
+/// its slot for reuse and increases the generation, so an id of a removed
+/// item is never valid again.
+pub struct TreeNodes<T> {{
+    slots: Vec<TreeSlot<T>>,
+    free: Vec<usize>,
+    roots: Vec<usize>,
+    len: usize,
+}}
+
+impl<T> Default for TreeNodes<T> {{
+    fn default() -> TreeNodes<T> {{
+        TreeNodes {{
+            slots: Vec::new(),
+            free: Vec::new(),
+            roots: Vec::new(),
+            len: 0,
+        }}
+    }}
+}}
+
+impl<T> TreeNodes<T> {{
+    pub fn new() -> TreeNodes<T> {{
+        TreeNodes::default()
+    }}
+    fn node(&self, id: usize) -> Option<&TreeNode<T>> {{
+        match self.slots.get(id & TREE_SLOT_MASK) {{
+            Some(slot) if slot.generation == id >> TREE_SLOT_BITS => slot.node.as_ref(),
+            _ => None,
+        }}
+    }}
+    fn node_mut(&mut self, id: usize) -> Option<&mut TreeNode<T>> {{
+        match self.slots.get_mut(id & TREE_SLOT_MASK) {{
+            Some(slot) if slot.generation == id >> TREE_SLOT_BITS => slot.node.as_mut(),
+            _ => None,
+        }}
+    }}
+    fn siblings_mut(&mut self, parent: Option<usize>) -> &mut Vec<usize> {{
+        match parent {{
+            Some(parent) => &mut self.node_mut(parent).expect(\"invalid tree id\").children,
+            None => &mut self.roots,
+        }}
+    }}
+    /// Set the rows of the children of `parent`, starting at `first`.
+    fn update_rows(&mut self, parent: Option<usize>, first: usize) {{
+        let siblings = ::std::mem::replace(self.siblings_mut(parent), Vec::new());
+        for (row, &id) in siblings.iter().enumerate().skip(first) {{
+            self.slots[id & TREE_SLOT_MASK].node.as_mut().unwrap().row = row;
+        }}
+        *self.siblings_mut(parent) = siblings;
+    }}
+    /// Number of items in the tree.
+    pub fn len(&self) -> usize {{
+        self.len
+    }}
+    pub fn is_empty(&self) -> bool {{
+        self.len == 0
+    }}
+    /// Tell if `id` belongs to an item that has not been removed.
+    pub fn contains(&self, id: usize) -> bool {{
+        self.node(id).is_some()
+    }}
+    pub fn get(&self, id: usize) -> Option<&T> {{
+        self.node(id).map(|n| &n.data)
+    }}
+    pub fn get_mut(&mut self, id: usize) -> Option<&mut T> {{
+        self.node_mut(id).map(|n| &mut n.data)
+    }}
+    pub fn parent(&self, id: usize) -> Option<usize> {{
+        self.node(id).and_then(|n| n.parent)
+    }}
+    pub fn row(&self, id: usize) -> usize {{
+        self.node(id).map_or(0, |n| n.row)
+    }}
+    /// The row of `id`, or `None` if the item was removed.
+    pub fn check_row(&self, id: usize) -> Option<usize> {{
+        self.node(id).map(|n| n.row)
+    }}
+    /// The ids of the children of `parent`, or of the top level items.
+    pub fn children(&self, parent: Option<usize>) -> &[usize] {{
+        match parent {{
+            Some(parent) => self.node(parent).map_or(&[], |n| &n.children[..]),
+            None => &self.roots,
+        }}
+    }}
+    pub fn row_count(&self, parent: Option<usize>) -> usize {{
+        self.children(parent).len()
+    }}
+    pub fn index(&self, parent: Option<usize>, row: usize) -> usize {{
+        self.children(parent)[row]
+    }}
+    /// Add an item at `row` under `parent` and return its id.
+    pub fn insert(&mut self, parent: Option<usize>, row: usize, data: T) -> usize {{
+        let node = TreeNode {{
+            parent,
+            row,
+            children: Vec::new(),
+            data,
+        }};
+        let slot = match self.free.pop() {{
+            Some(slot) => {{
+                self.slots[slot].node = Some(node);
+                slot
+            }}
+            None => {{
+                // a larger slot would overwrite the generation bits of the id
+                assert!(
+                    self.slots.len() <= TREE_SLOT_MASK,
+                    \"TreeNodes cannot hold more than {{}} items\",
+                    TREE_SLOT_MASK + 1
+                );
+                self.slots.push(TreeSlot {{
+                    generation: 0,
+                    node: Some(node),
+                }});
+                self.slots.len() - 1
+            }}
+        }};
+        let id = self.slots[slot].generation << TREE_SLOT_BITS | slot;
+        self.siblings_mut(parent).insert(row, id);
+        self.update_rows(parent, row + 1);
+        self.len += 1;
+        id
+    }}
+    /// Remove an item and all of its descendants and return its data.
+    pub fn remove(&mut self, id: usize) -> Option<T> {{
+        let (parent, row) = match self.node(id) {{
+            Some(node) => (node.parent, node.row),
+            None => return None,
+        }};
+        self.siblings_mut(parent).remove(row);
+        self.update_rows(parent, row);
+        let node = self.free_slot(id);
+        let mut descendants = node.children;
+        while let Some(id) = descendants.pop() {{
+            descendants.extend(self.free_slot(id).children);
+        }}
+        Some(node.data)
+    }}
+    fn free_slot(&mut self, id: usize) -> TreeNode<T> {{
+        let slot = id & TREE_SLOT_MASK;
+        let s = &mut self.slots[slot];
+        // a slot whose generation is used up is not used again
+        if s.generation < TREE_MAX_GENERATION {{
+            s.generation += 1;
+            self.free.push(slot);
+        }}
+        self.len -= 1;
+        s.node.take().unwrap()
+    }}
+    /// Remove all items. Old ids stay invalid.
+    pub fn clear(&mut self) {{
+        let roots = ::std::mem::replace(&mut self.roots, Vec::new());
+        for id in roots {{
+            let node = self.free_slot(id);
+            let mut descendants = node.children;
+            while let Some(id) = descendants.pop() {{
+                descendants.extend(self.free_slot(id).children);
+            }}
+        }}
+    }}
+}}"
+    )?;
+    Ok(())
+}
+
+fn write_rust_mapped_file(r: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        r,
+        "
+/// The bytes of a file that is opened read-only.
+///
+/// On Unix the file is mapped into memory, so pages are only read when
+/// they are used. Elsewhere the file is read at once.
+pub struct MappedFile {{
+    #[cfg(unix)]
+    ptr: *mut ::libc::c_void,
+    #[cfg(unix)]
+    len: usize,
+    #[cfg(not(unix))]
+    data: Vec<u8>,
 }}
 
-#[repr(C)]
-pub struct QModelIndex {{
-    row: c_int,
-    internal_id: usize,
+// the mapping is private and read-only
+unsafe impl Send for MappedFile {{}}
+unsafe impl Sync for MappedFile {{}}
+
+#[cfg(unix)]
+impl MappedFile {{
+    pub fn open<P: AsRef<::std::path::Path>>(path: P) -> ::std::io::Result<MappedFile> {{
+        use std::os::unix::io::AsRawFd;
+        let file = ::std::fs::File::open(path)?;
+        let len = file.metadata()?.len() as usize;
+        if len == 0 {{
+            return Ok(MappedFile::empty());
+        }}
+        let ptr = unsafe {{
+            ::libc::mmap(
+                ::std::ptr::null_mut(),
+                len,
+                ::libc::PROT_READ,
+                ::libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        }};
+        if ptr == ::libc::MAP_FAILED {{
+            return Err(::std::io::Error::last_os_error());
+        }}
+        Ok(MappedFile {{ ptr, len }})
+    }}
+    pub fn empty() -> MappedFile {{
+        MappedFile {{
+            ptr: ::std::ptr::null_mut(),
+            len: 0,
+        }}
+    }}
+    pub fn bytes(&self) -> &[u8] {{
+        if self.len == 0 {{
+            return &[];
+        }}
+        unsafe {{ slice::from_raw_parts(self.ptr as *const u8, self.len) }}
+    }}
+}}
+
+#[cfg(unix)]
+impl Drop for MappedFile {{
+    fn drop(&mut self) {{
+        if self.len > 0 {{
+            unsafe {{
+                ::libc::munmap(self.ptr, self.len);
+            }}
+        }}
+    }}
+}}
+
+#[cfg(not(unix))]
+impl MappedFile {{
+    pub fn open<P: AsRef<::std::path::Path>>(path: P) -> ::std::io::Result<MappedFile> {{
+        Ok(MappedFile {{
+            data: ::std::fs::read(path)?,
+        }})
+    }}
+    pub fn empty() -> MappedFile {{
+        MappedFile {{ data: Vec::new() }}
+    }}
+    pub fn bytes(&self) -> &[u8] {{
+        &self.data
+    }}
+}}
+
+/// The number of records in a mapped file, or `None` if the file is too
+/// small for the number of records in its header.
+fn mapped_rows(bytes: &[u8], record_size: usize) -> Option<usize> {{
+    if bytes.is_empty() {{
+        return Some(0);
+    }}
+    if bytes.len() < 8 {{
+        return None;
+    }}
+    let mut rows = [0u8; 8];
+    rows.copy_from_slice(&bytes[..8]);
+    let rows = u64::from_le_bytes(rows);
+    if rows > ::std::usize::MAX as u64 {{
+        return None;
+    }}
+    let rows = rows as usize;
+    let size = rows.checked_mul(record_size)?.checked_add(8)?;
+    if size <= bytes.len() {{
+        Some(rows)
+    }} else {{
+        None
+    }}
+}}
+
+/// The bytes to which a string field of a record refers. A field that
+/// points outside of the file gives no bytes.
+fn mapped_slice<'a>(bytes: &'a [u8], field: &[u8]) -> &'a [u8] {{
+    let mut offset = [0u8; 8];
+    offset.copy_from_slice(&field[..8]);
+    let mut len = [0u8; 4];
+    len.copy_from_slice(&field[8..12]);
+    let start = u64::from_le_bytes(offset);
+    let end = start.saturating_add(u64::from(u32::from_le_bytes(len)));
+    if end > bytes.len() as u64 {{
+        return &[];
+    }}
+    &bytes[start as usize..end as usize]
 }}"
-        )?;
-    }
+    )?;
+    Ok(())
+}
 
-    if has_string || has_byte_array || has_list_or_tree {
-        writeln!(
-            r,
-            "
+fn write_rust_row_pages(r: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        r,
+        "
+/// The pages of a paged List that were requested most recently.
+///
+/// A page is stored with its first row. When more than `capacity` pages
+/// are requested, the page that was used least recently is dropped.
+pub struct RowPages<T> {{
+    capacity: usize,
+    /// The page that was requested last is at the end.
+    pages: Vec<(usize, Vec<T>)>,
+}}
 
-fn to_usize(n: c_int) -> usize {{
-    if n < 0 {{
-        panic!(\"Cannot cast {{}} to usize\", n);
+impl<T> RowPages<T> {{
+    pub fn new(capacity: usize) -> RowPages<T> {{
+        RowPages {{
+            capacity: capacity.max(1),
+            pages: Vec::new(),
+        }}
     }}
-    n as usize
+    /// Keep the page that starts at `first`. When it is not kept yet, or
+    /// was kept with a different number of rows, `load` is called to read
+    /// the rows from `first` to `last`.
+    pub fn request<F>(&mut self, first: usize, last: usize, load: F)
+    where
+        F: FnOnce(usize, usize) -> Vec<T>,
+    {{
+        if let Some(pos) = self.pages.iter().position(|p| p.0 == first) {{
+            let page = self.pages.remove(pos);
+            if page.1.len() == last + 1 - first {{
+                self.pages.push(page);
+                return;
+            }}
+        }}
+        if self.pages.len() == self.capacity {{
+            self.pages.remove(0);
+        }}
+        self.pages.push((first, load(first, last)));
+    }}
+    /// Get a row from a page that is kept.
+    pub fn get(&self, row: usize) -> Option<&T> {{
+        self.pages
+            .iter()
+            .rev()
+            .find(|p| p.0 <= row && row - p.0 < p.1.len())
+            .map(|p| &p.1[row - p.0])
+    }}
+    pub fn get_mut(&mut self, row: usize) -> Option<&mut T> {{
+        self.pages
+            .iter_mut()
+            .rev()
+            .find(|p| p.0 <= row && row - p.0 < p.1.len())
+            .map(|p| &mut p.1[row - p.0])
+    }}
+    /// The number of pages that are kept.
+    pub fn len(&self) -> usize {{
+        self.pages.len()
+    }}
+    pub fn is_empty(&self) -> bool {{
+        self.pages.is_empty()
+    }}
+    /// Drop all pages, e.g. when the rows change.
+    pub fn clear(&mut self) {{
+        self.pages.clear();
+    }}
+}}"
+    )?;
+    Ok(())
+}
+
+fn write_rust_row_stream(r: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        r,
+        "
+/// Bounded single-producer single-consumer queue of rows.
+///
+/// `tail` is only written by the producer and `head` only by the consumer.
+/// Both count up and are masked to find the slot.
+struct RowRing<T> {{
+    slots: Box<[::std::cell::UnsafeCell<::std::mem::MaybeUninit<T>>]>,
+    mask: usize,
+    head: ::std::sync::atomic::AtomicUsize,
+    tail: ::std::sync::atomic::AtomicUsize,
+    /// Set when the consumer has been woken and has not drained yet.
+    woken: ::std::sync::atomic::AtomicBool,
 }}
-"
-        )?;
-    }
 
-    if has_string || has_byte_array || has_list_or_tree {
-        writeln!(
-            r,
-            "
-fn to_c_int(n: usize) -> c_int {{
-    if n > c_int::max_value() as usize {{
-        panic!(\"Cannot cast {{}} to c_int\", n);
+unsafe impl<T: Send> Sync for RowRing<T> {{}}
+
+impl<T> Drop for RowRing<T> {{
+    fn drop(&mut self) {{
+        let tail = self.tail.load(Ordering::Relaxed);
+        let mut head = self.head.load(Ordering::Relaxed);
+        while head != tail {{
+            unsafe {{
+                drop((*self.slots[head & self.mask].get()).as_ptr().read());
+            }}
+            head = head.wrapping_add(1);
+        }}
     }}
-    n as c_int
 }}
-"
-        )?;
-    }
+
+/// The sending half of a row stream. It can be moved to a worker thread.
+pub struct RowProducer<T> {{
+    ring: Arc<RowRing<T>>,
+    wake: Box<dyn FnMut() + Send>,
+}}
+
+impl<T> RowProducer<T> {{
+    /// Queue a row. If the stream is full, the row is given back.
+    ///
+    /// The model is woken only for the first row after it drained the
+    /// stream, so a fast producer causes one wake per event loop pass.
+    pub fn push(&mut self, row: T) -> Result<(), T> {{
+        let ring = &*self.ring;
+        let tail = ring.tail.load(Ordering::Relaxed);
+        if tail.wrapping_sub(ring.head.load(Ordering::Acquire)) == ring.slots.len() {{
+            return Err(row);
+        }}
+        unsafe {{
+            (*ring.slots[tail & ring.mask].get()).as_mut_ptr().write(row);
+        }}
+        ring.tail.store(tail.wrapping_add(1), Ordering::SeqCst);
+        if !ring.woken.swap(true, Ordering::SeqCst) {{
+            (self.wake)();
+        }}
+        Ok(())
+    }}
+    pub fn capacity(&self) -> usize {{
+        self.ring.slots.len()
+    }}
+}}
+
+/// The receiving half of a row stream. It is owned by the model.
+pub struct RowConsumer<T> {{
+    ring: Arc<RowRing<T>>,
+}}
+
+impl<T> RowConsumer<T> {{
+    /// Number of rows that can be taken. Rows that are pushed after this
+    /// call wake the model again.
+    pub fn ready(&mut self) -> usize {{
+        let ring = &*self.ring;
+        ring.woken.store(false, Ordering::SeqCst);
+        ring.tail
+            .load(Ordering::SeqCst)
+            .wrapping_sub(ring.head.load(Ordering::Relaxed))
+    }}
+    /// Pass `n` rows to `f` in the order in which they were pushed.
+    /// `n` must not be larger than the last value of `ready()`.
+    pub fn take<F: FnMut(T)>(&mut self, n: usize, mut f: F) {{
+        let ring = &*self.ring;
+        let head = ring.head.load(Ordering::Relaxed);
+        assert!(n <= ring.tail.load(Ordering::Acquire).wrapping_sub(head));
+        for i in 0..n {{
+            let slot = ring.slots[head.wrapping_add(i) & ring.mask].get();
+            f(unsafe {{ (*slot).as_ptr().read() }});
+        }}
+        ring.head.store(head.wrapping_add(n), Ordering::Release);
+    }}
+}}
+
+fn row_stream<T>(capacity: usize, wake: Box<dyn FnMut() + Send>) -> (RowProducer<T>, RowConsumer<T>) {{
+    let capacity = capacity.max(1).next_power_of_two();
+    let slots = (0..capacity)
+        .map(|_| ::std::cell::UnsafeCell::new(::std::mem::MaybeUninit::uninit()))
+        .collect();
+    let ring = Arc::new(RowRing {{
+        slots,
+        mask: capacity - 1,
+        head: ::std::sync::atomic::AtomicUsize::new(0),
+        tail: ::std::sync::atomic::AtomicUsize::new(0),
+        woken: ::std::sync::atomic::AtomicBool::new(false),
+    }});
+    (RowProducer {{ ring: ring.clone(), wake }}, RowConsumer {{ ring }})
+}}"
+    )?;
+    Ok(())
+}
+
+fn write_rust_requests(r: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        r,
+        "
+static REQUESTS: ::std::sync::atomic::AtomicU64 = ::std::sync::atomic::AtomicU64::new(0);
+
+/// Number that identifies a call of an async function in its signal.
+fn next_request() -> u64 {{
+    REQUESTS.fetch_add(1, Ordering::SeqCst) + 1
+}}"
+    )?;
+    Ok(())
+}
+
+fn write_rust_thread_pool(r: &mut Vec<u8>) -> Result<()> {
+    writeln!(
+        r,
+        "
+type Job = Box<dyn FnOnce() + Send>;
+
+thread_local! {{
+    static WORKER: ::std::cell::Cell<Option<usize>> = ::std::cell::Cell::new(None);
+}}
+
+/// A pool of threads that is shared by all objects.
+///
+/// There is one thread per core. Every thread has its own queue. A job that
+/// is spawned from a job goes to the queue of its thread; other jobs go to
+/// a shared queue. A thread runs the newest job of its own queue, then the
+/// oldest job of the shared queue and otherwise steals the oldest job of
+/// another thread.
+pub struct ThreadPool {{
+    shared: ::std::sync::Mutex<::std::collections::VecDeque<Job>>,
+    queues: Vec<::std::sync::Mutex<::std::collections::VecDeque<Job>>>,
+    pending: ::std::sync::Mutex<usize>,
+    wake: ::std::sync::Condvar,
+}}
+
+impl ThreadPool {{
+    /// The pool. The threads are started on the first call.
+    pub fn global() -> &'static ThreadPool {{
+        static POOL: AtomicPtr<ThreadPool> = AtomicPtr::new(0 as *mut ThreadPool);
+        static START: ::std::sync::Once = ::std::sync::Once::new();
+        START.call_once(|| {{
+            let threads = ::std::thread::available_parallelism().map_or(2, |n| n.get());
+            let pool: &'static ThreadPool = Box::leak(Box::new(ThreadPool {{
+                shared: ::std::sync::Mutex::new(::std::collections::VecDeque::new()),
+                queues: (0..threads)
+                    .map(|_| ::std::sync::Mutex::new(::std::collections::VecDeque::new()))
+                    .collect(),
+                pending: ::std::sync::Mutex::new(0),
+                wake: ::std::sync::Condvar::new(),
+            }}));
+            for worker in 0..threads {{
+                ::std::thread::spawn(move || pool.run(worker));
+            }}
+            POOL.store(pool as *const ThreadPool as *mut ThreadPool, Ordering::SeqCst);
+        }});
+        unsafe {{ &*POOL.load(Ordering::SeqCst) }}
+    }}
+    pub fn threads(&self) -> usize {{
+        self.queues.len()
+    }}
+    pub fn spawn<F>(&self, job: F)
+    where
+        F: FnOnce() + Send + 'static,
+    {{
+        let job: Job = Box::new(job);
+        match WORKER.with(|w| w.get()) {{
+            Some(worker) => self.queues[worker].lock().unwrap().push_back(job),
+            None => self.shared.lock().unwrap().push_back(job),
+        }}
+        *self.pending.lock().unwrap() += 1;
+        self.wake.notify_one();
+    }}
+    fn find_job(&self, worker: usize) -> Option<Job> {{
+        if let Some(job) = self.queues[worker].lock().unwrap().pop_back() {{
+            return Some(job);
+        }}
+        if let Some(job) = self.shared.lock().unwrap().pop_front() {{
+            return Some(job);
+        }}
+        let n = self.queues.len();
+        (1..n).find_map(|i| self.queues[(worker + i) % n].lock().unwrap().pop_front())
+    }}
+    fn run(&self, worker: usize) {{
+        WORKER.with(|w| w.set(Some(worker)));
+        loop {{
+            {{
+                let mut pending = self.pending.lock().unwrap();
+                while *pending == 0 {{
+                    pending = self.wake.wait(pending).unwrap();
+                }}
+                *pending -= 1;
+            }}
+            // one job is reserved for this thread, so a queue has a job
+            loop {{
+                if let Some(job) = self.find_job(worker) {{
+                    // a panic ends the job, not the thread
+                    let _ = ::std::panic::catch_unwind(::std::panic::AssertUnwindSafe(job));
+                    break;
+                }}
+                ::std::thread::yield_now();
+            }}
+        }}
+    }}
+}}
+
+struct Generation {{
+    current: ::std::sync::atomic::AtomicUsize,
+    finish: ::std::sync::Mutex<()>,
+}}
+
+impl Generation {{
+    /// Lock out other tokens. The lock holds no data, so it is still good
+    /// after `f` in `finish` panicked.
+    fn lock(&self) -> ::std::sync::MutexGuard<'_, ()> {{
+        self.finish.lock().unwrap_or_else(|e| e.into_inner())
+    }}
+}}
+
+/// Hands out cancellation tokens. A new token cancels all earlier ones.
+#[derive(Clone)]
+pub struct Generations {{
+    generation: Arc<Generation>,
+}}
+
+impl Generations {{
+    pub fn new() -> Generations {{
+        Generations {{
+            generation: Arc::new(Generation {{
+                current: ::std::sync::atomic::AtomicUsize::new(0),
+                finish: ::std::sync::Mutex::new(()),
+            }}),
+        }}
+    }}
+    /// Cancel the earlier tokens and return a new one.
+    pub fn next(&self) -> CancelToken {{
+        let _finish = self.generation.lock();
+        let value = self.generation.current.fetch_add(1, Ordering::SeqCst) + 1;
+        CancelToken {{
+            generation: self.generation.clone(),
+            value,
+        }}
+    }}
+    /// Cancel all tokens.
+    pub fn cancel(&self) {{
+        let _finish = self.generation.lock();
+        self.generation.current.fetch_add(1, Ordering::SeqCst);
+    }}
+}}
+
+impl Default for Generations {{
+    fn default() -> Generations {{
+        Generations::new()
+    }}
+}}
+
+/// Tells a computation if a newer one has replaced it.
+#[derive(Clone)]
+pub struct CancelToken {{
+    generation: Arc<Generation>,
+    value: usize,
+}}
+
+impl CancelToken {{
+    pub fn is_cancelled(&self) -> bool {{
+        self.generation.current.load(Ordering::SeqCst) != self.value
+    }}
+    /// Call `f` if the token is not cancelled, e.g. to store a result and
+    /// emit a signal. A newer token is handed out only after `f` returns,
+    /// so an old result never replaces a newer one.
+    pub fn finish<F: FnOnce()>(&self, f: F) -> bool {{
+        let _finish = self.generation.lock();
+        if self.is_cancelled() {{
+            return false;
+        }}
+        f();
+        true
+    }}
+}}"
+    )?;
     Ok(())
 }
 
@@ -1306,11 +3899,7 @@ use {}{}::*;",
 
     writeln!(
         r,
-        "
-extern \"C\" {{
-    pub fn qmetaobject__invokeMethod__0(obj: *const std::ffi::c_void, member: *const c_char);
-}}
-"
+        ""
     )?;
 
     write_rust_types(conf, &mut r)?;
@@ -1318,6 +3907,9 @@ extern \"C\" {{
     for object in conf.objects.values() {
         write_rust_interface_object(&mut r, object, conf)?;
     }
+    for proxy in conf.proxies.values() {
+        write_rust_proxy(&mut r, proxy)?;
+    }
     let mut file = conf
         .config_file
         .parent()
@@ -1330,21 +3922,14 @@ extern \"C\" {{
 }
 
 fn write_rust_implementation_object(r: &mut Vec<u8>, o: &Object) -> Result<()> {
-    if o.object_type != ObjectType::Object {
+    let columnar = o.storage == Storage::Columnar;
+    let mapped = o.storage == Storage::Mapped;
+    if o.object_type != ObjectType::Object && !columnar && !mapped {
         writeln!(r, "#[derive(Default, Clone)]")?;
         writeln!(r, "struct {}Item {{", o.name)?;
         for (name, ip) in &o.item_properties {
             let lc = snake_case(name);
-            if ip.optional {
-                writeln!(
-                    r,
-                    "    {}: Option<{}>,",
-                    lc,
-                    ip.item_property_type.rust_type()
-                )?;
-            } else {
-                writeln!(r, "    {}: {},", lc, ip.item_property_type.rust_type())?;
-            }
+            writeln!(r, "    {}: {},", lc, rust_type_(ip))?;
         }
         writeln!(r, "}}\n")?;
     }
@@ -1361,7 +3946,11 @@ fn write_rust_implementation_object(r: &mut Vec<u8>, o: &Object) -> Result<()> {
         let lc = snake_case(name);
         writeln!(r, "    {}: {},", lc, rust_type(p))?;
     }
-    if o.object_type != ObjectType::Object {
+    if columnar {
+        writeln!(r, "    columns: {}Columns,", o.name)?;
+    } else if mapped {
+        writeln!(r, "    records: {}Records,", o.name)?;
+    } else if o.object_type != ObjectType::Object {
         writeln!(r, "    list: Vec<{}Item>,", o.name)?;
     }
     writeln!(r, "}}\n")?;
@@ -1380,7 +3969,13 @@ fn write_rust_implementation_object(r: &mut Vec<u8>, o: &Object) -> Result<()> {
     )?;
     if o.object_type != ObjectType::Object {
         writeln!(r, "            model,")?;
-        writeln!(r, "            list: Vec::new(),")?;
+        if columnar {
+            writeln!(r, "            columns: {}Columns::new(),", o.name)?;
+        } else if mapped {
+            writeln!(r, "            records: {}Records::empty(),", o.name)?;
+        } else {
+            writeln!(r, "            list: Vec::new(),")?;
+        }
     }
     for (name, p) in &o.properties {
         let lc = snake_case(name);
@@ -1460,8 +4055,21 @@ fn write_rust_implementation_object(r: &mut Vec<u8>, o: &Object) -> Result<()> {
     if o.object_type == ObjectType::List {
         writeln!(
             r,
-            "    fn row_count(&self) -> usize {{\n        self.list.len()\n    }}"
+            "    fn row_count(&self) -> usize {{\n        self.{}.len()\n    }}",
+            if columnar {
+                "columns"
+            } else if mapped {
+                "records"
+            } else {
+                "list"
+            }
         )?;
+        if o.page_size > 0 {
+            writeln!(
+                r,
+                "    fn request_rows(&mut self, first: usize, last: usize) {{}}"
+            )?;
+        }
     } else if o.object_type == ObjectType::Tree {
         writeln!(
             r,
@@ -1489,52 +4097,85 @@ fn write_rust_implementation_object(r: &mut Vec<u8>, o: &Object) -> Result<()> {
     if o.object_type != ObjectType::Object {
         for (name, ip) in &o.item_properties {
             let lc = snake_case(name);
+            if mapped {
+                writeln!(
+                    r,
+                    "    fn {0}(&self, index: usize) -> {1} {{
+        self.records.{0}(index)
+    }}",
+                    lc,
+                    rust_return_type_(ip)
+                )?;
+                continue;
+            }
+            let (value, value_mut) = if columnar {
+                (
+                    format!("self.columns.{}()[index]", lc),
+                    format!("self.columns.{}_mut()[index]", lc),
+                )
+            } else {
+                let value = format!("self.list[index].{}", lc);
+                (value.clone(), value)
+            };
             writeln!(
                 r,
                 "    fn {}(&self, index: usize) -> {} {{",
                 lc,
                 rust_return_type_(ip)
             )?;
-            if ip.is_complex() && ip.optional {
+            if ip.rust_by_arc {
+                writeln!(r, "        {}[..].into()", value)?;
+            } else if ip.is_complex() && ip.optional {
                 writeln!(
                     r,
-                    "        self.list[index].{}.as_ref().map(|v| &v[..])",
-                    lc
+                    "        {}.as_ref().map(|v| &v[..])",
+                    value
                 )?;
             } else if ip.is_complex() {
-                writeln!(r, "        &self.list[index].{}", lc)?;
+                writeln!(r, "        &{}", value)?;
             } else {
-                writeln!(r, "        self.list[index].{}", lc)?;
+                writeln!(r, "        {}", value)?;
             }
             writeln!(r, "    }}")?;
+            if columnar && ip.is_numeric() {
+                writeln!(
+                    r,
+                    "    fn {0}_column(&self, first: usize, column: &mut [{1}]) {{
+        column.copy_from_slice(&self.columns.{0}()[first..first + column.len()]);
+    }}",
+                    lc,
+                    ip.rust_type()
+                )?;
+            }
             let bytearray = ip.item_property_type == SimpleType::QByteArray;
             if ip.write && bytearray && ip.optional {
                 writeln!(
                     r,
                     "    fn set_{}(&mut self, index: usize, v: Option<&[u8]>) -> bool {{
-        self.list[index].{0} = v.map(|v| v.to_vec());
+        {} = v.map(|v| v.to_vec());
         true
     }}",
-                    lc
+                    lc, value_mut
                 )?;
             } else if ip.write && bytearray {
                 writeln!(
                     r,
                     "    fn set_{}(&mut self, index: usize, v: &[u8]) -> bool {{
-        self.list[index].{0} = v.to_vec();
+        {} = v.to_vec();
         true
     }}",
-                    lc
+                    lc, value_mut
                 )?;
             } else if ip.write {
                 writeln!(
                     r,
                     "    fn set_{}(&mut self, index: usize, v: {}) -> bool {{
-        self.list[index].{0} = v;
+        {} = v;
         true
     }}",
                     lc,
-                    rust_type_(ip)
+                    rust_type_(ip),
+                    value_mut
                 )?;
             }
         }
@@ -1564,10 +4205,19 @@ pub fn write_implementation(conf: &Config) -> Result<()> {
 #![allow(unused_variables)]
 #![allow(dead_code)]
 #![allow(unused_unit)]
-use {}{}::*;
+use {}{}::*;{}
 ",
         get_module_prefix(conf),
-        conf.rust.interface_module
+        conf.rust.interface_module,
+        if conf
+            .objects
+            .values()
+            .any(|o| o.item_properties.values().any(|ip| ip.rust_by_arc))
+        {
+            "\nuse std::sync::Arc;"
+        } else {
+            ""
+        }
     )?;
 
     for object in conf.objects.values() {
@@ -17,3 +17,7 @@ pub fn snake_case(name: &str) -> String {
     let re = Regex::new("([A-Z])").unwrap();
     (name[..1].to_string() + &re.replace_all(&name[1..], "_$1")).to_lowercase()
 }
+
+pub fn upper_initial(name: &str) -> String {
+    format!("{}{}", &name[..1].to_uppercase(), &name[1..])
+}
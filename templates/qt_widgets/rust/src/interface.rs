@@ -10,14 +10,39 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -42,7 +67,7 @@ pub struct SimpleQObject {}
 
 pub struct SimpleEmitter {
     qobject: Arc<AtomicPtr<SimpleQObject>>,
-    message_changed: fn(*mut SimpleQObject),
+    message_changed: extern fn(*mut SimpleQObject),
 }
 
 unsafe impl Send for SimpleEmitter {}
@@ -82,7 +107,7 @@ pub trait SimpleTrait {
 #[no_mangle]
 pub extern "C" fn simple_new(
     simple: *mut SimpleQObject,
-    simple_message_changed: fn(*mut SimpleQObject),
+    simple_message_changed: extern fn(*mut SimpleQObject),
 ) -> *mut Simple {
     let simple_emit = SimpleEmitter {
         qobject: Arc::new(AtomicPtr::new(simple)),
@@ -101,7 +126,7 @@ pub unsafe extern "C" fn simple_free(ptr: *mut Simple) {
 pub unsafe extern "C" fn simple_message_get(
     ptr: *const Simple,
     p: *mut QString,
-    set: fn(*mut QString, *const c_char, c_int),
+    set: extern fn(*mut QString, *const c_char, c_int),
 ) {
     let o = &*ptr;
     let v = o.message();
@@ -2,6 +2,7 @@
 #![allow(unused_variables)]
 #![allow(dead_code)]
 use interface::*;
+use std::thread;
 
 pub struct Person {
     emit: PersonEmitter,
@@ -36,10 +37,25 @@ impl PersonTrait for Person {
         }
     }
 
+    fn append_vowels_later(&mut self) {
+        let mut emit = self.emit.clone();
+        thread::spawn(move || {
+            let vowels = emit.invoke_vowels_in_name().recv().unwrap();
+            emit.invoke_append(vowels.to_string(), 1);
+        });
+    }
+
     fn greet(&self, name: String) -> String {
         format!("Hello {}, my name is {}, how is it going?", name, self.user_name)
     }
 
+    fn greet_later(&self, name: String) -> Box<dyn FnOnce() -> String + Send> {
+        let user_name = self.user_name.clone();
+        Box::new(move || {
+            format!("Hello {}, my name is {}, how is it going?", name, user_name)
+        })
+    }
+
     fn vowels_in_name(&self) -> u8 {
         self.user_name.chars().fold(0, |count, ch| match ch {
             'a'|'e'|'i'|'o'|'u' => count + 1,
@@ -50,6 +66,10 @@ impl PersonTrait for Person {
     fn quote(&self, prefix: String, suffix: String) -> String {
         format!("{}{}{}", prefix, self.user_name, suffix)
     }
+    fn starts_with(&self, prefix: &[u16]) -> bool {
+        let mut name = self.user_name.encode_utf16();
+        prefix.iter().all(|c| name.next() == Some(*c))
+    }
     fn quote_bytes(&self, prefix: &[u8], suffix: &[u8]) -> Vec<u8> {
         let prefix = String::from_utf8_lossy(prefix);
         let suffix = String::from_utf8_lossy(suffix);
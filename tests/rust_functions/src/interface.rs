@@ -10,20 +10,216 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
 
 pub enum QByteArray {}
 
+type Job = Box<dyn FnOnce() + Send>;
+
+thread_local! {
+    static WORKER: ::std::cell::Cell<Option<usize>> = ::std::cell::Cell::new(None);
+}
+
+/// A pool of threads that is shared by all objects.
+///
+/// There is one thread per core. Every thread has its own queue. A job that
+/// is spawned from a job goes to the queue of its thread; other jobs go to
+/// a shared queue. A thread runs the newest job of its own queue, then the
+/// oldest job of the shared queue and otherwise steals the oldest job of
+/// another thread.
+pub struct ThreadPool {
+    shared: ::std::sync::Mutex<::std::collections::VecDeque<Job>>,
+    queues: Vec<::std::sync::Mutex<::std::collections::VecDeque<Job>>>,
+    pending: ::std::sync::Mutex<usize>,
+    wake: ::std::sync::Condvar,
+}
+
+impl ThreadPool {
+    /// The pool. The threads are started on the first call.
+    pub fn global() -> &'static ThreadPool {
+        static POOL: AtomicPtr<ThreadPool> = AtomicPtr::new(0 as *mut ThreadPool);
+        static START: ::std::sync::Once = ::std::sync::Once::new();
+        START.call_once(|| {
+            let threads = ::std::thread::available_parallelism().map_or(2, |n| n.get());
+            let pool: &'static ThreadPool = Box::leak(Box::new(ThreadPool {
+                shared: ::std::sync::Mutex::new(::std::collections::VecDeque::new()),
+                queues: (0..threads)
+                    .map(|_| ::std::sync::Mutex::new(::std::collections::VecDeque::new()))
+                    .collect(),
+                pending: ::std::sync::Mutex::new(0),
+                wake: ::std::sync::Condvar::new(),
+            }));
+            for worker in 0..threads {
+                ::std::thread::spawn(move || pool.run(worker));
+            }
+            POOL.store(pool as *const ThreadPool as *mut ThreadPool, Ordering::SeqCst);
+        });
+        unsafe { &*POOL.load(Ordering::SeqCst) }
+    }
+    pub fn threads(&self) -> usize {
+        self.queues.len()
+    }
+    pub fn spawn<F>(&self, job: F)
+    where
+        F: FnOnce() + Send + 'static,
+    {
+        let job: Job = Box::new(job);
+        match WORKER.with(|w| w.get()) {
+            Some(worker) => self.queues[worker].lock().unwrap().push_back(job),
+            None => self.shared.lock().unwrap().push_back(job),
+        }
+        *self.pending.lock().unwrap() += 1;
+        self.wake.notify_one();
+    }
+    fn find_job(&self, worker: usize) -> Option<Job> {
+        if let Some(job) = self.queues[worker].lock().unwrap().pop_back() {
+            return Some(job);
+        }
+        if let Some(job) = self.shared.lock().unwrap().pop_front() {
+            return Some(job);
+        }
+        let n = self.queues.len();
+        (1..n).find_map(|i| self.queues[(worker + i) % n].lock().unwrap().pop_front())
+    }
+    fn run(&self, worker: usize) {
+        WORKER.with(|w| w.set(Some(worker)));
+        loop {
+            {
+                let mut pending = self.pending.lock().unwrap();
+                while *pending == 0 {
+                    pending = self.wake.wait(pending).unwrap();
+                }
+                *pending -= 1;
+            }
+            // one job is reserved for this thread, so a queue has a job
+            loop {
+                if let Some(job) = self.find_job(worker) {
+                    // a panic ends the job, not the thread
+                    let _ = ::std::panic::catch_unwind(::std::panic::AssertUnwindSafe(job));
+                    break;
+                }
+                ::std::thread::yield_now();
+            }
+        }
+    }
+}
+
+struct Generation {
+    current: ::std::sync::atomic::AtomicUsize,
+    finish: ::std::sync::Mutex<()>,
+}
+
+impl Generation {
+    /// Lock out other tokens. The lock holds no data, so it is still good
+    /// after `f` in `finish` panicked.
+    fn lock(&self) -> ::std::sync::MutexGuard<'_, ()> {
+        self.finish.lock().unwrap_or_else(|e| e.into_inner())
+    }
+}
+
+/// Hands out cancellation tokens. A new token cancels all earlier ones.
+#[derive(Clone)]
+pub struct Generations {
+    generation: Arc<Generation>,
+}
+
+impl Generations {
+    pub fn new() -> Generations {
+        Generations {
+            generation: Arc::new(Generation {
+                current: ::std::sync::atomic::AtomicUsize::new(0),
+                finish: ::std::sync::Mutex::new(()),
+            }),
+        }
+    }
+    /// Cancel the earlier tokens and return a new one.
+    pub fn next(&self) -> CancelToken {
+        let _finish = self.generation.lock();
+        let value = self.generation.current.fetch_add(1, Ordering::SeqCst) + 1;
+        CancelToken {
+            generation: self.generation.clone(),
+            value,
+        }
+    }
+    /// Cancel all tokens.
+    pub fn cancel(&self) {
+        let _finish = self.generation.lock();
+        self.generation.current.fetch_add(1, Ordering::SeqCst);
+    }
+}
+
+impl Default for Generations {
+    fn default() -> Generations {
+        Generations::new()
+    }
+}
+
+/// Tells a computation if a newer one has replaced it.
+#[derive(Clone)]
+pub struct CancelToken {
+    generation: Arc<Generation>,
+    value: usize,
+}
+
+impl CancelToken {
+    pub fn is_cancelled(&self) -> bool {
+        self.generation.current.load(Ordering::SeqCst) != self.value
+    }
+    /// Call `f` if the token is not cancelled, e.g. to store a result and
+    /// emit a signal. A newer token is handed out only after `f` returns,
+    /// so an old result never replaces a newer one.
+    pub fn finish<F: FnOnce()>(&self, f: F) -> bool {
+        let _finish = self.generation.lock();
+        if self.is_cancelled() {
+            return false;
+        }
+        f();
+        true
+    }
+}
+
+static REQUESTS: ::std::sync::atomic::AtomicU64 = ::std::sync::atomic::AtomicU64::new(0);
+
+/// Number that identifies a call of an async function in its signal.
+fn next_request() -> u64 {
+    REQUESTS.fetch_add(1, Ordering::SeqCst) + 1
+}
+
 
 fn to_usize(n: c_int) -> usize {
     if n < 0 {
@@ -41,11 +237,32 @@ fn to_c_int(n: usize) -> c_int {
 }
 
 
+extern "C" {
+    fn person_greet_later_finished(o: *mut ::std::ffi::c_void, request: u64, result: *const c_char, len: c_int);
+}
+
+extern "C" {
+    fn person_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Person that was made on another thread.
+enum PersonCommand {
+    Append(String, u32),
+    AppendVowelsLater,
+    DoubleName,
+    Greet(String, ::std::sync::mpsc::SyncSender<String>),
+    Quote(String, String, ::std::sync::mpsc::SyncSender<String>),
+    QuoteBytes(Vec<u8>, Vec<u8>, ::std::sync::mpsc::SyncSender<Vec<u8>>),
+    StartsWith(Vec<u16>, ::std::sync::mpsc::SyncSender<bool>),
+    VowelsInName(::std::sync::mpsc::SyncSender<u8>),
+}
+
 pub struct PersonQObject {}
 
 pub struct PersonEmitter {
     qobject: Arc<AtomicPtr<PersonQObject>>,
     user_name_changed: extern fn(*mut PersonQObject),
+    commands: Arc<::std::sync::Mutex<Vec<PersonCommand>>>,
 }
 
 unsafe impl Send for PersonEmitter {}
@@ -61,11 +278,14 @@ impl PersonEmitter {
         PersonEmitter {
             qobject: self.qobject.clone(),
             user_name_changed: self.user_name_changed,
+            commands: self.commands.clone(),
         }
     }
     fn clear(&self) {
         let n: *const PersonQObject = null();
         self.qobject.store(n as *mut PersonQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
     }
     pub fn user_name_changed(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
@@ -73,6 +293,98 @@ impl PersonEmitter {
             (self.user_name_changed)(ptr);
         }
     }
+    fn greet_later_finished(&mut self, request: u64, result: String) {
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {
+            unsafe { person_greet_later_finished(ptr as *mut ::std::ffi::c_void, request, result.as_ptr() as *const c_char, to_c_int(result.len())) };
+        }
+    }
+    /// Call `append` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_append(&mut self, suffix: String, amount: u32) {
+        self.command(PersonCommand::Append(suffix, amount));
+    }
+    /// Call `append_vowels_later` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_append_vowels_later(&mut self) {
+        self.command(PersonCommand::AppendVowelsLater);
+    }
+    /// Call `double_name` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_double_name(&mut self) {
+        self.command(PersonCommand::DoubleName);
+    }
+    /// Call `greet` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_greet(&mut self, name: String) -> ::std::sync::mpsc::Receiver<String> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(PersonCommand::Greet(name, sender));
+        receiver
+    }
+    /// Call `quote` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_quote(&mut self, prefix: String, suffix: String) -> ::std::sync::mpsc::Receiver<String> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(PersonCommand::Quote(prefix, suffix, sender));
+        receiver
+    }
+    /// Call `quote_bytes` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_quote_bytes(&mut self, prefix: Vec<u8>, suffix: Vec<u8>) -> ::std::sync::mpsc::Receiver<Vec<u8>> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(PersonCommand::QuoteBytes(prefix, suffix, sender));
+        receiver
+    }
+    /// Call `starts_with` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_starts_with(&mut self, prefix: Vec<u16>) -> ::std::sync::mpsc::Receiver<bool> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(PersonCommand::StartsWith(prefix, sender));
+        receiver
+    }
+    /// Call `vowels_in_name` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_vowels_in_name(&mut self) -> ::std::sync::mpsc::Receiver<u8> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(PersonCommand::VowelsInName(sender));
+        receiver
+    }
+    fn command(&mut self, command: PersonCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { person_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
 }
 
 pub trait PersonTrait {
@@ -81,10 +393,13 @@ pub trait PersonTrait {
     fn user_name(&self) -> &str;
     fn set_user_name(&mut self, value: String);
     fn append(&mut self, suffix: String, amount: u32) -> ();
+    fn append_vowels_later(&mut self) -> ();
     fn double_name(&mut self) -> ();
     fn greet(&self, name: String) -> String;
+    fn greet_later(&self, name: String) -> Box<dyn FnOnce() -> String + Send>;
     fn quote(&self, prefix: String, suffix: String) -> String;
     fn quote_bytes(&self, prefix: &[u8], suffix: &[u8]) -> Vec<u8>;
+    fn starts_with(&self, prefix: &[u16]) -> bool;
     fn vowels_in_name(&self) -> u8;
 }
 
@@ -96,6 +411,7 @@ pub extern "C" fn person_new(
     let person_emit = PersonEmitter {
         qobject: Arc::new(AtomicPtr::new(person)),
         user_name_changed: person_user_name_changed,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
     };
     let d_person = Person::new(person_emit);
     Box::into_raw(Box::new(d_person))
@@ -134,6 +450,12 @@ pub unsafe extern "C" fn person_append(ptr: *mut Person, suffix_str: *const c_us
     o.append(suffix, amount)
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn person_append_vowels_later(ptr: *mut Person) {
+    let o = &mut *ptr;
+    o.append_vowels_later()
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn person_double_name(ptr: *mut Person) {
     let o = &mut *ptr;
@@ -150,6 +472,22 @@ pub unsafe extern "C" fn person_greet(ptr: *const Person, name_str: *const c_ush
     set(d, s, r.len() as i32);
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn person_greet_later(ptr: *mut Person, name_str: *const c_ushort, name_len: c_int) -> u64 {
+    let mut name = String::new();
+    set_string_from_utf16(&mut name, name_str, name_len);
+    let o = &mut *ptr;
+    let mut emit = o.emit().clone();
+    let job = o.greet_later(name);
+    let request = next_request();
+    ThreadPool::global().spawn(move || {
+        let r = ::std::panic::catch_unwind(::std::panic::AssertUnwindSafe(job))
+            .unwrap_or_default();
+        emit.greet_later_finished(request, r);
+    });
+    request
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn person_quote(ptr: *const Person, prefix_str: *const c_ushort, prefix_len: c_int, suffix_str: *const c_ushort, suffix_len: c_int, d: *mut QString, set: extern fn(*mut QString, str: *const c_char, len: c_int)) {
     let mut prefix = String::new();
@@ -172,8 +510,49 @@ pub unsafe extern "C" fn person_quote_bytes(ptr: *const Person, prefix_str: *con
     set(d, s, r.len() as i32);
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn person_starts_with(ptr: *const Person, prefix_str: *const c_ushort, prefix_len: c_int) -> bool {
+    let prefix = slice::from_raw_parts(prefix_str, to_usize(prefix_len));
+    let o = &*ptr;
+    o.starts_with(prefix)
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn person_vowels_in_name(ptr: *const Person) -> u8 {
     let o = &*ptr;
     o.vowels_in_name()
 }
+
+#[no_mangle]
+pub unsafe extern "C" fn person_apply_commands(ptr: *mut Person) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            PersonCommand::Append(suffix, amount) => o.append(suffix, amount),
+            PersonCommand::AppendVowelsLater => o.append_vowels_later(),
+            PersonCommand::DoubleName => o.double_name(),
+            PersonCommand::Greet(name, sender) => {
+                let _ = sender.send(o.greet(name));
+            }
+            PersonCommand::Quote(prefix, suffix, sender) => {
+                let _ = sender.send(o.quote(prefix, suffix));
+            }
+            PersonCommand::QuoteBytes(prefix, suffix, sender) => {
+                let _ = sender.send(o.quote_bytes(&prefix, &suffix));
+            }
+            PersonCommand::StartsWith(prefix, sender) => {
+                let _ = sender.send(o.starts_with(&prefix));
+            }
+            PersonCommand::VowelsInName(sender) => {
+                let _ = sender.send(o.vowels_in_name());
+            }
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
@@ -3,7 +3,7 @@
 #![allow(dead_code)]
 use interface::*;
 
-#[derive(Default, Clone)]
+#[derive(Default, Clone, PartialEq)]
 struct PersonsItem {
     user_name: String,
     age: u8,
@@ -36,40 +36,246 @@ impl PersonsTrait for Persons {
         self.list[index].user_name = v;
         true
     }
+    fn sort(&mut self, _: u8, order: SortOrder) {
+        self.model.layout_about_to_be_changed();
+        let mut old_rows: Vec<usize> = (0..self.list.len()).collect();
+        {
+            let list = &self.list;
+            old_rows.sort_by(|&a, &b| list[a].user_name.cmp(&list[b].user_name));
+        }
+        if order == SortOrder::Descending {
+            old_rows.reverse();
+        }
+        self.list = old_rows.iter().map(|&row| self.list[row].clone()).collect();
+        self.model.layout_changed_with_permutation(&old_rows);
+    }
+    fn arrange(&mut self, names: String) {
+        let new = names
+            .split(',')
+            .map(|name| PersonsItem {
+                user_name: name.into(),
+                age: 0,
+            })
+            .collect();
+        self.model
+            .sync_from(&mut self.list, new, |item| item.user_name.clone());
+    }
+    fn recruit(&mut self, count: u32) {
+        let handle = self.emit.handle();
+        let len = self.list.len();
+        let count = count as usize;
+        // prepare the change on another thread and apply it on this one
+        ::std::thread::spawn(move || {
+            let recruits: Vec<PersonsItem> = (0..count)
+                .map(|i| PersonsItem {
+                    user_name: format!("recruit {}", i),
+                    age: 0,
+                })
+                .collect();
+            let mut transaction = handle.transaction();
+            transaction.insert_rows(len, len + count - 1, move |persons| {
+                persons.list.extend(recruits);
+            });
+            transaction.remove_rows(0, 0, |persons| {
+                persons.list.remove(0);
+            });
+            transaction.commit();
+        });
+    }
 }
 
 pub struct NoRole {
     emit: NoRoleEmitter,
     model: NoRoleList,
-    list: Vec<PersonsItem>
+    columns: NoRoleColumns,
+    arrivals: RowConsumer<PersonsItem>,
+    producer: Option<RowProducer<PersonsItem>>,
 }
 
 impl NoRoleTrait for NoRole {
-    fn new(emit: NoRoleEmitter, model: NoRoleList) -> NoRole {
+    fn new(mut emit: NoRoleEmitter, model: NoRoleList) -> NoRole {
+        let (producer, arrivals) = emit.row_stream(16);
+        let mut columns = NoRoleColumns::new();
+        for _ in 0..10 {
+            columns.push(NoRoleRow::default());
+        }
         NoRole {
             emit: emit,
             model: model,
-            list: vec![PersonsItem::default(); 10],
+            columns: columns,
+            arrivals: arrivals,
+            producer: Some(producer),
         }
     }
+    fn fetch_more(&mut self) {
+        let row = self.columns.len();
+        let columns = &mut self.columns;
+        self.model.insert_rows_from(row, &mut self.arrivals, |item| {
+            columns.push(NoRoleRow {
+                user_age: item.age,
+                user_name: item.user_name,
+            })
+        });
+    }
     fn emit(&mut self) -> &mut NoRoleEmitter {
         &mut self.emit
     }
     fn row_count(&self) -> usize {
-        self.list.len()
+        self.columns.len()
     }
     fn user_name(&self, index: usize) -> &str {
-        &self.list[index].user_name
+        &self.columns.user_name()[index]
     }
     fn set_user_name(&mut self, index: usize, v: String) -> bool {
-        self.list[index].user_name = v;
+        self.columns.user_name_mut()[index] = v;
         true
     }
     fn user_age(&self, index: usize) -> u8 {
-        self.list[index].age
+        self.columns.user_age()[index]
+    }
+    fn user_age_column(&self, first: usize, column: &mut [u8]) {
+        column.copy_from_slice(&self.columns.user_age()[first..first + column.len()]);
     }
     fn set_user_age(&mut self, index: usize, v: u8) -> bool {
-        self.list[index].age = v;
+        self.columns.user_age_mut()[index] = v;
         true
     }
+    fn birthday(&mut self) {
+        for age in self.columns.user_age_mut() {
+            *age += 1;
+        }
+        let last = self.columns.len() - 1;
+        self.model.properties_changed(0, 4, &[NoRoleProperty::UserAge]);
+        self.model.properties_changed(5, last, &[NoRoleProperty::UserAge]);
+    }
+    fn welcome(&mut self, count: u32) {
+        let mut producer = match self.producer.take() {
+            Some(producer) => producer,
+            None => return,
+        };
+        // the stream holds fewer rows than are sent, so the worker has to
+        // wait for the model to take them
+        ::std::thread::spawn(move || {
+            for age in 0..count {
+                let mut item = PersonsItem {
+                    user_name: "newcomer".into(),
+                    age: age as u8,
+                };
+                while let Err(i) = producer.push(item) {
+                    item = i;
+                    ::std::thread::yield_now();
+                }
+            }
+        });
+    }
+}
+
+struct LogItem {
+    line: String,
+    number: u64,
+}
+
+pub struct Log {
+    emit: LogEmitter,
+    model: LogList,
+    pages: RowPages<LogItem>,
+    loads: u32,
+    rows: usize,
+}
+
+impl LogTrait for Log {
+    fn new(emit: LogEmitter, model: LogList) -> Log {
+        Log {
+            emit: emit,
+            model: model,
+            pages: RowPages::new(4),
+            loads: 0,
+            rows: 1_000_000,
+        }
+    }
+    fn emit(&mut self) -> &mut LogEmitter {
+        &mut self.emit
+    }
+    fn row_count(&self) -> usize {
+        self.rows
+    }
+    fn request_rows(&mut self, first: usize, last: usize) {
+        let loads = &mut self.loads;
+        self.pages.request(first, last, |first, last| {
+            *loads += 1;
+            (first..last + 1)
+                .map(|row| LogItem {
+                    line: format!("line {}", row),
+                    number: row as u64,
+                })
+                .collect()
+        });
+    }
+    fn line(&self, index: usize) -> &str {
+        &self.pages.get(index).unwrap().line
+    }
+    fn number(&self, index: usize) -> u64 {
+        self.pages.get(index).unwrap().number
+    }
+    fn append(&mut self, count: u32) {
+        let count = count as usize;
+        self.model.begin_insert_rows(self.rows, self.rows + count - 1);
+        self.rows += count;
+        self.model.end_insert_rows();
+    }
+    fn loads(&self) -> u32 {
+        self.loads
+    }
+    fn resident_pages(&self) -> u32 {
+        self.pages.len() as u32
+    }
+}
+
+pub struct Trace {
+    emit: TraceEmitter,
+    model: TraceList,
+    path: Option<String>,
+    records: TraceRecords,
+}
+
+impl TraceTrait for Trace {
+    fn new(emit: TraceEmitter, model: TraceList) -> Trace {
+        Trace {
+            emit: emit,
+            model: model,
+            path: None,
+            records: TraceRecords::empty(),
+        }
+    }
+    fn emit(&mut self) -> &mut TraceEmitter {
+        &mut self.emit
+    }
+    fn path(&self) -> Option<&str> {
+        self.path.as_ref().map(|p| &p[..])
+    }
+    fn set_path(&mut self, value: Option<String>) {
+        self.model.begin_reset_model();
+        self.records = value
+            .as_ref()
+            .and_then(|path| TraceRecords::open(path).ok())
+            .unwrap_or_else(TraceRecords::empty);
+        self.path = value;
+        self.model.end_reset_model();
+        self.emit.path_changed();
+    }
+    fn row_count(&self) -> usize {
+        self.records.len()
+    }
+    fn label(&self, index: usize) -> &str {
+        self.records.label(index)
+    }
+    fn time(&self, index: usize) -> u64 {
+        self.records.time(index)
+    }
+    fn valid(&self, index: usize) -> bool {
+        self.records.valid(index)
+    }
+    fn value(&self, index: usize) -> f64 {
+        self.records.value(index)
+    }
 }
@@ -10,6 +10,7 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 #[repr(C)]
 pub struct COption<T> {
     data: T,
@@ -50,11 +51,35 @@ where
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -72,6 +97,534 @@ pub struct QModelIndex {
     internal_id: usize,
 }
 
+/// A model signal sent by `sync_rows`.
+enum SyncSignal<'a> {
+    BeginRemove(usize, usize),
+    EndRemove,
+    BeginMove(usize, usize),
+    EndMove,
+    BeginInsert(usize, usize),
+    EndInsert,
+    BeginLayout,
+    /// The old row of every row.
+    EndLayout(&'a [usize]),
+    Changed(usize, usize),
+}
+
+/// Most ranges of removed rows, ranges of inserted rows or moved rows that
+/// `sync_rows` signals one by one. Each of them shifts the rows, so more
+/// moves are sent as one layout change and more removes or inserts as a
+/// replacement of all rows. That keeps a sync O(n log n).
+const SYNC_MAX_SIGNALS: usize = 64;
+
+/// The number of runs of `true` in `flags`.
+fn count_runs<I: Iterator<Item = bool>>(flags: I) -> usize {
+    let mut runs = 0;
+    let mut previous = false;
+    for flag in flags {
+        if flag && !previous {
+            runs += 1;
+        }
+        previous = flag;
+    }
+    runs
+}
+
+/// Indexes into `seq` of a longest increasing subsequence, O(n log n).
+fn longest_increasing(seq: &[usize]) -> Vec<usize> {
+    let mut tails: Vec<usize> = Vec::new();
+    let mut prev = vec![usize::max_value(); seq.len()];
+    for (i, &v) in seq.iter().enumerate() {
+        let pos = match tails.binary_search_by(|&t| seq[t].cmp(&v)) {
+            Ok(pos) | Err(pos) => pos,
+        };
+        if pos > 0 {
+            prev[i] = tails[pos - 1];
+        }
+        if pos == tails.len() {
+            tails.push(i);
+        } else {
+            tails[pos] = i;
+        }
+    }
+    let mut lis = vec![0; tails.len()];
+    let mut i = tails.last().cloned().unwrap_or(0);
+    for slot in lis.iter_mut().rev() {
+        *slot = i;
+        i = prev[i];
+    }
+    lis
+}
+
+/// Turn `rows` into `new` with removes, moves, inserts and changes of
+/// the rows that have the same key. Rows that are not moved keep their
+/// place, so views keep their selection and scroll position. `signal` gets
+/// the rows as they are when the signal is sent.
+fn sync_rows<T, K, F, S>(rows: &mut Vec<T>, new: Vec<T>, key: F, mut signal: S)
+where
+    T: PartialEq,
+    K: ::std::hash::Hash + Eq,
+    F: Fn(&T) -> K,
+    S: FnMut(SyncSignal, &[T]),
+{
+    let new_rows: ::std::collections::HashMap<K, usize> =
+        new.iter().enumerate().map(|(i, t)| (key(t), i)).collect();
+    let mut seen = vec![false; new.len()];
+    let mut duplicate = new_rows.len() != new.len();
+    // the row in `new` of every old row, if it is still there
+    let targets: Vec<Option<usize>> = rows
+        .iter()
+        .map(|t| {
+            let target = new_rows.get(&key(t)).cloned();
+            if let Some(target) = target {
+                duplicate |= seen[target];
+                seen[target] = true;
+            }
+            target
+        })
+        .collect();
+    drop(new_rows);
+    if duplicate
+        || count_runs(targets.iter().map(|t| t.is_none())) > SYNC_MAX_SIGNALS
+        || count_runs(seen.iter().map(|s| !s)) > SYNC_MAX_SIGNALS
+    {
+        // keys are not unique or the rows changed too much, so replace all
+        if !rows.is_empty() {
+            signal(SyncSignal::BeginRemove(0, rows.len() - 1), rows);
+            rows.clear();
+            signal(SyncSignal::EndRemove, rows);
+        }
+        if !new.is_empty() {
+            signal(SyncSignal::BeginInsert(0, new.len() - 1), rows);
+            *rows = new;
+            signal(SyncSignal::EndInsert, rows);
+        }
+        return;
+    }
+    // remove rows that are gone, back to front, one range at a time
+    let mut end = targets.len();
+    while end > 0 {
+        if targets[end - 1].is_some() {
+            end -= 1;
+            continue;
+        }
+        let mut first = end - 1;
+        while first > 0 && targets[first - 1].is_none() {
+            first -= 1;
+        }
+        signal(SyncSignal::BeginRemove(first, end - 1), rows);
+        rows.drain(first..end);
+        signal(SyncSignal::EndRemove, rows);
+        end = first;
+    }
+    let mut current: Vec<usize> = targets.into_iter().filter_map(|t| t).collect();
+    // rows in a longest increasing run of targets stay, the others move
+    let lis = longest_increasing(&current);
+    if current.len() - lis.len() > SYNC_MAX_SIGNALS {
+        // order the rows by target in one pass
+        let mut by_target = vec![usize::max_value(); new.len()];
+        for (row, &target) in current.iter().enumerate() {
+            by_target[target] = row;
+        }
+        let old_rows: Vec<usize> = by_target
+            .into_iter()
+            .filter(|&row| row != usize::max_value())
+            .collect();
+        signal(SyncSignal::BeginLayout, rows);
+        let mut old: Vec<Option<T>> = rows.drain(..).map(Some).collect();
+        rows.extend(old_rows.iter().map(|&row| old[row].take().unwrap()));
+        signal(SyncSignal::EndLayout(&old_rows), rows);
+    } else if current.len() > lis.len() {
+        // at most SYNC_MAX_SIGNALS moves, each shifts the rows once
+        let mut placed = vec![false; new.len()];
+        for i in lis {
+            placed[current[i]] = true;
+        }
+        let mut previous: Option<usize> = None;
+        for target in 0..new.len() {
+            if !seen[target] {
+                continue;
+            }
+            if !placed[target] {
+                let from = current.iter().position(|&t| t == target).unwrap();
+                let to = previous
+                    .map(|p| current.iter().position(|&t| t == p).unwrap() + 1)
+                    .unwrap_or(0);
+                if to != from && to != from + 1 {
+                    signal(SyncSignal::BeginMove(from, to), rows);
+                    let row = rows.remove(from);
+                    let t = current.remove(from);
+                    let to = if to > from { to - 1 } else { to };
+                    rows.insert(to, row);
+                    current.insert(to, t);
+                    signal(SyncSignal::EndMove, rows);
+                }
+                placed[target] = true;
+            }
+            previous = Some(target);
+        }
+    }
+    // insert new rows and update the rows that stayed; there are at most
+    // SYNC_MAX_SIGNALS inserted ranges and each shifts the rows once
+    let mut new: Vec<Option<T>> = new.into_iter().map(Some).collect();
+    let mut row = 0;
+    while row < new.len() {
+        if seen[row] {
+            let mut last = row;
+            while last < new.len() && seen[last] && rows[last] != *new[last].as_ref().unwrap() {
+                rows[last] = new[last].take().unwrap();
+                last += 1;
+            }
+            if last > row {
+                signal(SyncSignal::Changed(row, last - 1), rows);
+                row = last;
+            } else {
+                row += 1;
+            }
+            continue;
+        }
+        let mut last = row;
+        while last + 1 < new.len() && !seen[last + 1] {
+            last += 1;
+        }
+        signal(SyncSignal::BeginInsert(row, last), rows);
+        let tail = rows.split_off(row);
+        rows.extend(new[row..=last].iter_mut().map(|t| t.take().unwrap()));
+        rows.extend(tail);
+        signal(SyncSignal::EndInsert, rows);
+        row = last + 1;
+    }
+}
+
+/// Sort `rows` by their `keys`. The sort is stable in both orders.
+fn sort_rows<K, F>(rows: &mut Vec<usize>, keys: Vec<K>, order: SortOrder, cmp: F)
+where
+    F: Fn(&K, &K) -> ::std::cmp::Ordering,
+{
+    let mut keyed: Vec<(usize, K)> = rows.drain(..).zip(keys).collect();
+    if order == SortOrder::Ascending {
+        keyed.sort_by(|a, b| cmp(&a.1, &b.1));
+    } else {
+        keyed.sort_by(|a, b| cmp(&b.1, &a.1));
+    }
+    rows.extend(keyed.into_iter().map(|(row, _)| row));
+}
+
+/// Find the position of `row` among `rows`, which do not contain it and
+/// are sorted like sort_rows() sorts them.
+fn place_row<K, G, F>(rows: &[c_int], row: usize, key: G, order: SortOrder, cmp: F) -> usize
+where
+    G: Fn(usize) -> K,
+    F: Fn(&K, &K) -> ::std::cmp::Ordering,
+{
+    let k = key(row);
+    let (mut low, mut high) = (0, rows.len());
+    while low < high {
+        let mid = low + (high - low) / 2;
+        let r = to_usize(rows[mid]);
+        let kr = key(r);
+        let ord = if order == SortOrder::Ascending {
+            cmp(&kr, &k)
+        } else {
+            cmp(&k, &kr)
+        };
+        // rows with equal keys keep the order of the source
+        if ord == ::std::cmp::Ordering::Less || (ord == ::std::cmp::Ordering::Equal && r < row) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    low
+}
+
+/// Bounded single-producer single-consumer queue of rows.
+///
+/// `tail` is only written by the producer and `head` only by the consumer.
+/// Both count up and are masked to find the slot.
+struct RowRing<T> {
+    slots: Box<[::std::cell::UnsafeCell<::std::mem::MaybeUninit<T>>]>,
+    mask: usize,
+    head: ::std::sync::atomic::AtomicUsize,
+    tail: ::std::sync::atomic::AtomicUsize,
+    /// Set when the consumer has been woken and has not drained yet.
+    woken: ::std::sync::atomic::AtomicBool,
+}
+
+unsafe impl<T: Send> Sync for RowRing<T> {}
+
+impl<T> Drop for RowRing<T> {
+    fn drop(&mut self) {
+        let tail = self.tail.load(Ordering::Relaxed);
+        let mut head = self.head.load(Ordering::Relaxed);
+        while head != tail {
+            unsafe {
+                drop((*self.slots[head & self.mask].get()).as_ptr().read());
+            }
+            head = head.wrapping_add(1);
+        }
+    }
+}
+
+/// The sending half of a row stream. It can be moved to a worker thread.
+pub struct RowProducer<T> {
+    ring: Arc<RowRing<T>>,
+    wake: Box<dyn FnMut() + Send>,
+}
+
+impl<T> RowProducer<T> {
+    /// Queue a row. If the stream is full, the row is given back.
+    ///
+    /// The model is woken only for the first row after it drained the
+    /// stream, so a fast producer causes one wake per event loop pass.
+    pub fn push(&mut self, row: T) -> Result<(), T> {
+        let ring = &*self.ring;
+        let tail = ring.tail.load(Ordering::Relaxed);
+        if tail.wrapping_sub(ring.head.load(Ordering::Acquire)) == ring.slots.len() {
+            return Err(row);
+        }
+        unsafe {
+            (*ring.slots[tail & ring.mask].get()).as_mut_ptr().write(row);
+        }
+        ring.tail.store(tail.wrapping_add(1), Ordering::SeqCst);
+        if !ring.woken.swap(true, Ordering::SeqCst) {
+            (self.wake)();
+        }
+        Ok(())
+    }
+    pub fn capacity(&self) -> usize {
+        self.ring.slots.len()
+    }
+}
+
+/// The receiving half of a row stream. It is owned by the model.
+pub struct RowConsumer<T> {
+    ring: Arc<RowRing<T>>,
+}
+
+impl<T> RowConsumer<T> {
+    /// Number of rows that can be taken. Rows that are pushed after this
+    /// call wake the model again.
+    pub fn ready(&mut self) -> usize {
+        let ring = &*self.ring;
+        ring.woken.store(false, Ordering::SeqCst);
+        ring.tail
+            .load(Ordering::SeqCst)
+            .wrapping_sub(ring.head.load(Ordering::Relaxed))
+    }
+    /// Pass `n` rows to `f` in the order in which they were pushed.
+    /// `n` must not be larger than the last value of `ready()`.
+    pub fn take<F: FnMut(T)>(&mut self, n: usize, mut f: F) {
+        let ring = &*self.ring;
+        let head = ring.head.load(Ordering::Relaxed);
+        assert!(n <= ring.tail.load(Ordering::Acquire).wrapping_sub(head));
+        for i in 0..n {
+            let slot = ring.slots[head.wrapping_add(i) & ring.mask].get();
+            f(unsafe { (*slot).as_ptr().read() });
+        }
+        ring.head.store(head.wrapping_add(n), Ordering::Release);
+    }
+}
+
+fn row_stream<T>(capacity: usize, wake: Box<dyn FnMut() + Send>) -> (RowProducer<T>, RowConsumer<T>) {
+    let capacity = capacity.max(1).next_power_of_two();
+    let slots = (0..capacity)
+        .map(|_| ::std::cell::UnsafeCell::new(::std::mem::MaybeUninit::uninit()))
+        .collect();
+    let ring = Arc::new(RowRing {
+        slots,
+        mask: capacity - 1,
+        head: ::std::sync::atomic::AtomicUsize::new(0),
+        tail: ::std::sync::atomic::AtomicUsize::new(0),
+        woken: ::std::sync::atomic::AtomicBool::new(false),
+    });
+    (RowProducer { ring: ring.clone(), wake }, RowConsumer { ring })
+}
+
+/// The bytes of a file that is opened read-only.
+///
+/// On Unix the file is mapped into memory, so pages are only read when
+/// they are used. Elsewhere the file is read at once.
+pub struct MappedFile {
+    #[cfg(unix)]
+    ptr: *mut ::libc::c_void,
+    #[cfg(unix)]
+    len: usize,
+    #[cfg(not(unix))]
+    data: Vec<u8>,
+}
+
+// the mapping is private and read-only
+unsafe impl Send for MappedFile {}
+unsafe impl Sync for MappedFile {}
+
+#[cfg(unix)]
+impl MappedFile {
+    pub fn open<P: AsRef<::std::path::Path>>(path: P) -> ::std::io::Result<MappedFile> {
+        use std::os::unix::io::AsRawFd;
+        let file = ::std::fs::File::open(path)?;
+        let len = file.metadata()?.len() as usize;
+        if len == 0 {
+            return Ok(MappedFile::empty());
+        }
+        let ptr = unsafe {
+            ::libc::mmap(
+                ::std::ptr::null_mut(),
+                len,
+                ::libc::PROT_READ,
+                ::libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == ::libc::MAP_FAILED {
+            return Err(::std::io::Error::last_os_error());
+        }
+        Ok(MappedFile { ptr, len })
+    }
+    pub fn empty() -> MappedFile {
+        MappedFile {
+            ptr: ::std::ptr::null_mut(),
+            len: 0,
+        }
+    }
+    pub fn bytes(&self) -> &[u8] {
+        if self.len == 0 {
+            return &[];
+        }
+        unsafe { slice::from_raw_parts(self.ptr as *const u8, self.len) }
+    }
+}
+
+#[cfg(unix)]
+impl Drop for MappedFile {
+    fn drop(&mut self) {
+        if self.len > 0 {
+            unsafe {
+                ::libc::munmap(self.ptr, self.len);
+            }
+        }
+    }
+}
+
+#[cfg(not(unix))]
+impl MappedFile {
+    pub fn open<P: AsRef<::std::path::Path>>(path: P) -> ::std::io::Result<MappedFile> {
+        Ok(MappedFile {
+            data: ::std::fs::read(path)?,
+        })
+    }
+    pub fn empty() -> MappedFile {
+        MappedFile { data: Vec::new() }
+    }
+    pub fn bytes(&self) -> &[u8] {
+        &self.data
+    }
+}
+
+/// The number of records in a mapped file, or `None` if the file is too
+/// small for the number of records in its header.
+fn mapped_rows(bytes: &[u8], record_size: usize) -> Option<usize> {
+    if bytes.is_empty() {
+        return Some(0);
+    }
+    if bytes.len() < 8 {
+        return None;
+    }
+    let mut rows = [0u8; 8];
+    rows.copy_from_slice(&bytes[..8]);
+    let rows = u64::from_le_bytes(rows);
+    if rows > ::std::usize::MAX as u64 {
+        return None;
+    }
+    let rows = rows as usize;
+    let size = rows.checked_mul(record_size)?.checked_add(8)?;
+    if size <= bytes.len() {
+        Some(rows)
+    } else {
+        None
+    }
+}
+
+/// The bytes to which a string field of a record refers. A field that
+/// points outside of the file gives no bytes.
+fn mapped_slice<'a>(bytes: &'a [u8], field: &[u8]) -> &'a [u8] {
+    let mut offset = [0u8; 8];
+    offset.copy_from_slice(&field[..8]);
+    let mut len = [0u8; 4];
+    len.copy_from_slice(&field[8..12]);
+    let start = u64::from_le_bytes(offset);
+    let end = start.saturating_add(u64::from(u32::from_le_bytes(len)));
+    if end > bytes.len() as u64 {
+        return &[];
+    }
+    &bytes[start as usize..end as usize]
+}
+
+/// The pages of a paged List that were requested most recently.
+///
+/// A page is stored with its first row. When more than `capacity` pages
+/// are requested, the page that was used least recently is dropped.
+pub struct RowPages<T> {
+    capacity: usize,
+    /// The page that was requested last is at the end.
+    pages: Vec<(usize, Vec<T>)>,
+}
+
+impl<T> RowPages<T> {
+    pub fn new(capacity: usize) -> RowPages<T> {
+        RowPages {
+            capacity: capacity.max(1),
+            pages: Vec::new(),
+        }
+    }
+    /// Keep the page that starts at `first`. When it is not kept yet, or
+    /// was kept with a different number of rows, `load` is called to read
+    /// the rows from `first` to `last`.
+    pub fn request<F>(&mut self, first: usize, last: usize, load: F)
+    where
+        F: FnOnce(usize, usize) -> Vec<T>,
+    {
+        if let Some(pos) = self.pages.iter().position(|p| p.0 == first) {
+            let page = self.pages.remove(pos);
+            if page.1.len() == last + 1 - first {
+                self.pages.push(page);
+                return;
+            }
+        }
+        if self.pages.len() == self.capacity {
+            self.pages.remove(0);
+        }
+        self.pages.push((first, load(first, last)));
+    }
+    /// Get a row from a page that is kept.
+    pub fn get(&self, row: usize) -> Option<&T> {
+        self.pages
+            .iter()
+            .rev()
+            .find(|p| p.0 <= row && row - p.0 < p.1.len())
+            .map(|p| &p.1[row - p.0])
+    }
+    pub fn get_mut(&mut self, row: usize) -> Option<&mut T> {
+        self.pages
+            .iter_mut()
+            .rev()
+            .find(|p| p.0 <= row && row - p.0 < p.1.len())
+            .map(|p| &mut p.1[row - p.0])
+    }
+    /// The number of pages that are kept.
+    pub fn len(&self) -> usize {
+        self.pages.len()
+    }
+    pub fn is_empty(&self) -> bool {
+        self.pages.is_empty()
+    }
+    /// Drop all pages, e.g. when the rows change.
+    pub fn clear(&mut self) {
+        self.pages.clear();
+    }
+}
+
 
 fn to_usize(n: c_int) -> usize {
     if n < 0 {
@@ -89,31 +642,87 @@ fn to_c_int(n: usize) -> c_int {
 }
 
 
-pub struct NoRoleQObject {}
+extern "C" {
+    fn log_commands_pending(o: *mut ::std::ffi::c_void);
+}
 
-pub struct NoRoleEmitter {
-    qobject: Arc<AtomicPtr<NoRoleQObject>>,
-    new_data_ready: extern fn(*mut NoRoleQObject),
+/// A call of a function of Log that was made on another thread.
+enum LogCommand {
+    Append(u32),
+    Loads(::std::sync::mpsc::SyncSender<u32>),
+    ResidentPages(::std::sync::mpsc::SyncSender<u32>),
 }
 
-unsafe impl Send for NoRoleEmitter {}
+pub struct LogQObject {}
 
-impl NoRoleEmitter {
+pub struct LogEmitter {
+    qobject: Arc<AtomicPtr<LogQObject>>,
+    new_data_ready: extern fn(*mut LogQObject),
+    commands: Arc<::std::sync::Mutex<Vec<LogCommand>>>,
+}
+
+unsafe impl Send for LogEmitter {}
+
+impl LogEmitter {
     /// Clone the emitter
     ///
     /// The emitter can only be cloned when it is mutable. The emitter calls
     /// into C++ code which may call into Rust again. If emmitting is possible
     /// from immutable structures, that might lead to access to a mutable
     /// reference. That is undefined behaviour and forbidden.
-    pub fn clone(&mut self) -> NoRoleEmitter {
-        NoRoleEmitter {
+    pub fn clone(&mut self) -> LogEmitter {
+        LogEmitter {
             qobject: self.qobject.clone(),
             new_data_ready: self.new_data_ready,
+            commands: self.commands.clone(),
         }
     }
     fn clear(&self) {
-        let n: *const NoRoleQObject = null();
-        self.qobject.store(n as *mut NoRoleQObject, Ordering::SeqCst);
+        let n: *const LogQObject = null();
+        self.qobject.store(n as *mut LogQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    /// Call `append` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_append(&mut self, count: u32) {
+        self.command(LogCommand::Append(count));
+    }
+    /// Call `loads` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_loads(&mut self) -> ::std::sync::mpsc::Receiver<u32> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(LogCommand::Loads(sender));
+        receiver
+    }
+    /// Call `resident_pages` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_resident_pages(&mut self) -> ::std::sync::mpsc::Receiver<u32> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(LogCommand::ResidentPages(sender));
+        receiver
+    }
+    fn command(&mut self, command: LogCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { log_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
     }
     pub fn new_data_ready(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
@@ -123,23 +732,32 @@ impl NoRoleEmitter {
     }
 }
 
+/// The item properties of Log, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum LogProperty {
+    Line = 0,
+    Number = 1,
+}
+
 #[derive(Clone)]
-pub struct NoRoleList {
-    qobject: *mut NoRoleQObject,
-    layout_about_to_be_changed: extern fn(*mut NoRoleQObject),
-    layout_changed: extern fn(*mut NoRoleQObject),
-    data_changed: extern fn(*mut NoRoleQObject, usize, usize),
-    begin_reset_model: extern fn(*mut NoRoleQObject),
-    end_reset_model: extern fn(*mut NoRoleQObject),
-    begin_insert_rows: extern fn(*mut NoRoleQObject, usize, usize),
-    end_insert_rows: extern fn(*mut NoRoleQObject),
-    begin_move_rows: extern fn(*mut NoRoleQObject, usize, usize, usize),
-    end_move_rows: extern fn(*mut NoRoleQObject),
-    begin_remove_rows: extern fn(*mut NoRoleQObject, usize, usize),
-    end_remove_rows: extern fn(*mut NoRoleQObject),
+pub struct LogList {
+    qobject: *mut LogQObject,
+    layout_about_to_be_changed: extern fn(*mut LogQObject),
+    layout_changed: extern fn(*mut LogQObject),
+    data_changed: extern fn(*mut LogQObject, usize, usize),
+    properties_changed: extern fn(*mut LogQObject, usize, usize, u64),
+    begin_reset_model: extern fn(*mut LogQObject),
+    end_reset_model: extern fn(*mut LogQObject),
+    begin_insert_rows: extern fn(*mut LogQObject, usize, usize),
+    end_insert_rows: extern fn(*mut LogQObject),
+    begin_move_rows: extern fn(*mut LogQObject, usize, usize, usize),
+    end_move_rows: extern fn(*mut LogQObject),
+    begin_remove_rows: extern fn(*mut LogQObject, usize, usize),
+    end_remove_rows: extern fn(*mut LogQObject),
+    layout_changed_with_permutation: extern fn(*mut LogQObject, *const usize, usize),
 }
 
-impl NoRoleList {
+impl LogList {
     pub fn layout_about_to_be_changed(&mut self) {
         (self.layout_about_to_be_changed)(self.qobject);
     }
@@ -149,6 +767,14 @@ impl NoRoleList {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[LogProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -173,11 +799,42 @@ impl NoRoleList {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
 }
 
-pub trait NoRoleTrait {
-    fn new(emit: NoRoleEmitter, model: NoRoleList) -> Self;
-    fn emit(&mut self) -> &mut NoRoleEmitter;
+pub trait LogTrait {
+    fn new(emit: LogEmitter, model: LogList) -> Self;
+    fn emit(&mut self) -> &mut LogEmitter;
+    fn append(&mut self, count: u32) -> ();
+    fn loads(&self) -> u32;
+    fn resident_pages(&self) -> u32;
     fn row_count(&self) -> usize;
     fn insert_rows(&mut self, _row: usize, _count: usize) -> bool { false }
     fn remove_rows(&mut self, _row: usize, _count: usize) -> bool { false }
@@ -186,146 +843,264 @@ pub trait NoRoleTrait {
     }
     fn fetch_more(&mut self) {}
     fn sort(&mut self, _: u8, _: SortOrder) {}
-    fn user_age(&self, index: usize) -> u8;
-    fn set_user_age(&mut self, index: usize, _: u8) -> bool;
-    fn user_name(&self, index: usize) -> &str;
-    fn set_user_name(&mut self, index: usize, _: String) -> bool;
+    /// Make the rows from `first` to `last` available to the getters.
+    /// The rows are one page of 64 rows or the last rows of the model.
+    fn request_rows(&mut self, first: usize, last: usize);
+    fn line(&self, index: usize) -> &str;
+    fn number(&self, index: usize) -> u64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn number_column(&self, first: usize, column: &mut [u64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.number(first + row);
+        }
+    }
 }
 
 #[no_mangle]
-pub extern "C" fn no_role_new(
-    no_role: *mut NoRoleQObject,
-    no_role_new_data_ready: extern fn(*mut NoRoleQObject),
-    no_role_layout_about_to_be_changed: extern fn(*mut NoRoleQObject),
-    no_role_layout_changed: extern fn(*mut NoRoleQObject),
-    no_role_data_changed: extern fn(*mut NoRoleQObject, usize, usize),
-    no_role_begin_reset_model: extern fn(*mut NoRoleQObject),
-    no_role_end_reset_model: extern fn(*mut NoRoleQObject),
-    no_role_begin_insert_rows: extern fn(*mut NoRoleQObject, usize, usize),
-    no_role_end_insert_rows: extern fn(*mut NoRoleQObject),
-    no_role_begin_move_rows: extern fn(*mut NoRoleQObject, usize, usize, usize),
-    no_role_end_move_rows: extern fn(*mut NoRoleQObject),
-    no_role_begin_remove_rows: extern fn(*mut NoRoleQObject, usize, usize),
-    no_role_end_remove_rows: extern fn(*mut NoRoleQObject),
-) -> *mut NoRole {
-    let no_role_emit = NoRoleEmitter {
-        qobject: Arc::new(AtomicPtr::new(no_role)),
-        new_data_ready: no_role_new_data_ready,
+pub extern "C" fn log_new(
+    log: *mut LogQObject,
+    log_new_data_ready: extern fn(*mut LogQObject),
+    log_layout_about_to_be_changed: extern fn(*mut LogQObject),
+    log_layout_changed: extern fn(*mut LogQObject),
+    log_data_changed: extern fn(*mut LogQObject, usize, usize),
+    log_properties_changed: extern fn(*mut LogQObject, usize, usize, u64),
+    log_begin_reset_model: extern fn(*mut LogQObject),
+    log_end_reset_model: extern fn(*mut LogQObject),
+    log_begin_insert_rows: extern fn(*mut LogQObject, usize, usize),
+    log_end_insert_rows: extern fn(*mut LogQObject),
+    log_begin_move_rows: extern fn(*mut LogQObject, usize, usize, usize),
+    log_end_move_rows: extern fn(*mut LogQObject),
+    log_begin_remove_rows: extern fn(*mut LogQObject, usize, usize),
+    log_end_remove_rows: extern fn(*mut LogQObject),
+    log_layout_changed_with_permutation: extern fn(*mut LogQObject, *const usize, usize),
+) -> *mut Log {
+    let log_emit = LogEmitter {
+        qobject: Arc::new(AtomicPtr::new(log)),
+        new_data_ready: log_new_data_ready,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
     };
-    let model = NoRoleList {
-        qobject: no_role,
-        layout_about_to_be_changed: no_role_layout_about_to_be_changed,
-        layout_changed: no_role_layout_changed,
-        data_changed: no_role_data_changed,
-        begin_reset_model: no_role_begin_reset_model,
-        end_reset_model: no_role_end_reset_model,
-        begin_insert_rows: no_role_begin_insert_rows,
-        end_insert_rows: no_role_end_insert_rows,
-        begin_move_rows: no_role_begin_move_rows,
-        end_move_rows: no_role_end_move_rows,
-        begin_remove_rows: no_role_begin_remove_rows,
-        end_remove_rows: no_role_end_remove_rows,
+    let model = LogList {
+        qobject: log,
+        layout_about_to_be_changed: log_layout_about_to_be_changed,
+        layout_changed: log_layout_changed,
+        data_changed: log_data_changed,
+        properties_changed: log_properties_changed,
+        begin_reset_model: log_begin_reset_model,
+        end_reset_model: log_end_reset_model,
+        begin_insert_rows: log_begin_insert_rows,
+        end_insert_rows: log_end_insert_rows,
+        begin_move_rows: log_begin_move_rows,
+        end_move_rows: log_end_move_rows,
+        begin_remove_rows: log_begin_remove_rows,
+        end_remove_rows: log_end_remove_rows,
+        layout_changed_with_permutation: log_layout_changed_with_permutation,
     };
-    let d_no_role = NoRole::new(no_role_emit, model);
-    Box::into_raw(Box::new(d_no_role))
+    let d_log = Log::new(log_emit, model);
+    Box::into_raw(Box::new(d_log))
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn no_role_free(ptr: *mut NoRole) {
+pub unsafe extern "C" fn log_free(ptr: *mut Log) {
     Box::from_raw(ptr).emit().clear();
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn no_role_row_count(ptr: *const NoRole) -> c_int {
+pub unsafe extern "C" fn log_append(ptr: *mut Log, count: u32) {
+    let o = &mut *ptr;
+    o.append(count)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn log_loads(ptr: *const Log) -> u32 {
+    let o = &*ptr;
+    o.loads()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn log_resident_pages(ptr: *const Log) -> u32 {
+    let o = &*ptr;
+    o.resident_pages()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn log_apply_commands(ptr: *mut Log) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            LogCommand::Append(count) => o.append(count),
+            LogCommand::Loads(sender) => {
+                let _ = sender.send(o.loads());
+            }
+            LogCommand::ResidentPages(sender) => {
+                let _ = sender.send(o.resident_pages());
+            }
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn log_row_count(ptr: *const Log) -> c_int {
     to_c_int((&*ptr).row_count())
 }
 #[no_mangle]
-pub unsafe extern "C" fn no_role_insert_rows(ptr: *mut NoRole, row: c_int, count: c_int) -> bool {
+pub unsafe extern "C" fn log_insert_rows(ptr: *mut Log, row: c_int, count: c_int) -> bool {
     (&mut *ptr).insert_rows(to_usize(row), to_usize(count))
 }
 #[no_mangle]
-pub unsafe extern "C" fn no_role_remove_rows(ptr: *mut NoRole, row: c_int, count: c_int) -> bool {
+pub unsafe extern "C" fn log_remove_rows(ptr: *mut Log, row: c_int, count: c_int) -> bool {
     (&mut *ptr).remove_rows(to_usize(row), to_usize(count))
 }
 #[no_mangle]
-pub unsafe extern "C" fn no_role_can_fetch_more(ptr: *const NoRole) -> bool {
+pub unsafe extern "C" fn log_can_fetch_more(ptr: *const Log) -> bool {
     (&*ptr).can_fetch_more()
 }
 #[no_mangle]
-pub unsafe extern "C" fn no_role_fetch_more(ptr: *mut NoRole) {
+pub unsafe extern "C" fn log_fetch_more(ptr: *mut Log) {
     (&mut *ptr).fetch_more()
 }
 #[no_mangle]
-pub unsafe extern "C" fn no_role_sort(
-    ptr: *mut NoRole,
+pub unsafe extern "C" fn log_sort(
+    ptr: *mut Log,
     column: u8,
     order: SortOrder,
 ) {
     (&mut *ptr).sort(column, order)
 }
-
 #[no_mangle]
-pub unsafe extern "C" fn no_role_data_user_age(ptr: *const NoRole, row: c_int) -> u8 {
-    let o = &*ptr;
-    o.user_age(to_usize(row))
+pub unsafe extern "C" fn log_request_rows(ptr: *mut Log, first: c_int, last: c_int) {
+    (&mut *ptr).request_rows(to_usize(first), to_usize(last))
 }
 
-#[no_mangle]
-pub unsafe extern "C" fn no_role_set_data_user_age(
-    ptr: *mut NoRole, row: c_int,
-    v: u8,
-) -> bool {
-    (&mut *ptr).set_user_age(to_usize(row), v)
+#[repr(C)]
+pub struct LogDataRange {
+    line: *mut QString,
+    number: *mut u64,
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn no_role_data_user_name(
-    ptr: *const NoRole, row: c_int,
-    d: *mut QString,
+pub unsafe extern "C" fn log_data_range(
+    ptr: *const Log,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut LogDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.line(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.line, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        let column = slice::from_raw_parts_mut(range.number, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.number(index);
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn log_data_line(
+    ptr: *const Log, row: c_int,
+    d: *mut QString,
     set: extern fn(*mut QString, *const c_char, len: c_int),
 ) {
     let o = &*ptr;
-    let data = o.user_name(to_usize(row));
+    let data = o.line(to_usize(row));
     let s: *const c_char = data.as_ptr() as *const c_char;
     set(d, s, to_c_int(data.len()));
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn no_role_set_data_user_name(
-    ptr: *mut NoRole, row: c_int,
-    s: *const c_ushort, len: c_int,
-) -> bool {
-    let o = &mut *ptr;
-    let mut v = String::new();
-    set_string_from_utf16(&mut v, s, len);
-    o.set_user_name(to_usize(row), v)
+pub unsafe extern "C" fn log_data_number(ptr: *const Log, row: c_int) -> u64 {
+    let o = &*ptr;
+    o.number(to_usize(row))
 }
 
-pub struct PersonsQObject {}
+#[no_mangle]
+pub unsafe extern "C" fn log_column_number(ptr: *const Log, first: c_int, count: c_int, column: *mut u64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).number_column(to_usize(first), column);
+}
 
-pub struct PersonsEmitter {
-    qobject: Arc<AtomicPtr<PersonsQObject>>,
-    new_data_ready: extern fn(*mut PersonsQObject),
+extern "C" {
+    fn no_role_commands_pending(o: *mut ::std::ffi::c_void);
 }
 
-unsafe impl Send for PersonsEmitter {}
+/// A call of a function of NoRole that was made on another thread.
+enum NoRoleCommand {
+    Birthday,
+    Welcome(u32),
+}
 
-impl PersonsEmitter {
+pub struct NoRoleQObject {}
+
+pub struct NoRoleEmitter {
+    qobject: Arc<AtomicPtr<NoRoleQObject>>,
+    new_data_ready: extern fn(*mut NoRoleQObject),
+    commands: Arc<::std::sync::Mutex<Vec<NoRoleCommand>>>,
+}
+
+unsafe impl Send for NoRoleEmitter {}
+
+impl NoRoleEmitter {
     /// Clone the emitter
     ///
     /// The emitter can only be cloned when it is mutable. The emitter calls
     /// into C++ code which may call into Rust again. If emmitting is possible
     /// from immutable structures, that might lead to access to a mutable
     /// reference. That is undefined behaviour and forbidden.
-    pub fn clone(&mut self) -> PersonsEmitter {
-        PersonsEmitter {
+    pub fn clone(&mut self) -> NoRoleEmitter {
+        NoRoleEmitter {
             qobject: self.qobject.clone(),
             new_data_ready: self.new_data_ready,
+            commands: self.commands.clone(),
         }
     }
     fn clear(&self) {
-        let n: *const PersonsQObject = null();
-        self.qobject.store(n as *mut PersonsQObject, Ordering::SeqCst);
+        let n: *const NoRoleQObject = null();
+        self.qobject.store(n as *mut NoRoleQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    /// Call `birthday` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_birthday(&mut self) {
+        self.command(NoRoleCommand::Birthday);
+    }
+    /// Call `welcome` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_welcome(&mut self, count: u32) {
+        self.command(NoRoleCommand::Welcome(count));
+    }
+    fn command(&mut self, command: NoRoleCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { no_role_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
     }
     pub fn new_data_ready(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
@@ -333,25 +1108,41 @@ impl PersonsEmitter {
             (self.new_data_ready)(ptr);
         }
     }
+    /// Create a stream through which a worker thread can send rows.
+    /// Pushing a row into an empty stream calls `new_data_ready()`, so
+    /// the model can take the rows in `fetch_more()`.
+    pub fn row_stream<T>(&mut self, capacity: usize) -> (RowProducer<T>, RowConsumer<T>) {
+        let mut emit = self.clone();
+        row_stream(capacity, Box::new(move || emit.new_data_ready()))
+    }
+}
+
+/// The item properties of NoRole, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum NoRoleProperty {
+    UserAge = 0,
+    UserName = 1,
 }
 
 #[derive(Clone)]
-pub struct PersonsList {
-    qobject: *mut PersonsQObject,
-    layout_about_to_be_changed: extern fn(*mut PersonsQObject),
-    layout_changed: extern fn(*mut PersonsQObject),
-    data_changed: extern fn(*mut PersonsQObject, usize, usize),
-    begin_reset_model: extern fn(*mut PersonsQObject),
-    end_reset_model: extern fn(*mut PersonsQObject),
-    begin_insert_rows: extern fn(*mut PersonsQObject, usize, usize),
-    end_insert_rows: extern fn(*mut PersonsQObject),
-    begin_move_rows: extern fn(*mut PersonsQObject, usize, usize, usize),
-    end_move_rows: extern fn(*mut PersonsQObject),
-    begin_remove_rows: extern fn(*mut PersonsQObject, usize, usize),
-    end_remove_rows: extern fn(*mut PersonsQObject),
+pub struct NoRoleList {
+    qobject: *mut NoRoleQObject,
+    layout_about_to_be_changed: extern fn(*mut NoRoleQObject),
+    layout_changed: extern fn(*mut NoRoleQObject),
+    data_changed: extern fn(*mut NoRoleQObject, usize, usize),
+    properties_changed: extern fn(*mut NoRoleQObject, usize, usize, u64),
+    begin_reset_model: extern fn(*mut NoRoleQObject),
+    end_reset_model: extern fn(*mut NoRoleQObject),
+    begin_insert_rows: extern fn(*mut NoRoleQObject, usize, usize),
+    end_insert_rows: extern fn(*mut NoRoleQObject),
+    begin_move_rows: extern fn(*mut NoRoleQObject, usize, usize, usize),
+    end_move_rows: extern fn(*mut NoRoleQObject),
+    begin_remove_rows: extern fn(*mut NoRoleQObject, usize, usize),
+    end_remove_rows: extern fn(*mut NoRoleQObject),
+    layout_changed_with_permutation: extern fn(*mut NoRoleQObject, *const usize, usize),
 }
 
-impl PersonsList {
+impl NoRoleList {
     pub fn layout_about_to_be_changed(&mut self) {
         (self.layout_about_to_be_changed)(self.qobject);
     }
@@ -361,6 +1152,14 @@ impl PersonsList {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[NoRoleProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -385,11 +1184,53 @@ impl PersonsList {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Insert the rows that are ready in `stream` at `row`, announced
+    /// with one begin_insert_rows()/end_insert_rows() pair. `insert` is
+    /// called for each row, in order, and should add it to the model.
+    pub fn insert_rows_from<T, F: FnMut(T)>(&mut self, row: usize, stream: &mut RowConsumer<T>, insert: F) -> usize {
+        let n = stream.ready();
+        if n > 0 {
+            self.begin_insert_rows(row, row + n - 1);
+            stream.take(n, insert);
+            self.end_insert_rows();
+        }
+        n
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
 }
 
-pub trait PersonsTrait {
-    fn new(emit: PersonsEmitter, model: PersonsList) -> Self;
-    fn emit(&mut self) -> &mut PersonsEmitter;
+pub trait NoRoleTrait {
+    fn new(emit: NoRoleEmitter, model: NoRoleList) -> Self;
+    fn emit(&mut self) -> &mut NoRoleEmitter;
+    fn birthday(&mut self) -> ();
+    fn welcome(&mut self, count: u32) -> ();
     fn row_count(&self) -> usize;
     fn insert_rows(&mut self, _row: usize, _count: usize) -> bool { false }
     fn remove_rows(&mut self, _row: usize, _count: usize) -> bool { false }
@@ -398,85 +1239,183 @@ pub trait PersonsTrait {
     }
     fn fetch_more(&mut self) {}
     fn sort(&mut self, _: u8, _: SortOrder) {}
+    fn user_age(&self, index: usize) -> u8;
+    /// Copy the values for the rows from `first` into `column`.
+    fn user_age_column(&self, first: usize, column: &mut [u8]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.user_age(first + row);
+        }
+    }
+    fn set_user_age(&mut self, index: usize, _: u8) -> bool;
     fn user_name(&self, index: usize) -> &str;
     fn set_user_name(&mut self, index: usize, _: String) -> bool;
 }
 
 #[no_mangle]
-pub extern "C" fn persons_new(
-    persons: *mut PersonsQObject,
-    persons_new_data_ready: extern fn(*mut PersonsQObject),
-    persons_layout_about_to_be_changed: extern fn(*mut PersonsQObject),
-    persons_layout_changed: extern fn(*mut PersonsQObject),
-    persons_data_changed: extern fn(*mut PersonsQObject, usize, usize),
-    persons_begin_reset_model: extern fn(*mut PersonsQObject),
-    persons_end_reset_model: extern fn(*mut PersonsQObject),
-    persons_begin_insert_rows: extern fn(*mut PersonsQObject, usize, usize),
-    persons_end_insert_rows: extern fn(*mut PersonsQObject),
-    persons_begin_move_rows: extern fn(*mut PersonsQObject, usize, usize, usize),
-    persons_end_move_rows: extern fn(*mut PersonsQObject),
-    persons_begin_remove_rows: extern fn(*mut PersonsQObject, usize, usize),
-    persons_end_remove_rows: extern fn(*mut PersonsQObject),
-) -> *mut Persons {
-    let persons_emit = PersonsEmitter {
-        qobject: Arc::new(AtomicPtr::new(persons)),
-        new_data_ready: persons_new_data_ready,
+pub extern "C" fn no_role_new(
+    no_role: *mut NoRoleQObject,
+    no_role_new_data_ready: extern fn(*mut NoRoleQObject),
+    no_role_layout_about_to_be_changed: extern fn(*mut NoRoleQObject),
+    no_role_layout_changed: extern fn(*mut NoRoleQObject),
+    no_role_data_changed: extern fn(*mut NoRoleQObject, usize, usize),
+    no_role_properties_changed: extern fn(*mut NoRoleQObject, usize, usize, u64),
+    no_role_begin_reset_model: extern fn(*mut NoRoleQObject),
+    no_role_end_reset_model: extern fn(*mut NoRoleQObject),
+    no_role_begin_insert_rows: extern fn(*mut NoRoleQObject, usize, usize),
+    no_role_end_insert_rows: extern fn(*mut NoRoleQObject),
+    no_role_begin_move_rows: extern fn(*mut NoRoleQObject, usize, usize, usize),
+    no_role_end_move_rows: extern fn(*mut NoRoleQObject),
+    no_role_begin_remove_rows: extern fn(*mut NoRoleQObject, usize, usize),
+    no_role_end_remove_rows: extern fn(*mut NoRoleQObject),
+    no_role_layout_changed_with_permutation: extern fn(*mut NoRoleQObject, *const usize, usize),
+) -> *mut NoRole {
+    let no_role_emit = NoRoleEmitter {
+        qobject: Arc::new(AtomicPtr::new(no_role)),
+        new_data_ready: no_role_new_data_ready,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
     };
-    let model = PersonsList {
-        qobject: persons,
-        layout_about_to_be_changed: persons_layout_about_to_be_changed,
-        layout_changed: persons_layout_changed,
-        data_changed: persons_data_changed,
-        begin_reset_model: persons_begin_reset_model,
-        end_reset_model: persons_end_reset_model,
-        begin_insert_rows: persons_begin_insert_rows,
-        end_insert_rows: persons_end_insert_rows,
-        begin_move_rows: persons_begin_move_rows,
-        end_move_rows: persons_end_move_rows,
-        begin_remove_rows: persons_begin_remove_rows,
-        end_remove_rows: persons_end_remove_rows,
+    let model = NoRoleList {
+        qobject: no_role,
+        layout_about_to_be_changed: no_role_layout_about_to_be_changed,
+        layout_changed: no_role_layout_changed,
+        data_changed: no_role_data_changed,
+        properties_changed: no_role_properties_changed,
+        begin_reset_model: no_role_begin_reset_model,
+        end_reset_model: no_role_end_reset_model,
+        begin_insert_rows: no_role_begin_insert_rows,
+        end_insert_rows: no_role_end_insert_rows,
+        begin_move_rows: no_role_begin_move_rows,
+        end_move_rows: no_role_end_move_rows,
+        begin_remove_rows: no_role_begin_remove_rows,
+        end_remove_rows: no_role_end_remove_rows,
+        layout_changed_with_permutation: no_role_layout_changed_with_permutation,
     };
-    let d_persons = Persons::new(persons_emit, model);
-    Box::into_raw(Box::new(d_persons))
+    let d_no_role = NoRole::new(no_role_emit, model);
+    Box::into_raw(Box::new(d_no_role))
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn persons_free(ptr: *mut Persons) {
+pub unsafe extern "C" fn no_role_free(ptr: *mut NoRole) {
     Box::from_raw(ptr).emit().clear();
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn persons_row_count(ptr: *const Persons) -> c_int {
+pub unsafe extern "C" fn no_role_birthday(ptr: *mut NoRole) {
+    let o = &mut *ptr;
+    o.birthday()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_welcome(ptr: *mut NoRole, count: u32) {
+    let o = &mut *ptr;
+    o.welcome(count)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_apply_commands(ptr: *mut NoRole) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            NoRoleCommand::Birthday => o.birthday(),
+            NoRoleCommand::Welcome(count) => o.welcome(count),
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_row_count(ptr: *const NoRole) -> c_int {
     to_c_int((&*ptr).row_count())
 }
 #[no_mangle]
-pub unsafe extern "C" fn persons_insert_rows(ptr: *mut Persons, row: c_int, count: c_int) -> bool {
+pub unsafe extern "C" fn no_role_insert_rows(ptr: *mut NoRole, row: c_int, count: c_int) -> bool {
     (&mut *ptr).insert_rows(to_usize(row), to_usize(count))
 }
 #[no_mangle]
-pub unsafe extern "C" fn persons_remove_rows(ptr: *mut Persons, row: c_int, count: c_int) -> bool {
+pub unsafe extern "C" fn no_role_remove_rows(ptr: *mut NoRole, row: c_int, count: c_int) -> bool {
     (&mut *ptr).remove_rows(to_usize(row), to_usize(count))
 }
 #[no_mangle]
-pub unsafe extern "C" fn persons_can_fetch_more(ptr: *const Persons) -> bool {
+pub unsafe extern "C" fn no_role_can_fetch_more(ptr: *const NoRole) -> bool {
     (&*ptr).can_fetch_more()
 }
 #[no_mangle]
-pub unsafe extern "C" fn persons_fetch_more(ptr: *mut Persons) {
+pub unsafe extern "C" fn no_role_fetch_more(ptr: *mut NoRole) {
     (&mut *ptr).fetch_more()
 }
 #[no_mangle]
-pub unsafe extern "C" fn persons_sort(
-    ptr: *mut Persons,
+pub unsafe extern "C" fn no_role_sort(
+    ptr: *mut NoRole,
     column: u8,
     order: SortOrder,
 ) {
     (&mut *ptr).sort(column, order)
 }
 
+#[repr(C)]
+pub struct NoRoleDataRange {
+    user_age: *mut u8,
+    user_name: *mut QString,
+}
+
 #[no_mangle]
-pub unsafe extern "C" fn persons_data_user_name(
-    ptr: *const Persons, row: c_int,
+pub unsafe extern "C" fn no_role_data_range(
+    ptr: *const NoRole,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut NoRoleDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        let column = slice::from_raw_parts_mut(range.user_age, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.user_age(index);
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.user_name(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.user_name, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_data_user_age(ptr: *const NoRole, row: c_int) -> u8 {
+    let o = &*ptr;
+    o.user_age(to_usize(row))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_column_user_age(ptr: *const NoRole, first: c_int, count: c_int, column: *mut u8) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).user_age_column(to_usize(first), column);
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_set_data_user_age(
+    ptr: *mut NoRole, row: c_int,
+    v: u8,
+) -> bool {
+    (&mut *ptr).set_user_age(to_usize(row), v)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn no_role_data_user_name(
+    ptr: *const NoRole, row: c_int,
     d: *mut QString,
     set: extern fn(*mut QString, *const c_char, len: c_int),
 ) {
@@ -487,8 +1426,8 @@ pub unsafe extern "C" fn persons_data_user_name(
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn persons_set_data_user_name(
-    ptr: *mut Persons, row: c_int,
+pub unsafe extern "C" fn no_role_set_data_user_name(
+    ptr: *mut NoRole, row: c_int,
     s: *const c_ushort, len: c_int,
 ) -> bool {
     let o = &mut *ptr;
@@ -496,3 +1435,1108 @@ pub unsafe extern "C" fn persons_set_data_user_name(
     set_string_from_utf16(&mut v, s, len);
     o.set_user_name(to_usize(row), v)
 }
+
+/// The rows of NoRole with one `Vec` per item property.
+///
+/// All columns have the same length. Each column is available as a slice,
+/// so a scan over one property does not touch the others.
+#[derive(Default, Clone)]
+pub struct NoRoleColumns {
+    rows: usize,
+    user_age: Vec<u8>,
+    user_name: Vec<String>,
+}
+
+/// The values of one row of NoRoleColumns.
+#[derive(Default, Clone)]
+pub struct NoRoleRow {
+    pub user_age: u8,
+    pub user_name: String,
+}
+
+impl NoRoleColumns {
+    pub fn new() -> Self {
+        Self::default()
+    }
+    pub fn len(&self) -> usize {
+        self.rows
+    }
+    pub fn is_empty(&self) -> bool {
+        self.rows == 0
+    }
+    pub fn user_age(&self) -> &[u8] {
+        &self.user_age
+    }
+    pub fn user_age_mut(&mut self) -> &mut [u8] {
+        &mut self.user_age
+    }
+    pub fn user_name(&self) -> &[String] {
+        &self.user_name
+    }
+    pub fn user_name_mut(&mut self) -> &mut [String] {
+        &mut self.user_name
+    }
+    pub fn push(&mut self, values: NoRoleRow) {
+        self.user_age.push(values.user_age);
+        self.user_name.push(values.user_name);
+        self.rows += 1;
+    }
+    pub fn insert(&mut self, row: usize, values: NoRoleRow) {
+        self.user_age.insert(row, values.user_age);
+        self.user_name.insert(row, values.user_name);
+        self.rows += 1;
+    }
+    pub fn remove(&mut self, row: usize) {
+        self.user_age.remove(row);
+        self.user_name.remove(row);
+        self.rows -= 1;
+    }
+    pub fn truncate(&mut self, len: usize) {
+        self.user_age.truncate(len);
+        self.user_name.truncate(len);
+        self.rows = self.rows.min(len);
+    }
+    pub fn clear(&mut self) {
+        self.truncate(0);
+    }
+    pub fn reserve(&mut self, additional: usize) {
+        self.user_age.reserve(additional);
+        self.user_name.reserve(additional);
+    }
+}
+
+extern "C" {
+    fn persons_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Persons that was made on another thread.
+enum PersonsCommand {
+    Arrange(String),
+    Recruit(u32),
+}
+
+pub struct PersonsQObject {}
+
+pub struct PersonsEmitter {
+    qobject: Arc<AtomicPtr<PersonsQObject>>,
+    new_data_ready: extern fn(*mut PersonsQObject),
+    commands: Arc<::std::sync::Mutex<Vec<PersonsCommand>>>,
+    transactions: Arc<PersonsTransactions>,
+}
+
+unsafe impl Send for PersonsEmitter {}
+
+impl PersonsEmitter {
+    /// Clone the emitter
+    ///
+    /// The emitter can only be cloned when it is mutable. The emitter calls
+    /// into C++ code which may call into Rust again. If emmitting is possible
+    /// from immutable structures, that might lead to access to a mutable
+    /// reference. That is undefined behaviour and forbidden.
+    pub fn clone(&mut self) -> PersonsEmitter {
+        PersonsEmitter {
+            qobject: self.qobject.clone(),
+            new_data_ready: self.new_data_ready,
+            commands: self.commands.clone(),
+            transactions: self.transactions.clone(),
+        }
+    }
+    fn clear(&self) {
+        let n: *const PersonsQObject = null();
+        self.qobject.store(n as *mut PersonsQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    /// Call `arrange` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_arrange(&mut self, names: String) {
+        self.command(PersonsCommand::Arrange(names));
+    }
+    /// Call `recruit` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_recruit(&mut self, count: u32) {
+        self.command(PersonsCommand::Recruit(count));
+    }
+    fn command(&mut self, command: PersonsCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { persons_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
+    pub fn new_data_ready(&mut self) {
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {
+            (self.new_data_ready)(ptr);
+        }
+    }
+    /// Create a handle with which any thread can change the model.
+    pub fn handle(&mut self) -> PersonsHandle {
+        PersonsHandle {
+            qobject: self.qobject.clone(),
+            transactions: self.transactions.clone(),
+        }
+    }
+}
+
+/// The item properties of Persons, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum PersonsProperty {
+    UserName = 0,
+}
+
+#[derive(Clone)]
+pub struct PersonsList {
+    qobject: *mut PersonsQObject,
+    layout_about_to_be_changed: extern fn(*mut PersonsQObject),
+    layout_changed: extern fn(*mut PersonsQObject),
+    data_changed: extern fn(*mut PersonsQObject, usize, usize),
+    properties_changed: extern fn(*mut PersonsQObject, usize, usize, u64),
+    begin_reset_model: extern fn(*mut PersonsQObject),
+    end_reset_model: extern fn(*mut PersonsQObject),
+    begin_insert_rows: extern fn(*mut PersonsQObject, usize, usize),
+    end_insert_rows: extern fn(*mut PersonsQObject),
+    begin_move_rows: extern fn(*mut PersonsQObject, usize, usize, usize),
+    end_move_rows: extern fn(*mut PersonsQObject),
+    begin_remove_rows: extern fn(*mut PersonsQObject, usize, usize),
+    end_remove_rows: extern fn(*mut PersonsQObject),
+    layout_changed_with_permutation: extern fn(*mut PersonsQObject, *const usize, usize),
+}
+
+impl PersonsList {
+    pub fn layout_about_to_be_changed(&mut self) {
+        (self.layout_about_to_be_changed)(self.qobject);
+    }
+    pub fn layout_changed(&mut self) {
+        (self.layout_changed)(self.qobject);
+    }
+    pub fn data_changed(&mut self, first: usize, last: usize) {
+        (self.data_changed)(self.qobject, first, last);
+    }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[PersonsProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
+    pub fn begin_reset_model(&mut self) {
+        (self.begin_reset_model)(self.qobject);
+    }
+    pub fn end_reset_model(&mut self) {
+        (self.end_reset_model)(self.qobject);
+    }
+    pub fn begin_insert_rows(&mut self, first: usize, last: usize) {
+        (self.begin_insert_rows)(self.qobject, first, last);
+    }
+    pub fn end_insert_rows(&mut self) {
+        (self.end_insert_rows)(self.qobject);
+    }
+    pub fn begin_move_rows(&mut self, first: usize, last: usize, destination: usize) {
+        (self.begin_move_rows)(self.qobject, first, last, destination);
+    }
+    pub fn end_move_rows(&mut self) {
+        (self.end_move_rows)(self.qobject);
+    }
+    pub fn begin_remove_rows(&mut self, first: usize, last: usize) {
+        (self.begin_remove_rows)(self.qobject, first, last);
+    }
+    pub fn end_remove_rows(&mut self) {
+        (self.end_remove_rows)(self.qobject);
+    }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
+}
+
+pub trait PersonsTrait {
+    fn new(emit: PersonsEmitter, model: PersonsList) -> Self;
+    fn emit(&mut self) -> &mut PersonsEmitter;
+    fn arrange(&mut self, names: String) -> ();
+    fn recruit(&mut self, count: u32) -> ();
+    fn row_count(&self) -> usize;
+    fn insert_rows(&mut self, _row: usize, _count: usize) -> bool { false }
+    fn remove_rows(&mut self, _row: usize, _count: usize) -> bool { false }
+    fn can_fetch_more(&self) -> bool {
+        false
+    }
+    fn fetch_more(&mut self) {}
+    fn sort(&mut self, _: u8, _: SortOrder) {}
+    fn user_name(&self, index: usize) -> &str;
+    fn set_user_name(&mut self, index: usize, _: String) -> bool;
+}
+
+#[no_mangle]
+pub extern "C" fn persons_new(
+    persons: *mut PersonsQObject,
+    persons_new_data_ready: extern fn(*mut PersonsQObject),
+    persons_layout_about_to_be_changed: extern fn(*mut PersonsQObject),
+    persons_layout_changed: extern fn(*mut PersonsQObject),
+    persons_data_changed: extern fn(*mut PersonsQObject, usize, usize),
+    persons_properties_changed: extern fn(*mut PersonsQObject, usize, usize, u64),
+    persons_begin_reset_model: extern fn(*mut PersonsQObject),
+    persons_end_reset_model: extern fn(*mut PersonsQObject),
+    persons_begin_insert_rows: extern fn(*mut PersonsQObject, usize, usize),
+    persons_end_insert_rows: extern fn(*mut PersonsQObject),
+    persons_begin_move_rows: extern fn(*mut PersonsQObject, usize, usize, usize),
+    persons_end_move_rows: extern fn(*mut PersonsQObject),
+    persons_begin_remove_rows: extern fn(*mut PersonsQObject, usize, usize),
+    persons_end_remove_rows: extern fn(*mut PersonsQObject),
+    persons_layout_changed_with_permutation: extern fn(*mut PersonsQObject, *const usize, usize),
+    persons_transactions_pending: extern fn(*mut PersonsQObject),
+) -> *mut Persons {
+    let model = PersonsList {
+        qobject: persons,
+        layout_about_to_be_changed: persons_layout_about_to_be_changed,
+        layout_changed: persons_layout_changed,
+        data_changed: persons_data_changed,
+        properties_changed: persons_properties_changed,
+        begin_reset_model: persons_begin_reset_model,
+        end_reset_model: persons_end_reset_model,
+        begin_insert_rows: persons_begin_insert_rows,
+        end_insert_rows: persons_end_insert_rows,
+        begin_move_rows: persons_begin_move_rows,
+        end_move_rows: persons_end_move_rows,
+        begin_remove_rows: persons_begin_remove_rows,
+        end_remove_rows: persons_end_remove_rows,
+        layout_changed_with_permutation: persons_layout_changed_with_permutation,
+    };
+    let persons_emit = PersonsEmitter {
+        qobject: Arc::new(AtomicPtr::new(persons)),
+        new_data_ready: persons_new_data_ready,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
+        transactions: Arc::new(PersonsTransactions {
+            queue: ::std::sync::Mutex::new(Vec::new()),
+            model: model.clone(),
+            pending: persons_transactions_pending,
+        }),
+    };
+    let d_persons = Persons::new(persons_emit, model);
+    Box::into_raw(Box::new(d_persons))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_free(ptr: *mut Persons) {
+    Box::from_raw(ptr).emit().clear();
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_arrange(ptr: *mut Persons, names_str: *const c_ushort, names_len: c_int) {
+    let mut names = String::new();
+    set_string_from_utf16(&mut names, names_str, names_len);
+    let o = &mut *ptr;
+    o.arrange(names)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_recruit(ptr: *mut Persons, count: u32) {
+    let o = &mut *ptr;
+    o.recruit(count)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_apply_commands(ptr: *mut Persons) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            PersonsCommand::Arrange(names) => o.arrange(names),
+            PersonsCommand::Recruit(count) => o.recruit(count),
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_row_count(ptr: *const Persons) -> c_int {
+    to_c_int((&*ptr).row_count())
+}
+#[no_mangle]
+pub unsafe extern "C" fn persons_insert_rows(ptr: *mut Persons, row: c_int, count: c_int) -> bool {
+    (&mut *ptr).insert_rows(to_usize(row), to_usize(count))
+}
+#[no_mangle]
+pub unsafe extern "C" fn persons_remove_rows(ptr: *mut Persons, row: c_int, count: c_int) -> bool {
+    (&mut *ptr).remove_rows(to_usize(row), to_usize(count))
+}
+#[no_mangle]
+pub unsafe extern "C" fn persons_can_fetch_more(ptr: *const Persons) -> bool {
+    (&*ptr).can_fetch_more()
+}
+#[no_mangle]
+pub unsafe extern "C" fn persons_fetch_more(ptr: *mut Persons) {
+    (&mut *ptr).fetch_more()
+}
+#[no_mangle]
+pub unsafe extern "C" fn persons_sort(
+    ptr: *mut Persons,
+    column: u8,
+    order: SortOrder,
+) {
+    (&mut *ptr).sort(column, order)
+}
+
+#[repr(C)]
+pub struct PersonsDataRange {
+    user_name: *mut QString,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_data_range(
+    ptr: *const Persons,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut PersonsDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.user_name(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.user_name, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_data_user_name(
+    ptr: *const Persons, row: c_int,
+    d: *mut QString,
+    set: extern fn(*mut QString, *const c_char, len: c_int),
+) {
+    let o = &*ptr;
+    let data = o.user_name(to_usize(row));
+    let s: *const c_char = data.as_ptr() as *const c_char;
+    set(d, s, to_c_int(data.len()));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_set_data_user_name(
+    ptr: *mut Persons, row: c_int,
+    s: *const c_ushort, len: c_int,
+) -> bool {
+    let o = &mut *ptr;
+    let mut v = String::new();
+    set_string_from_utf16(&mut v, s, len);
+    o.set_user_name(to_usize(row), v)
+}
+
+type PersonsUpdate = Box<dyn FnOnce(&mut Persons) + Send>;
+
+enum PersonsChange {
+    Reset(PersonsUpdate),
+    Insert(usize, usize, PersonsUpdate),
+    Remove(usize, usize, PersonsUpdate),
+    Move(usize, usize, usize, PersonsUpdate),
+    Data(usize, usize, PersonsUpdate),
+}
+
+struct PersonsTransactions {
+    queue: ::std::sync::Mutex<Vec<PersonsChange>>,
+    model: PersonsList,
+    pending: extern fn(*mut PersonsQObject),
+}
+
+/// Handle with which any thread can change Persons.
+///
+/// Changes are recorded in a transaction. A committed transaction is
+/// applied on the GUI thread, with the model signals around each change.
+#[derive(Clone)]
+pub struct PersonsHandle {
+    qobject: Arc<AtomicPtr<PersonsQObject>>,
+    transactions: Arc<PersonsTransactions>,
+}
+
+// The model in the transactions is only used on the GUI thread.
+unsafe impl Send for PersonsHandle {}
+
+impl PersonsHandle {
+    pub fn transaction(&self) -> PersonsTransaction {
+        PersonsTransaction {
+            handle: self.clone(),
+            changes: Vec::new(),
+        }
+    }
+}
+
+/// Changes to Persons that are applied together when committed.
+///
+/// Every change has a function that updates the data of the model. It is
+/// called on the GUI thread, between the begin and end signals.
+pub struct PersonsTransaction {
+    handle: PersonsHandle,
+    changes: Vec<PersonsChange>,
+}
+
+impl PersonsTransaction {
+    pub fn reset<F>(&mut self, update: F)
+    where
+        F: FnOnce(&mut Persons) + Send + 'static,
+    {
+        self.changes.push(PersonsChange::Reset(Box::new(update)));
+    }
+    pub fn insert_rows<F>(&mut self, first: usize, last: usize, update: F)
+    where
+        F: FnOnce(&mut Persons) + Send + 'static,
+    {
+        self.changes
+            .push(PersonsChange::Insert(first, last, Box::new(update)));
+    }
+    pub fn remove_rows<F>(&mut self, first: usize, last: usize, update: F)
+    where
+        F: FnOnce(&mut Persons) + Send + 'static,
+    {
+        self.changes
+            .push(PersonsChange::Remove(first, last, Box::new(update)));
+    }
+    pub fn move_rows<F>(&mut self, first: usize, last: usize, destination: usize, update: F)
+    where
+        F: FnOnce(&mut Persons) + Send + 'static,
+    {
+        self.changes.push(PersonsChange::Move(first, last, destination, Box::new(update)));
+    }
+    pub fn data_changed<F>(&mut self, first: usize, last: usize, update: F)
+    where
+        F: FnOnce(&mut Persons) + Send + 'static,
+    {
+        self.changes
+            .push(PersonsChange::Data(first, last, Box::new(update)));
+    }
+    /// Send the changes to the GUI thread.
+    pub fn commit(self) {
+        if self.changes.is_empty() {
+            return;
+        }
+        let wake = {
+            let mut queue = self.handle.transactions.queue.lock().unwrap();
+            let wake = queue.is_empty();
+            queue.extend(self.changes);
+            wake
+        };
+        if wake {
+            let ptr = self.handle.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {
+                (self.handle.transactions.pending)(ptr);
+            }
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_apply_transactions(ptr: *mut Persons) {
+    let o = &mut *ptr;
+    let transactions = o.emit().transactions.clone();
+    let mut model = transactions.model.clone();
+    let changes = ::std::mem::replace(&mut *transactions.queue.lock().unwrap(), Vec::new());
+    for change in changes {
+        match change {
+            PersonsChange::Reset(update) => {
+                model.begin_reset_model();
+                update(o);
+                model.end_reset_model();
+            }
+            PersonsChange::Insert(first, last, update) => {
+                model.begin_insert_rows(first, last);
+                update(o);
+                model.end_insert_rows();
+            }
+            PersonsChange::Remove(first, last, update) => {
+                model.begin_remove_rows(first, last);
+                update(o);
+                model.end_remove_rows();
+            }
+            PersonsChange::Move(first, last, destination, update) => {
+                model.begin_move_rows(first, last, destination);
+                update(o);
+                model.end_move_rows();
+            }
+            PersonsChange::Data(first, last, update) => {
+                update(o);
+                model.data_changed(first, last);
+            }
+        }
+    }
+}
+
+pub struct TraceQObject {}
+
+pub struct TraceEmitter {
+    qobject: Arc<AtomicPtr<TraceQObject>>,
+    path_changed: extern fn(*mut TraceQObject),
+    new_data_ready: extern fn(*mut TraceQObject),
+}
+
+unsafe impl Send for TraceEmitter {}
+
+impl TraceEmitter {
+    /// Clone the emitter
+    ///
+    /// The emitter can only be cloned when it is mutable. The emitter calls
+    /// into C++ code which may call into Rust again. If emmitting is possible
+    /// from immutable structures, that might lead to access to a mutable
+    /// reference. That is undefined behaviour and forbidden.
+    pub fn clone(&mut self) -> TraceEmitter {
+        TraceEmitter {
+            qobject: self.qobject.clone(),
+            path_changed: self.path_changed,
+            new_data_ready: self.new_data_ready,
+        }
+    }
+    fn clear(&self) {
+        let n: *const TraceQObject = null();
+        self.qobject.store(n as *mut TraceQObject, Ordering::SeqCst);
+    }
+    pub fn path_changed(&mut self) {
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {
+            (self.path_changed)(ptr);
+        }
+    }
+    pub fn new_data_ready(&mut self) {
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {
+            (self.new_data_ready)(ptr);
+        }
+    }
+}
+
+/// The item properties of Trace, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum TraceProperty {
+    Label = 0,
+    Time = 1,
+    Valid = 2,
+    Value = 3,
+}
+
+#[derive(Clone)]
+pub struct TraceList {
+    qobject: *mut TraceQObject,
+    layout_about_to_be_changed: extern fn(*mut TraceQObject),
+    layout_changed: extern fn(*mut TraceQObject),
+    data_changed: extern fn(*mut TraceQObject, usize, usize),
+    properties_changed: extern fn(*mut TraceQObject, usize, usize, u64),
+    begin_reset_model: extern fn(*mut TraceQObject),
+    end_reset_model: extern fn(*mut TraceQObject),
+    begin_insert_rows: extern fn(*mut TraceQObject, usize, usize),
+    end_insert_rows: extern fn(*mut TraceQObject),
+    begin_move_rows: extern fn(*mut TraceQObject, usize, usize, usize),
+    end_move_rows: extern fn(*mut TraceQObject),
+    begin_remove_rows: extern fn(*mut TraceQObject, usize, usize),
+    end_remove_rows: extern fn(*mut TraceQObject),
+    layout_changed_with_permutation: extern fn(*mut TraceQObject, *const usize, usize),
+}
+
+impl TraceList {
+    pub fn layout_about_to_be_changed(&mut self) {
+        (self.layout_about_to_be_changed)(self.qobject);
+    }
+    pub fn layout_changed(&mut self) {
+        (self.layout_changed)(self.qobject);
+    }
+    pub fn data_changed(&mut self, first: usize, last: usize) {
+        (self.data_changed)(self.qobject, first, last);
+    }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[TraceProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
+    pub fn begin_reset_model(&mut self) {
+        (self.begin_reset_model)(self.qobject);
+    }
+    pub fn end_reset_model(&mut self) {
+        (self.end_reset_model)(self.qobject);
+    }
+    pub fn begin_insert_rows(&mut self, first: usize, last: usize) {
+        (self.begin_insert_rows)(self.qobject, first, last);
+    }
+    pub fn end_insert_rows(&mut self) {
+        (self.end_insert_rows)(self.qobject);
+    }
+    pub fn begin_move_rows(&mut self, first: usize, last: usize, destination: usize) {
+        (self.begin_move_rows)(self.qobject, first, last, destination);
+    }
+    pub fn end_move_rows(&mut self) {
+        (self.end_move_rows)(self.qobject);
+    }
+    pub fn begin_remove_rows(&mut self, first: usize, last: usize) {
+        (self.begin_remove_rows)(self.qobject, first, last);
+    }
+    pub fn end_remove_rows(&mut self) {
+        (self.end_remove_rows)(self.qobject);
+    }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
+}
+
+pub trait TraceTrait {
+    fn new(emit: TraceEmitter, model: TraceList) -> Self;
+    fn emit(&mut self) -> &mut TraceEmitter;
+    fn path(&self) -> Option<&str>;
+    fn set_path(&mut self, value: Option<String>);
+    fn row_count(&self) -> usize;
+    fn insert_rows(&mut self, _row: usize, _count: usize) -> bool { false }
+    fn remove_rows(&mut self, _row: usize, _count: usize) -> bool { false }
+    fn can_fetch_more(&self) -> bool {
+        false
+    }
+    fn fetch_more(&mut self) {}
+    fn sort(&mut self, _: u8, _: SortOrder) {}
+    fn label(&self, index: usize) -> &str;
+    fn time(&self, index: usize) -> u64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn time_column(&self, first: usize, column: &mut [u64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.time(first + row);
+        }
+    }
+    fn valid(&self, index: usize) -> bool;
+    fn value(&self, index: usize) -> f64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn value_column(&self, first: usize, column: &mut [f64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.value(first + row);
+        }
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn trace_new(
+    trace: *mut TraceQObject,
+    trace_path_changed: extern fn(*mut TraceQObject),
+    trace_new_data_ready: extern fn(*mut TraceQObject),
+    trace_layout_about_to_be_changed: extern fn(*mut TraceQObject),
+    trace_layout_changed: extern fn(*mut TraceQObject),
+    trace_data_changed: extern fn(*mut TraceQObject, usize, usize),
+    trace_properties_changed: extern fn(*mut TraceQObject, usize, usize, u64),
+    trace_begin_reset_model: extern fn(*mut TraceQObject),
+    trace_end_reset_model: extern fn(*mut TraceQObject),
+    trace_begin_insert_rows: extern fn(*mut TraceQObject, usize, usize),
+    trace_end_insert_rows: extern fn(*mut TraceQObject),
+    trace_begin_move_rows: extern fn(*mut TraceQObject, usize, usize, usize),
+    trace_end_move_rows: extern fn(*mut TraceQObject),
+    trace_begin_remove_rows: extern fn(*mut TraceQObject, usize, usize),
+    trace_end_remove_rows: extern fn(*mut TraceQObject),
+    trace_layout_changed_with_permutation: extern fn(*mut TraceQObject, *const usize, usize),
+) -> *mut Trace {
+    let trace_emit = TraceEmitter {
+        qobject: Arc::new(AtomicPtr::new(trace)),
+        path_changed: trace_path_changed,
+        new_data_ready: trace_new_data_ready,
+    };
+    let model = TraceList {
+        qobject: trace,
+        layout_about_to_be_changed: trace_layout_about_to_be_changed,
+        layout_changed: trace_layout_changed,
+        data_changed: trace_data_changed,
+        properties_changed: trace_properties_changed,
+        begin_reset_model: trace_begin_reset_model,
+        end_reset_model: trace_end_reset_model,
+        begin_insert_rows: trace_begin_insert_rows,
+        end_insert_rows: trace_end_insert_rows,
+        begin_move_rows: trace_begin_move_rows,
+        end_move_rows: trace_end_move_rows,
+        begin_remove_rows: trace_begin_remove_rows,
+        end_remove_rows: trace_end_remove_rows,
+        layout_changed_with_permutation: trace_layout_changed_with_permutation,
+    };
+    let d_trace = Trace::new(trace_emit, model);
+    Box::into_raw(Box::new(d_trace))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_free(ptr: *mut Trace) {
+    Box::from_raw(ptr).emit().clear();
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_path_get(
+    ptr: *const Trace,
+    p: *mut QString,
+    set: extern fn(*mut QString, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let v = o.path();
+    if let Some(v) = v {
+        let s: *const c_char = v.as_ptr() as *const c_char;
+        set(p, s, to_c_int(v.len()));
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_path_set(ptr: *mut Trace, v: *const c_ushort, len: c_int) {
+    let o = &mut *ptr;
+    let mut s = String::new();
+    set_string_from_utf16(&mut s, v, len);
+    o.set_path(Some(s));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_path_set_none(ptr: *mut Trace) {
+    let o = &mut *ptr;
+    o.set_path(None);
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_row_count(ptr: *const Trace) -> c_int {
+    to_c_int((&*ptr).row_count())
+}
+#[no_mangle]
+pub unsafe extern "C" fn trace_insert_rows(ptr: *mut Trace, row: c_int, count: c_int) -> bool {
+    (&mut *ptr).insert_rows(to_usize(row), to_usize(count))
+}
+#[no_mangle]
+pub unsafe extern "C" fn trace_remove_rows(ptr: *mut Trace, row: c_int, count: c_int) -> bool {
+    (&mut *ptr).remove_rows(to_usize(row), to_usize(count))
+}
+#[no_mangle]
+pub unsafe extern "C" fn trace_can_fetch_more(ptr: *const Trace) -> bool {
+    (&*ptr).can_fetch_more()
+}
+#[no_mangle]
+pub unsafe extern "C" fn trace_fetch_more(ptr: *mut Trace) {
+    (&mut *ptr).fetch_more()
+}
+#[no_mangle]
+pub unsafe extern "C" fn trace_sort(
+    ptr: *mut Trace,
+    column: u8,
+    order: SortOrder,
+) {
+    (&mut *ptr).sort(column, order)
+}
+
+#[repr(C)]
+pub struct TraceDataRange {
+    label: *mut QString,
+    time: *mut u64,
+    valid: *mut bool,
+    value: *mut f64,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_data_range(
+    ptr: *const Trace,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut TraceDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.label(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.label, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        let column = slice::from_raw_parts_mut(range.time, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.time(index);
+        }
+    }
+    if mask & (1 << 2) != 0 {
+        let column = slice::from_raw_parts_mut(range.valid, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.valid(index);
+        }
+    }
+    if mask & (1 << 3) != 0 {
+        let column = slice::from_raw_parts_mut(range.value, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.value(index);
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_data_label(
+    ptr: *const Trace, row: c_int,
+    d: *mut QString,
+    set: extern fn(*mut QString, *const c_char, len: c_int),
+) {
+    let o = &*ptr;
+    let data = o.label(to_usize(row));
+    let s: *const c_char = data.as_ptr() as *const c_char;
+    set(d, s, to_c_int(data.len()));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_data_time(ptr: *const Trace, row: c_int) -> u64 {
+    let o = &*ptr;
+    o.time(to_usize(row))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_column_time(ptr: *const Trace, first: c_int, count: c_int, column: *mut u64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).time_column(to_usize(first), column);
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_data_valid(ptr: *const Trace, row: c_int) -> bool {
+    let o = &*ptr;
+    o.valid(to_usize(row))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_data_value(ptr: *const Trace, row: c_int) -> f64 {
+    let o = &*ptr;
+    o.value(to_usize(row))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn trace_column_value(ptr: *const Trace, first: c_int, count: c_int, column: *mut f64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).value_column(to_usize(first), column);
+}
+
+/// The rows of Trace in a file of fixed size records.
+///
+/// The file starts with the number of records as a little endian u64.
+/// The records follow without padding. A record holds the item properties
+/// in the order of their names. Numbers are little endian and a bool is
+/// one byte. A QString or QByteArray is a little endian u64 offset in the
+/// file and a u32 length. Strings are UTF-8.
+pub struct TraceRecords {
+    file: MappedFile,
+    rows: usize,
+}
+
+impl TraceRecords {
+    /// The size of a record in bytes.
+    pub const RECORD_SIZE: usize = 29;
+
+    pub fn open<P: AsRef<::std::path::Path>>(path: P) -> ::std::io::Result<TraceRecords> {
+        let file = MappedFile::open(path)?;
+        match mapped_rows(file.bytes(), Self::RECORD_SIZE) {
+            Some(rows) => Ok(TraceRecords { file, rows }),
+            None => Err(::std::io::Error::new(
+                ::std::io::ErrorKind::InvalidData,
+                "file is too small for its records",
+            )),
+        }
+    }
+    pub fn empty() -> TraceRecords {
+        TraceRecords {
+            file: MappedFile::empty(),
+            rows: 0,
+        }
+    }
+    pub fn len(&self) -> usize {
+        self.rows
+    }
+    pub fn is_empty(&self) -> bool {
+        self.rows == 0
+    }
+    fn field(&self, row: usize, offset: usize, len: usize) -> &[u8] {
+        assert!(row < self.rows);
+        let start = 8 + row * Self::RECORD_SIZE + offset;
+        &self.file.bytes()[start..start + len]
+    }
+    /// The value, or an empty string if it is not valid UTF-8.
+    pub fn label(&self, row: usize) -> &str {
+        let bytes = mapped_slice(self.file.bytes(), self.field(row, 0, 12));
+        ::std::str::from_utf8(bytes).unwrap_or("")
+    }
+    pub fn time(&self, row: usize) -> u64 {
+        let mut value = [0u8; 8];
+        value.copy_from_slice(self.field(row, 12, 8));
+        u64::from_le_bytes(value)
+    }
+    pub fn valid(&self, row: usize) -> bool {
+        self.field(row, 20, 1)[0] != 0
+    }
+    pub fn value(&self, row: usize) -> f64 {
+        let mut value = [0u8; 8];
+        value.copy_from_slice(self.field(row, 21, 8));
+        f64::from_le_bytes(value)
+    }
+}
+
+pub struct SortedPersons {
+    property: c_int,
+    filter: String,
+}
+
+impl SortedPersons {
+    /// Tell if the item property `property` contains the filter.
+    fn matches(&self, o: &Persons, index: usize) -> bool {
+        let filter = &self.filter;
+        match self.property {
+            0 => {
+                let v = o.user_name(index);
+                v.to_lowercase().contains(filter)
+            }
+            _ => true,
+        }
+    }
+    fn accepts(&mut self, o: &Persons, index: usize) -> bool {
+        self.matches(o, index)
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn sorted_persons_new() -> *mut SortedPersons {
+    Box::into_raw(Box::new(SortedPersons {
+        property: -1,
+        filter: String::new(),
+    }))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn sorted_persons_free(ptr: *mut SortedPersons) {
+    drop(Box::from_raw(ptr));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn sorted_persons_set_filter(
+    ptr: *mut SortedPersons,
+    property: c_int,
+    filter: *const c_ushort,
+    filter_len: c_int,
+) {
+    let p = &mut *ptr;
+    p.property = property;
+    p.filter = String::from_utf16_lossy(slice::from_raw_parts(filter, to_usize(filter_len)))
+        .to_lowercase();
+}
+
+/// Write the rows that pass the filter, in sorted order, to `rows`.
+#[no_mangle]
+pub unsafe extern "C" fn sorted_persons_rows(
+    ptr: *mut SortedPersons,
+    source: *const Persons,
+    sort: c_int,
+    order: SortOrder,
+    rows: *mut c_int,
+) -> c_int {
+    let p = &mut *ptr;
+    let o = &*source;
+    let index = |row| row;
+    let row_count = o.row_count();
+    let mut accepted: Vec<usize> = (0..row_count)
+        .filter(|&row| p.filter.is_empty() || p.accepts(o, index(row)))
+        .collect();
+    match sort {
+        0 => {
+            let keys: Vec<_> = accepted.iter().map(|&row| o.user_name(index(row))).collect();
+            sort_rows(&mut accepted, keys, order, |a, b| a.cmp(b));
+        }
+        _ => {}
+    }
+    let rows = slice::from_raw_parts_mut(rows, accepted.len());
+    for (r, a) in rows.iter_mut().zip(&accepted) {
+        *r = to_c_int(*a);
+    }
+    to_c_int(accepted.len())
+}
+
+/// Find the position of the source row `row` among `rows`, the rows that
+/// pass the filter in sorted order without `row`. Return -1 when `row`
+/// does not pass the filter.
+#[no_mangle]
+pub unsafe extern "C" fn sorted_persons_place(
+    ptr: *mut SortedPersons,
+    source: *const Persons,
+    sort: c_int,
+    order: SortOrder,
+    rows: *const c_int,
+    len: c_int,
+    row: c_int,
+) -> c_int {
+    let p = &mut *ptr;
+    let o = &*source;
+    let index = |row| row;
+    let row = to_usize(row);
+    if !p.filter.is_empty() && !p.accepts(o, index(row)) {
+        return -1;
+    }
+    let rows = slice::from_raw_parts(rows, to_usize(len));
+    let place = match sort {
+        0 => place_row(rows, row, |r| o.user_name(index(r)), order, |a, b| a.cmp(b)),
+        _ => place_row(rows, row, |r| r, SortOrder::Ascending, |a, b| a.cmp(b)),
+    };
+    to_c_int(place)
+}
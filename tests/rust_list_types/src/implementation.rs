@@ -2,6 +2,7 @@
 #![allow(unused_variables)]
 #![allow(dead_code)]
 use interface::*;
+use std::sync::Arc;
 
 #[derive(Default, Clone)]
 struct ListItem {
@@ -19,8 +20,10 @@ struct ListItem {
     f64: f64,
     bytearray: Vec<u8>,
     optional_bytearray: Option<Vec<u8>>,
+    bytearray_arc: Option<Arc<[u8]>>,
     string: String,
     optional_string: Option<String>,
+    string_utf16: Vec<u16>,
 }
 
 pub struct List {
@@ -141,6 +144,23 @@ impl ListTrait for List {
         self.list[index].optional_string = v;
         true
     }
+    fn string_utf16(&self, index: usize) -> &[u16] {
+        &self.list[index].string_utf16
+    }
+    fn set_string_utf16(&mut self, index: usize, v: Vec<u16>) -> bool {
+        self.list[index].string_utf16 = v;
+        true
+    }
+    fn bytearray_arc(&self, index: usize) -> Arc<[u8]> {
+        match self.list[index].bytearray_arc {
+            Some(ref b) => b.clone(),
+            None => Arc::from(&[][..]),
+        }
+    }
+    fn set_bytearray_arc(&mut self, index: usize, v: &[u8]) -> bool {
+        self.list[index].bytearray_arc = Some(v.into());
+        true
+    }
     fn bytearray(&self, index: usize) -> &[u8] {
         &self.list[index].bytearray
     }
@@ -10,6 +10,7 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 #[repr(C)]
 pub struct COption<T> {
     data: T,
@@ -50,11 +51,35 @@ where
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -75,6 +100,205 @@ pub struct QModelIndex {
     internal_id: usize,
 }
 
+/// A model signal sent by `sync_rows`.
+enum SyncSignal<'a> {
+    BeginRemove(usize, usize),
+    EndRemove,
+    BeginMove(usize, usize),
+    EndMove,
+    BeginInsert(usize, usize),
+    EndInsert,
+    BeginLayout,
+    /// The old row of every row.
+    EndLayout(&'a [usize]),
+    Changed(usize, usize),
+}
+
+/// Most ranges of removed rows, ranges of inserted rows or moved rows that
+/// `sync_rows` signals one by one. Each of them shifts the rows, so more
+/// moves are sent as one layout change and more removes or inserts as a
+/// replacement of all rows. That keeps a sync O(n log n).
+const SYNC_MAX_SIGNALS: usize = 64;
+
+/// The number of runs of `true` in `flags`.
+fn count_runs<I: Iterator<Item = bool>>(flags: I) -> usize {
+    let mut runs = 0;
+    let mut previous = false;
+    for flag in flags {
+        if flag && !previous {
+            runs += 1;
+        }
+        previous = flag;
+    }
+    runs
+}
+
+/// Indexes into `seq` of a longest increasing subsequence, O(n log n).
+fn longest_increasing(seq: &[usize]) -> Vec<usize> {
+    let mut tails: Vec<usize> = Vec::new();
+    let mut prev = vec![usize::max_value(); seq.len()];
+    for (i, &v) in seq.iter().enumerate() {
+        let pos = match tails.binary_search_by(|&t| seq[t].cmp(&v)) {
+            Ok(pos) | Err(pos) => pos,
+        };
+        if pos > 0 {
+            prev[i] = tails[pos - 1];
+        }
+        if pos == tails.len() {
+            tails.push(i);
+        } else {
+            tails[pos] = i;
+        }
+    }
+    let mut lis = vec![0; tails.len()];
+    let mut i = tails.last().cloned().unwrap_or(0);
+    for slot in lis.iter_mut().rev() {
+        *slot = i;
+        i = prev[i];
+    }
+    lis
+}
+
+/// Turn `rows` into `new` with removes, moves, inserts and changes of
+/// the rows that have the same key. Rows that are not moved keep their
+/// place, so views keep their selection and scroll position. `signal` gets
+/// the rows as they are when the signal is sent.
+fn sync_rows<T, K, F, S>(rows: &mut Vec<T>, new: Vec<T>, key: F, mut signal: S)
+where
+    T: PartialEq,
+    K: ::std::hash::Hash + Eq,
+    F: Fn(&T) -> K,
+    S: FnMut(SyncSignal, &[T]),
+{
+    let new_rows: ::std::collections::HashMap<K, usize> =
+        new.iter().enumerate().map(|(i, t)| (key(t), i)).collect();
+    let mut seen = vec![false; new.len()];
+    let mut duplicate = new_rows.len() != new.len();
+    // the row in `new` of every old row, if it is still there
+    let targets: Vec<Option<usize>> = rows
+        .iter()
+        .map(|t| {
+            let target = new_rows.get(&key(t)).cloned();
+            if let Some(target) = target {
+                duplicate |= seen[target];
+                seen[target] = true;
+            }
+            target
+        })
+        .collect();
+    drop(new_rows);
+    if duplicate
+        || count_runs(targets.iter().map(|t| t.is_none())) > SYNC_MAX_SIGNALS
+        || count_runs(seen.iter().map(|s| !s)) > SYNC_MAX_SIGNALS
+    {
+        // keys are not unique or the rows changed too much, so replace all
+        if !rows.is_empty() {
+            signal(SyncSignal::BeginRemove(0, rows.len() - 1), rows);
+            rows.clear();
+            signal(SyncSignal::EndRemove, rows);
+        }
+        if !new.is_empty() {
+            signal(SyncSignal::BeginInsert(0, new.len() - 1), rows);
+            *rows = new;
+            signal(SyncSignal::EndInsert, rows);
+        }
+        return;
+    }
+    // remove rows that are gone, back to front, one range at a time
+    let mut end = targets.len();
+    while end > 0 {
+        if targets[end - 1].is_some() {
+            end -= 1;
+            continue;
+        }
+        let mut first = end - 1;
+        while first > 0 && targets[first - 1].is_none() {
+            first -= 1;
+        }
+        signal(SyncSignal::BeginRemove(first, end - 1), rows);
+        rows.drain(first..end);
+        signal(SyncSignal::EndRemove, rows);
+        end = first;
+    }
+    let mut current: Vec<usize> = targets.into_iter().filter_map(|t| t).collect();
+    // rows in a longest increasing run of targets stay, the others move
+    let lis = longest_increasing(&current);
+    if current.len() - lis.len() > SYNC_MAX_SIGNALS {
+        // order the rows by target in one pass
+        let mut by_target = vec![usize::max_value(); new.len()];
+        for (row, &target) in current.iter().enumerate() {
+            by_target[target] = row;
+        }
+        let old_rows: Vec<usize> = by_target
+            .into_iter()
+            .filter(|&row| row != usize::max_value())
+            .collect();
+        signal(SyncSignal::BeginLayout, rows);
+        let mut old: Vec<Option<T>> = rows.drain(..).map(Some).collect();
+        rows.extend(old_rows.iter().map(|&row| old[row].take().unwrap()));
+        signal(SyncSignal::EndLayout(&old_rows), rows);
+    } else if current.len() > lis.len() {
+        // at most SYNC_MAX_SIGNALS moves, each shifts the rows once
+        let mut placed = vec![false; new.len()];
+        for i in lis {
+            placed[current[i]] = true;
+        }
+        let mut previous: Option<usize> = None;
+        for target in 0..new.len() {
+            if !seen[target] {
+                continue;
+            }
+            if !placed[target] {
+                let from = current.iter().position(|&t| t == target).unwrap();
+                let to = previous
+                    .map(|p| current.iter().position(|&t| t == p).unwrap() + 1)
+                    .unwrap_or(0);
+                if to != from && to != from + 1 {
+                    signal(SyncSignal::BeginMove(from, to), rows);
+                    let row = rows.remove(from);
+                    let t = current.remove(from);
+                    let to = if to > from { to - 1 } else { to };
+                    rows.insert(to, row);
+                    current.insert(to, t);
+                    signal(SyncSignal::EndMove, rows);
+                }
+                placed[target] = true;
+            }
+            previous = Some(target);
+        }
+    }
+    // insert new rows and update the rows that stayed; there are at most
+    // SYNC_MAX_SIGNALS inserted ranges and each shifts the rows once
+    let mut new: Vec<Option<T>> = new.into_iter().map(Some).collect();
+    let mut row = 0;
+    while row < new.len() {
+        if seen[row] {
+            let mut last = row;
+            while last < new.len() && seen[last] && rows[last] != *new[last].as_ref().unwrap() {
+                rows[last] = new[last].take().unwrap();
+                last += 1;
+            }
+            if last > row {
+                signal(SyncSignal::Changed(row, last - 1), rows);
+                row = last;
+            } else {
+                row += 1;
+            }
+            continue;
+        }
+        let mut last = row;
+        while last + 1 < new.len() && !seen[last + 1] {
+            last += 1;
+        }
+        signal(SyncSignal::BeginInsert(row, last), rows);
+        let tail = rows.split_off(row);
+        rows.extend(new[row..=last].iter_mut().map(|t| t.take().unwrap()));
+        rows.extend(tail);
+        signal(SyncSignal::EndInsert, rows);
+        row = last + 1;
+    }
+}
+
 
 fn to_usize(n: c_int) -> usize {
     if n < 0 {
@@ -126,12 +350,36 @@ impl ListEmitter {
     }
 }
 
+/// The item properties of List, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum ListProperty {
+    Boolean = 0,
+    Bytearray = 1,
+    BytearrayArc = 2,
+    F32 = 3,
+    F64 = 4,
+    I16 = 5,
+    I32 = 6,
+    I64 = 7,
+    I8 = 8,
+    OptionalBoolean = 9,
+    OptionalBytearray = 10,
+    OptionalString = 11,
+    String = 12,
+    StringUtf16 = 13,
+    U16 = 14,
+    U32 = 15,
+    U64 = 16,
+    U8 = 17,
+}
+
 #[derive(Clone)]
 pub struct ListList {
     qobject: *mut ListQObject,
     layout_about_to_be_changed: extern fn(*mut ListQObject),
     layout_changed: extern fn(*mut ListQObject),
     data_changed: extern fn(*mut ListQObject, usize, usize),
+    properties_changed: extern fn(*mut ListQObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut ListQObject),
     end_reset_model: extern fn(*mut ListQObject),
     begin_insert_rows: extern fn(*mut ListQObject, usize, usize),
@@ -140,6 +388,7 @@ pub struct ListList {
     end_move_rows: extern fn(*mut ListQObject),
     begin_remove_rows: extern fn(*mut ListQObject, usize, usize),
     end_remove_rows: extern fn(*mut ListQObject),
+    layout_changed_with_permutation: extern fn(*mut ListQObject, *const usize, usize),
 }
 
 impl ListList {
@@ -152,6 +401,14 @@ impl ListList {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[ListProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -176,6 +433,34 @@ impl ListList {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Finish a layout change in which the item at row `i` came from row
+    /// `old_rows[i]`, e.g. after sorting. Persistent indexes are moved
+    /// to the new rows of their items; items that are not in `old_rows`
+    /// lose their persistent indexes.
+    pub fn layout_changed_with_permutation(&mut self, old_rows: &[usize]) {
+        (self.layout_changed_with_permutation)(self.qobject, old_rows.as_ptr(), old_rows.len());
+    }
+    /// Replace `rows` with `new` with as few removes, moves and inserts as
+    /// possible. Rows with the same `key` are kept and, if they differ,
+    /// updated and signalled with data_changed().
+    pub fn sync_from<T, K, F>(&mut self, rows: &mut Vec<T>, new: Vec<T>, key: F)
+    where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+    {
+        sync_rows(rows, new, key, |signal, _| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(from, from, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            SyncSignal::EndLayout(old_rows) => self.layout_changed_with_permutation(old_rows),
+            SyncSignal::Changed(first, last) => self.data_changed(first, last),
+        });
+    }
 }
 
 pub trait ListTrait {
@@ -193,17 +478,55 @@ pub trait ListTrait {
     fn set_boolean(&mut self, index: usize, _: bool) -> bool;
     fn bytearray(&self, index: usize) -> &[u8];
     fn set_bytearray(&mut self, index: usize, _: &[u8]) -> bool;
+    fn bytearray_arc(&self, index: usize) -> Arc<[u8]>;
+    fn set_bytearray_arc(&mut self, index: usize, _: &[u8]) -> bool;
     fn f32(&self, index: usize) -> f32;
+    /// Copy the values for the rows from `first` into `column`.
+    fn f32_column(&self, first: usize, column: &mut [f32]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.f32(first + row);
+        }
+    }
     fn set_f32(&mut self, index: usize, _: f32) -> bool;
     fn f64(&self, index: usize) -> f64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn f64_column(&self, first: usize, column: &mut [f64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.f64(first + row);
+        }
+    }
     fn set_f64(&mut self, index: usize, _: f64) -> bool;
     fn i16(&self, index: usize) -> i16;
+    /// Copy the values for the rows from `first` into `column`.
+    fn i16_column(&self, first: usize, column: &mut [i16]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.i16(first + row);
+        }
+    }
     fn set_i16(&mut self, index: usize, _: i16) -> bool;
     fn i32(&self, index: usize) -> i32;
+    /// Copy the values for the rows from `first` into `column`.
+    fn i32_column(&self, first: usize, column: &mut [i32]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.i32(first + row);
+        }
+    }
     fn set_i32(&mut self, index: usize, _: i32) -> bool;
     fn i64(&self, index: usize) -> i64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn i64_column(&self, first: usize, column: &mut [i64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.i64(first + row);
+        }
+    }
     fn set_i64(&mut self, index: usize, _: i64) -> bool;
     fn i8(&self, index: usize) -> i8;
+    /// Copy the values for the rows from `first` into `column`.
+    fn i8_column(&self, first: usize, column: &mut [i8]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.i8(first + row);
+        }
+    }
     fn set_i8(&mut self, index: usize, _: i8) -> bool;
     fn optional_boolean(&self, index: usize) -> Option<bool>;
     fn set_optional_boolean(&mut self, index: usize, _: Option<bool>) -> bool;
@@ -213,13 +536,39 @@ pub trait ListTrait {
     fn set_optional_string(&mut self, index: usize, _: Option<String>) -> bool;
     fn string(&self, index: usize) -> &str;
     fn set_string(&mut self, index: usize, _: String) -> bool;
+    fn string_utf16(&self, index: usize) -> &[u16];
+    fn set_string_utf16(&mut self, index: usize, _: Vec<u16>) -> bool;
     fn u16(&self, index: usize) -> u16;
+    /// Copy the values for the rows from `first` into `column`.
+    fn u16_column(&self, first: usize, column: &mut [u16]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.u16(first + row);
+        }
+    }
     fn set_u16(&mut self, index: usize, _: u16) -> bool;
     fn u32(&self, index: usize) -> u32;
+    /// Copy the values for the rows from `first` into `column`.
+    fn u32_column(&self, first: usize, column: &mut [u32]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.u32(first + row);
+        }
+    }
     fn set_u32(&mut self, index: usize, _: u32) -> bool;
     fn u64(&self, index: usize) -> u64;
+    /// Copy the values for the rows from `first` into `column`.
+    fn u64_column(&self, first: usize, column: &mut [u64]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.u64(first + row);
+        }
+    }
     fn set_u64(&mut self, index: usize, _: u64) -> bool;
     fn u8(&self, index: usize) -> u8;
+    /// Copy the values for the rows from `first` into `column`.
+    fn u8_column(&self, first: usize, column: &mut [u8]) {
+        for (row, value) in column.iter_mut().enumerate() {
+            *value = self.u8(first + row);
+        }
+    }
     fn set_u8(&mut self, index: usize, _: u8) -> bool;
 }
 
@@ -230,6 +579,7 @@ pub extern "C" fn list_new(
     list_layout_about_to_be_changed: extern fn(*mut ListQObject),
     list_layout_changed: extern fn(*mut ListQObject),
     list_data_changed: extern fn(*mut ListQObject, usize, usize),
+    list_properties_changed: extern fn(*mut ListQObject, usize, usize, u64),
     list_begin_reset_model: extern fn(*mut ListQObject),
     list_end_reset_model: extern fn(*mut ListQObject),
     list_begin_insert_rows: extern fn(*mut ListQObject, usize, usize),
@@ -238,6 +588,7 @@ pub extern "C" fn list_new(
     list_end_move_rows: extern fn(*mut ListQObject),
     list_begin_remove_rows: extern fn(*mut ListQObject, usize, usize),
     list_end_remove_rows: extern fn(*mut ListQObject),
+    list_layout_changed_with_permutation: extern fn(*mut ListQObject, *const usize, usize),
 ) -> *mut List {
     let list_emit = ListEmitter {
         qobject: Arc::new(AtomicPtr::new(list)),
@@ -248,6 +599,7 @@ pub extern "C" fn list_new(
         layout_about_to_be_changed: list_layout_about_to_be_changed,
         layout_changed: list_layout_changed,
         data_changed: list_data_changed,
+        properties_changed: list_properties_changed,
         begin_reset_model: list_begin_reset_model,
         end_reset_model: list_end_reset_model,
         begin_insert_rows: list_begin_insert_rows,
@@ -256,6 +608,7 @@ pub extern "C" fn list_new(
         end_move_rows: list_end_move_rows,
         begin_remove_rows: list_begin_remove_rows,
         end_remove_rows: list_end_remove_rows,
+        layout_changed_with_permutation: list_layout_changed_with_permutation,
     };
     let d_list = List::new(list_emit, model);
     Box::into_raw(Box::new(d_list))
@@ -295,6 +648,160 @@ pub unsafe extern "C" fn list_sort(
     (&mut *ptr).sort(column, order)
 }
 
+#[repr(C)]
+pub struct ListDataRange {
+    boolean: *mut bool,
+    bytearray: *mut QByteArray,
+    f32: *mut f32,
+    f64: *mut f64,
+    i16: *mut i16,
+    i32: *mut i32,
+    i64: *mut i64,
+    i8: *mut i8,
+    optional_boolean: *mut COption<bool>,
+    optional_bytearray: *mut QByteArray,
+    optional_string: *mut QString,
+    string: *mut QString,
+    string_utf16: *mut QString,
+    u16: *mut u16,
+    u32: *mut u32,
+    u64: *mut u64,
+    u8: *mut u8,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn list_data_range(
+    ptr: *const List,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut ListDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+    set_qbytearray: extern fn(*mut QByteArray, c_int, *const c_char, c_int),
+    set_qstring_utf16: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let rows = first..first + len;
+    if mask & (1 << 0) != 0 {
+        let column = slice::from_raw_parts_mut(range.boolean, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.boolean(index);
+        }
+    }
+    if mask & (1 << 1) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.bytearray(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qbytearray(range.bytearray, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 3) != 0 {
+        let column = slice::from_raw_parts_mut(range.f32, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.f32(index);
+        }
+    }
+    if mask & (1 << 4) != 0 {
+        let column = slice::from_raw_parts_mut(range.f64, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.f64(index);
+        }
+    }
+    if mask & (1 << 5) != 0 {
+        let column = slice::from_raw_parts_mut(range.i16, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.i16(index);
+        }
+    }
+    if mask & (1 << 6) != 0 {
+        let column = slice::from_raw_parts_mut(range.i32, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.i32(index);
+        }
+    }
+    if mask & (1 << 7) != 0 {
+        let column = slice::from_raw_parts_mut(range.i64, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.i64(index);
+        }
+    }
+    if mask & (1 << 8) != 0 {
+        let column = slice::from_raw_parts_mut(range.i8, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.i8(index);
+        }
+    }
+    if mask & (1 << 9) != 0 {
+        let column = slice::from_raw_parts_mut(range.optional_boolean, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.optional_boolean(index).into();
+        }
+    }
+    if mask & (1 << 10) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            if let Some(data) = o.optional_bytearray(index) {
+                let s: *const c_char = data.as_ptr() as *const c_char;
+                set_qbytearray(range.optional_bytearray, to_c_int(i), s, to_c_int(data.len()));
+            }
+        }
+    }
+    if mask & (1 << 11) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            if let Some(data) = o.optional_string(index) {
+                let s: *const c_char = data.as_ptr() as *const c_char;
+                set_qstring(range.optional_string, to_c_int(i), s, to_c_int(data.len()));
+            }
+        }
+    }
+    if mask & (1 << 12) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.string(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.string, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 13) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.string_utf16(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring_utf16(range.string_utf16, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+    if mask & (1 << 14) != 0 {
+        let column = slice::from_raw_parts_mut(range.u16, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.u16(index);
+        }
+    }
+    if mask & (1 << 15) != 0 {
+        let column = slice::from_raw_parts_mut(range.u32, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.u32(index);
+        }
+    }
+    if mask & (1 << 16) != 0 {
+        let column = slice::from_raw_parts_mut(range.u64, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.u64(index);
+        }
+    }
+    if mask & (1 << 17) != 0 {
+        let column = slice::from_raw_parts_mut(range.u8, len);
+        for (v, index) in column.iter_mut().zip(rows.clone()) {
+            *v = o.u8(index);
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn list_release_arc(data: *const c_char, len: c_int) {
+    let data = slice::from_raw_parts(data as *const u8, to_usize(len));
+    drop(Arc::from_raw(data as *const [u8]));
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_data_boolean(ptr: *const List, row: c_int) -> bool {
     let o = &*ptr;
@@ -331,12 +838,36 @@ pub unsafe extern "C" fn list_set_data_bytearray(
     o.set_bytearray(to_usize(row), slice)
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_data_bytearray_arc(ptr: *const List, row: c_int, len: *mut c_int) -> *const c_char {
+    let o = &*ptr;
+    let data = o.bytearray_arc(to_usize(row));
+    *len = to_c_int(data.len());
+    Arc::into_raw(data) as *const c_char
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn list_set_data_bytearray_arc(
+    ptr: *mut List, row: c_int,
+    s: *const c_char, len: c_int,
+) -> bool {
+    let o = &mut *ptr;
+    let slice = ::std::slice::from_raw_parts(s as *const u8, to_usize(len));
+    o.set_bytearray_arc(to_usize(row), slice)
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_data_f32(ptr: *const List, row: c_int) -> f32 {
     let o = &*ptr;
     o.f32(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_f32(ptr: *const List, first: c_int, count: c_int, column: *mut f32) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).f32_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_f32(
     ptr: *mut List, row: c_int,
@@ -351,6 +882,12 @@ pub unsafe extern "C" fn list_data_f64(ptr: *const List, row: c_int) -> f64 {
     o.f64(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_f64(ptr: *const List, first: c_int, count: c_int, column: *mut f64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).f64_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_f64(
     ptr: *mut List, row: c_int,
@@ -365,6 +902,12 @@ pub unsafe extern "C" fn list_data_i16(ptr: *const List, row: c_int) -> i16 {
     o.i16(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_i16(ptr: *const List, first: c_int, count: c_int, column: *mut i16) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).i16_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_i16(
     ptr: *mut List, row: c_int,
@@ -379,6 +922,12 @@ pub unsafe extern "C" fn list_data_i32(ptr: *const List, row: c_int) -> i32 {
     o.i32(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_i32(ptr: *const List, first: c_int, count: c_int, column: *mut i32) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).i32_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_i32(
     ptr: *mut List, row: c_int,
@@ -393,6 +942,12 @@ pub unsafe extern "C" fn list_data_i64(ptr: *const List, row: c_int) -> i64 {
     o.i64(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_i64(ptr: *const List, first: c_int, count: c_int, column: *mut i64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).i64_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_i64(
     ptr: *mut List, row: c_int,
@@ -407,6 +962,12 @@ pub unsafe extern "C" fn list_data_i8(ptr: *const List, row: c_int) -> i8 {
     o.i8(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_i8(ptr: *const List, first: c_int, count: c_int, column: *mut i8) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).i8_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_i8(
     ptr: *mut List, row: c_int,
@@ -516,12 +1077,40 @@ pub unsafe extern "C" fn list_set_data_string(
     o.set_string(to_usize(row), v)
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_data_string_utf16(
+    ptr: *const List, row: c_int,
+    d: *mut QString,
+    set: extern fn(*mut QString, *const c_char, len: c_int),
+) {
+    let o = &*ptr;
+    let data = o.string_utf16(to_usize(row));
+    let s: *const c_char = data.as_ptr() as *const c_char;
+    set(d, s, to_c_int(data.len()));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn list_set_data_string_utf16(
+    ptr: *mut List, row: c_int,
+    s: *const c_ushort, len: c_int,
+) -> bool {
+    let o = &mut *ptr;
+    let v = slice::from_raw_parts(s, to_usize(len)).to_vec();
+    o.set_string_utf16(to_usize(row), v)
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_data_u16(ptr: *const List, row: c_int) -> u16 {
     let o = &*ptr;
     o.u16(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_u16(ptr: *const List, first: c_int, count: c_int, column: *mut u16) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).u16_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_u16(
     ptr: *mut List, row: c_int,
@@ -536,6 +1125,12 @@ pub unsafe extern "C" fn list_data_u32(ptr: *const List, row: c_int) -> u32 {
     o.u32(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_u32(ptr: *const List, first: c_int, count: c_int, column: *mut u32) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).u32_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_u32(
     ptr: *mut List, row: c_int,
@@ -550,6 +1145,12 @@ pub unsafe extern "C" fn list_data_u64(ptr: *const List, row: c_int) -> u64 {
     o.u64(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_u64(ptr: *const List, first: c_int, count: c_int, column: *mut u64) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).u64_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_u64(
     ptr: *mut List, row: c_int,
@@ -564,6 +1165,12 @@ pub unsafe extern "C" fn list_data_u8(ptr: *const List, row: c_int) -> u8 {
     o.u8(to_usize(row))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn list_column_u8(ptr: *const List, first: c_int, count: c_int, column: *mut u8) {
+    let column = slice::from_raw_parts_mut(column, to_usize(count));
+    (&*ptr).u8_column(to_usize(first), column);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn list_set_data_u8(
     ptr: *mut List, row: c_int,
@@ -2,10 +2,12 @@
 #![allow(unused_variables)]
 #![allow(dead_code)]
 use interface::*;
+use std::cell::Cell;
 
 pub struct Person {
     emit: PersonEmitter,
     user_name: String,
+    user_name_reads: Cell<u32>,
 }
 
 impl PersonTrait for Person {
@@ -13,17 +15,51 @@ impl PersonTrait for Person {
         Person {
             emit: emit,
             user_name: String::new(),
+            user_name_reads: Cell::new(0),
         }
     }
     fn emit(&mut self) -> &mut PersonEmitter {
         &mut self.emit
     }
     fn user_name(&self) -> &str {
+        self.user_name_reads.set(self.user_name_reads.get() + 1);
         &self.user_name
     }
     fn set_user_name(&mut self, value: String) {
         self.user_name = value;
         self.emit.user_name_changed();
     }
+    fn user_name_reads(&self) -> u32 {
+        self.user_name_reads.get()
+    }
 }
 
+pub struct Account {
+    emit: AccountEmitter,
+    user_name: String,
+    user_name_reads: Cell<u32>,
+}
+
+impl AccountTrait for Account {
+    fn new(emit: AccountEmitter) -> Account {
+        Account {
+            emit: emit,
+            user_name: String::new(),
+            user_name_reads: Cell::new(0),
+        }
+    }
+    fn emit(&mut self) -> &mut AccountEmitter {
+        &mut self.emit
+    }
+    fn user_name(&self) -> &str {
+        self.user_name_reads.set(self.user_name_reads.get() + 1);
+        &self.user_name
+    }
+    fn set_user_name(&mut self, value: String) {
+        self.user_name = value;
+        self.emit.user_name_changed();
+    }
+    fn user_name_reads(&self) -> u32 {
+        self.user_name_reads.get()
+    }
+}
@@ -10,14 +10,39 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -38,11 +63,181 @@ fn to_c_int(n: usize) -> c_int {
 }
 
 
+extern "C" {
+    fn account_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Account that was made on another thread.
+enum AccountCommand {
+    UserNameReads(::std::sync::mpsc::SyncSender<u32>),
+}
+
+pub struct AccountQObject {}
+
+pub struct AccountEmitter {
+    qobject: Arc<AtomicPtr<AccountQObject>>,
+    /// One bit per property that changed since the last notification.
+    changes: Arc<::std::sync::atomic::AtomicU64>,
+    changes_pending: extern fn(*mut AccountQObject),
+    commands: Arc<::std::sync::Mutex<Vec<AccountCommand>>>,
+}
+
+unsafe impl Send for AccountEmitter {}
+
+impl AccountEmitter {
+    /// Clone the emitter
+    ///
+    /// The emitter can only be cloned when it is mutable. The emitter calls
+    /// into C++ code which may call into Rust again. If emmitting is possible
+    /// from immutable structures, that might lead to access to a mutable
+    /// reference. That is undefined behaviour and forbidden.
+    pub fn clone(&mut self) -> AccountEmitter {
+        AccountEmitter {
+            qobject: self.qobject.clone(),
+            changes: self.changes.clone(),
+            changes_pending: self.changes_pending,
+            commands: self.commands.clone(),
+        }
+    }
+    fn clear(&self) {
+        let n: *const AccountQObject = null();
+        self.qobject.store(n as *mut AccountQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    pub fn user_name_changed(&mut self) {
+        if self.changes.fetch_or(1 << 0, Ordering::SeqCst) == 0 {
+            let ptr = self.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {
+                (self.changes_pending)(ptr);
+            }
+        }
+    }
+    /// Call `user_name_reads` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_user_name_reads(&mut self) -> ::std::sync::mpsc::Receiver<u32> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(AccountCommand::UserNameReads(sender));
+        receiver
+    }
+    fn command(&mut self, command: AccountCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { account_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
+}
+
+pub trait AccountTrait {
+    fn new(emit: AccountEmitter) -> Self;
+    fn emit(&mut self) -> &mut AccountEmitter;
+    fn user_name(&self) -> &str;
+    fn set_user_name(&mut self, value: String);
+    fn user_name_reads(&self) -> u32;
+}
+
+#[no_mangle]
+pub extern "C" fn account_new(
+    account: *mut AccountQObject,
+    account_changes_pending: extern fn(*mut AccountQObject),
+) -> *mut Account {
+    let account_emit = AccountEmitter {
+        qobject: Arc::new(AtomicPtr::new(account)),
+        changes: Arc::new(::std::sync::atomic::AtomicU64::new(0)),
+        changes_pending: account_changes_pending,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
+    };
+    let d_account = Account::new(account_emit);
+    Box::into_raw(Box::new(d_account))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn account_free(ptr: *mut Account) {
+    Box::from_raw(ptr).emit().clear();
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn account_take_changes(ptr: *mut Account) -> u64 {
+    (&mut *ptr).emit().changes.swap(0, Ordering::SeqCst)
+}
+
+/// The properties that changed since the last call of take_changes.
+#[no_mangle]
+pub unsafe extern "C" fn account_pending_changes(ptr: *mut Account) -> u64 {
+    (&mut *ptr).emit().changes.load(Ordering::SeqCst)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn account_user_name_get(
+    ptr: *const Account,
+    p: *mut QString,
+    set: extern fn(*mut QString, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let v = o.user_name();
+    let s: *const c_char = v.as_ptr() as *const c_char;
+    set(p, s, to_c_int(v.len()));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn account_user_name_set(ptr: *mut Account, v: *const c_ushort, len: c_int) {
+    let o = &mut *ptr;
+    let mut s = String::new();
+    set_string_from_utf16(&mut s, v, len);
+    o.set_user_name(s);
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn account_user_name_reads(ptr: *const Account) -> u32 {
+    let o = &*ptr;
+    o.user_name_reads()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn account_apply_commands(ptr: *mut Account) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            AccountCommand::UserNameReads(sender) => {
+                let _ = sender.send(o.user_name_reads());
+            }
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
+extern "C" {
+    fn person_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Person that was made on another thread.
+enum PersonCommand {
+    UserNameReads(::std::sync::mpsc::SyncSender<u32>),
+}
+
 pub struct PersonQObject {}
 
 pub struct PersonEmitter {
     qobject: Arc<AtomicPtr<PersonQObject>>,
     user_name_changed: extern fn(*mut PersonQObject),
+    commands: Arc<::std::sync::Mutex<Vec<PersonCommand>>>,
 }
 
 unsafe impl Send for PersonEmitter {}
@@ -58,11 +253,14 @@ impl PersonEmitter {
         PersonEmitter {
             qobject: self.qobject.clone(),
             user_name_changed: self.user_name_changed,
+            commands: self.commands.clone(),
         }
     }
     fn clear(&self) {
         let n: *const PersonQObject = null();
         self.qobject.store(n as *mut PersonQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
     }
     pub fn user_name_changed(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
@@ -70,6 +268,30 @@ impl PersonEmitter {
             (self.user_name_changed)(ptr);
         }
     }
+    /// Call `user_name_reads` on the thread of the QObject.
+    ///
+    /// The result can be received when the call has been made. Calling
+    /// `recv()` on the thread of the QObject deadlocks: the call is made
+    /// by the event loop of that thread. When the QObject has been
+    /// destroyed, `recv()` returns an error.
+    pub fn invoke_user_name_reads(&mut self) -> ::std::sync::mpsc::Receiver<u32> {
+        let (sender, receiver) = ::std::sync::mpsc::sync_channel(1);
+        self.command(PersonCommand::UserNameReads(sender));
+        receiver
+    }
+    fn command(&mut self, command: PersonCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { person_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
 }
 
 pub trait PersonTrait {
@@ -77,6 +299,7 @@ pub trait PersonTrait {
     fn emit(&mut self) -> &mut PersonEmitter;
     fn user_name(&self) -> &str;
     fn set_user_name(&mut self, value: String);
+    fn user_name_reads(&self) -> u32;
 }
 
 #[no_mangle]
@@ -87,6 +310,7 @@ pub extern "C" fn person_new(
     let person_emit = PersonEmitter {
         qobject: Arc::new(AtomicPtr::new(person)),
         user_name_changed: person_user_name_changed,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
     };
     let d_person = Person::new(person_emit);
     Box::into_raw(Box::new(d_person))
@@ -116,3 +340,28 @@ pub unsafe extern "C" fn person_user_name_set(ptr: *mut Person, v: *const c_usho
     set_string_from_utf16(&mut s, v, len);
     o.set_user_name(s);
 }
+
+#[no_mangle]
+pub unsafe extern "C" fn person_user_name_reads(ptr: *const Person) -> u32 {
+    let o = &*ptr;
+    o.user_name_reads()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn person_apply_commands(ptr: *mut Person) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            PersonCommand::UserNameReads(sender) => {
+                let _ = sender.send(o.user_name_reads());
+            }
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
@@ -23,6 +23,7 @@ pub struct Object {
     string: String,
     optional_string: Option<String>,
     string_by_function: String,
+    string_utf16: Vec<u16>,
 }
 
 impl ObjectTrait for Object {
@@ -46,7 +47,8 @@ impl ObjectTrait for Object {
             optional_bytearray: None,
             string: String::new(),
             optional_string: None,
-            string_by_function: String::new()
+            string_by_function: String::new(),
+            string_utf16: Vec::new()
         }
     }
     fn emit(&mut self) -> &mut ObjectEmitter {
@@ -181,6 +183,13 @@ impl ObjectTrait for Object {
         self.string = value;
         self.emit.string_changed();
     }
+    fn string_utf16(&self) -> &[u16] {
+        &self.string_utf16
+    }
+    fn set_string_utf16(&mut self, value: Vec<u16>) {
+        self.string_utf16 = value;
+        self.emit.string_utf16_changed();
+    }
     fn string_by_function<F>(&self, getter: F) where F: FnOnce(&str) {
         getter(&self.string_by_function)
     }
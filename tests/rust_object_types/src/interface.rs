@@ -10,6 +10,7 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 #[repr(C)]
 pub struct COption<T> {
     data: T,
@@ -50,11 +51,35 @@ where
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -96,6 +121,7 @@ pub struct ObjectEmitter {
     optional_u64_changed: extern fn(*mut ObjectQObject),
     string_changed: extern fn(*mut ObjectQObject),
     string_by_function_changed: extern fn(*mut ObjectQObject),
+    string_utf16_changed: extern fn(*mut ObjectQObject),
     u16_changed: extern fn(*mut ObjectQObject),
     u32_changed: extern fn(*mut ObjectQObject),
     u64_changed: extern fn(*mut ObjectQObject),
@@ -128,6 +154,7 @@ impl ObjectEmitter {
             optional_u64_changed: self.optional_u64_changed,
             string_changed: self.string_changed,
             string_by_function_changed: self.string_by_function_changed,
+            string_utf16_changed: self.string_utf16_changed,
             u16_changed: self.u16_changed,
             u32_changed: self.u32_changed,
             u64_changed: self.u64_changed,
@@ -222,6 +249,12 @@ impl ObjectEmitter {
             (self.string_by_function_changed)(ptr);
         }
     }
+    pub fn string_utf16_changed(&mut self) {
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {
+            (self.string_utf16_changed)(ptr);
+        }
+    }
     pub fn u16_changed(&mut self) {
         let ptr = self.qobject.load(Ordering::SeqCst);
         if !ptr.is_null() {
@@ -278,6 +311,8 @@ pub trait ObjectTrait {
     fn string(&self) -> &str;
     fn set_string(&mut self, value: String);
     fn string_by_function<F>(&self, getter: F) where F: FnOnce(&str);    fn set_string_by_function(&mut self, value: String);
+    fn string_utf16(&self) -> &[u16];
+    fn set_string_utf16(&mut self, value: Vec<u16>);
     fn u16(&self) -> u16;
     fn set_u16(&mut self, value: u16);
     fn u32(&self) -> u32;
@@ -305,6 +340,7 @@ pub extern "C" fn object_new(
     object_optional_u64_changed: extern fn(*mut ObjectQObject),
     object_string_changed: extern fn(*mut ObjectQObject),
     object_string_by_function_changed: extern fn(*mut ObjectQObject),
+    object_string_utf16_changed: extern fn(*mut ObjectQObject),
     object_u16_changed: extern fn(*mut ObjectQObject),
     object_u32_changed: extern fn(*mut ObjectQObject),
     object_u64_changed: extern fn(*mut ObjectQObject),
@@ -326,6 +362,7 @@ pub extern "C" fn object_new(
         optional_u64_changed: object_optional_u64_changed,
         string_changed: object_string_changed,
         string_by_function_changed: object_string_by_function_changed,
+        string_utf16_changed: object_string_utf16_changed,
         u16_changed: object_u16_changed,
         u32_changed: object_u32_changed,
         u64_changed: object_u64_changed,
@@ -563,6 +600,25 @@ pub unsafe extern "C" fn object_string_by_function_set(ptr: *mut Object, v: *con
     o.set_string_by_function(s);
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn object_string_utf16_get(
+    ptr: *const Object,
+    p: *mut QString,
+    set: extern fn(*mut QString, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let v = o.string_utf16();
+    let s: *const c_char = v.as_ptr() as *const c_char;
+    set(p, s, to_c_int(v.len()));
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn object_string_utf16_set(ptr: *mut Object, v: *const c_ushort, len: c_int) {
+    let o = &mut *ptr;
+    let s = slice::from_raw_parts(v, to_usize(len)).to_vec();
+    o.set_string_utf16(s);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn object_u16_get(ptr: *const Object) -> u16 {
     (&*ptr).u16()
@@ -73,3 +73,28 @@ impl PersonTrait for Person {
     }
 }
 
+pub struct Progress {
+    emit: ProgressEmitter,
+    done: u32,
+}
+
+impl ProgressTrait for Progress {
+    fn new(emit: ProgressEmitter) -> Progress {
+        Progress {
+            emit: emit,
+            done: 0,
+        }
+    }
+    fn emit(&mut self) -> &mut ProgressEmitter {
+        &mut self.emit
+    }
+    fn done(&self) -> u32 {
+        self.done
+    }
+    fn advance(&mut self, steps: u32) {
+        for _ in 0..steps {
+            self.done += 1;
+            self.emit.done_changed();
+        }
+    }
+}
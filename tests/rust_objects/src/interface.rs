@@ -10,14 +10,39 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -248,3 +273,134 @@ pub unsafe extern "C" fn person_free(ptr: *mut Person) {
 pub unsafe extern "C" fn person_object_get(ptr: *mut Person) -> *mut InnerObject {
     (&mut *ptr).object_mut()
 }
+
+extern "C" {
+    fn progress_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Progress that was made on another thread.
+enum ProgressCommand {
+    Advance(u32),
+}
+
+pub struct ProgressQObject {}
+
+pub struct ProgressEmitter {
+    qobject: Arc<AtomicPtr<ProgressQObject>>,
+    /// One bit per property that changed since the last notification.
+    changes: Arc<::std::sync::atomic::AtomicU64>,
+    changes_pending: extern fn(*mut ProgressQObject),
+    commands: Arc<::std::sync::Mutex<Vec<ProgressCommand>>>,
+}
+
+unsafe impl Send for ProgressEmitter {}
+
+impl ProgressEmitter {
+    /// Clone the emitter
+    ///
+    /// The emitter can only be cloned when it is mutable. The emitter calls
+    /// into C++ code which may call into Rust again. If emmitting is possible
+    /// from immutable structures, that might lead to access to a mutable
+    /// reference. That is undefined behaviour and forbidden.
+    pub fn clone(&mut self) -> ProgressEmitter {
+        ProgressEmitter {
+            qobject: self.qobject.clone(),
+            changes: self.changes.clone(),
+            changes_pending: self.changes_pending,
+            commands: self.commands.clone(),
+        }
+    }
+    fn clear(&self) {
+        let n: *const ProgressQObject = null();
+        self.qobject.store(n as *mut ProgressQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    pub fn done_changed(&mut self) {
+        if self.changes.fetch_or(1 << 0, Ordering::SeqCst) == 0 {
+            let ptr = self.qobject.load(Ordering::SeqCst);
+            if !ptr.is_null() {
+                (self.changes_pending)(ptr);
+            }
+        }
+    }
+    /// Call `advance` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_advance(&mut self, steps: u32) {
+        self.command(ProgressCommand::Advance(steps));
+    }
+    fn command(&mut self, command: ProgressCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { progress_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
+}
+
+pub trait ProgressTrait {
+    fn new(emit: ProgressEmitter) -> Self;
+    fn emit(&mut self) -> &mut ProgressEmitter;
+    fn done(&self) -> u32;
+    fn advance(&mut self, steps: u32) -> ();
+}
+
+#[no_mangle]
+pub extern "C" fn progress_new(
+    progress: *mut ProgressQObject,
+    progress_changes_pending: extern fn(*mut ProgressQObject),
+) -> *mut Progress {
+    let progress_emit = ProgressEmitter {
+        qobject: Arc::new(AtomicPtr::new(progress)),
+        changes: Arc::new(::std::sync::atomic::AtomicU64::new(0)),
+        changes_pending: progress_changes_pending,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
+    };
+    let d_progress = Progress::new(progress_emit);
+    Box::into_raw(Box::new(d_progress))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn progress_free(ptr: *mut Progress) {
+    Box::from_raw(ptr).emit().clear();
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn progress_take_changes(ptr: *mut Progress) -> u64 {
+    (&mut *ptr).emit().changes.swap(0, Ordering::SeqCst)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn progress_done_get(ptr: *const Progress) -> u32 {
+    (&*ptr).done()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn progress_advance(ptr: *mut Progress, steps: u32) {
+    let o = &mut *ptr;
+    o.advance(steps)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn progress_apply_commands(ptr: *mut Progress) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            ProgressCommand::Advance(steps) => o.advance(steps),
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
@@ -11,45 +11,129 @@ struct PersonsItem {
 pub struct Persons {
     emit: PersonsEmitter,
     model: PersonsTree,
-    list: Vec<PersonsItem>,
+    nodes: TreeNodes<PersonsItem>,
 }
 
 impl PersonsTrait for Persons {
     fn new(emit: PersonsEmitter, model: PersonsTree) -> Persons {
+        let mut nodes = TreeNodes::new();
+        for row in 0..10 {
+            nodes.insert(None, row, PersonsItem::default());
+        }
         Persons {
             emit: emit,
             model: model,
-            list: vec![PersonsItem::default(); 10],
+            nodes: nodes,
         }
     }
     fn emit(&mut self) -> &mut PersonsEmitter {
         &mut self.emit
     }
     fn row_count(&self, index: Option<usize>) -> usize {
-        self.list.len()
+        self.nodes.row_count(index)
     }
     fn index(&self, index: Option<usize>, row: usize) -> usize {
-        0
+        self.nodes.index(index, row)
     }
     fn parent(&self, index: usize) -> Option<usize> {
-        None
+        self.nodes.parent(index)
     }
     fn row(&self, index: usize) -> usize {
-        index
+        self.nodes.row(index)
     }
     fn check_row(&self, index: usize, _row: usize) -> Option<usize> {
-        if index < self.list.len() {
-            Some(index)
-        } else {
-            None
-        }
+        self.nodes.check_row(index)
     }
     fn user_name(&self, index: usize) -> &str {
-        &self.list[index].user_name
+        &self.nodes.get(index).unwrap().user_name
     }
     fn set_user_name(&mut self, index: usize, v: String) -> bool {
-        self.list[index].user_name = v;
+        self.nodes.get_mut(index).unwrap().user_name = v;
         true
     }
+    fn replace(&mut self, row: u32) {
+        let row = row as usize;
+        let id = self.nodes.index(None, row);
+        self.model.begin_remove_rows(None, row, row);
+        self.nodes.remove(id);
+        self.model.end_remove_rows();
+        self.model.begin_insert_rows(None, row, row);
+        self.nodes.insert(None, row, PersonsItem::default());
+        self.model.end_insert_rows();
+    }
+}
+
+#[derive(PartialEq)]
+struct Name {
+    id: usize,
+    name: String,
+}
+
+/// A flat tree whose rows are synced from a list of names.
+pub struct Names {
+    emit: NamesEmitter,
+    model: NamesTree,
+    rows: Vec<Name>,
+    next_id: usize,
+}
+
+impl Names {
+    fn get(&self, index: usize) -> &Name {
+        self.rows.iter().find(|n| n.id == index).unwrap()
+    }
 }
 
+impl NamesTrait for Names {
+    fn new(emit: NamesEmitter, model: NamesTree) -> Names {
+        Names {
+            emit: emit,
+            model: model,
+            rows: Vec::new(),
+            next_id: 0,
+        }
+    }
+    fn emit(&mut self) -> &mut NamesEmitter {
+        &mut self.emit
+    }
+    fn row_count(&self, index: Option<usize>) -> usize {
+        if index.is_none() {
+            self.rows.len()
+        } else {
+            0
+        }
+    }
+    fn index(&self, index: Option<usize>, row: usize) -> usize {
+        self.rows[row].id
+    }
+    fn parent(&self, index: usize) -> Option<usize> {
+        None
+    }
+    fn row(&self, index: usize) -> usize {
+        self.rows.iter().position(|n| n.id == index).unwrap()
+    }
+    fn check_row(&self, index: usize, _row: usize) -> Option<usize> {
+        self.rows.iter().position(|n| n.id == index)
+    }
+    fn name(&self, index: usize) -> &str {
+        &self.get(index).name
+    }
+    fn set_names(&mut self, names: String) {
+        let mut new = Vec::new();
+        for name in names.split(',') {
+            // a name that is kept keeps its id
+            let id = match self.rows.iter().find(|n| n.name == name) {
+                Some(n) => n.id,
+                None => {
+                    self.next_id += 1;
+                    self.next_id
+                }
+            };
+            new.push(Name {
+                id: id,
+                name: name.into(),
+            });
+        }
+        self.model
+            .sync_from(None, &mut self.rows, new, |n| n.name.clone(), |n| n.id);
+    }
+}
@@ -10,6 +10,7 @@ use std::ptr::null;
 use implementation::*;
 
 
+
 #[repr(C)]
 pub struct COption<T> {
     data: T,
@@ -50,11 +51,35 @@ where
 pub enum QString {}
 
 fn set_string_from_utf16(s: &mut String, str: *const c_ushort, len: c_int) {
-    let utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
-    let characters = decode_utf16(utf16.iter().cloned())
-        .map(|r| r.unwrap());
+    let mut utf16 = unsafe { slice::from_raw_parts(str, to_usize(len)) };
     s.clear();
-    s.extend(characters);
+    s.reserve(utf16.len());
+    while !utf16.is_empty() {
+        // ASCII is checked and copied in blocks that the compiler vectorizes
+        let mut ascii = 0;
+        for block in utf16.chunks_exact(16) {
+            if block.iter().fold(0, |a, c| a | c) >= 0x80 {
+                break;
+            }
+            ascii += block.len();
+        }
+        while ascii < utf16.len() && utf16[ascii] < 0x80 {
+            ascii += 1;
+        }
+        // only ASCII is appended, so the string stays valid UTF-8
+        unsafe { s.as_mut_vec() }.extend(utf16[..ascii].iter().map(|&c| c as u8));
+        let rest = &utf16[ascii..];
+        if rest.is_empty() {
+            break;
+        }
+        // decode up to the next ASCII code unit, which never splits a
+        // surrogate pair; lone surrogates become U+FFFD
+        let end = rest[1..].iter().position(|&c| c < 0x80).map_or(rest.len(), |p| p + 1);
+        let characters = decode_utf16(rest[..end].iter().cloned())
+            .map(|r| r.unwrap_or(::std::char::REPLACEMENT_CHARACTER));
+        s.extend(characters);
+        utf16 = &rest[end..];
+    }
 }
 
 
@@ -72,6 +97,394 @@ pub struct QModelIndex {
     internal_id: usize,
 }
 
+/// A model signal sent by `sync_rows`.
+enum SyncSignal<'a> {
+    BeginRemove(usize, usize),
+    EndRemove,
+    BeginMove(usize, usize),
+    EndMove,
+    BeginInsert(usize, usize),
+    EndInsert,
+    BeginLayout,
+    /// The old row of every row.
+    EndLayout(&'a [usize]),
+    Changed(usize, usize),
+}
+
+/// Most ranges of removed rows, ranges of inserted rows or moved rows that
+/// `sync_rows` signals one by one. Each of them shifts the rows, so more
+/// moves are sent as one layout change and more removes or inserts as a
+/// replacement of all rows. That keeps a sync O(n log n).
+const SYNC_MAX_SIGNALS: usize = 64;
+
+/// The number of runs of `true` in `flags`.
+fn count_runs<I: Iterator<Item = bool>>(flags: I) -> usize {
+    let mut runs = 0;
+    let mut previous = false;
+    for flag in flags {
+        if flag && !previous {
+            runs += 1;
+        }
+        previous = flag;
+    }
+    runs
+}
+
+/// Indexes into `seq` of a longest increasing subsequence, O(n log n).
+fn longest_increasing(seq: &[usize]) -> Vec<usize> {
+    let mut tails: Vec<usize> = Vec::new();
+    let mut prev = vec![usize::max_value(); seq.len()];
+    for (i, &v) in seq.iter().enumerate() {
+        let pos = match tails.binary_search_by(|&t| seq[t].cmp(&v)) {
+            Ok(pos) | Err(pos) => pos,
+        };
+        if pos > 0 {
+            prev[i] = tails[pos - 1];
+        }
+        if pos == tails.len() {
+            tails.push(i);
+        } else {
+            tails[pos] = i;
+        }
+    }
+    let mut lis = vec![0; tails.len()];
+    let mut i = tails.last().cloned().unwrap_or(0);
+    for slot in lis.iter_mut().rev() {
+        *slot = i;
+        i = prev[i];
+    }
+    lis
+}
+
+/// Turn `rows` into `new` with removes, moves, inserts and changes of
+/// the rows that have the same key. Rows that are not moved keep their
+/// place, so views keep their selection and scroll position. `signal` gets
+/// the rows as they are when the signal is sent.
+fn sync_rows<T, K, F, S>(rows: &mut Vec<T>, new: Vec<T>, key: F, mut signal: S)
+where
+    T: PartialEq,
+    K: ::std::hash::Hash + Eq,
+    F: Fn(&T) -> K,
+    S: FnMut(SyncSignal, &[T]),
+{
+    let new_rows: ::std::collections::HashMap<K, usize> =
+        new.iter().enumerate().map(|(i, t)| (key(t), i)).collect();
+    let mut seen = vec![false; new.len()];
+    let mut duplicate = new_rows.len() != new.len();
+    // the row in `new` of every old row, if it is still there
+    let targets: Vec<Option<usize>> = rows
+        .iter()
+        .map(|t| {
+            let target = new_rows.get(&key(t)).cloned();
+            if let Some(target) = target {
+                duplicate |= seen[target];
+                seen[target] = true;
+            }
+            target
+        })
+        .collect();
+    drop(new_rows);
+    if duplicate
+        || count_runs(targets.iter().map(|t| t.is_none())) > SYNC_MAX_SIGNALS
+        || count_runs(seen.iter().map(|s| !s)) > SYNC_MAX_SIGNALS
+    {
+        // keys are not unique or the rows changed too much, so replace all
+        if !rows.is_empty() {
+            signal(SyncSignal::BeginRemove(0, rows.len() - 1), rows);
+            rows.clear();
+            signal(SyncSignal::EndRemove, rows);
+        }
+        if !new.is_empty() {
+            signal(SyncSignal::BeginInsert(0, new.len() - 1), rows);
+            *rows = new;
+            signal(SyncSignal::EndInsert, rows);
+        }
+        return;
+    }
+    // remove rows that are gone, back to front, one range at a time
+    let mut end = targets.len();
+    while end > 0 {
+        if targets[end - 1].is_some() {
+            end -= 1;
+            continue;
+        }
+        let mut first = end - 1;
+        while first > 0 && targets[first - 1].is_none() {
+            first -= 1;
+        }
+        signal(SyncSignal::BeginRemove(first, end - 1), rows);
+        rows.drain(first..end);
+        signal(SyncSignal::EndRemove, rows);
+        end = first;
+    }
+    let mut current: Vec<usize> = targets.into_iter().filter_map(|t| t).collect();
+    // rows in a longest increasing run of targets stay, the others move
+    let lis = longest_increasing(&current);
+    if current.len() - lis.len() > SYNC_MAX_SIGNALS {
+        // order the rows by target in one pass
+        let mut by_target = vec![usize::max_value(); new.len()];
+        for (row, &target) in current.iter().enumerate() {
+            by_target[target] = row;
+        }
+        let old_rows: Vec<usize> = by_target
+            .into_iter()
+            .filter(|&row| row != usize::max_value())
+            .collect();
+        signal(SyncSignal::BeginLayout, rows);
+        let mut old: Vec<Option<T>> = rows.drain(..).map(Some).collect();
+        rows.extend(old_rows.iter().map(|&row| old[row].take().unwrap()));
+        signal(SyncSignal::EndLayout(&old_rows), rows);
+    } else if current.len() > lis.len() {
+        // at most SYNC_MAX_SIGNALS moves, each shifts the rows once
+        let mut placed = vec![false; new.len()];
+        for i in lis {
+            placed[current[i]] = true;
+        }
+        let mut previous: Option<usize> = None;
+        for target in 0..new.len() {
+            if !seen[target] {
+                continue;
+            }
+            if !placed[target] {
+                let from = current.iter().position(|&t| t == target).unwrap();
+                let to = previous
+                    .map(|p| current.iter().position(|&t| t == p).unwrap() + 1)
+                    .unwrap_or(0);
+                if to != from && to != from + 1 {
+                    signal(SyncSignal::BeginMove(from, to), rows);
+                    let row = rows.remove(from);
+                    let t = current.remove(from);
+                    let to = if to > from { to - 1 } else { to };
+                    rows.insert(to, row);
+                    current.insert(to, t);
+                    signal(SyncSignal::EndMove, rows);
+                }
+                placed[target] = true;
+            }
+            previous = Some(target);
+        }
+    }
+    // insert new rows and update the rows that stayed; there are at most
+    // SYNC_MAX_SIGNALS inserted ranges and each shifts the rows once
+    let mut new: Vec<Option<T>> = new.into_iter().map(Some).collect();
+    let mut row = 0;
+    while row < new.len() {
+        if seen[row] {
+            let mut last = row;
+            while last < new.len() && seen[last] && rows[last] != *new[last].as_ref().unwrap() {
+                rows[last] = new[last].take().unwrap();
+                last += 1;
+            }
+            if last > row {
+                signal(SyncSignal::Changed(row, last - 1), rows);
+                row = last;
+            } else {
+                row += 1;
+            }
+            continue;
+        }
+        let mut last = row;
+        while last + 1 < new.len() && !seen[last + 1] {
+            last += 1;
+        }
+        signal(SyncSignal::BeginInsert(row, last), rows);
+        let tail = rows.split_off(row);
+        rows.extend(new[row..=last].iter_mut().map(|t| t.take().unwrap()));
+        rows.extend(tail);
+        signal(SyncSignal::EndInsert, rows);
+        row = last + 1;
+    }
+}
+
+/// Number of bits of a tree item id that select the slot. The other bits
+/// hold the generation of the slot. On 32 bit targets the generation gets
+/// 8 bits, so a slot is retired after 255 reuses but a tree can hold 2^24
+/// items.
+#[cfg(target_pointer_width = "64")]
+const TREE_SLOT_BITS: usize = 32;
+#[cfg(not(target_pointer_width = "64"))]
+const TREE_SLOT_BITS: usize = 24;
+const TREE_SLOT_MASK: usize = (1 << TREE_SLOT_BITS) - 1;
+const TREE_MAX_GENERATION: usize = ::std::usize::MAX >> TREE_SLOT_BITS;
+
+struct TreeNode<T> {
+    parent: Option<usize>,
+    row: usize,
+    children: Vec<usize>,
+    data: T,
+}
+
+struct TreeSlot<T> {
+    generation: usize,
+    node: Option<TreeNode<T>>,
+}
+
+/// Storage for the items of a Tree model.
+///
+/// The ids of the items can be used as the ids of the Tree trait. An id
+/// holds a slot and the generation of that slot. Removing an item frees
+/// its slot for reuse and increases the generation, so an id of a removed
+/// item is never valid again.
+pub struct TreeNodes<T> {
+    slots: Vec<TreeSlot<T>>,
+    free: Vec<usize>,
+    roots: Vec<usize>,
+    len: usize,
+}
+
+impl<T> Default for TreeNodes<T> {
+    fn default() -> TreeNodes<T> {
+        TreeNodes {
+            slots: Vec::new(),
+            free: Vec::new(),
+            roots: Vec::new(),
+            len: 0,
+        }
+    }
+}
+
+impl<T> TreeNodes<T> {
+    pub fn new() -> TreeNodes<T> {
+        TreeNodes::default()
+    }
+    fn node(&self, id: usize) -> Option<&TreeNode<T>> {
+        match self.slots.get(id & TREE_SLOT_MASK) {
+            Some(slot) if slot.generation == id >> TREE_SLOT_BITS => slot.node.as_ref(),
+            _ => None,
+        }
+    }
+    fn node_mut(&mut self, id: usize) -> Option<&mut TreeNode<T>> {
+        match self.slots.get_mut(id & TREE_SLOT_MASK) {
+            Some(slot) if slot.generation == id >> TREE_SLOT_BITS => slot.node.as_mut(),
+            _ => None,
+        }
+    }
+    fn siblings_mut(&mut self, parent: Option<usize>) -> &mut Vec<usize> {
+        match parent {
+            Some(parent) => &mut self.node_mut(parent).expect("invalid tree id").children,
+            None => &mut self.roots,
+        }
+    }
+    /// Set the rows of the children of `parent`, starting at `first`.
+    fn update_rows(&mut self, parent: Option<usize>, first: usize) {
+        let siblings = ::std::mem::replace(self.siblings_mut(parent), Vec::new());
+        for (row, &id) in siblings.iter().enumerate().skip(first) {
+            self.slots[id & TREE_SLOT_MASK].node.as_mut().unwrap().row = row;
+        }
+        *self.siblings_mut(parent) = siblings;
+    }
+    /// Number of items in the tree.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+    /// Tell if `id` belongs to an item that has not been removed.
+    pub fn contains(&self, id: usize) -> bool {
+        self.node(id).is_some()
+    }
+    pub fn get(&self, id: usize) -> Option<&T> {
+        self.node(id).map(|n| &n.data)
+    }
+    pub fn get_mut(&mut self, id: usize) -> Option<&mut T> {
+        self.node_mut(id).map(|n| &mut n.data)
+    }
+    pub fn parent(&self, id: usize) -> Option<usize> {
+        self.node(id).and_then(|n| n.parent)
+    }
+    pub fn row(&self, id: usize) -> usize {
+        self.node(id).map_or(0, |n| n.row)
+    }
+    /// The row of `id`, or `None` if the item was removed.
+    pub fn check_row(&self, id: usize) -> Option<usize> {
+        self.node(id).map(|n| n.row)
+    }
+    /// The ids of the children of `parent`, or of the top level items.
+    pub fn children(&self, parent: Option<usize>) -> &[usize] {
+        match parent {
+            Some(parent) => self.node(parent).map_or(&[], |n| &n.children[..]),
+            None => &self.roots,
+        }
+    }
+    pub fn row_count(&self, parent: Option<usize>) -> usize {
+        self.children(parent).len()
+    }
+    pub fn index(&self, parent: Option<usize>, row: usize) -> usize {
+        self.children(parent)[row]
+    }
+    /// Add an item at `row` under `parent` and return its id.
+    pub fn insert(&mut self, parent: Option<usize>, row: usize, data: T) -> usize {
+        let node = TreeNode {
+            parent,
+            row,
+            children: Vec::new(),
+            data,
+        };
+        let slot = match self.free.pop() {
+            Some(slot) => {
+                self.slots[slot].node = Some(node);
+                slot
+            }
+            None => {
+                // a larger slot would overwrite the generation bits of the id
+                assert!(
+                    self.slots.len() <= TREE_SLOT_MASK,
+                    "TreeNodes cannot hold more than {} items",
+                    TREE_SLOT_MASK + 1
+                );
+                self.slots.push(TreeSlot {
+                    generation: 0,
+                    node: Some(node),
+                });
+                self.slots.len() - 1
+            }
+        };
+        let id = self.slots[slot].generation << TREE_SLOT_BITS | slot;
+        self.siblings_mut(parent).insert(row, id);
+        self.update_rows(parent, row + 1);
+        self.len += 1;
+        id
+    }
+    /// Remove an item and all of its descendants and return its data.
+    pub fn remove(&mut self, id: usize) -> Option<T> {
+        let (parent, row) = match self.node(id) {
+            Some(node) => (node.parent, node.row),
+            None => return None,
+        };
+        self.siblings_mut(parent).remove(row);
+        self.update_rows(parent, row);
+        let node = self.free_slot(id);
+        let mut descendants = node.children;
+        while let Some(id) = descendants.pop() {
+            descendants.extend(self.free_slot(id).children);
+        }
+        Some(node.data)
+    }
+    fn free_slot(&mut self, id: usize) -> TreeNode<T> {
+        let slot = id & TREE_SLOT_MASK;
+        let s = &mut self.slots[slot];
+        // a slot whose generation is used up is not used again
+        if s.generation < TREE_MAX_GENERATION {
+            s.generation += 1;
+            self.free.push(slot);
+        }
+        self.len -= 1;
+        s.node.take().unwrap()
+    }
+    /// Remove all items. Old ids stay invalid.
+    pub fn clear(&mut self) {
+        let roots = ::std::mem::replace(&mut self.roots, Vec::new());
+        for id in roots {
+            let node = self.free_slot(id);
+            let mut descendants = node.children;
+            while let Some(id) = descendants.pop() {
+                descendants.extend(self.free_slot(id).children);
+            }
+        }
+    }
+}
+
 
 fn to_usize(n: c_int) -> usize {
     if n < 0 {
@@ -89,11 +502,417 @@ fn to_c_int(n: usize) -> c_int {
 }
 
 
+extern "C" {
+    fn names_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Names that was made on another thread.
+enum NamesCommand {
+    SetNames(String),
+}
+
+pub struct NamesQObject {}
+
+pub struct NamesEmitter {
+    qobject: Arc<AtomicPtr<NamesQObject>>,
+    new_data_ready: extern fn(*mut NamesQObject, index: COption<usize>),
+    commands: Arc<::std::sync::Mutex<Vec<NamesCommand>>>,
+}
+
+unsafe impl Send for NamesEmitter {}
+
+impl NamesEmitter {
+    /// Clone the emitter
+    ///
+    /// The emitter can only be cloned when it is mutable. The emitter calls
+    /// into C++ code which may call into Rust again. If emmitting is possible
+    /// from immutable structures, that might lead to access to a mutable
+    /// reference. That is undefined behaviour and forbidden.
+    pub fn clone(&mut self) -> NamesEmitter {
+        NamesEmitter {
+            qobject: self.qobject.clone(),
+            new_data_ready: self.new_data_ready,
+            commands: self.commands.clone(),
+        }
+    }
+    fn clear(&self) {
+        let n: *const NamesQObject = null();
+        self.qobject.store(n as *mut NamesQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    /// Call `set_names` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_set_names(&mut self, names: String) {
+        self.command(NamesCommand::SetNames(names));
+    }
+    fn command(&mut self, command: NamesCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { names_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
+    }
+    pub fn new_data_ready(&mut self, item: Option<usize>) {
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if !ptr.is_null() {
+            (self.new_data_ready)(ptr, item.into());
+        }
+    }
+}
+
+/// The item properties of Names, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum NamesProperty {
+    Name = 0,
+}
+
+#[derive(Clone)]
+pub struct NamesTree {
+    qobject: *mut NamesQObject,
+    layout_about_to_be_changed: extern fn(*mut NamesQObject),
+    layout_changed: extern fn(*mut NamesQObject),
+    data_changed: extern fn(*mut NamesQObject, usize, usize),
+    properties_changed: extern fn(*mut NamesQObject, usize, usize, u64),
+    begin_reset_model: extern fn(*mut NamesQObject),
+    end_reset_model: extern fn(*mut NamesQObject),
+    begin_insert_rows: extern fn(*mut NamesQObject, index: COption<usize>, usize, usize),
+    end_insert_rows: extern fn(*mut NamesQObject),
+    begin_move_rows: extern fn(*mut NamesQObject, index: COption<usize>, usize, usize, dest: COption<usize>, usize),
+    end_move_rows: extern fn(*mut NamesQObject),
+    begin_remove_rows: extern fn(*mut NamesQObject, index: COption<usize>, usize, usize),
+    end_remove_rows: extern fn(*mut NamesQObject),
+}
+
+impl NamesTree {
+    pub fn layout_about_to_be_changed(&mut self) {
+        (self.layout_about_to_be_changed)(self.qobject);
+    }
+    pub fn layout_changed(&mut self) {
+        (self.layout_changed)(self.qobject);
+    }
+    pub fn data_changed(&mut self, first: usize, last: usize) {
+        (self.data_changed)(self.qobject, first, last);
+    }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[NamesProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
+    pub fn begin_reset_model(&mut self) {
+        (self.begin_reset_model)(self.qobject);
+    }
+    pub fn end_reset_model(&mut self) {
+        (self.end_reset_model)(self.qobject);
+    }
+    pub fn begin_insert_rows(&mut self, index: Option<usize>, first: usize, last: usize) {
+        (self.begin_insert_rows)(self.qobject, index.into(), first, last);
+    }
+    pub fn end_insert_rows(&mut self) {
+        (self.end_insert_rows)(self.qobject);
+    }
+    pub fn begin_move_rows(&mut self, index: Option<usize>, first: usize, last: usize, dest: Option<usize>, destination: usize) {
+        (self.begin_move_rows)(self.qobject, index.into(), first, last, dest.into(), destination);
+    }
+    pub fn end_move_rows(&mut self) {
+        (self.end_move_rows)(self.qobject);
+    }
+    pub fn begin_remove_rows(&mut self, index: Option<usize>, first: usize, last: usize) {
+        (self.begin_remove_rows)(self.qobject, index.into(), first, last);
+    }
+    pub fn end_remove_rows(&mut self) {
+        (self.end_remove_rows)(self.qobject);
+    }
+    /// Replace `rows`, the children of `index`, with `new` with as few
+    /// removes, moves and inserts as possible. Rows with the same `key`
+    /// are kept and, if they differ, updated and signalled with
+    /// data_changed() for the items given by `id`. `row()` has to agree
+    /// with `rows` while the signals are sent.
+    pub fn sync_from<T, K, F, I>(
+        &mut self,
+        index: Option<usize>,
+        rows: &mut Vec<T>,
+        new: Vec<T>,
+        key: F,
+        id: I,
+    ) where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+        I: Fn(&T) -> usize,
+    {
+        sync_rows(rows, new, key, |signal, current| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(index, first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(index, from, from, index, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(index, first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            // persistent indexes are found again by id
+            SyncSignal::EndLayout(_old_rows) => self.layout_changed(),
+            SyncSignal::Changed(first, last) => {
+                self.data_changed(id(&current[first]), id(&current[last]))
+            }
+        });
+    }
+}
+
+pub trait NamesTrait {
+    fn new(emit: NamesEmitter, model: NamesTree) -> Self;
+    fn emit(&mut self) -> &mut NamesEmitter;
+    fn set_names(&mut self, names: String) -> ();
+    fn row_count(&self, _: Option<usize>) -> usize;
+    /// Tell if an item has or may have children. Override this when
+    /// row_count() starts loading data that is not needed to answer.
+    fn has_children(&self, index: Option<usize>) -> bool {
+        self.row_count(index) > 0
+    }
+    fn can_fetch_more(&self, _: Option<usize>) -> bool {
+        false
+    }
+    fn fetch_more(&mut self, _: Option<usize>) {}
+    fn sort(&mut self, _: u8, _: SortOrder) {}
+    fn check_row(&self, index: usize, row: usize) -> Option<usize>;
+    fn index(&self, item: Option<usize>, row: usize) -> usize;
+    fn parent(&self, index: usize) -> Option<usize>;
+    fn row(&self, index: usize) -> usize;
+    fn name(&self, index: usize) -> &str;
+}
+
+#[no_mangle]
+pub extern "C" fn names_new(
+    names: *mut NamesQObject,
+    names_new_data_ready: extern fn(*mut NamesQObject, index: COption<usize>),
+    names_layout_about_to_be_changed: extern fn(*mut NamesQObject),
+    names_layout_changed: extern fn(*mut NamesQObject),
+    names_data_changed: extern fn(*mut NamesQObject, usize, usize),
+    names_properties_changed: extern fn(*mut NamesQObject, usize, usize, u64),
+    names_begin_reset_model: extern fn(*mut NamesQObject),
+    names_end_reset_model: extern fn(*mut NamesQObject),
+    names_begin_insert_rows: extern fn(*mut NamesQObject, index: COption<usize>, usize, usize),
+    names_end_insert_rows: extern fn(*mut NamesQObject),
+    names_begin_move_rows: extern fn(*mut NamesQObject, index: COption<usize>, usize, usize, index: COption<usize>, usize),
+    names_end_move_rows: extern fn(*mut NamesQObject),
+    names_begin_remove_rows: extern fn(*mut NamesQObject, index: COption<usize>, usize, usize),
+    names_end_remove_rows: extern fn(*mut NamesQObject),
+) -> *mut Names {
+    let names_emit = NamesEmitter {
+        qobject: Arc::new(AtomicPtr::new(names)),
+        new_data_ready: names_new_data_ready,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
+    };
+    let model = NamesTree {
+        qobject: names,
+        layout_about_to_be_changed: names_layout_about_to_be_changed,
+        layout_changed: names_layout_changed,
+        data_changed: names_data_changed,
+        properties_changed: names_properties_changed,
+        begin_reset_model: names_begin_reset_model,
+        end_reset_model: names_end_reset_model,
+        begin_insert_rows: names_begin_insert_rows,
+        end_insert_rows: names_end_insert_rows,
+        begin_move_rows: names_begin_move_rows,
+        end_move_rows: names_end_move_rows,
+        begin_remove_rows: names_begin_remove_rows,
+        end_remove_rows: names_end_remove_rows,
+    };
+    let d_names = Names::new(names_emit, model);
+    Box::into_raw(Box::new(d_names))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn names_free(ptr: *mut Names) {
+    Box::from_raw(ptr).emit().clear();
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn names_set_names(ptr: *mut Names, names_str: *const c_ushort, names_len: c_int) {
+    let mut names = String::new();
+    set_string_from_utf16(&mut names, names_str, names_len);
+    let o = &mut *ptr;
+    o.set_names(names)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn names_apply_commands(ptr: *mut Names) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            NamesCommand::SetNames(names) => o.set_names(names),
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn names_row_count(
+    ptr: *const Names,
+    index: COption<usize>,
+) -> c_int {
+    to_c_int((&*ptr).row_count(index.into()))
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_has_children(
+    ptr: *const Names,
+    index: COption<usize>,
+) -> bool {
+    (&*ptr).has_children(index.into())
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_can_fetch_more(
+    ptr: *const Names,
+    index: COption<usize>,
+) -> bool {
+    (&*ptr).can_fetch_more(index.into())
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_fetch_more(ptr: *mut Names, index: COption<usize>) {
+    (&mut *ptr).fetch_more(index.into())
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_sort(
+    ptr: *mut Names,
+    column: u8,
+    order: SortOrder
+) {
+    (&mut *ptr).sort(column, order)
+}
+/// Replace each row in `rows` with the current row of the item in `ids`
+/// or with -1 if the item is gone.
+#[no_mangle]
+pub unsafe extern "C" fn names_check_rows(
+    ptr: *const Names,
+    ids: *const usize,
+    rows: *mut c_int,
+    len: c_int,
+) {
+    let o = &*ptr;
+    let ids = slice::from_raw_parts(ids, to_usize(len));
+    let rows = slice::from_raw_parts_mut(rows, to_usize(len));
+    for (id, row) in ids.iter().zip(rows.iter_mut()) {
+        *row = o.check_row(*id, to_usize(*row)).map_or(-1, to_c_int);
+    }
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_index(
+    ptr: *const Names,
+    index: COption<usize>,
+    row: c_int,
+) -> usize {
+    (&*ptr).index(index.into(), to_usize(row))
+}
+/// The item at `row` below `index` or `None` if there is no such row.
+#[no_mangle]
+pub unsafe extern "C" fn names_index_checked(
+    ptr: *const Names,
+    index: COption<usize>,
+    row: c_int,
+) -> COption<usize> {
+    let o = &*ptr;
+    let index = index.into();
+    if row < 0 || to_usize(row) >= o.row_count(index) {
+        return None.into();
+    }
+    Some(o.index(index, to_usize(row))).into()
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_parent(ptr: *const Names, index: usize) -> QModelIndex {
+    if let Some(parent) = (&*ptr).parent(index) {
+        QModelIndex {
+            row: to_c_int((&*ptr).row(parent)),
+            internal_id: parent,
+        }
+    } else {
+        QModelIndex {
+            row: -1,
+            internal_id: 0,
+        }
+    }
+}
+#[no_mangle]
+pub unsafe extern "C" fn names_row(ptr: *const Names, index: usize) -> c_int {
+    to_c_int((&*ptr).row(index))
+}
+
+#[repr(C)]
+pub struct NamesDataRange {
+    id: *mut usize,
+    name: *mut QString,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn names_data_range(
+    ptr: *const Names,
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut NamesDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let parent = parent.into();
+    let ids: Vec<usize> = (first..first + len).map(|row| o.index(parent, row)).collect();
+    if !range.id.is_null() {
+        slice::from_raw_parts_mut(range.id, len).copy_from_slice(&ids);
+    }
+    let rows = ids.iter().cloned();
+    if mask & (1 << 0) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.name(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.name, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn names_data_name(
+    ptr: *const Names, index: usize,
+    d: *mut QString,
+    set: extern fn(*mut QString, *const c_char, len: c_int),
+) {
+    let o = &*ptr;
+    let data = o.name(index);
+    let s: *const c_char = data.as_ptr() as *const c_char;
+    set(d, s, to_c_int(data.len()));
+}
+
+extern "C" {
+    fn persons_commands_pending(o: *mut ::std::ffi::c_void);
+}
+
+/// A call of a function of Persons that was made on another thread.
+enum PersonsCommand {
+    Replace(u32),
+}
+
 pub struct PersonsQObject {}
 
 pub struct PersonsEmitter {
     qobject: Arc<AtomicPtr<PersonsQObject>>,
     new_data_ready: extern fn(*mut PersonsQObject, index: COption<usize>),
+    commands: Arc<::std::sync::Mutex<Vec<PersonsCommand>>>,
 }
 
 unsafe impl Send for PersonsEmitter {}
@@ -109,11 +928,33 @@ impl PersonsEmitter {
         PersonsEmitter {
             qobject: self.qobject.clone(),
             new_data_ready: self.new_data_ready,
+            commands: self.commands.clone(),
         }
     }
     fn clear(&self) {
         let n: *const PersonsQObject = null();
         self.qobject.store(n as *mut PersonsQObject, Ordering::SeqCst);
+        // drop the queued calls, a waiting receiver gets an error
+        self.commands.lock().unwrap().clear();
+    }
+    /// Call `replace` on the thread of the QObject.
+    ///
+    /// The call is dropped when the QObject has been destroyed.
+    pub fn invoke_replace(&mut self, row: u32) {
+        self.command(PersonsCommand::Replace(row));
+    }
+    fn command(&mut self, command: PersonsCommand) {
+        // clear() empties the queue under the same lock after the QObject
+        // is gone, so a call is only queued while the QObject can make it
+        let mut commands = self.commands.lock().unwrap();
+        let ptr = self.qobject.load(Ordering::SeqCst);
+        if ptr.is_null() {
+            return;
+        }
+        commands.push(command);
+        if commands.len() == 1 {
+            unsafe { persons_commands_pending(ptr as *mut ::std::ffi::c_void) };
+        }
     }
     pub fn new_data_ready(&mut self, item: Option<usize>) {
         let ptr = self.qobject.load(Ordering::SeqCst);
@@ -123,12 +964,19 @@ impl PersonsEmitter {
     }
 }
 
+/// The item properties of Persons, to tell which ones changed.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum PersonsProperty {
+    UserName = 0,
+}
+
 #[derive(Clone)]
 pub struct PersonsTree {
     qobject: *mut PersonsQObject,
     layout_about_to_be_changed: extern fn(*mut PersonsQObject),
     layout_changed: extern fn(*mut PersonsQObject),
     data_changed: extern fn(*mut PersonsQObject, usize, usize),
+    properties_changed: extern fn(*mut PersonsQObject, usize, usize, u64),
     begin_reset_model: extern fn(*mut PersonsQObject),
     end_reset_model: extern fn(*mut PersonsQObject),
     begin_insert_rows: extern fn(*mut PersonsQObject, index: COption<usize>, usize, usize),
@@ -149,6 +997,14 @@ impl PersonsTree {
     pub fn data_changed(&mut self, first: usize, last: usize) {
         (self.data_changed)(self.qobject, first, last);
     }
+    /// Queue a change of `properties` for the items `first` to `last`.
+    /// Changes that are queued before control returns to the event loop
+    /// are emitted together, with only the roles and columns of the
+    /// changed properties.
+    pub fn properties_changed(&mut self, first: usize, last: usize, properties: &[PersonsProperty]) {
+        let mask = properties.iter().fold(0, |mask, p| mask | 1u64 << *p as u64);
+        (self.properties_changed)(self.qobject, first, last, mask);
+    }
     pub fn begin_reset_model(&mut self) {
         (self.begin_reset_model)(self.qobject);
     }
@@ -173,12 +1029,51 @@ impl PersonsTree {
     pub fn end_remove_rows(&mut self) {
         (self.end_remove_rows)(self.qobject);
     }
+    /// Replace `rows`, the children of `index`, with `new` with as few
+    /// removes, moves and inserts as possible. Rows with the same `key`
+    /// are kept and, if they differ, updated and signalled with
+    /// data_changed() for the items given by `id`. `row()` has to agree
+    /// with `rows` while the signals are sent.
+    pub fn sync_from<T, K, F, I>(
+        &mut self,
+        index: Option<usize>,
+        rows: &mut Vec<T>,
+        new: Vec<T>,
+        key: F,
+        id: I,
+    ) where
+        T: PartialEq,
+        K: ::std::hash::Hash + Eq,
+        F: Fn(&T) -> K,
+        I: Fn(&T) -> usize,
+    {
+        sync_rows(rows, new, key, |signal, current| match signal {
+            SyncSignal::BeginRemove(first, last) => self.begin_remove_rows(index, first, last),
+            SyncSignal::EndRemove => self.end_remove_rows(),
+            SyncSignal::BeginMove(from, to) => self.begin_move_rows(index, from, from, index, to),
+            SyncSignal::EndMove => self.end_move_rows(),
+            SyncSignal::BeginInsert(first, last) => self.begin_insert_rows(index, first, last),
+            SyncSignal::EndInsert => self.end_insert_rows(),
+            SyncSignal::BeginLayout => self.layout_about_to_be_changed(),
+            // persistent indexes are found again by id
+            SyncSignal::EndLayout(_old_rows) => self.layout_changed(),
+            SyncSignal::Changed(first, last) => {
+                self.data_changed(id(&current[first]), id(&current[last]))
+            }
+        });
+    }
 }
 
 pub trait PersonsTrait {
     fn new(emit: PersonsEmitter, model: PersonsTree) -> Self;
     fn emit(&mut self) -> &mut PersonsEmitter;
+    fn replace(&mut self, row: u32) -> ();
     fn row_count(&self, _: Option<usize>) -> usize;
+    /// Tell if an item has or may have children. Override this when
+    /// row_count() starts loading data that is not needed to answer.
+    fn has_children(&self, index: Option<usize>) -> bool {
+        self.row_count(index) > 0
+    }
     fn can_fetch_more(&self, _: Option<usize>) -> bool {
         false
     }
@@ -199,6 +1094,7 @@ pub extern "C" fn persons_new(
     persons_layout_about_to_be_changed: extern fn(*mut PersonsQObject),
     persons_layout_changed: extern fn(*mut PersonsQObject),
     persons_data_changed: extern fn(*mut PersonsQObject, usize, usize),
+    persons_properties_changed: extern fn(*mut PersonsQObject, usize, usize, u64),
     persons_begin_reset_model: extern fn(*mut PersonsQObject),
     persons_end_reset_model: extern fn(*mut PersonsQObject),
     persons_begin_insert_rows: extern fn(*mut PersonsQObject, index: COption<usize>, usize, usize),
@@ -211,12 +1107,14 @@ pub extern "C" fn persons_new(
     let persons_emit = PersonsEmitter {
         qobject: Arc::new(AtomicPtr::new(persons)),
         new_data_ready: persons_new_data_ready,
+        commands: Arc::new(::std::sync::Mutex::new(Vec::new())),
     };
     let model = PersonsTree {
         qobject: persons,
         layout_about_to_be_changed: persons_layout_about_to_be_changed,
         layout_changed: persons_layout_changed,
         data_changed: persons_data_changed,
+        properties_changed: persons_properties_changed,
         begin_reset_model: persons_begin_reset_model,
         end_reset_model: persons_end_reset_model,
         begin_insert_rows: persons_begin_insert_rows,
@@ -235,6 +1133,29 @@ pub unsafe extern "C" fn persons_free(ptr: *mut Persons) {
     Box::from_raw(ptr).emit().clear();
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn persons_replace(ptr: *mut Persons, row: u32) {
+    let o = &mut *ptr;
+    o.replace(row)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_apply_commands(ptr: *mut Persons) {
+    let o = &mut *ptr;
+    let queue = o.emit().commands.clone();
+    let mut commands = ::std::mem::replace(&mut *queue.lock().unwrap(), Vec::new());
+    for command in commands.drain(..) {
+        match command {
+            PersonsCommand::Replace(row) => o.replace(row),
+        }
+    }
+    // keep the buffer for the next calls
+    let mut queue = queue.lock().unwrap();
+    if queue.is_empty() {
+        *queue = commands;
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn persons_row_count(
     ptr: *const Persons,
@@ -243,6 +1164,13 @@ pub unsafe extern "C" fn persons_row_count(
     to_c_int((&*ptr).row_count(index.into()))
 }
 #[no_mangle]
+pub unsafe extern "C" fn persons_has_children(
+    ptr: *const Persons,
+    index: COption<usize>,
+) -> bool {
+    (&*ptr).has_children(index.into())
+}
+#[no_mangle]
 pub unsafe extern "C" fn persons_can_fetch_more(
     ptr: *const Persons,
     index: COption<usize>,
@@ -261,13 +1189,21 @@ pub unsafe extern "C" fn persons_sort(
 ) {
     (&mut *ptr).sort(column, order)
 }
+/// Replace each row in `rows` with the current row of the item in `ids`
+/// or with -1 if the item is gone.
 #[no_mangle]
-pub unsafe extern "C" fn persons_check_row(
+pub unsafe extern "C" fn persons_check_rows(
     ptr: *const Persons,
-    index: usize,
-    row: c_int,
-) -> COption<usize> {
-    (&*ptr).check_row(index, to_usize(row)).into()
+    ids: *const usize,
+    rows: *mut c_int,
+    len: c_int,
+) {
+    let o = &*ptr;
+    let ids = slice::from_raw_parts(ids, to_usize(len));
+    let rows = slice::from_raw_parts_mut(rows, to_usize(len));
+    for (id, row) in ids.iter().zip(rows.iter_mut()) {
+        *row = o.check_row(*id, to_usize(*row)).map_or(-1, to_c_int);
+    }
 }
 #[no_mangle]
 pub unsafe extern "C" fn persons_index(
@@ -277,6 +1213,20 @@ pub unsafe extern "C" fn persons_index(
 ) -> usize {
     (&*ptr).index(index.into(), to_usize(row))
 }
+/// The item at `row` below `index` or `None` if there is no such row.
+#[no_mangle]
+pub unsafe extern "C" fn persons_index_checked(
+    ptr: *const Persons,
+    index: COption<usize>,
+    row: c_int,
+) -> COption<usize> {
+    let o = &*ptr;
+    let index = index.into();
+    if row < 0 || to_usize(row) >= o.row_count(index) {
+        return None.into();
+    }
+    Some(o.index(index, to_usize(row))).into()
+}
 #[no_mangle]
 pub unsafe extern "C" fn persons_parent(ptr: *const Persons, index: usize) -> QModelIndex {
     if let Some(parent) = (&*ptr).parent(index) {
@@ -296,6 +1246,41 @@ pub unsafe extern "C" fn persons_row(ptr: *const Persons, index: usize) -> c_int
     to_c_int((&*ptr).row(index))
 }
 
+#[repr(C)]
+pub struct PersonsDataRange {
+    id: *mut usize,
+    user_name: *mut QString,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn persons_data_range(
+    ptr: *const Persons,
+    parent: COption<usize>,
+    first: c_int,
+    last: c_int,
+    mask: u64,
+    range: *mut PersonsDataRange,
+    set_qstring: extern fn(*mut QString, c_int, *const c_char, c_int),
+) {
+    let o = &*ptr;
+    let range = &*range;
+    let first = to_usize(first);
+    let len = to_usize(last) + 1 - first;
+    let parent = parent.into();
+    let ids: Vec<usize> = (first..first + len).map(|row| o.index(parent, row)).collect();
+    if !range.id.is_null() {
+        slice::from_raw_parts_mut(range.id, len).copy_from_slice(&ids);
+    }
+    let rows = ids.iter().cloned();
+    if mask & (1 << 0) != 0 {
+        for (i, index) in rows.clone().enumerate() {
+            let data = o.user_name(index);
+            let s: *const c_char = data.as_ptr() as *const c_char;
+            set_qstring(range.user_name, to_c_int(i), s, to_c_int(data.len()));
+        }
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn persons_data_user_name(
     ptr: *const Persons, index: usize,
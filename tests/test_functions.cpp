@@ -33,6 +33,9 @@ private slots:
     void testAppendFunction();
     void testQuoteFunction();
     void testQuoteBytesFunction();
+    void testBorrowedArgument();
+    void testAsyncFunction();
+    void testInvokeFromThread();
 };
 
 void TestRustObject::testConstructor()
@@ -95,6 +98,56 @@ void TestRustObject::testQuoteBytesFunction()
     QCOMPARE(r, QByteArray("<<Konqi>>"));
 }
 
+void TestRustObject::testBorrowedArgument()
+{
+    // GIVEN
+    Person person;
+    person.setUserName("Konqi");
+
+    // THEN
+    QVERIFY(person.startsWith("Kon"));
+    QVERIFY(person.startsWith(""));
+    QVERIFY(!person.startsWith("Kate"));
+    QVERIFY(!person.startsWith("Konqi!"));
+}
+
+void TestRustObject::testAsyncFunction()
+{
+    // GIVEN
+    Person person;
+    person.setUserName("Konqi");
+    QSignalSpy spy(&person, &Person::greetLaterFinished);
+
+    // WHEN
+    const quint64 first = person.greetLater("John");
+    const quint64 second = person.greetLater("Kate");
+
+    // THEN
+    QVERIFY(first != second);
+    while (spy.count() < 2) {
+        QVERIFY(spy.wait());
+    }
+    QHash<quint64, QString> results;
+    for (const QList<QVariant>& args: spy) {
+        results[args.at(0).value<quint64>()] = args.at(1).toString();
+    }
+    QCOMPARE(results.value(first), QString("Hello John, my name is Konqi, how is it going?"));
+    QCOMPARE(results.value(second), QString("Hello Kate, my name is Konqi, how is it going?"));
+}
+
+void TestRustObject::testInvokeFromThread()
+{
+    // GIVEN
+    Person person;
+    person.setUserName("Konqi");
+
+    // WHEN
+    person.appendVowelsLater();
+
+    // THEN
+    QTRY_COMPARE(person.userName(), QString("Konqi2"));
+}
+
 void TestRustObject::testStringFunction()
 {
     // GIVEN
@@ -25,13 +25,17 @@ namespace {
 extern "C" {
     Person::Private* person_new(Person*, void (*)(Person*));
     void person_free(Person::Private*);
+    void person_apply_commands(Person::Private*);
     void person_user_name_get(const Person::Private*, QString*, qstring_set);
     void person_user_name_set(Person::Private*, const ushort *str, int len);
     void person_append(Person::Private*, const ushort*, int, quint32);
+    void person_append_vowels_later(Person::Private*);
     void person_double_name(Person::Private*);
     void person_greet(const Person::Private*, const ushort*, int, QString*, qstring_set);
+    quint64 person_greet_later(Person::Private*, const ushort*, int);
     void person_quote(const Person::Private*, const ushort*, int, const ushort*, int, QString*, qstring_set);
     void person_quote_bytes(const Person::Private*, const char*, int, const char*, int, QByteArray*, qbytearray_set);
+    bool person_starts_with(const Person::Private*, const ushort*, int);
     quint8 person_vowels_in_name(const Person::Private*);
 };
 
@@ -64,10 +68,18 @@ QString Person::userName() const
 void Person::setUserName(const QString& v) {
     person_user_name_set(m_d, reinterpret_cast<const ushort*>(v.data()), v.size());
 }
+void Person::applyCommands()
+{
+    person_apply_commands(m_d);
+}
 void Person::append(const QString& suffix, quint32 amount)
 {
     return person_append(m_d, suffix.utf16(), suffix.size(), amount);
 }
+void Person::appendVowelsLater()
+{
+    return person_append_vowels_later(m_d);
+}
 void Person::doubleName()
 {
     return person_double_name(m_d);
@@ -78,6 +90,10 @@ QString Person::greet(const QString& name) const
     person_greet(m_d, name.utf16(), name.size(), &s, set_qstring);
     return s;
 }
+quint64 Person::greetLater(const QString& name) const
+{
+    return person_greet_later(m_d, name.utf16(), name.size());
+}
 QString Person::quote(const QString& prefix, const QString& suffix) const
 {
     QString s;
@@ -90,7 +106,22 @@ QByteArray Person::quoteBytes(const QByteArray& prefix, const QByteArray& suffix
     person_quote_bytes(m_d, prefix.data(), prefix.size(), suffix.data(), suffix.size(), &s, set_qbytearray);
     return s;
 }
+bool Person::startsWith(const QString& prefix) const
+{
+    return person_starts_with(m_d, prefix.utf16(), prefix.size());
+}
 quint8 Person::vowelsInName() const
 {
     return person_vowels_in_name(m_d);
 }
+extern "C" void person_commands_pending(Person* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
+extern "C" void person_greet_later_finished(Person* o, quint64 request, const char* bytes, int nbytes)
+{
+    const QString result = QString::fromUtf8(bytes, nbytes);
+    QMetaObject::invokeMethod(o, "greetLaterFinished", Qt::QueuedConnection,
+        Q_ARG(quint64, request),
+        Q_ARG(QString, result));
+}
@@ -23,12 +23,18 @@ public:
     QString userName() const;
     void setUserName(const QString& v);
     Q_INVOKABLE void append(const QString& suffix, quint32 amount);
+    Q_INVOKABLE void appendVowelsLater();
     Q_INVOKABLE void doubleName();
     Q_INVOKABLE QString greet(const QString& name) const;
+    Q_INVOKABLE quint64 greetLater(const QString& name) const;
     Q_INVOKABLE QString quote(const QString& prefix, const QString& suffix) const;
     Q_INVOKABLE QByteArray quoteBytes(const QByteArray& prefix, const QByteArray& suffix) const;
+    Q_INVOKABLE bool startsWith(const QString& prefix) const;
     Q_INVOKABLE quint8 vowelsInName() const;
+private Q_SLOTS:
+    void applyCommands();
 Q_SIGNALS:
     void userNameChanged();
+    void greetLaterFinished(quint64 request, const QString& result);
 };
 #endif // TEST_FUNCTIONS_RUST_H
@@ -21,6 +21,8 @@
 #include "test_list_rust.h"
 #include <QTest>
 #include <QSignalSpy>
+#include <QDataStream>
+#include <QTemporaryFile>
 
 class TestRustList : public QObject
 {
@@ -30,6 +32,21 @@ private slots:
     void testStringGetter();
     void testStringSetter();
     void testAccessByDefaultRole();
+    void testDataAfterChange();
+    void testRoleNames();
+    void testPropertiesChanged();
+    void testRowStream();
+    void testColumn();
+    void testMappedRecords();
+    void testPagedRows();
+    void testPagedRowsAppended();
+    void testTransaction();
+    void testSyncFrom();
+    void testProxySort();
+    void testProxyFilter();
+    void testProxySourceChange();
+    void testProxySourceMove();
+    void testSortPersistentIndex();
 };
 
 void TestRustList::testConstructor()
@@ -92,5 +109,348 @@ void TestRustList::testAccessByDefaultRole()
     QCOMPARE(age.value<quint8>(), (quint8)21);
 }
 
+void TestRustList::testDataAfterChange()
+{
+    // GIVEN
+    Persons persons;
+    // data() fetches a block of rows from Rust
+    QCOMPARE(persons.data(persons.index(0,0)).toString(), QString());
+
+    // WHEN
+    const bool set = persons.setUserName(1, "Konqi");
+
+    // THEN
+    QVERIFY(set);
+    QCOMPARE(persons.data(persons.index(0,0)).toString(), QString());
+    QCOMPARE(persons.data(persons.index(1,0)).toString(), QString("Konqi"));
+    QCOMPARE(persons.data(persons.index(9,0)).toString(), QString());
+}
+
+void TestRustList::testRoleNames()
+{
+    // GIVEN
+    NoRole norole;
+
+    // WHEN
+    const auto names = norole.roleNames();
+
+    // THEN
+    QCOMPARE(names.value(Qt::DisplayRole), QByteArray("display"));
+    QCOMPARE(norole.role("display"), (int)Qt::DisplayRole);
+    QCOMPARE(names.value(norole.role("userName")), QByteArray("userName"));
+    QCOMPARE(names.value(norole.role("userAge")), QByteArray("userAge"));
+    QCOMPARE(norole.role("unknown"), -1);
+}
+
+void TestRustList::testPropertiesChanged()
+{
+    // GIVEN
+    NoRole norole;
+    QSignalSpy spy(&norole, &NoRole::dataChanged);
+
+    // WHEN
+    norole.birthday();
+
+    // THEN
+    QCOMPARE(spy.count(), 0);
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 1);
+    const auto args = spy.at(0);
+    QCOMPARE(args.at(0).value<QModelIndex>().row(), 0);
+    QCOMPARE(args.at(1).value<QModelIndex>().row(), 9);
+    const auto roles = args.at(2).value<QVector<int>>();
+    QVERIFY(roles.contains(norole.role("userAge")));
+    QVERIFY(!roles.contains(norole.role("userName")));
+    QCOMPARE(norole.data(norole.index(9, 0), norole.role("userAge")).toInt(), 1);
+}
+
+void TestRustList::testRowStream()
+{
+    // GIVEN
+    NoRole norole;
+    QSignalSpy spy(&norole, &NoRole::rowsInserted);
+
+    // WHEN
+    norole.welcome(100);
+
+    // THEN
+    QTRY_COMPARE(norole.rowCount(), 110);
+    QCOMPARE(spy.last().at(2).toInt(), 109);
+    QCOMPARE(norole.data(norole.index(10, 0), norole.role("userName")).toString(),
+             QString("newcomer"));
+    QCOMPARE(norole.data(norole.index(109, 0), norole.role("userAge")).toInt(), 99);
+}
+
+void TestRustList::testColumn()
+{
+    // GIVEN
+    NoRole norole;
+    norole.setUserAge(3, 30);
+    norole.birthday();
+
+    // WHEN
+    const QVector<quint8> ages = norole.userAgeColumn(2, 20);
+
+    // THEN
+    // the range is clipped to the rows of the model
+    QCOMPARE(ages.size(), 8);
+    QCOMPARE(ages.at(0), quint8(1));
+    QCOMPARE(ages.at(1), quint8(31));
+    QVERIFY(norole.userAgeColumn(10, 20).isEmpty());
+}
+
+void TestRustList::testMappedRecords()
+{
+    // GIVEN
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    // a record is label, time, valid and value: 12 + 8 + 1 + 8 bytes
+    const QByteArray label("first");
+    out << quint64(2);
+    out << quint64(8 + 2 * 29) << quint32(label.size()) << quint64(10) << quint8(1) << 0.5;
+    out << quint64(0) << quint32(0) << quint64(20) << quint8(0) << -1.5;
+    out.writeRawData(label.constData(), label.size());
+    file.close();
+    Trace trace;
+    QSignalSpy spy(&trace, &Trace::modelReset);
+
+    // WHEN
+    trace.setPath(file.fileName());
+
+    // THEN
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(trace.rowCount(), 2);
+    QCOMPARE(trace.label(0), QString("first"));
+    QCOMPARE(trace.label(1), QString());
+    QCOMPARE(trace.time(1), quint64(20));
+    QCOMPARE(trace.valid(0), true);
+    QCOMPARE(trace.value(1), -1.5);
+}
+
+void TestRustList::testPagedRows()
+{
+    // GIVEN
+    Log log;
+    QCOMPARE(log.rowCount(), 1000000);
+
+    // WHEN
+    for (int row = 0; row < 1000000; row += 100000) {
+        QCOMPARE(log.data(log.index(row, 0)).toString(), QString("line %1").arg(row));
+    }
+
+    // THEN
+    QCOMPARE(log.residentPages(), quint32(4));
+    QCOMPARE(log.loads(), quint32(10));
+    // a page that was dropped is loaded again
+    QCOMPARE(log.line(0), QString("line 0"));
+    QCOMPARE(log.loads(), quint32(11));
+    // a column that spans pages is copied one page at a time
+    const QVector<quint64> numbers = log.numberColumn(60, 200);
+    QCOMPARE(numbers.size(), 141);
+    QCOMPARE(numbers.first(), quint64(60));
+    QCOMPARE(numbers.last(), quint64(200));
+}
+
+void TestRustList::testPagedRowsAppended()
+{
+    // GIVEN
+    Log log;
+    log.append(10);
+    QCOMPARE(log.line(1000009), QString("line 1000009"));
+    QCOMPARE(log.loads(), quint32(1));
+
+    // WHEN
+    log.append(10);
+
+    // THEN
+    // the last page grew, so it is loaded again
+    QCOMPARE(log.rowCount(), 1000020);
+    QCOMPARE(log.line(1000019), QString("line 1000019"));
+    QCOMPARE(log.loads(), quint32(2));
+}
+
+void TestRustList::testTransaction()
+{
+    // GIVEN
+    Persons persons;
+    QSignalSpy inserted(&persons, &Persons::rowsInserted);
+    QSignalSpy removed(&persons, &Persons::rowsRemoved);
+
+    // WHEN
+    persons.recruit(3);
+
+    // THEN
+    QTRY_COMPARE(persons.rowCount(), 12);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 10);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 12);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(persons.data(persons.index(9, 0)).toString(), QString("recruit 0"));
+    QCOMPARE(persons.data(persons.index(11, 0)).toString(), QString("recruit 2"));
+}
+
+static void setNames(Persons& persons, const QStringList& names)
+{
+    for (int i = 0; i < names.size(); ++i) {
+        persons.setUserName(i, names.at(i));
+    }
+}
+
+static QStringList proxyNames(const SortedPersons& proxy)
+{
+    QStringList names;
+    for (int i = 0; i < proxy.rowCount(); ++i) {
+        names.append(proxy.data(proxy.index(i, 0)).toString());
+    }
+    return names;
+}
+
+void TestRustList::testProxySort()
+{
+    // GIVEN
+    Persons persons;
+    setNames(persons, {"j", "c", "h", "a", "f", "b", "i", "e", "g", "d"});
+    SortedPersons proxy;
+    proxy.setSourceModel(&persons);
+
+    // WHEN
+    proxy.sort(0, Qt::DescendingOrder);
+
+    // THEN
+    QCOMPARE(proxy.rowCount(), 10);
+    QCOMPARE(proxyNames(proxy).join(""), QString("jihgfedcba"));
+    QCOMPARE(proxy.mapToSource(proxy.index(0, 0)), persons.index(0, 0));
+    QCOMPARE(proxy.mapFromSource(persons.index(3, 0)), proxy.index(9, 0));
+}
+
+void TestRustList::testProxyFilter()
+{
+    // GIVEN
+    Persons persons;
+    setNames(persons, {"Konqi", "Katie", "Tux", "Kiki", "Gnu"});
+    SortedPersons proxy;
+    proxy.setSourceModel(&persons);
+    proxy.sort(0);
+    QSignalSpy spy(&proxy, &SortedPersons::rowsRemoved);
+
+    // WHEN
+    proxy.setFilterText("K");
+
+    // THEN
+    QVERIFY(spy.count() > 0);
+    QCOMPARE(proxyNames(proxy), QStringList({"Katie", "Kiki", "Konqi"}));
+
+    // WHEN
+    proxy.setFilterText("U");
+
+    // THEN
+    QCOMPARE(proxyNames(proxy), QStringList({"Gnu", "Tux"}));
+}
+
+void TestRustList::testProxySourceChange()
+{
+    // GIVEN
+    Persons persons;
+    setNames(persons, {"b", "d", "f", "h", "j", "l", "n", "p", "r", "t"});
+    SortedPersons proxy;
+    proxy.setSourceModel(&persons);
+    proxy.sort(0);
+    const QPersistentModelIndex index(proxy.index(0, 0));
+    QSignalSpy moved(&proxy, &SortedPersons::rowsMoved);
+    QSignalSpy layout(&proxy, &SortedPersons::layoutChanged);
+
+    // WHEN
+    persons.setData(persons.index(0, 0), "z");
+
+    // THEN
+    // only the changed row moves
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(layout.count(), 0);
+    QCOMPARE(proxy.data(proxy.index(9, 0)).toString(), QString("z"));
+    QCOMPARE(index.row(), 9);
+    QCOMPARE(index.data().toString(), QString("z"));
+}
+
+void TestRustList::testProxySourceMove()
+{
+    // GIVEN
+    Persons persons;
+    setNames(persons, {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"});
+    SortedPersons sorted;
+    sorted.setSourceModel(&persons);
+    sorted.sort(0);
+    SortedPersons unsorted;
+    unsorted.setSourceModel(&persons);
+    const QPersistentModelIndex sortedIndex(sorted.index(9, 0));
+    const QPersistentModelIndex unsortedIndex(unsorted.index(9, 0));
+    QSignalSpy sortedMoved(&sorted, &SortedPersons::rowsMoved);
+    QSignalSpy sortedReset(&sorted, &SortedPersons::modelReset);
+    QSignalSpy unsortedMoved(&unsorted, &SortedPersons::rowsMoved);
+    QSignalSpy unsortedReset(&unsorted, &SortedPersons::modelReset);
+
+    // WHEN
+    persons.arrange("j,a,b,c,d,e,f,g,h,i");
+
+    // THEN
+    // the sorted proxy keeps its order
+    QCOMPARE(sortedReset.count(), 0);
+    QCOMPARE(sortedMoved.count(), 0);
+    QCOMPARE(proxyNames(sorted).join(""), QString("abcdefghij"));
+    QCOMPARE(sorted.mapToSource(sorted.index(9, 0)), persons.index(0, 0));
+    QCOMPARE(sortedIndex.row(), 9);
+    // the unsorted proxy follows the source
+    QCOMPARE(unsortedReset.count(), 0);
+    QCOMPARE(unsortedMoved.count(), 1);
+    QCOMPARE(proxyNames(unsorted).join(""), QString("jabcdefghi"));
+    QCOMPARE(unsortedIndex.row(), 0);
+    QCOMPARE(unsortedIndex.data().toString(), QString("j"));
+}
+
+void TestRustList::testSortPersistentIndex()
+{
+    // GIVEN
+    Persons persons;
+    setNames(persons, {"j", "c", "h", "a", "f", "b", "i", "e", "g", "d"});
+    const QPersistentModelIndex index(persons.index(0, 0));
+
+    // WHEN
+    persons.sort(0);
+
+    // THEN
+    QCOMPARE(persons.data(persons.index(0, 0)).toString(), QString("a"));
+    QCOMPARE(index.row(), 9);
+    QCOMPARE(index.data().toString(), QString("j"));
+}
+
+void TestRustList::testSyncFrom()
+{
+    // GIVEN
+    Persons persons;
+    setNames(persons, {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"});
+    const QPersistentModelIndex index(persons.index(2, 0));
+    QSignalSpy removed(&persons, &Persons::rowsRemoved);
+    QSignalSpy moved(&persons, &Persons::rowsMoved);
+    QSignalSpy inserted(&persons, &Persons::rowsInserted);
+    QSignalSpy reset(&persons, &Persons::modelReset);
+
+    // WHEN
+    persons.arrange("j,a,b,c,x");
+
+    // THEN
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(reset.count(), 0);
+    QStringList names;
+    for (int i = 0; i < persons.rowCount(); ++i) {
+        names.append(persons.data(persons.index(i, 0)).toString());
+    }
+    QCOMPARE(names, QStringList({"j", "a", "b", "c", "x"}));
+    QCOMPARE(index.row(), 3);
+    QCOMPARE(index.data().toString(), QString("c"));
+}
+
 QTEST_MAIN(TestRustList)
 #include "test_list.moc"
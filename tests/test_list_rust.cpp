@@ -1,5 +1,7 @@
 /* generated by rust_qt_binding_generator */
 #include "test_list_rust.h"
+#include <algorithm>
+#include <iterator>
 
 namespace {
 
@@ -21,6 +23,15 @@ namespace {
         *val = QString::fromUtf8(utf8, nbytes);
     }
 
+    typedef void (*qstring_set_at)(QString* val, int i, const char* bytes, int nbytes);
+    void set_qstring_at(QString* val, int i, const char* bytes, int nbytes) {
+        val[i] = QString::fromUtf8(bytes, nbytes);
+    }
+
+    struct role_name_t {
+        const char* name;
+        int role;
+    };
     struct qmodelindex_t {
         int row;
         quintptr id;
@@ -28,9 +39,386 @@ namespace {
     inline QVariant cleanNullQVariant(const QVariant& v) {
         return (v.isNull()) ?QVariant() :v;
     }
+    inline void tracePathChanged(Trace* o)
+    {
+        Q_EMIT o->pathChanged();
+    }
+}
+namespace {
+    struct log_data_range_t {
+        QString* line;
+        quint64* number;
+    };
+    constexpr role_name_t log_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"line", Qt::UserRole + 0},
+        {"number", Qt::UserRole + 1},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int log_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void log_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
+extern "C" {
+    void log_data_range(const Log::Private*, int, int, quint64, log_data_range_t*, qstring_set_at);
+    void log_data_line(const Log::Private*, int, QString*, qstring_set);
+    quint64 log_data_number(const Log::Private*, int);
+    void log_column_number(const Log::Private*, int, int, quint64*);
+    void log_sort(Log::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
+    void log_request_rows(Log::Private*, int, int);
+
+    int log_row_count(const Log::Private*);
+    bool log_insert_rows(Log::Private*, int, int);
+    bool log_remove_rows(Log::Private*, int, int);
+    bool log_can_fetch_more(const Log::Private*);
+    void log_fetch_more(Log::Private*);
+}
+int Log::columnCount(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : 1;
+}
+
+bool Log::hasChildren(const QModelIndex &parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+int Log::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : log_row_count(m_d);
+}
+
+bool Log::insertRows(int row, int count, const QModelIndex &)
+{
+    return log_insert_rows(m_d, row, count);
+}
+
+bool Log::removeRows(int row, int count, const QModelIndex &)
+{
+    return log_remove_rows(m_d, row, count);
+}
+
+QModelIndex Log::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!parent.isValid() && row >= 0 && row < rowCount(parent) && column >= 0 && column < 1) {
+        return createIndex(row, column, (quintptr)row);
+    }
+    return QModelIndex();
+}
+
+QModelIndex Log::parent(const QModelIndex &) const
+{
+    return QModelIndex();
+}
+
+bool Log::canFetchMore(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : log_can_fetch_more(m_d);
+}
+
+void Log::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid()) {
+        log_fetch_more(m_d);
+    }
+}
+void Log::updatePersistentIndexes() {}
+
+void Log::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
+void Log::sort(int column, Qt::SortOrder order)
+{
+    log_sort(m_d, column, order);
+}
+Qt::ItemFlags Log::flags(const QModelIndex &i) const
+{
+    auto flags = QAbstractItemModel::flags(i);
+    return flags;
+}
+
+QString Log::line(int row) const
+{
+    requestRows(row);
+    QString s;
+    log_data_line(m_d, row, &s, set_qstring);
+    return s;
+}
+
+quint64 Log::number(int row) const
+{
+    requestRows(row);
+    return log_data_number(m_d, row);
+}
+
+QVector<quint64> Log::numberColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint64> column(qMax(0, last - first + 1));
+    for (int row = first; row <= last; row += 64 - row % 64) {
+        requestRows(row);
+        const int count = qMin(last + 1, row + 64 - row % 64) - row;
+        log_column_number(m_d, row, count, column.data() + row - first);
+    }
+    return column;
+}
+
+struct Log::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<QString> line;
+    QVector<quint64> number;
+    // first row of the page that was requested last
+    int page = -1;
+};
+
+void Log::clearDataRange() const
+{
+    m_dataRange->count = 0;
+    // the rows of Rust may have changed, so request the page again
+    m_dataRange->page = -1;
+}
+
+int Log::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->line.resize(r->count);
+        r->number.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        log_data_range_t columns = {
+            r->line.data(),
+            r->number.data()
+        };
+        requestRows(r->first);
+        log_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
+
+void Log::requestRows(int row) const
+{
+    // Rust keeps the page that was requested last, so a row on that page
+    // can be read without asking again
+    const int first = row - row % 64;
+    if (m_dataRange->page != first) {
+        log_request_rows(m_d, first, qMin(first + 64, rowCount()) - 1);
+        m_dataRange->page = first;
+    }
+}
+QVariant Log::data(const QModelIndex &index, int role) const
+{
+    Q_ASSERT(rowCount(index.parent()) > index.row());
+    switch (log_property(index.column(), role)) {
+    case 0:
+        return QVariant::fromValue(m_dataRange->line.value(dataRangeRow(index, 0)));
+    case 1:
+        return QVariant::fromValue(m_dataRange->number.value(dataRangeRow(index, 1)));
+    }
+    return QVariant();
+}
+
+int Log::role(const char* name) const {
+    auto end = std::end(log_role_names);
+    auto i = std::lower_bound(std::begin(log_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
+}
+QHash<int, QByteArray> Log::roleNames() const {
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: log_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
+    return names;
+}
+QVariant Log::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+    return m_headerData.value(qMakePair(section, (Qt::ItemDataRole)role), role == Qt::DisplayRole ?QString::number(section + 1) :QVariant());
+}
+
+bool Log::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if (orientation != Qt::Horizontal) {
+        return false;
+    }
+    m_headerData.insert(qMakePair(section, (Qt::ItemDataRole)role), value);
+    return true;
+}
+
+void Log::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Log::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        log_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
+extern "C" {
+    Log::Private* log_new(Log*,
+        void (*)(const Log*),
+        void (*)(Log*),
+        void (*)(Log*),
+        void (*)(Log*, quintptr, quintptr),
+        void (*)(Log*, quintptr, quintptr, quint64),
+        void (*)(Log*),
+        void (*)(Log*),
+        void (*)(Log*, int, int),
+        void (*)(Log*),
+        void (*)(Log*, int, int, int),
+        void (*)(Log*),
+        void (*)(Log*, int, int),
+        void (*)(Log*),
+        void (*)(Log*, const quintptr*, quintptr));
+    void log_free(Log::Private*);
+    void log_apply_commands(Log::Private*);
+    void log_append(Log::Private*, quint32);
+    quint32 log_loads(const Log::Private*);
+    quint32 log_resident_pages(const Log::Private*);
+};
+
+namespace {
+    struct no_role_data_range_t {
+        quint8* userAge;
+        QString* userName;
+    };
+    constexpr role_name_t no_role_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"userAge", Qt::UserRole + 0},
+        {"userName", Qt::UserRole + 1},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int no_role_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void no_role_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
 }
 extern "C" {
+    void no_role_data_range(const NoRole::Private*, int, int, quint64, no_role_data_range_t*, qstring_set_at);
     quint8 no_role_data_user_age(const NoRole::Private*, int);
+    void no_role_column_user_age(const NoRole::Private*, int, int, quint8*);
     bool no_role_set_data_user_age(NoRole::Private*, int, quint8);
     void no_role_data_user_name(const NoRole::Private*, int, QString*, qstring_set);
     bool no_role_set_data_user_name(NoRole::Private*, int, const ushort* s, int len);
@@ -93,6 +481,28 @@ void NoRole::fetchMore(const QModelIndex &parent)
 }
 void NoRole::updatePersistentIndexes() {}
 
+void NoRole::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
 void NoRole::sort(int column, Qt::SortOrder order)
 {
     no_role_sort(m_d, column, order);
@@ -116,6 +526,7 @@ bool NoRole::setUserAge(int row, quint8 value)
     bool set = false;
     set = no_role_set_data_user_age(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -134,43 +545,88 @@ bool NoRole::setUserName(int row, const QString& value)
     bool set = false;
     set = no_role_set_data_user_name(m_d, row, value.utf16(), value.length());
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
     return set;
 }
 
+QVector<quint8> NoRole::userAgeColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint8> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        no_role_column_user_age(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+struct NoRole::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<quint8> userAge;
+    QVector<QString> userName;
+};
+
+void NoRole::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int NoRole::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->userAge.resize(r->count);
+        r->userName.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        no_role_data_range_t columns = {
+            r->userAge.data(),
+            r->userName.data()
+        };
+        no_role_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant NoRole::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (no_role_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(userAge(index.row()));
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(userName(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->userAge.value(dataRangeRow(index, 0)));
+    case 1:
+        return QVariant::fromValue(m_dataRange->userName.value(dataRangeRow(index, 1)));
     }
     return QVariant();
 }
 
 int NoRole::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(no_role_role_names);
+    auto i = std::lower_bound(std::begin(no_role_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> NoRole::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "userAge");
-    names.insert(Qt::UserRole + 1, "userName");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: no_role_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant NoRole::headerData(int section, Qt::Orientation orientation, int role) const
@@ -190,19 +646,52 @@ bool NoRole::setHeaderData(int section, Qt::Orientation orientation, const QVari
     return true;
 }
 
+void NoRole::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void NoRole::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        no_role_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 bool NoRole::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (index.column() == 0) {
-        if (role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<quint8>())) {
-                return setUserAge(index.row(), value.value<quint8>());
-            }
+    switch (no_role_property(index.column(), role)) {
+    case 0:
+        if (value.canConvert(qMetaTypeId<quint8>())) {
+            return setUserAge(index.row(), value.value<quint8>());
         }
-        if (role == Qt::UserRole + 1) {
-            if (value.canConvert(qMetaTypeId<QString>())) {
-                return setUserName(index.row(), value.value<QString>());
-            }
+        break;
+    case 1:
+        if (value.canConvert(qMetaTypeId<QString>())) {
+            return setUserName(index.row(), value.value<QString>());
         }
+        break;
     }
     return false;
 }
@@ -213,6 +702,7 @@ extern "C" {
         void (*)(NoRole*),
         void (*)(NoRole*),
         void (*)(NoRole*, quintptr, quintptr),
+        void (*)(NoRole*, quintptr, quintptr, quint64),
         void (*)(NoRole*),
         void (*)(NoRole*),
         void (*)(NoRole*, int, int),
@@ -220,11 +710,57 @@ extern "C" {
         void (*)(NoRole*, int, int, int),
         void (*)(NoRole*),
         void (*)(NoRole*, int, int),
-        void (*)(NoRole*));
+        void (*)(NoRole*),
+        void (*)(NoRole*, const quintptr*, quintptr));
     void no_role_free(NoRole::Private*);
+    void no_role_apply_commands(NoRole::Private*);
+    void no_role_birthday(NoRole::Private*);
+    void no_role_welcome(NoRole::Private*, quint32);
 };
 
+namespace {
+    struct persons_data_range_t {
+        QString* userName;
+    };
+    constexpr role_name_t persons_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"userName", Qt::UserRole + 0},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int persons_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::UserRole + 0:
+                return 0;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void persons_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::EditRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void persons_data_range(const Persons::Private*, int, int, quint64, persons_data_range_t*, qstring_set_at);
     void persons_data_user_name(const Persons::Private*, int, QString*, qstring_set);
     bool persons_set_data_user_name(Persons::Private*, int, const ushort* s, int len);
     void persons_sort(Persons::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
@@ -286,6 +822,28 @@ void Persons::fetchMore(const QModelIndex &parent)
 }
 void Persons::updatePersistentIndexes() {}
 
+void Persons::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
 void Persons::sort(int column, Qt::SortOrder order)
 {
     persons_sort(m_d, column, order);
@@ -311,42 +869,72 @@ bool Persons::setUserName(int row, const QString& value)
     bool set = false;
     set = persons_set_data_user_name(m_d, row, value.utf16(), value.length());
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
     return set;
 }
 
+struct Persons::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<QString> userName;
+};
+
+void Persons::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int Persons::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->userName.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        persons_data_range_t columns = {
+            r->userName.data()
+        };
+        persons_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant Persons::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (persons_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::EditRole:
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(userName(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->userName.value(dataRangeRow(index, 0)));
     }
     return QVariant();
 }
 
 int Persons::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(persons_role_names);
+    auto i = std::lower_bound(std::begin(persons_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> Persons::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "userName");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: persons_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant Persons::headerData(int section, Qt::Orientation orientation, int role) const
@@ -366,14 +954,47 @@ bool Persons::setHeaderData(int section, Qt::Orientation orientation, const QVar
     return true;
 }
 
+void Persons::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Persons::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        persons_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 bool Persons::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (index.column() == 0) {
-        if (role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<QString>())) {
-                return setUserName(index.row(), value.value<QString>());
-            }
+    switch (persons_property(index.column(), role)) {
+    case 0:
+        if (value.canConvert(qMetaTypeId<QString>())) {
+            return setUserName(index.row(), value.value<QString>());
         }
+        break;
     }
     return false;
 }
@@ -384,6 +1005,7 @@ extern "C" {
         void (*)(Persons*),
         void (*)(Persons*),
         void (*)(Persons*, quintptr, quintptr),
+        void (*)(Persons*, quintptr, quintptr, quint64),
         void (*)(Persons*),
         void (*)(Persons*),
         void (*)(Persons*, int, int),
@@ -391,61 +1013,563 @@ extern "C" {
         void (*)(Persons*, int, int, int),
         void (*)(Persons*),
         void (*)(Persons*, int, int),
+        void (*)(Persons*),
+        void (*)(Persons*, const quintptr*, quintptr),
         void (*)(Persons*));
     void persons_free(Persons::Private*);
+    void persons_apply_transactions(Persons::Private*);
+    void persons_apply_commands(Persons::Private*);
+    void persons_arrange(Persons::Private*, const ushort*, int);
+    void persons_recruit(Persons::Private*, quint32);
 };
 
-NoRole::NoRole(bool /*owned*/, QObject *parent):
-    QAbstractItemModel(parent),
-    m_d(nullptr),
-    m_ownsPrivate(false)
+namespace {
+    struct trace_data_range_t {
+        QString* label;
+        quint64* time;
+        bool* valid;
+        double* value;
+    };
+    constexpr role_name_t trace_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"label", Qt::UserRole + 0},
+        {"statusTip", Qt::StatusTipRole},
+        {"time", Qt::UserRole + 1},
+        {"toolTip", Qt::ToolTipRole},
+        {"valid", Qt::UserRole + 2},
+        {"value", Qt::UserRole + 3},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int trace_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            case Qt::UserRole + 2:
+                return 2;
+            case Qt::UserRole + 3:
+                return 3;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void trace_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 2)) {
+            roles.append(Qt::UserRole + 2);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 3)) {
+            roles.append(Qt::UserRole + 3);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
+extern "C" {
+    void trace_data_range(const Trace::Private*, int, int, quint64, trace_data_range_t*, qstring_set_at);
+    void trace_data_label(const Trace::Private*, int, QString*, qstring_set);
+    quint64 trace_data_time(const Trace::Private*, int);
+    void trace_column_time(const Trace::Private*, int, int, quint64*);
+    bool trace_data_valid(const Trace::Private*, int);
+    double trace_data_value(const Trace::Private*, int);
+    void trace_column_value(const Trace::Private*, int, int, double*);
+    void trace_sort(Trace::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    int trace_row_count(const Trace::Private*);
+    bool trace_insert_rows(Trace::Private*, int, int);
+    bool trace_remove_rows(Trace::Private*, int, int);
+    bool trace_can_fetch_more(const Trace::Private*);
+    void trace_fetch_more(Trace::Private*);
+}
+int Trace::columnCount(const QModelIndex &parent) const
 {
-    initHeaderData();
+    return (parent.isValid()) ? 0 : 1;
 }
 
-NoRole::NoRole(QObject *parent):
-    QAbstractItemModel(parent),
-    m_d(no_role_new(this,
-        [](const NoRole* o) {
-            Q_EMIT o->newDataReady(QModelIndex());
-        },
-        [](NoRole* o) {
-            Q_EMIT o->layoutAboutToBeChanged();
-        },
-        [](NoRole* o) {
-            o->updatePersistentIndexes();
-            Q_EMIT o->layoutChanged();
-        },
+bool Trace::hasChildren(const QModelIndex &parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+int Trace::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : trace_row_count(m_d);
+}
+
+bool Trace::insertRows(int row, int count, const QModelIndex &)
+{
+    return trace_insert_rows(m_d, row, count);
+}
+
+bool Trace::removeRows(int row, int count, const QModelIndex &)
+{
+    return trace_remove_rows(m_d, row, count);
+}
+
+QModelIndex Trace::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!parent.isValid() && row >= 0 && row < rowCount(parent) && column >= 0 && column < 1) {
+        return createIndex(row, column, (quintptr)row);
+    }
+    return QModelIndex();
+}
+
+QModelIndex Trace::parent(const QModelIndex &) const
+{
+    return QModelIndex();
+}
+
+bool Trace::canFetchMore(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : trace_can_fetch_more(m_d);
+}
+
+void Trace::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid()) {
+        trace_fetch_more(m_d);
+    }
+}
+void Trace::updatePersistentIndexes() {}
+
+void Trace::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
+void Trace::sort(int column, Qt::SortOrder order)
+{
+    trace_sort(m_d, column, order);
+}
+Qt::ItemFlags Trace::flags(const QModelIndex &i) const
+{
+    auto flags = QAbstractItemModel::flags(i);
+    return flags;
+}
+
+QString Trace::label(int row) const
+{
+    QString s;
+    trace_data_label(m_d, row, &s, set_qstring);
+    return s;
+}
+
+quint64 Trace::time(int row) const
+{
+    return trace_data_time(m_d, row);
+}
+
+bool Trace::valid(int row) const
+{
+    return trace_data_valid(m_d, row);
+}
+
+double Trace::value(int row) const
+{
+    return trace_data_value(m_d, row);
+}
+
+QVector<quint64> Trace::timeColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint64> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        trace_column_time(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<double> Trace::valueColumn(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<double> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        trace_column_value(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+struct Trace::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<QString> label;
+    QVector<quint64> time;
+    QVector<bool> valid;
+    QVector<double> value;
+};
+
+void Trace::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int Trace::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->label.resize(r->count);
+        r->time.resize(r->count);
+        r->valid.resize(r->count);
+        r->value.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        trace_data_range_t columns = {
+            r->label.data(),
+            r->time.data(),
+            r->valid.data(),
+            r->value.data()
+        };
+        trace_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
+QVariant Trace::data(const QModelIndex &index, int role) const
+{
+    Q_ASSERT(rowCount(index.parent()) > index.row());
+    switch (trace_property(index.column(), role)) {
+    case 0:
+        return QVariant::fromValue(m_dataRange->label.value(dataRangeRow(index, 0)));
+    case 1:
+        return QVariant::fromValue(m_dataRange->time.value(dataRangeRow(index, 1)));
+    case 2:
+        return QVariant::fromValue(m_dataRange->valid.value(dataRangeRow(index, 2)));
+    case 3:
+        return QVariant::fromValue(m_dataRange->value.value(dataRangeRow(index, 3)));
+    }
+    return QVariant();
+}
+
+int Trace::role(const char* name) const {
+    auto end = std::end(trace_role_names);
+    auto i = std::lower_bound(std::begin(trace_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
+}
+QHash<int, QByteArray> Trace::roleNames() const {
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: trace_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
+    return names;
+}
+QVariant Trace::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+    return m_headerData.value(qMakePair(section, (Qt::ItemDataRole)role), role == Qt::DisplayRole ?QString::number(section + 1) :QVariant());
+}
+
+bool Trace::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if (orientation != Qt::Horizontal) {
+        return false;
+    }
+    m_headerData.insert(qMakePair(section, (Qt::ItemDataRole)role), value);
+    return true;
+}
+
+void Trace::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Trace::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        trace_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
+extern "C" {
+    Trace::Private* trace_new(Trace*, void (*)(Trace*),
+        void (*)(const Trace*),
+        void (*)(Trace*),
+        void (*)(Trace*),
+        void (*)(Trace*, quintptr, quintptr),
+        void (*)(Trace*, quintptr, quintptr, quint64),
+        void (*)(Trace*),
+        void (*)(Trace*),
+        void (*)(Trace*, int, int),
+        void (*)(Trace*),
+        void (*)(Trace*, int, int, int),
+        void (*)(Trace*),
+        void (*)(Trace*, int, int),
+        void (*)(Trace*),
+        void (*)(Trace*, const quintptr*, quintptr));
+    void trace_free(Trace::Private*);
+    void trace_path_get(const Trace::Private*, QString*, qstring_set);
+    void trace_path_set(Trace::Private*, const ushort *str, int len);
+    void trace_path_set_none(Trace::Private*);
+};
+
+extern "C" {
+    SortedPersons::Private* sorted_persons_new();
+    void sorted_persons_free(SortedPersons::Private*);
+    void sorted_persons_set_filter(SortedPersons::Private*, int, const ushort*, int);
+    int sorted_persons_rows(SortedPersons::Private*, const Persons::Private*, int, Qt::SortOrder, int*);
+    int sorted_persons_place(SortedPersons::Private*, const Persons::Private*, int, Qt::SortOrder, const int*, int, int);
+};
+Log::Log(bool /*owned*/, QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(nullptr),
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
+{
+    initHeaderData();
+}
+
+Log::Log(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(log_new(this,
+        [](const Log* o) {
+            Q_EMIT o->newDataReady(QModelIndex());
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            Q_EMIT o->layoutAboutToBeChanged();
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->updatePersistentIndexes();
+            Q_EMIT o->layoutChanged();
+        },
+        [](Log* o, quintptr first, quintptr last) {
+            o->clearDataRange();
+            o->dataChanged(o->createIndex(first, 0, first),
+                       o->createIndex(last, 0, last));
+        },
+        [](Log* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginResetModel();
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->endResetModel();
+        },
+        [](Log* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginInsertRows(QModelIndex(), first, last);
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->endInsertRows();
+        },
+        [](Log* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->endMoveRows();
+        },
+        [](Log* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginRemoveRows(QModelIndex(), first, last);
+        },
+        [](Log* o) {
+            o->clearDataRange();
+            o->endRemoveRows();
+        },
+        [](Log* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
+        }
+)),
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
+{
+    connect(this, &Log::newDataReady, this, [this](const QModelIndex& i) {
+        this->fetchMore(i);
+    }, Qt::QueuedConnection);
+    initHeaderData();
+}
+
+Log::~Log() {
+    if (m_ownsPrivate) {
+        log_free(m_d);
+    }
+    delete m_dataRange;
+}
+void Log::initHeaderData() {
+    m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("line"));
+}
+void Log::applyCommands()
+{
+    log_apply_commands(m_d);
+}
+void Log::append(quint32 count)
+{
+    return log_append(m_d, count);
+}
+quint32 Log::loads() const
+{
+    return log_loads(m_d);
+}
+quint32 Log::residentPages() const
+{
+    return log_resident_pages(m_d);
+}
+NoRole::NoRole(bool /*owned*/, QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(nullptr),
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
+{
+    initHeaderData();
+}
+
+NoRole::NoRole(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(no_role_new(this,
+        [](const NoRole* o) {
+            Q_EMIT o->newDataReady(QModelIndex());
+        },
+        [](NoRole* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            Q_EMIT o->layoutAboutToBeChanged();
+        },
+        [](NoRole* o) {
+            o->clearDataRange();
+            o->updatePersistentIndexes();
+            Q_EMIT o->layoutChanged();
+        },
         [](NoRole* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 0, last));
         },
+        [](NoRole* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](NoRole* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](NoRole* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](NoRole* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](NoRole* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](NoRole* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](NoRole* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](NoRole* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](NoRole* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](NoRole* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &NoRole::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -457,13 +1581,27 @@ NoRole::~NoRole() {
     if (m_ownsPrivate) {
         no_role_free(m_d);
     }
+    delete m_dataRange;
 }
 void NoRole::initHeaderData() {
 }
+void NoRole::applyCommands()
+{
+    no_role_apply_commands(m_d);
+}
+void NoRole::birthday()
+{
+    return no_role_birthday(m_d);
+}
+void NoRole::welcome(quint32 count)
+{
+    return no_role_welcome(m_d, count);
+}
 Persons::Persons(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -475,42 +1613,71 @@ Persons::Persons(QObject *parent):
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](Persons* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](Persons* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 0, last));
         },
+        [](Persons* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](Persons* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](Persons* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](Persons* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](Persons* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](Persons* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
+        },
+        [](Persons* o) {
+            QMetaObject::invokeMethod(o, "applyTransactions", Qt::QueuedConnection);
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &Persons::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -522,7 +1689,785 @@ Persons::~Persons() {
     if (m_ownsPrivate) {
         persons_free(m_d);
     }
+    delete m_dataRange;
 }
 void Persons::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("userName"));
 }
+void Persons::applyTransactions()
+{
+    persons_apply_transactions(m_d);
+}
+void Persons::applyCommands()
+{
+    persons_apply_commands(m_d);
+}
+void Persons::arrange(const QString& names)
+{
+    return persons_arrange(m_d, names.utf16(), names.size());
+}
+void Persons::recruit(quint32 count)
+{
+    return persons_recruit(m_d, count);
+}
+Trace::Trace(bool /*owned*/, QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(nullptr),
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
+{
+    initHeaderData();
+}
+
+Trace::Trace(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(trace_new(this,
+        tracePathChanged,
+        [](const Trace* o) {
+            Q_EMIT o->newDataReady(QModelIndex());
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            Q_EMIT o->layoutAboutToBeChanged();
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->updatePersistentIndexes();
+            Q_EMIT o->layoutChanged();
+        },
+        [](Trace* o, quintptr first, quintptr last) {
+            o->clearDataRange();
+            o->dataChanged(o->createIndex(first, 0, first),
+                       o->createIndex(last, 0, last));
+        },
+        [](Trace* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginResetModel();
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->endResetModel();
+        },
+        [](Trace* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginInsertRows(QModelIndex(), first, last);
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->endInsertRows();
+        },
+        [](Trace* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->endMoveRows();
+        },
+        [](Trace* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginRemoveRows(QModelIndex(), first, last);
+        },
+        [](Trace* o) {
+            o->clearDataRange();
+            o->endRemoveRows();
+        },
+        [](Trace* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
+        }
+)),
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
+{
+    connect(this, &Trace::newDataReady, this, [this](const QModelIndex& i) {
+        this->fetchMore(i);
+    }, Qt::QueuedConnection);
+    initHeaderData();
+}
+
+Trace::~Trace() {
+    if (m_ownsPrivate) {
+        trace_free(m_d);
+    }
+    delete m_dataRange;
+}
+void Trace::initHeaderData() {
+}
+QString Trace::path() const
+{
+    QString v;
+    trace_path_get(m_d, &v, set_qstring);
+    return v;
+}
+void Trace::setPath(const QString& v) {
+    if (v.isNull()) {
+        trace_path_set_none(m_d);
+    } else {
+    trace_path_set(m_d, reinterpret_cast<const ushort*>(v.data()), v.size());
+    }
+}
+
+SortedPersons::SortedPersons(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(sorted_persons_new()),
+    m_source(nullptr),
+    m_sortColumn(-1),
+    m_sortOrder(Qt::AscendingOrder),
+    m_sortRole(Qt::DisplayRole),
+    m_filterRole(Qt::DisplayRole),
+    m_rootMapping(nullptr)
+{
+}
+
+SortedPersons::~SortedPersons()
+{
+    clearMappings();
+    sorted_persons_free(m_d);
+}
+
+Persons* SortedPersons::sourceModel() const
+{
+    return m_source;
+}
+
+void SortedPersons::setSourceModel(Persons* source)
+{
+    if (source == m_source) {
+        return;
+    }
+    beginResetModel();
+    if (m_source) {
+        disconnect(m_source, nullptr, this, nullptr);
+    }
+    clearMappings();
+    m_source = source;
+    resetFilter();
+    if (m_source) {
+        connect(m_source, &Persons::modelAboutToBeReset, this, &SortedPersons::beginResetModel);
+        connect(m_source, &Persons::modelReset, this, [this]() {
+            clearMappings();
+            resetFilter();
+            endResetModel();
+        });
+        connect(m_source, &Persons::layoutAboutToBeChanged, this, [this]() {
+            beginLayoutChange();
+        });
+        connect(m_source, &Persons::layoutChanged, this, [this]() {
+            clearMappings();
+            endLayoutChange();
+        });
+        connect(m_source, &Persons::rowsInserted, this, &SortedPersons::sourceRowsInserted);
+        connect(m_source, &Persons::rowsAboutToBeRemoved, this, &SortedPersons::sourceRowsAboutToBeRemoved);
+        connect(m_source, &Persons::rowsRemoved, this, &SortedPersons::sourceRowsRemoved);
+        connect(m_source, &Persons::rowsAboutToBeMoved, this, &SortedPersons::sourceRowsAboutToBeMoved);
+        connect(m_source, &Persons::rowsMoved, this, &SortedPersons::sourceRowsMoved);
+        connect(m_source, &Persons::dataChanged, this, &SortedPersons::sourceDataChanged);
+        connect(m_source, &Persons::headerDataChanged, this, &SortedPersons::headerDataChanged);
+        connect(m_source, &QObject::destroyed, this, [this]() {
+            setSourceModel(nullptr);
+        });
+    }
+    endResetModel();
+    Q_EMIT sourceModelChanged();
+}
+
+int SortedPersons::sortRole() const
+{
+    return m_sortRole;
+}
+
+void SortedPersons::setSortRole(int role)
+{
+    if (role == m_sortRole) {
+        return;
+    }
+    m_sortRole = role;
+    if (m_sortColumn >= 0) {
+        sort(m_sortColumn, m_sortOrder);
+    }
+    Q_EMIT sortRoleChanged();
+}
+
+int SortedPersons::filterRole() const
+{
+    return m_filterRole;
+}
+
+void SortedPersons::setFilterRole(int role)
+{
+    if (role == m_filterRole) {
+        return;
+    }
+    m_filterRole = role;
+    if (!m_filterText.isEmpty()) {
+        refilter();
+    }
+    Q_EMIT filterRoleChanged();
+}
+
+QString SortedPersons::filterText() const
+{
+    return m_filterText;
+}
+
+void SortedPersons::setFilterText(const QString& text)
+{
+    if (text == m_filterText) {
+        return;
+    }
+    m_filterText = text;
+    refilter();
+    Q_EMIT filterTextChanged();
+}
+
+void SortedPersons::sortByRole(const QString& role, Qt::SortOrder order)
+{
+    const int sortRole = m_source ? m_source->role(role.toUtf8().constData()) : -1;
+    const bool changed = sortRole != m_sortRole;
+    m_sortRole = sortRole;
+    sort(0, order);
+    if (changed) {
+        Q_EMIT sortRoleChanged();
+    }
+}
+
+void SortedPersons::sort(int column, Qt::SortOrder order)
+{
+    beginLayoutChange();
+    m_sortColumn = column;
+    m_sortOrder = order;
+    clearMappings();
+    endLayoutChange();
+}
+
+SortedPersons::Mapping* SortedPersons::cachedMapping(const QModelIndex &sourceParent) const
+{
+    if (!sourceParent.isValid()) {
+        return m_rootMapping;
+    }
+    return m_mappings.value(sourceParent.internalId());
+}
+
+SortedPersons::Mapping* SortedPersons::mapping(const QModelIndex &sourceParent) const
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        m = new Mapping();
+        m->sourceRows = sourceRows(sourceParent);
+        updateProxyRows(m, m_source->rowCount(sourceParent));
+        if (sourceParent.isValid()) {
+            m_mappings.insert(sourceParent.internalId(), m);
+        } else {
+            m_rootMapping = m;
+        }
+    }
+    return m;
+}
+
+QVector<int> SortedPersons::sourceRows(const QModelIndex &sourceParent) const
+{
+    QVector<int> rows(m_source->rowCount(sourceParent));
+    if (m_sortColumn < 0 && m_filterText.isEmpty()) {
+        for (int i = 0; i < rows.size(); ++i) {
+            rows[i] = i;
+        }
+        return rows;
+    }
+    const int sort = m_sortColumn < 0 ? -1 : persons_property(m_sortColumn, m_sortRole);
+    rows.resize(sorted_persons_rows(m_d, m_source->m_d, sort, m_sortOrder, rows.data()));
+    return rows;
+}
+
+void SortedPersons::updateProxyRows(Mapping* m, int sourceRowCount) const
+{
+    m->proxyRows.fill(-1, sourceRowCount);
+    for (int i = 0; i < m->sourceRows.size(); ++i) {
+        m->proxyRows[m->sourceRows.at(i)] = i;
+    }
+}
+
+void SortedPersons::removeProxyRows(Mapping* m, const QModelIndex &sourceParent, const QVector<bool>& remove)
+{
+    // remove from the back, a contiguous block of proxy rows at a time
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    int last = m->sourceRows.size() - 1;
+    while (last >= 0) {
+        if (!remove.at(m->sourceRows.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && remove.at(m->sourceRows.at(first - 1))) {
+            --first;
+        }
+        beginRemoveRows(proxyParent, first, last);
+        m->sourceRows.remove(first, last - first + 1);
+        updateProxyRows(m, remove.size());
+        endRemoveRows();
+        last = first - 1;
+    }
+}
+
+void SortedPersons::updateMapping(const QModelIndex &sourceParent)
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    const int count = m_source->rowCount(sourceParent);
+    const QVector<int> rows = sourceRows(sourceParent);
+    QVector<bool> remove(count, true);
+    for (int row: rows) {
+        remove[row] = false;
+    }
+    removeProxyRows(m, sourceParent, remove);
+    // put the remaining rows in their new order
+    QVector<int> kept;
+    kept.reserve(m->sourceRows.size());
+    for (int row: rows) {
+        if (m->proxyRows.at(row) >= 0) {
+            kept.append(row);
+        }
+    }
+    if (kept != m->sourceRows) {
+        beginLayoutChange();
+        m->sourceRows = kept;
+        updateProxyRows(m, count);
+        endLayoutChange();
+    }
+    // insert the new rows, a contiguous block of proxy rows at a time
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    int first = 0;
+    while (first < rows.size()) {
+        if (m->proxyRows.at(rows.at(first)) >= 0) {
+            ++first;
+            continue;
+        }
+        int last = first;
+        while (last + 1 < rows.size() && m->proxyRows.at(rows.at(last + 1)) < 0) {
+            ++last;
+        }
+        beginInsertRows(proxyParent, first, last);
+        for (int i = first; i <= last; ++i) {
+            m->sourceRows.insert(i, rows.at(i));
+        }
+        updateProxyRows(m, count);
+        endInsertRows();
+        first = last + 1;
+    }
+}
+
+void SortedPersons::placeRows(const QModelIndex &sourceParent, int first, int last)
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    // many changed rows are cheaper to sort again together
+    if (last - first >= 64) {
+        updateMapping(sourceParent);
+        return;
+    }
+    const int count = m_source->rowCount(sourceParent);
+    const int sort = m_sortColumn < 0 ? -1 : persons_property(m_sortColumn, m_sortRole);
+    // the rows that did not change are still in order, so the new order is
+    // found by placing each changed row among them
+    QVector<int> order;
+    order.reserve(m->sourceRows.size() + last - first + 1);
+    for (int row: m->sourceRows) {
+        if (row < first || row > last) {
+            order.append(row);
+        }
+    }
+    for (int row = first; row <= last; ++row) {
+        const int place = sorted_persons_place(m_d, m_source->m_d, sort, m_sortOrder,
+                order.constData(), order.size(), row);
+        if (place >= 0) {
+            order.insert(place, row);
+        }
+    }
+    QVector<int> rank(count, -1);
+    for (int i = 0; i < order.size(); ++i) {
+        rank[order.at(i)] = i;
+    }
+    QVector<bool> remove(count, false);
+    for (int row = first; row <= last; ++row) {
+        remove[row] = rank.at(row) < 0;
+    }
+    removeProxyRows(m, sourceParent, remove);
+    // move or insert each changed row behind the row before it in the new
+    // order, counting only rows that are in their place already
+    const QModelIndex proxyParent = mapFromSource(sourceParent);
+    QVector<int>& rows = m->sourceRows;
+    for (int row = first; row <= last; ++row) {
+        if (rank.at(row) < 0) {
+            continue;
+        }
+        const int from = m->proxyRows.at(row);
+        int to = 0;
+        for (int i = 0; i < rows.size(); ++i) {
+            const int r = rows.at(i);
+            const bool placed = r < row || r > last;
+            if (r != row && placed && rank.at(r) < rank.at(row)) {
+                to = from >= 0 && i > from ? i : i + 1;
+            }
+        }
+        if (from < 0) {
+            beginInsertRows(proxyParent, to, to);
+            rows.insert(to, row);
+            updateProxyRows(m, count);
+            endInsertRows();
+        } else if (to != from) {
+            beginMoveRows(proxyParent, from, from, proxyParent, to > from ? to + 1 : to);
+            rows.remove(from);
+            rows.insert(to, row);
+            updateProxyRows(m, count);
+            endMoveRows();
+        }
+    }
+}
+
+void SortedPersons::updateAncestors(const QModelIndex &sourceParent)
+{
+    Q_UNUSED(sourceParent);
+}
+
+void SortedPersons::dropMapping(const QModelIndex &sourceParent)
+{
+    Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    if (sourceParent.isValid()) {
+        m_mappings.remove(sourceParent.internalId());
+    } else {
+        m_rootMapping = nullptr;
+    }
+    delete m;
+}
+
+void SortedPersons::clearMappings()
+{
+    qDeleteAll(m_mappings);
+    m_mappings.clear();
+    delete m_rootMapping;
+    m_rootMapping = nullptr;
+}
+
+void SortedPersons::resetFilter()
+{
+    const int property = m_filterText.isEmpty() ? -1 : persons_property(0, m_filterRole);
+    sorted_persons_set_filter(m_d, property, m_filterText.utf16(), m_filterText.size());
+}
+
+void SortedPersons::refilter()
+{
+    resetFilter();
+    if (!m_source) {
+        return;
+    }
+    // parents go before their children, so rows that are filtered out take
+    // the mappings below them along
+    QVector<QModelIndex> parents;
+    parents.append(QModelIndex());
+    for (int i = 0; i < parents.size(); ++i) {
+        const QModelIndex sourceParent = parents.at(i);
+        updateMapping(sourceParent);
+    }
+}
+
+void SortedPersons::beginLayoutChange()
+{
+    Q_EMIT layoutAboutToBeChanged();
+    m_layoutIndexes = persistentIndexList();
+    m_layoutSourceIndexes.clear();
+    for (const QModelIndex& index: m_layoutIndexes) {
+        m_layoutSourceIndexes.append(QPersistentModelIndex(mapToSource(index)));
+    }
+}
+
+void SortedPersons::endLayoutChange()
+{
+    QModelIndexList to;
+    for (const QPersistentModelIndex& index: m_layoutSourceIndexes) {
+        to.append(mapFromSource(index));
+    }
+    changePersistentIndexList(m_layoutIndexes, to);
+    m_layoutIndexes.clear();
+    m_layoutSourceIndexes.clear();
+    Q_EMIT layoutChanged();
+}
+
+void SortedPersons::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Mapping* m = cachedMapping(parent);
+    if (m) {
+        const int count = last - first + 1;
+        for (int& row: m->sourceRows) {
+            if (row >= first) {
+                row += count;
+            }
+        }
+        updateProxyRows(m, m_source->rowCount(parent));
+        updateMapping(parent);
+    }
+    updateAncestors(parent);
+}
+
+void SortedPersons::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    Mapping* m = cachedMapping(parent);
+    if (m) {
+        QVector<bool> remove(m_source->rowCount(parent), false);
+        for (int row = first; row <= last; ++row) {
+            remove[row] = true;
+        }
+        removeProxyRows(m, parent, remove);
+    }
+}
+
+void SortedPersons::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Mapping* m = cachedMapping(parent);
+    if (m) {
+        const int count = last - first + 1;
+        for (int& row: m->sourceRows) {
+            if (row > last) {
+                row -= count;
+            }
+        }
+        updateProxyRows(m, m_source->rowCount(parent));
+    }
+    updateAncestors(parent);
+}
+
+void SortedPersons::sourceRowsAboutToBeMoved(const QModelIndex &parent, int, int, const QModelIndex &destination)
+{
+    // a move to another parent can change which rows pass the filter
+    if (parent != destination) {
+        beginResetModel();
+    }
+}
+
+void SortedPersons::sourceRowsMoved(const QModelIndex &parent, int first, int last, const QModelIndex &destination, int row)
+{
+    if (parent != destination) {
+        clearMappings();
+        resetFilter();
+        endResetModel();
+        return;
+    }
+    Mapping* m = cachedMapping(parent);
+    if (!m) {
+        return;
+    }
+    const int count = last - first + 1;
+    // the number of a source row after the move
+    const auto moved = [=](int r) {
+        if (r >= first && r <= last) {
+            return row > last ? r + row - last - 1 : r - first + row;
+        }
+        if (row > last && r > last && r < row) {
+            return r - count;
+        }
+        if (row < first && r >= row && r < first) {
+            return r + count;
+        }
+        return r;
+    };
+    if (m_sortColumn >= 0) {
+        // the order of the proxy does not depend on the order of the source
+        for (int& r: m->sourceRows) {
+            r = moved(r);
+        }
+        updateProxyRows(m, m_source->rowCount(parent));
+        return;
+    }
+    // the proxy keeps the order of the source, so the visible rows that
+    // were moved are one block that moves in the proxy too
+    int proxyFirst = m->sourceRows.size();
+    int proxyLast = -1;
+    int proxyRow = 0;
+    for (int i = 0; i < m->sourceRows.size(); ++i) {
+        const int r = m->sourceRows.at(i);
+        if (r >= first && r <= last) {
+            proxyFirst = qMin(proxyFirst, i);
+            proxyLast = i;
+        }
+        if (r < row) {
+            proxyRow = i + 1;
+        }
+    }
+    const bool move = proxyLast >= 0 && (proxyRow < proxyFirst || proxyRow > proxyLast + 1);
+    if (move) {
+        const QModelIndex proxyParent = mapFromSource(parent);
+        beginMoveRows(proxyParent, proxyFirst, proxyLast, proxyParent, proxyRow);
+    }
+    for (int& r: m->sourceRows) {
+        r = moved(r);
+    }
+    std::sort(m->sourceRows.begin(), m->sourceRows.end());
+    updateProxyRows(m, m_source->rowCount(parent));
+    if (move) {
+        endMoveRows();
+    }
+}
+
+void SortedPersons::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    const QModelIndex sourceParent = topLeft.parent();
+    // only a change of the sort role or the filter role can move rows
+    const bool sortChanged = m_sortColumn >= 0
+            && (roles.isEmpty() || roles.contains(m_sortRole));
+    const bool filterChanged = !m_filterText.isEmpty()
+            && (roles.isEmpty() || roles.contains(m_filterRole));
+    if (sortChanged || filterChanged) {
+        placeRows(sourceParent, topLeft.row(), bottomRight.row());
+    }
+    if (filterChanged) {
+        updateAncestors(sourceParent);
+    }
+    const Mapping* m = cachedMapping(sourceParent);
+    if (!m) {
+        return;
+    }
+    int first = m->sourceRows.size();
+    int last = -1;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const int proxyRow = m->proxyRows.value(row, -1);
+        if (proxyRow >= 0) {
+            first = qMin(first, proxyRow);
+            last = qMax(last, proxyRow);
+        }
+    }
+    if (last >= 0) {
+        const QModelIndex proxyParent = mapFromSource(sourceParent);
+        Q_EMIT dataChanged(index(first, topLeft.column(), proxyParent),
+                index(last, bottomRight.column(), proxyParent), roles);
+    }
+}
+
+QModelIndex SortedPersons::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!m_source || !proxyIndex.isValid()) {
+        return QModelIndex();
+    }
+    const int row = mapping(QModelIndex())->sourceRows.at(proxyIndex.row());
+    return m_source->index(row, proxyIndex.column());
+}
+
+QModelIndex SortedPersons::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!m_source || !sourceIndex.isValid()) {
+        return QModelIndex();
+    }
+    const QModelIndex sourceParent = sourceIndex.parent();
+    const int row = mapping(sourceParent)->proxyRows.value(sourceIndex.row(), -1);
+    if (row < 0) {
+        return QModelIndex();
+    }
+    return createIndex(row, sourceIndex.column(), quintptr(0));
+}
+
+int SortedPersons::columnCount(const QModelIndex &parent) const
+{
+    return m_source ? m_source->columnCount(mapToSource(parent)) : 0;
+}
+
+QVariant SortedPersons::data(const QModelIndex &index, int role) const
+{
+    return m_source ? m_source->data(mapToSource(index), role) : QVariant();
+}
+
+bool SortedPersons::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    return m_source && m_source->setData(mapToSource(index), value, role);
+}
+
+QModelIndex SortedPersons::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!m_source || row < 0 || column < 0 || column >= columnCount(parent) || parent.isValid()) {
+        return QModelIndex();
+    }
+    const QModelIndex sourceParent = mapToSource(parent);
+    const Mapping* m = mapping(sourceParent);
+    if (row >= m->sourceRows.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, quintptr(0));
+}
+
+QModelIndex SortedPersons::parent(const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QModelIndex();
+}
+
+bool SortedPersons::hasChildren(const QModelIndex &parent) const
+{
+    if (!m_source) {
+        return false;
+    }
+    if (m_filterText.isEmpty()) {
+        return m_source->hasChildren(mapToSource(parent));
+    }
+    return rowCount(parent) > 0;
+}
+
+int SortedPersons::rowCount(const QModelIndex &parent) const
+{
+    if (!m_source || parent.isValid()) {
+        return 0;
+    }
+    return mapping(mapToSource(parent))->sourceRows.size();
+}
+
+bool SortedPersons::canFetchMore(const QModelIndex &parent) const
+{
+    return m_source && m_source->canFetchMore(mapToSource(parent));
+}
+
+void SortedPersons::fetchMore(const QModelIndex &parent)
+{
+    if (m_source) {
+        m_source->fetchMore(mapToSource(parent));
+    }
+}
+
+Qt::ItemFlags SortedPersons::flags(const QModelIndex &index) const
+{
+    return m_source ? m_source->flags(mapToSource(index)) : QAbstractItemModel::flags(index);
+}
+
+QHash<int, QByteArray> SortedPersons::roleNames() const
+{
+    return m_source ? m_source->roleNames() : QAbstractItemModel::roleNames();
+}
+
+QVariant SortedPersons::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    return m_source ? m_source->headerData(section, orientation, role) : QVariant();
+}
+extern "C" void log_commands_pending(Log* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
+extern "C" void no_role_commands_pending(NoRole* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
+extern "C" void persons_commands_pending(Persons* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
@@ -5,8 +5,79 @@
 #include <QtCore/QObject>
 #include <QtCore/QAbstractItemModel>
 
+class Log;
 class NoRole;
 class Persons;
+class Trace;
+class SortedPersons;
+
+class Log : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    class Private;
+private:
+    Private * m_d;
+    bool m_ownsPrivate;
+    explicit Log(bool owned, QObject *parent);
+public:
+    explicit Log(QObject *parent = nullptr);
+    ~Log();
+    Q_INVOKABLE void append(quint32 count);
+    Q_INVOKABLE quint32 loads() const;
+    Q_INVOKABLE quint32 residentPages() const;
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    int role(const char* name) const;
+    QHash<int, QByteArray> roleNames() const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role = Qt::EditRole) override;
+    Q_INVOKABLE bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    Q_INVOKABLE bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    Q_INVOKABLE QString line(int row) const;
+    Q_INVOKABLE quint64 number(int row) const;
+    Q_INVOKABLE QVector<quint64> numberColumn(int first, int last) const;
+
+Q_SIGNALS:
+    // new data is ready to be made available to the model with fetchMore()
+    void newDataReady(const QModelIndex &parent) const;
+private:
+    QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
+    void initHeaderData();
+    void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    void requestRows(int row) const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
+private Q_SLOTS:
+    void applyCommands();
+Q_SIGNALS:
+};
 
 class NoRole : public QAbstractItemModel
 {
@@ -20,6 +91,8 @@ private:
 public:
     explicit NoRole(QObject *parent = nullptr);
     ~NoRole();
+    Q_INVOKABLE void birthday();
+    Q_INVOKABLE void welcome(quint32 count);
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -40,6 +113,7 @@ public:
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     Q_INVOKABLE quint8 userAge(int row) const;
     Q_INVOKABLE bool setUserAge(int row, quint8 value);
+    Q_INVOKABLE QVector<quint8> userAgeColumn(int first, int last) const;
     Q_INVOKABLE QString userName(int row) const;
     Q_INVOKABLE bool setUserName(int row, const QString& value);
 
@@ -50,12 +124,34 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
+private Q_SLOTS:
+    void applyCommands();
 Q_SIGNALS:
 };
 
 class Persons : public QAbstractItemModel
 {
     Q_OBJECT
+    friend class SortedPersons;
 public:
     class Private;
 private:
@@ -65,6 +161,8 @@ private:
 public:
     explicit Persons(QObject *parent = nullptr);
     ~Persons();
+    Q_INVOKABLE void arrange(const QString& names);
+    Q_INVOKABLE void recruit(quint32 count);
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -93,6 +191,177 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
+private Q_SLOTS:
+    void applyTransactions();
+private Q_SLOTS:
+    void applyCommands();
+Q_SIGNALS:
+};
+
+class Trace : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    class Private;
+private:
+    Private * m_d;
+    bool m_ownsPrivate;
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged FINAL)
+    explicit Trace(bool owned, QObject *parent);
+public:
+    explicit Trace(QObject *parent = nullptr);
+    ~Trace();
+    QString path() const;
+    void setPath(const QString& v);
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    int role(const char* name) const;
+    QHash<int, QByteArray> roleNames() const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role = Qt::EditRole) override;
+    Q_INVOKABLE bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    Q_INVOKABLE bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    Q_INVOKABLE QString label(int row) const;
+    Q_INVOKABLE quint64 time(int row) const;
+    Q_INVOKABLE QVector<quint64> timeColumn(int first, int last) const;
+    Q_INVOKABLE bool valid(int row) const;
+    Q_INVOKABLE double value(int row) const;
+    Q_INVOKABLE QVector<double> valueColumn(int first, int last) const;
+
+Q_SIGNALS:
+    // new data is ready to be made available to the model with fetchMore()
+    void newDataReady(const QModelIndex &parent) const;
+private:
+    QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
+    void initHeaderData();
+    void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
 Q_SIGNALS:
+    void pathChanged();
+};
+
+class SortedPersons : public QAbstractItemModel
+{
+    Q_OBJECT
+    Q_PROPERTY(Persons* sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged FINAL)
+    Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged FINAL)
+    Q_PROPERTY(int filterRole READ filterRole WRITE setFilterRole NOTIFY filterRoleChanged FINAL)
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged FINAL)
+public:
+    class Private;
+    explicit SortedPersons(QObject *parent = nullptr);
+    ~SortedPersons();
+    Persons* sourceModel() const;
+    void setSourceModel(Persons* source);
+    int sortRole() const;
+    void setSortRole(int role);
+    int filterRole() const;
+    void setFilterRole(int role);
+    QString filterText() const;
+    void setFilterText(const QString& text);
+    Q_INVOKABLE QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    Q_INVOKABLE QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
+    Q_INVOKABLE void sortByRole(const QString& role, Qt::SortOrder order);
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    QHash<int, QByteArray> roleNames() const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+Q_SIGNALS:
+    void sourceModelChanged();
+    void sortRoleChanged();
+    void filterRoleChanged();
+    void filterTextChanged();
+private:
+    // the visible rows of the source below one parent, in the order of the proxy
+    struct Mapping {
+        QVector<int> sourceRows;
+        QVector<int> proxyRows;
+    };
+    Private * m_d;
+    Persons* m_source;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    int m_sortRole;
+    int m_filterRole;
+    QString m_filterText;
+    mutable Mapping* m_rootMapping;
+    mutable QHash<quintptr, Mapping*> m_mappings;
+    QModelIndexList m_layoutIndexes;
+    QList<QPersistentModelIndex> m_layoutSourceIndexes;
+    Mapping* cachedMapping(const QModelIndex &sourceParent) const;
+    Mapping* mapping(const QModelIndex &sourceParent) const;
+    QVector<int> sourceRows(const QModelIndex &sourceParent) const;
+    void updateProxyRows(Mapping* m, int sourceRowCount) const;
+    void updateMapping(const QModelIndex &sourceParent);
+    void placeRows(const QModelIndex &sourceParent, int first, int last);
+    void updateAncestors(const QModelIndex &sourceParent);
+    void removeProxyRows(Mapping* m, const QModelIndex &sourceParent, const QVector<bool>& remove);
+    void dropMapping(const QModelIndex &sourceParent);
+    void clearMappings();
+    void resetFilter();
+    void refilter();
+    void beginLayoutChange();
+    void endLayoutChange();
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeMoved(const QModelIndex &parent, int, int, const QModelIndex &destination);
+    void sourceRowsMoved(const QModelIndex &parent, int first, int last, const QModelIndex &destination, int row);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
 };
 #endif // TEST_LIST_RUST_H
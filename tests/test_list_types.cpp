@@ -43,8 +43,10 @@ private slots:
     void testDouble();
     void testString();
     void testOptionalString();
+    void testStringUtf16();
     void testByteArray();
     void testOptionalByteArray();
+    void testByteArrayArc();
 };
 
 template <typename V, typename Set, typename Get>
@@ -244,6 +246,13 @@ void TestRustListTypes::testString()
     test(QString("$𐐷𤭢"), &List::setString, &List::string,  "string");
 }
 
+void TestRustListTypes::testStringUtf16()
+{
+    test(QString(""), &List::setStringUtf16, &List::stringUtf16, "stringUtf16");
+    test(QString("Konqi"), &List::setStringUtf16, &List::stringUtf16, "stringUtf16");
+    test(QString("$𐐷𤭢"), &List::setStringUtf16, &List::stringUtf16, "stringUtf16");
+}
+
 void TestRustListTypes::testOptionalString()
 {
     testOptional(QString(), &List::setOptionalString, &List::optionalString,
@@ -305,5 +314,21 @@ void TestRustListTypes::testStringSetter()
     QCOMPARE(value.toString(), QString("Konqi"));
 }
 
+void TestRustListTypes::testByteArrayArc()
+{
+    const char data[10] = {0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9};
+    test(QByteArray(data, 0), &List::setBytearrayArc,
+        &List::bytearrayArc, "bytearrayArc");
+    test(QByteArray(data, 10), &List::setBytearrayArc,
+        &List::bytearrayArc, "bytearrayArc");
+
+    // the same buffer is returned for every read
+    List list;
+    list.setBytearrayArc(2, QByteArray(data, 10));
+    const QByteArray a = list.bytearrayArc(2);
+    const QByteArray b = list.bytearrayArc(2);
+    QCOMPARE(a.constData(), b.constData());
+}
+
 QTEST_MAIN(TestRustListTypes)
 #include "test_list_types.moc"
@@ -1,5 +1,8 @@
 /* generated by rust_qt_binding_generator */
 #include "test_list_types_rust.h"
+#include <algorithm>
+#include <iterator>
+#include <QtCore/QMutex>
 
 namespace {
 
@@ -33,6 +36,9 @@ namespace {
     void set_qstring(QString* val, const char* utf8, int nbytes) {
         *val = QString::fromUtf8(utf8, nbytes);
     }
+    void set_qstring_utf16(QString* val, const char* utf16, int nchars) {
+        *val = QString(reinterpret_cast<const QChar*>(utf16), nchars);
+    }
 
     typedef void (*qbytearray_set)(QByteArray* val, const char* bytes, int nbytes);
     void set_qbytearray(QByteArray* v, const char* bytes, int nbytes) {
@@ -44,6 +50,72 @@ namespace {
         }
     }
 
+    typedef void (*qstring_set_at)(QString* val, int i, const char* bytes, int nbytes);
+    void set_qstring_at(QString* val, int i, const char* bytes, int nbytes) {
+        val[i] = QString::fromUtf8(bytes, nbytes);
+    }
+
+    typedef void (*qbytearray_set_at)(QByteArray* val, int i, const char* bytes, int nbytes);
+    void set_qbytearray_at(QByteArray* val, int i, const char* bytes, int nbytes) {
+        val[i] = QByteArray(bytes, nbytes);
+    }
+    void set_qstring_utf16_at(QString* val, int i, const char* utf16, int nchars) {
+        val[i] = QString(reinterpret_cast<const QChar*>(utf16), nchars);
+    }
+
+    typedef void (*arc_release)(const char* data, int len);
+    struct arc_entry_t {
+        QByteArray bytes;
+        arc_release release;
+    };
+    class arc_registry_t {
+        QMutex mutex;
+        QHash<const char*, arc_entry_t> entries;
+        // inserts until the next sweep; this grows with the number of
+        // buffers in use, so a sweep costs O(1) per insert
+        int sweepAfter = 64;
+        void sweep() {
+            auto i = entries.begin();
+            while (i != entries.end()) {
+                if (i.value().bytes.isDetached()) {
+                    i.value().release(i.key(), i.value().bytes.size());
+                    i = entries.erase(i);
+                } else {
+                    ++i;
+                }
+            }
+            sweepAfter = qMax(64, entries.size());
+        }
+    public:
+        QByteArray get(const char* data, int len, arc_release release) {
+            QMutexLocker lock(&mutex);
+            auto i = entries.constFind(data);
+            if (i != entries.constEnd()) {
+                release(data, len);
+                return i.value().bytes;
+            }
+            if (len == 0) {
+                release(data, len);
+                return QByteArray(data, 0);
+            }
+            if (--sweepAfter <= 0) {
+                sweep();
+            }
+            // the buffer is kept alive by Rust until no QByteArray refers to it
+            const QByteArray b = QByteArray::fromRawData(data, len);
+            entries.insert(data, arc_entry_t{b, release});
+            return b;
+        }
+    };
+    arc_registry_t& arc_registry() {
+        static arc_registry_t registry;
+        return registry;
+    }
+
+    struct role_name_t {
+        const char* name;
+        int role;
+    };
     struct qmodelindex_t {
         int row;
         quintptr id;
@@ -52,22 +124,208 @@ namespace {
         return (v.isNull()) ?QVariant() :v;
     }
 }
+namespace {
+    struct list_data_range_t {
+        bool* boolean;
+        QByteArray* bytearray;
+        float* f32;
+        double* f64;
+        qint16* i16;
+        qint32* i32;
+        qint64* i64;
+        qint8* i8;
+        option_bool* optionalBoolean;
+        QByteArray* optionalBytearray;
+        QString* optionalString;
+        QString* string;
+        QString* stringUtf16;
+        quint16* u16;
+        quint32* u32;
+        quint64* u64;
+        quint8* u8;
+    };
+    constexpr role_name_t list_role_names[] = {
+        {"boolean", Qt::UserRole + 0},
+        {"bytearray", Qt::UserRole + 1},
+        {"bytearrayArc", Qt::UserRole + 2},
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"f32", Qt::UserRole + 3},
+        {"f64", Qt::UserRole + 4},
+        {"i16", Qt::UserRole + 5},
+        {"i32", Qt::UserRole + 6},
+        {"i64", Qt::UserRole + 7},
+        {"i8", Qt::UserRole + 8},
+        {"optionalBoolean", Qt::UserRole + 9},
+        {"optionalBytearray", Qt::UserRole + 10},
+        {"optionalString", Qt::UserRole + 11},
+        {"statusTip", Qt::StatusTipRole},
+        {"string", Qt::UserRole + 12},
+        {"stringUtf16", Qt::UserRole + 13},
+        {"toolTip", Qt::ToolTipRole},
+        {"u16", Qt::UserRole + 14},
+        {"u32", Qt::UserRole + 15},
+        {"u64", Qt::UserRole + 16},
+        {"u8", Qt::UserRole + 17},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int list_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::UserRole + 0:
+                return 0;
+            case Qt::UserRole + 1:
+                return 1;
+            case Qt::UserRole + 2:
+                return 2;
+            case Qt::UserRole + 3:
+                return 3;
+            case Qt::UserRole + 4:
+                return 4;
+            case Qt::UserRole + 5:
+                return 5;
+            case Qt::UserRole + 6:
+                return 6;
+            case Qt::UserRole + 7:
+                return 7;
+            case Qt::UserRole + 8:
+                return 8;
+            case Qt::UserRole + 9:
+                return 9;
+            case Qt::UserRole + 10:
+                return 10;
+            case Qt::UserRole + 11:
+                return 11;
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::UserRole + 12:
+                return 12;
+            case Qt::UserRole + 13:
+                return 13;
+            case Qt::UserRole + 14:
+                return 14;
+            case Qt::UserRole + 15:
+                return 15;
+            case Qt::UserRole + 16:
+                return 16;
+            case Qt::UserRole + 17:
+                return 17;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void list_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 1)) {
+            roles.append(Qt::UserRole + 1);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 2)) {
+            roles.append(Qt::UserRole + 2);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 3)) {
+            roles.append(Qt::UserRole + 3);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 4)) {
+            roles.append(Qt::UserRole + 4);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 5)) {
+            roles.append(Qt::UserRole + 5);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 6)) {
+            roles.append(Qt::UserRole + 6);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 7)) {
+            roles.append(Qt::UserRole + 7);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 8)) {
+            roles.append(Qt::UserRole + 8);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 9)) {
+            roles.append(Qt::UserRole + 9);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 10)) {
+            roles.append(Qt::UserRole + 10);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 11)) {
+            roles.append(Qt::UserRole + 11);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 12)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::EditRole);
+            roles.append(Qt::UserRole + 12);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 13)) {
+            roles.append(Qt::UserRole + 13);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 14)) {
+            roles.append(Qt::UserRole + 14);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 15)) {
+            roles.append(Qt::UserRole + 15);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 16)) {
+            roles.append(Qt::UserRole + 16);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        if (properties & (quint64(1) << 17)) {
+            roles.append(Qt::UserRole + 17);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void list_data_range(const List::Private*, int, int, quint64, list_data_range_t*, qstring_set_at, qbytearray_set_at, qstring_set_at);
+    void list_release_arc(const char*, int);
     bool list_data_boolean(const List::Private*, int);
     bool list_set_data_boolean(List::Private*, int, bool);
     void list_data_bytearray(const List::Private*, int, QByteArray*, qbytearray_set);
     bool list_set_data_bytearray(List::Private*, int, const char* s, int len);
+    const char* list_data_bytearray_arc(const List::Private*, int, int*);
+    bool list_set_data_bytearray_arc(List::Private*, int, const char* s, int len);
     float list_data_f32(const List::Private*, int);
+    void list_column_f32(const List::Private*, int, int, float*);
     bool list_set_data_f32(List::Private*, int, float);
     double list_data_f64(const List::Private*, int);
+    void list_column_f64(const List::Private*, int, int, double*);
     bool list_set_data_f64(List::Private*, int, double);
     qint16 list_data_i16(const List::Private*, int);
+    void list_column_i16(const List::Private*, int, int, qint16*);
     bool list_set_data_i16(List::Private*, int, qint16);
     qint32 list_data_i32(const List::Private*, int);
+    void list_column_i32(const List::Private*, int, int, qint32*);
     bool list_set_data_i32(List::Private*, int, qint32);
     qint64 list_data_i64(const List::Private*, int);
+    void list_column_i64(const List::Private*, int, int, qint64*);
     bool list_set_data_i64(List::Private*, int, qint64);
     qint8 list_data_i8(const List::Private*, int);
+    void list_column_i8(const List::Private*, int, int, qint8*);
     bool list_set_data_i8(List::Private*, int, qint8);
     option_bool list_data_optional_boolean(const List::Private*, int);
     bool list_set_data_optional_boolean(List::Private*, int, bool);
@@ -80,13 +338,19 @@ extern "C" {
     bool list_set_data_optional_string_none(List::Private*, int);
     void list_data_string(const List::Private*, int, QString*, qstring_set);
     bool list_set_data_string(List::Private*, int, const ushort* s, int len);
+    void list_data_string_utf16(const List::Private*, int, QString*, qstring_set);
+    bool list_set_data_string_utf16(List::Private*, int, const ushort* s, int len);
     quint16 list_data_u16(const List::Private*, int);
+    void list_column_u16(const List::Private*, int, int, quint16*);
     bool list_set_data_u16(List::Private*, int, quint16);
     quint32 list_data_u32(const List::Private*, int);
+    void list_column_u32(const List::Private*, int, int, quint32*);
     bool list_set_data_u32(List::Private*, int, quint32);
     quint64 list_data_u64(const List::Private*, int);
+    void list_column_u64(const List::Private*, int, int, quint64*);
     bool list_set_data_u64(List::Private*, int, quint64);
     quint8 list_data_u8(const List::Private*, int);
+    void list_column_u8(const List::Private*, int, int, quint8*);
     bool list_set_data_u8(List::Private*, int, quint8);
     void list_sort(List::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
 
@@ -147,6 +411,28 @@ void List::fetchMore(const QModelIndex &parent)
 }
 void List::updatePersistentIndexes() {}
 
+void List::updatePersistentIndexes(const quintptr* oldRows, int len) {
+    quintptr size = 0;
+    for (int row = 0; row < len; ++row) {
+        size = qMax(size, oldRows[row] + 1);
+    }
+    QVector<int> newRows(size, -1);
+    for (int row = 0; row < len; ++row) {
+        newRows[oldRows[row]] = row;
+    }
+    const auto from = persistentIndexList();
+    auto to = from;
+    for (int i = 0; i < to.size(); ++i) {
+        const int row = newRows.value(from.at(i).row(), -1);
+        if (row >= 0) {
+            to[i] = createIndex(row, from.at(i).column(), (quintptr)row);
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
 void List::sort(int column, Qt::SortOrder order)
 {
     list_sort(m_d, column, order);
@@ -170,6 +456,7 @@ bool List::setBoolean(int row, bool value)
     bool set = false;
     set = list_set_data_boolean(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -188,6 +475,26 @@ bool List::setBytearray(int row, const QByteArray& value)
     bool set = false;
     set = list_set_data_bytearray(m_d, row, value.data(), value.length());
     if (set) {
+        clearDataRange();
+        QModelIndex index = createIndex(row, 0, row);
+        Q_EMIT dataChanged(index, index);
+    }
+    return set;
+}
+
+QByteArray List::bytearrayArc(int row) const
+{
+    int len;
+    const char* data = list_data_bytearray_arc(m_d, row, &len);
+    return arc_registry().get(data, len, list_release_arc);
+}
+
+bool List::setBytearrayArc(int row, const QByteArray& value)
+{
+    bool set = false;
+    set = list_set_data_bytearray_arc(m_d, row, value.data(), value.length());
+    if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -204,6 +511,7 @@ bool List::setF32(int row, float value)
     bool set = false;
     set = list_set_data_f32(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -220,6 +528,7 @@ bool List::setF64(int row, double value)
     bool set = false;
     set = list_set_data_f64(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -236,6 +545,7 @@ bool List::setI16(int row, qint16 value)
     bool set = false;
     set = list_set_data_i16(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -252,6 +562,7 @@ bool List::setI32(int row, qint32 value)
     bool set = false;
     set = list_set_data_i32(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -268,6 +579,7 @@ bool List::setI64(int row, qint64 value)
     bool set = false;
     set = list_set_data_i64(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -284,6 +596,7 @@ bool List::setI8(int row, qint8 value)
     bool set = false;
     set = list_set_data_i8(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -309,6 +622,7 @@ bool List::setOptionalBoolean(int row, const QVariant& value)
     set = list_set_data_optional_boolean(m_d, row, value.value<bool>());
     }
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -331,6 +645,7 @@ bool List::setOptionalBytearray(int row, const QByteArray& value)
     set = list_set_data_optional_bytearray(m_d, row, value.data(), value.length());
     }
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -353,6 +668,7 @@ bool List::setOptionalString(int row, const QString& value)
     set = list_set_data_optional_string(m_d, row, value.utf16(), value.length());
     }
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -371,6 +687,26 @@ bool List::setString(int row, const QString& value)
     bool set = false;
     set = list_set_data_string(m_d, row, value.utf16(), value.length());
     if (set) {
+        clearDataRange();
+        QModelIndex index = createIndex(row, 0, row);
+        Q_EMIT dataChanged(index, index);
+    }
+    return set;
+}
+
+QString List::stringUtf16(int row) const
+{
+    QString s;
+    list_data_string_utf16(m_d, row, &s, set_qstring_utf16);
+    return s;
+}
+
+bool List::setStringUtf16(int row, const QString& value)
+{
+    bool set = false;
+    set = list_set_data_string_utf16(m_d, row, value.utf16(), value.length());
+    if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -387,6 +723,7 @@ bool List::setU16(int row, quint16 value)
     bool set = false;
     set = list_set_data_u16(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -403,6 +740,7 @@ bool List::setU32(int row, quint32 value)
     bool set = false;
     set = list_set_data_u32(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -419,6 +757,7 @@ bool List::setU64(int row, quint64 value)
     bool set = false;
     set = list_set_data_u64(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
@@ -435,87 +774,264 @@ bool List::setU8(int row, quint8 value)
     bool set = false;
     set = list_set_data_u8(m_d, row, value);
     if (set) {
+        clearDataRange();
         QModelIndex index = createIndex(row, 0, row);
         Q_EMIT dataChanged(index, index);
     }
     return set;
 }
 
+QVector<float> List::f32Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<float> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_f32(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<double> List::f64Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<double> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_f64(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<qint16> List::i16Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<qint16> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_i16(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<qint32> List::i32Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<qint32> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_i32(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<qint64> List::i64Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<qint64> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_i64(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<qint8> List::i8Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<qint8> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_i8(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<quint16> List::u16Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint16> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_u16(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<quint32> List::u32Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint32> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_u32(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<quint64> List::u64Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint64> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_u64(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+QVector<quint8> List::u8Column(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    QVector<quint8> column(qMax(0, last - first + 1));
+    if (!column.isEmpty()) {
+        list_column_u8(m_d, first, column.size(), column.data());
+    }
+    return column;
+}
+
+struct List::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    QVector<bool> boolean;
+    QVector<QByteArray> bytearray;
+    QVector<float> f32;
+    QVector<double> f64;
+    QVector<qint16> i16;
+    QVector<qint32> i32;
+    QVector<qint64> i64;
+    QVector<qint8> i8;
+    QVector<option_bool> optionalBoolean;
+    QVector<QByteArray> optionalBytearray;
+    QVector<QString> optionalString;
+    QVector<QString> string;
+    QVector<QString> stringUtf16;
+    QVector<quint16> u16;
+    QVector<quint32> u32;
+    QVector<quint64> u64;
+    QVector<quint8> u8;
+};
+
+void List::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int List::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    if (row < r->first || row >= r->first + r->count) {
+        const QModelIndex parent;
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->boolean.resize(r->count);
+        r->bytearray.resize(r->count);
+        r->f32.resize(r->count);
+        r->f64.resize(r->count);
+        r->i16.resize(r->count);
+        r->i32.resize(r->count);
+        r->i64.resize(r->count);
+        r->i8.resize(r->count);
+        r->optionalBoolean.resize(r->count);
+        r->optionalBytearray.fill(QByteArray(), r->count);
+        r->optionalString.fill(QString(), r->count);
+        r->string.resize(r->count);
+        r->stringUtf16.resize(r->count);
+        r->u16.resize(r->count);
+        r->u32.resize(r->count);
+        r->u64.resize(r->count);
+        r->u8.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        list_data_range_t columns = {
+            r->boolean.data(),
+            r->bytearray.data(),
+            r->f32.data(),
+            r->f64.data(),
+            r->i16.data(),
+            r->i32.data(),
+            r->i64.data(),
+            r->i8.data(),
+            r->optionalBoolean.data(),
+            r->optionalBytearray.data(),
+            r->optionalString.data(),
+            r->string.data(),
+            r->stringUtf16.data(),
+            r->u16.data(),
+            r->u32.data(),
+            r->u64.data(),
+            r->u8.data()
+        };
+        list_data_range(m_d, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at, set_qbytearray_at, set_qstring_utf16_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant List::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (list_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(boolean(index.row()));
-        case Qt::UserRole + 1:
-            return QVariant::fromValue(bytearray(index.row()));
-        case Qt::UserRole + 2:
-            return QVariant::fromValue(f32(index.row()));
-        case Qt::UserRole + 3:
-            return QVariant::fromValue(f64(index.row()));
-        case Qt::UserRole + 4:
-            return QVariant::fromValue(i16(index.row()));
-        case Qt::UserRole + 5:
-            return QVariant::fromValue(i32(index.row()));
-        case Qt::UserRole + 6:
-            return QVariant::fromValue(i64(index.row()));
-        case Qt::UserRole + 7:
-            return QVariant::fromValue(i8(index.row()));
-        case Qt::UserRole + 8:
-            return optionalBoolean(index.row());
-        case Qt::UserRole + 9:
-            return cleanNullQVariant(QVariant::fromValue(optionalBytearray(index.row())));
-        case Qt::UserRole + 10:
-            return cleanNullQVariant(QVariant::fromValue(optionalString(index.row())));
-        case Qt::DisplayRole:
-        case Qt::EditRole:
-        case Qt::UserRole + 11:
-            return QVariant::fromValue(string(index.row()));
-        case Qt::UserRole + 12:
-            return QVariant::fromValue(u16(index.row()));
-        case Qt::UserRole + 13:
-            return QVariant::fromValue(u32(index.row()));
-        case Qt::UserRole + 14:
-            return QVariant::fromValue(u64(index.row()));
-        case Qt::UserRole + 15:
-            return QVariant::fromValue(u8(index.row()));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->boolean.value(dataRangeRow(index, 0)));
+    case 1:
+        return QVariant::fromValue(m_dataRange->bytearray.value(dataRangeRow(index, 1)));
+    case 2:
+        return QVariant::fromValue(bytearrayArc(index.row()));
+    case 3:
+        return QVariant::fromValue(m_dataRange->f32.value(dataRangeRow(index, 3)));
+    case 4:
+        return QVariant::fromValue(m_dataRange->f64.value(dataRangeRow(index, 4)));
+    case 5:
+        return QVariant::fromValue(m_dataRange->i16.value(dataRangeRow(index, 5)));
+    case 6:
+        return QVariant::fromValue(m_dataRange->i32.value(dataRangeRow(index, 6)));
+    case 7:
+        return QVariant::fromValue(m_dataRange->i64.value(dataRangeRow(index, 7)));
+    case 8:
+        return QVariant::fromValue(m_dataRange->i8.value(dataRangeRow(index, 8)));
+    case 9:
+        return m_dataRange->optionalBoolean.value(dataRangeRow(index, 9));
+    case 10:
+        return cleanNullQVariant(QVariant::fromValue(m_dataRange->optionalBytearray.value(dataRangeRow(index, 10))));
+    case 11:
+        return cleanNullQVariant(QVariant::fromValue(m_dataRange->optionalString.value(dataRangeRow(index, 11))));
+    case 12:
+        return QVariant::fromValue(m_dataRange->string.value(dataRangeRow(index, 12)));
+    case 13:
+        return QVariant::fromValue(m_dataRange->stringUtf16.value(dataRangeRow(index, 13)));
+    case 14:
+        return QVariant::fromValue(m_dataRange->u16.value(dataRangeRow(index, 14)));
+    case 15:
+        return QVariant::fromValue(m_dataRange->u32.value(dataRangeRow(index, 15)));
+    case 16:
+        return QVariant::fromValue(m_dataRange->u64.value(dataRangeRow(index, 16)));
+    case 17:
+        return QVariant::fromValue(m_dataRange->u8.value(dataRangeRow(index, 17)));
     }
     return QVariant();
 }
 
 int List::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(list_role_names);
+    auto i = std::lower_bound(std::begin(list_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> List::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "boolean");
-    names.insert(Qt::UserRole + 1, "bytearray");
-    names.insert(Qt::UserRole + 2, "f32");
-    names.insert(Qt::UserRole + 3, "f64");
-    names.insert(Qt::UserRole + 4, "i16");
-    names.insert(Qt::UserRole + 5, "i32");
-    names.insert(Qt::UserRole + 6, "i64");
-    names.insert(Qt::UserRole + 7, "i8");
-    names.insert(Qt::UserRole + 8, "optionalBoolean");
-    names.insert(Qt::UserRole + 9, "optionalBytearray");
-    names.insert(Qt::UserRole + 10, "optionalString");
-    names.insert(Qt::UserRole + 11, "string");
-    names.insert(Qt::UserRole + 12, "u16");
-    names.insert(Qt::UserRole + 13, "u32");
-    names.insert(Qt::UserRole + 14, "u64");
-    names.insert(Qt::UserRole + 15, "u8");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: list_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant List::headerData(int section, Qt::Orientation orientation, int role) const
@@ -535,87 +1051,129 @@ bool List::setHeaderData(int section, Qt::Orientation orientation, const QVarian
     return true;
 }
 
+void List::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void List::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        list_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 bool List::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (index.column() == 0) {
-        if (role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<bool>())) {
-                return setBoolean(index.row(), value.value<bool>());
-            }
+    switch (list_property(index.column(), role)) {
+    case 0:
+        if (value.canConvert(qMetaTypeId<bool>())) {
+            return setBoolean(index.row(), value.value<bool>());
         }
-        if (role == Qt::UserRole + 1) {
-            if (value.canConvert(qMetaTypeId<QByteArray>())) {
-                return setBytearray(index.row(), value.value<QByteArray>());
-            }
+        break;
+    case 1:
+        if (value.canConvert(qMetaTypeId<QByteArray>())) {
+            return setBytearray(index.row(), value.value<QByteArray>());
         }
-        if (role == Qt::UserRole + 2) {
-            if (value.canConvert(qMetaTypeId<float>())) {
-                return setF32(index.row(), value.value<float>());
-            }
+        break;
+    case 2:
+        if (value.canConvert(qMetaTypeId<QByteArray>())) {
+            return setBytearrayArc(index.row(), value.value<QByteArray>());
         }
-        if (role == Qt::UserRole + 3) {
-            if (value.canConvert(qMetaTypeId<double>())) {
-                return setF64(index.row(), value.value<double>());
-            }
+        break;
+    case 3:
+        if (value.canConvert(qMetaTypeId<float>())) {
+            return setF32(index.row(), value.value<float>());
         }
-        if (role == Qt::UserRole + 4) {
-            if (value.canConvert(qMetaTypeId<qint16>())) {
-                return setI16(index.row(), value.value<qint16>());
-            }
+        break;
+    case 4:
+        if (value.canConvert(qMetaTypeId<double>())) {
+            return setF64(index.row(), value.value<double>());
         }
-        if (role == Qt::UserRole + 5) {
-            if (value.canConvert(qMetaTypeId<qint32>())) {
-                return setI32(index.row(), value.value<qint32>());
-            }
+        break;
+    case 5:
+        if (value.canConvert(qMetaTypeId<qint16>())) {
+            return setI16(index.row(), value.value<qint16>());
         }
-        if (role == Qt::UserRole + 6) {
-            if (value.canConvert(qMetaTypeId<qint64>())) {
-                return setI64(index.row(), value.value<qint64>());
-            }
+        break;
+    case 6:
+        if (value.canConvert(qMetaTypeId<qint32>())) {
+            return setI32(index.row(), value.value<qint32>());
         }
-        if (role == Qt::UserRole + 7) {
-            if (value.canConvert(qMetaTypeId<qint8>())) {
-                return setI8(index.row(), value.value<qint8>());
-            }
+        break;
+    case 7:
+        if (value.canConvert(qMetaTypeId<qint64>())) {
+            return setI64(index.row(), value.value<qint64>());
         }
-        if (role == Qt::UserRole + 8) {
-            return setOptionalBoolean(index.row(), value);
+        break;
+    case 8:
+        if (value.canConvert(qMetaTypeId<qint8>())) {
+            return setI8(index.row(), value.value<qint8>());
         }
-        if (role == Qt::UserRole + 9) {
-            if (!value.isValid() || value.isNull() ||value.canConvert(qMetaTypeId<QByteArray>())) {
-                return setOptionalBytearray(index.row(), value.value<QByteArray>());
-            }
+        break;
+    case 9:
+        return setOptionalBoolean(index.row(), value);
+    case 10:
+        if (!value.isValid() || value.isNull() ||value.canConvert(qMetaTypeId<QByteArray>())) {
+            return setOptionalBytearray(index.row(), value.value<QByteArray>());
         }
-        if (role == Qt::UserRole + 10) {
-            if (!value.isValid() || value.isNull() ||value.canConvert(qMetaTypeId<QString>())) {
-                return setOptionalString(index.row(), value.value<QString>());
-            }
+        break;
+    case 11:
+        if (!value.isValid() || value.isNull() ||value.canConvert(qMetaTypeId<QString>())) {
+            return setOptionalString(index.row(), value.value<QString>());
         }
-        if (role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole + 11) {
-            if (value.canConvert(qMetaTypeId<QString>())) {
-                return setString(index.row(), value.value<QString>());
-            }
+        break;
+    case 12:
+        if (value.canConvert(qMetaTypeId<QString>())) {
+            return setString(index.row(), value.value<QString>());
         }
-        if (role == Qt::UserRole + 12) {
-            if (value.canConvert(qMetaTypeId<quint16>())) {
-                return setU16(index.row(), value.value<quint16>());
-            }
+        break;
+    case 13:
+        if (value.canConvert(qMetaTypeId<QString>())) {
+            return setStringUtf16(index.row(), value.value<QString>());
         }
-        if (role == Qt::UserRole + 13) {
-            if (value.canConvert(qMetaTypeId<quint32>())) {
-                return setU32(index.row(), value.value<quint32>());
-            }
+        break;
+    case 14:
+        if (value.canConvert(qMetaTypeId<quint16>())) {
+            return setU16(index.row(), value.value<quint16>());
         }
-        if (role == Qt::UserRole + 14) {
-            if (value.canConvert(qMetaTypeId<quint64>())) {
-                return setU64(index.row(), value.value<quint64>());
-            }
+        break;
+    case 15:
+        if (value.canConvert(qMetaTypeId<quint32>())) {
+            return setU32(index.row(), value.value<quint32>());
         }
-        if (role == Qt::UserRole + 15) {
-            if (value.canConvert(qMetaTypeId<quint8>())) {
-                return setU8(index.row(), value.value<quint8>());
-            }
+        break;
+    case 16:
+        if (value.canConvert(qMetaTypeId<quint64>())) {
+            return setU64(index.row(), value.value<quint64>());
+        }
+        break;
+    case 17:
+        if (value.canConvert(qMetaTypeId<quint8>())) {
+            return setU8(index.row(), value.value<quint8>());
         }
+        break;
     }
     return false;
 }
@@ -626,6 +1184,7 @@ extern "C" {
         void (*)(List*),
         void (*)(List*),
         void (*)(List*, quintptr, quintptr),
+        void (*)(List*, quintptr, quintptr, quint64),
         void (*)(List*),
         void (*)(List*),
         void (*)(List*, int, int),
@@ -633,14 +1192,16 @@ extern "C" {
         void (*)(List*, int, int, int),
         void (*)(List*),
         void (*)(List*, int, int),
-        void (*)(List*));
+        void (*)(List*),
+        void (*)(List*, const quintptr*, quintptr));
     void list_free(List::Private*);
 };
 
 List::List(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -652,42 +1213,68 @@ List::List(QObject *parent):
             Q_EMIT o->newDataReady(QModelIndex());
         },
         [](List* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](List* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](List* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             o->dataChanged(o->createIndex(first, 0, first),
                        o->createIndex(last, 0, last));
         },
+        [](List* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            o->queueDataChanged(QModelIndex(), first, last, properties);
+        },
         [](List* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](List* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](List* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginInsertRows(QModelIndex(), first, last);
         },
         [](List* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](List* o, int first, int last, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
         },
         [](List* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](List* o, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginRemoveRows(QModelIndex(), first, last);
         },
         [](List* o) {
+            o->clearDataRange();
             o->endRemoveRows();
+        },
+        [](List* o, const quintptr* oldRows, quintptr len) {
+            o->clearDataRange();
+            o->updatePersistentIndexes(oldRows, len);
+            Q_EMIT o->layoutChanged();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &List::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -699,6 +1286,7 @@ List::~List() {
     if (m_ownsPrivate) {
         list_free(m_d);
     }
+    delete m_dataRange;
 }
 void List::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("string"));
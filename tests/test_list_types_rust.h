@@ -41,18 +41,26 @@ public:
     Q_INVOKABLE bool setBoolean(int row, bool value);
     Q_INVOKABLE QByteArray bytearray(int row) const;
     Q_INVOKABLE bool setBytearray(int row, const QByteArray& value);
+    Q_INVOKABLE QByteArray bytearrayArc(int row) const;
+    Q_INVOKABLE bool setBytearrayArc(int row, const QByteArray& value);
     Q_INVOKABLE float f32(int row) const;
     Q_INVOKABLE bool setF32(int row, float value);
+    Q_INVOKABLE QVector<float> f32Column(int first, int last) const;
     Q_INVOKABLE double f64(int row) const;
     Q_INVOKABLE bool setF64(int row, double value);
+    Q_INVOKABLE QVector<double> f64Column(int first, int last) const;
     Q_INVOKABLE qint16 i16(int row) const;
     Q_INVOKABLE bool setI16(int row, qint16 value);
+    Q_INVOKABLE QVector<qint16> i16Column(int first, int last) const;
     Q_INVOKABLE qint32 i32(int row) const;
     Q_INVOKABLE bool setI32(int row, qint32 value);
+    Q_INVOKABLE QVector<qint32> i32Column(int first, int last) const;
     Q_INVOKABLE qint64 i64(int row) const;
     Q_INVOKABLE bool setI64(int row, qint64 value);
+    Q_INVOKABLE QVector<qint64> i64Column(int first, int last) const;
     Q_INVOKABLE qint8 i8(int row) const;
     Q_INVOKABLE bool setI8(int row, qint8 value);
+    Q_INVOKABLE QVector<qint8> i8Column(int first, int last) const;
     Q_INVOKABLE QVariant optionalBoolean(int row) const;
     Q_INVOKABLE bool setOptionalBoolean(int row, const QVariant& value);
     Q_INVOKABLE QByteArray optionalBytearray(int row) const;
@@ -61,14 +69,20 @@ public:
     Q_INVOKABLE bool setOptionalString(int row, const QString& value);
     Q_INVOKABLE QString string(int row) const;
     Q_INVOKABLE bool setString(int row, const QString& value);
+    Q_INVOKABLE QString stringUtf16(int row) const;
+    Q_INVOKABLE bool setStringUtf16(int row, const QString& value);
     Q_INVOKABLE quint16 u16(int row) const;
     Q_INVOKABLE bool setU16(int row, quint16 value);
+    Q_INVOKABLE QVector<quint16> u16Column(int first, int last) const;
     Q_INVOKABLE quint32 u32(int row) const;
     Q_INVOKABLE bool setU32(int row, quint32 value);
+    Q_INVOKABLE QVector<quint32> u32Column(int first, int last) const;
     Q_INVOKABLE quint64 u64(int row) const;
     Q_INVOKABLE bool setU64(int row, quint64 value);
+    Q_INVOKABLE QVector<quint64> u64Column(int first, int last) const;
     Q_INVOKABLE quint8 u8(int row) const;
     Q_INVOKABLE bool setU8(int row, quint8 value);
+    Q_INVOKABLE QVector<quint8> u8Column(int first, int last) const;
 
 Q_SIGNALS:
     // new data is ready to be made available to the model with fetchMore()
@@ -77,6 +91,25 @@ private:
     QHash<QPair<int,Qt::ItemDataRole>, QVariant> m_headerData;
     void initHeaderData();
     void updatePersistentIndexes();
+    void updatePersistentIndexes(const quintptr* oldRows, int len);
+    // block of rows that is fetched from Rust in one call and
+    // serves data()
+    struct DataRange;
+    DataRange* const m_dataRange;
+    int dataRangeRow(const QModelIndex &index, int property) const;
+    void clearDataRange() const;
+    // changed item properties that are emitted together once control
+    // returns to the event loop
+    struct DataChange {
+        QModelIndex parent;
+        int first;
+        int last;
+        quint64 properties;
+    };
+    QVector<DataChange> m_dataChanges;
+    void queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties);
+private Q_SLOTS:
+    void emitDataChanged();
 Q_SIGNALS:
 };
 #endif // TEST_LIST_TYPES_RUST_H
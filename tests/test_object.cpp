@@ -29,6 +29,8 @@ private slots:
     void testConstructor();
     void testStringGetter();
     void testStringSetter();
+    void testCachedGetter();
+    void testCoalescedCachedGetter();
 };
 
 void TestRustObject::testConstructor()
@@ -57,5 +59,47 @@ void TestRustObject::testStringSetter()
     QCOMPARE(person.userName(), QString("Konqi"));
 }
 
+void TestRustObject::testCachedGetter()
+{
+    // GIVEN
+    Person person;
+    QSignalSpy spy(&person, &Person::userNameChanged);
+    person.setUserName("Konqi");
+    QCOMPARE(person.userName(), QString("Konqi"));
+
+    // WHEN
+    person.setUserName("Kate");
+
+    // THEN
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(person.userName(), QString("Kate"));
+    // a second read without a change in between does not call into Rust
+    const quint32 reads = person.userNameReads();
+    QCOMPARE(person.userName(), QString("Kate"));
+    QCOMPARE(person.userNameReads(), reads);
+}
+
+void TestRustObject::testCoalescedCachedGetter()
+{
+    // GIVEN
+    Account account;
+    QSignalSpy spy(&account, &Account::userNameChanged);
+    account.setUserName("Konqi");
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(account.userName(), QString("Konqi"));
+    const quint32 reads = account.userNameReads();
+    QCOMPARE(account.userName(), QString("Konqi"));
+    QCOMPARE(account.userNameReads(), reads);
+
+    // WHEN
+    account.setUserName("Kate");
+
+    // THEN
+    // the value is read again before the change is signalled
+    QCOMPARE(account.userName(), QString("Kate"));
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(account.userName(), QString("Kate"));
+}
+
 QTEST_MAIN(TestRustObject)
 #include "test_object.moc"
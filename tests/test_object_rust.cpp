@@ -9,16 +9,79 @@ namespace {
     }
     inline void personUserNameChanged(Person* o)
     {
-        Q_EMIT o->userNameChanged();
+        QMetaObject::invokeMethod(o, "invalidateUserName");
     }
 }
+extern "C" {
+    Account::Private* account_new(Account*, void (*)(Account*));
+    void account_free(Account::Private*);
+    quint64 account_take_changes(Account::Private*);
+    quint64 account_pending_changes(Account::Private*);
+    void account_apply_commands(Account::Private*);
+    void account_user_name_get(const Account::Private*, QString*, qstring_set);
+    void account_user_name_set(Account::Private*, const ushort *str, int len);
+    quint32 account_user_name_reads(const Account::Private*);
+};
+
 extern "C" {
     Person::Private* person_new(Person*, void (*)(Person*));
     void person_free(Person::Private*);
+    void person_apply_commands(Person::Private*);
     void person_user_name_get(const Person::Private*, QString*, qstring_set);
     void person_user_name_set(Person::Private*, const ushort *str, int len);
+    quint32 person_user_name_reads(const Person::Private*);
 };
 
+Account::Account(bool /*owned*/, QObject *parent):
+    QObject(parent),
+    m_d(nullptr),
+    m_ownsPrivate(false)
+{
+}
+
+Account::Account(QObject *parent):
+    QObject(parent),
+    m_d(account_new(this,
+        [](Account* o) {
+            QMetaObject::invokeMethod(o, "emitChanges", Qt::QueuedConnection);
+        })),
+    m_ownsPrivate(true)
+{
+}
+
+Account::~Account() {
+    if (m_ownsPrivate) {
+        account_free(m_d);
+    }
+}
+QString Account::userName() const
+{
+    if (!m_userNameCached || (account_pending_changes(m_d) & (quint64(1) << 0))) {
+        m_userName = QString();
+        account_user_name_get(m_d, &m_userName, set_qstring);
+        m_userNameCached = true;
+    }
+    return m_userName;
+}
+void Account::setUserName(const QString& v) {
+    account_user_name_set(m_d, reinterpret_cast<const ushort*>(v.data()), v.size());
+}
+void Account::emitChanges()
+{
+    const quint64 changes = account_take_changes(m_d);
+    if (changes & (quint64(1) << 0)) {
+        m_userNameCached = false;
+        Q_EMIT userNameChanged();
+    }
+}
+void Account::applyCommands()
+{
+    account_apply_commands(m_d);
+}
+quint32 Account::userNameReads() const
+{
+    return account_user_name_reads(m_d);
+}
 Person::Person(bool /*owned*/, QObject *parent):
     QObject(parent),
     m_d(nullptr),
@@ -41,10 +104,34 @@ Person::~Person() {
 }
 QString Person::userName() const
 {
-    QString v;
-    person_user_name_get(m_d, &v, set_qstring);
-    return v;
+    if (!m_userNameCached) {
+        m_userName = QString();
+        person_user_name_get(m_d, &m_userName, set_qstring);
+        m_userNameCached = true;
+    }
+    return m_userName;
+}
+void Person::invalidateUserName()
+{
+    m_userNameCached = false;
+    Q_EMIT userNameChanged();
 }
 void Person::setUserName(const QString& v) {
     person_user_name_set(m_d, reinterpret_cast<const ushort*>(v.data()), v.size());
 }
+void Person::applyCommands()
+{
+    person_apply_commands(m_d);
+}
+quint32 Person::userNameReads() const
+{
+    return person_user_name_reads(m_d);
+}
+extern "C" void account_commands_pending(Account* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
+extern "C" void person_commands_pending(Person* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
@@ -5,8 +5,37 @@
 #include <QtCore/QObject>
 #include <QtCore/QAbstractItemModel>
 
+class Account;
 class Person;
 
+class Account : public QObject
+{
+    Q_OBJECT
+public:
+    class Private;
+private:
+    Private * m_d;
+    bool m_ownsPrivate;
+    Q_PROPERTY(QString userName READ userName WRITE setUserName NOTIFY userNameChanged FINAL)
+    explicit Account(bool owned, QObject *parent);
+public:
+    explicit Account(QObject *parent = nullptr);
+    ~Account();
+    QString userName() const;
+    void setUserName(const QString& v);
+    Q_INVOKABLE quint32 userNameReads() const;
+private Q_SLOTS:
+    void applyCommands();
+private Q_SLOTS:
+    void emitChanges();
+private:
+    // property values that are read from Rust again only after a change
+    mutable QString m_userName;
+    mutable bool m_userNameCached = false;
+Q_SIGNALS:
+    void userNameChanged();
+};
+
 class Person : public QObject
 {
     Q_OBJECT
@@ -22,6 +51,15 @@ public:
     ~Person();
     QString userName() const;
     void setUserName(const QString& v);
+    Q_INVOKABLE quint32 userNameReads() const;
+private Q_SLOTS:
+    void applyCommands();
+private Q_SLOTS:
+    void invalidateUserName();
+private:
+    // property values that are read from Rust again only after a change
+    mutable QString m_userName;
+    mutable bool m_userNameCached = false;
 Q_SIGNALS:
     void userNameChanged();
 };
@@ -25,6 +25,8 @@ private slots:
     void testByteArray();
     void testOptionalByteArray();
     void testStringByFunction();
+    void testStringUtf16();
+    void testStringLoneSurrogate();
 };
 
 template <typename V, typename Set, typename Get, typename Changed>
@@ -207,6 +209,8 @@ void TestRustObjectTypes::testString()
         &Object::string, &Object::stringChanged);
     testSetter(QString("$𐐷𤭢"), &Object::setString,
         &Object::string, &Object::stringChanged);
+    testSetter(QString("Konqi the dragon lives in KDE 𐐷 and ä Konqi"),
+        &Object::setString, &Object::string, &Object::stringChanged);
 }
 
 void TestRustObjectTypes::testStringByFunction()
@@ -221,6 +225,31 @@ void TestRustObjectTypes::testStringByFunction()
         &Object::stringByFunction, &Object::stringByFunctionChanged);
 }
 
+void TestRustObjectTypes::testStringUtf16()
+{
+    testSetter(QString(), &Object::setStringUtf16,
+        &Object::stringUtf16, &Object::stringUtf16Changed);
+    testSetter(QString(""), &Object::setStringUtf16,
+        &Object::stringUtf16, &Object::stringUtf16Changed);
+    testSetter(QString("Konqi"), &Object::setStringUtf16,
+        &Object::stringUtf16, &Object::stringUtf16Changed);
+    testSetter(QString("$𐐷𤭢"), &Object::setStringUtf16,
+        &Object::stringUtf16, &Object::stringUtf16Changed);
+}
+
+void TestRustObjectTypes::testStringLoneSurrogate()
+{
+    // GIVEN
+    Object object;
+    const QChar high(0xD801);
+
+    // WHEN
+    object.setString(QString("Konqi") + high + QString("Kate"));
+
+    // THEN
+    QCOMPARE(object.string(), QString("Konqi") + QChar(0xFFFD) + QString("Kate"));
+}
+
 void TestRustObjectTypes::testOptionalString()
 {
     testSetter(QString(), &Object::setOptionalString,
@@ -33,6 +33,9 @@ namespace {
     void set_qstring(QString* val, const char* utf8, int nbytes) {
         *val = QString::fromUtf8(utf8, nbytes);
     }
+    void set_qstring_utf16(QString* val, const char* utf16, int nchars) {
+        *val = QString(reinterpret_cast<const QChar*>(utf16), nchars);
+    }
 
     typedef void (*qbytearray_set)(QByteArray* val, const char* bytes, int nbytes);
     void set_qbytearray(QByteArray* v, const char* bytes, int nbytes) {
@@ -99,6 +102,10 @@ namespace {
     {
         Q_EMIT o->stringByFunctionChanged();
     }
+    inline void objectStringUtf16Changed(Object* o)
+    {
+        Q_EMIT o->stringUtf16Changed();
+    }
     inline void objectU16Changed(Object* o)
     {
         Q_EMIT o->u16Changed();
@@ -117,7 +124,7 @@ namespace {
     }
 }
 extern "C" {
-    Object::Private* object_new(Object*, void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*));
+    Object::Private* object_new(Object*, void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*), void (*)(Object*));
     void object_free(Object::Private*);
     bool object_boolean_get(const Object::Private*);
     void object_boolean_set(Object::Private*, bool);
@@ -151,6 +158,8 @@ extern "C" {
     void object_string_set(Object::Private*, const ushort *str, int len);
     void object_string_by_function_get(const Object::Private*, QString*, qstring_set);
     void object_string_by_function_set(Object::Private*, const ushort *str, int len);
+    void object_string_utf16_get(const Object::Private*, QString*, qstring_set);
+    void object_string_utf16_set(Object::Private*, const ushort *str, int len);
     quint16 object_u16_get(const Object::Private*);
     void object_u16_set(Object::Private*, quint16);
     quint32 object_u32_get(const Object::Private*);
@@ -185,6 +194,7 @@ Object::Object(QObject *parent):
         objectOptionalU64Changed,
         objectStringChanged,
         objectStringByFunctionChanged,
+        objectStringUtf16Changed,
         objectU16Changed,
         objectU32Changed,
         objectU64Changed,
@@ -332,6 +342,15 @@ QString Object::stringByFunction() const
 void Object::setStringByFunction(const QString& v) {
     object_string_by_function_set(m_d, reinterpret_cast<const ushort*>(v.data()), v.size());
 }
+QString Object::stringUtf16() const
+{
+    QString v;
+    object_string_utf16_get(m_d, &v, set_qstring_utf16);
+    return v;
+}
+void Object::setStringUtf16(const QString& v) {
+    object_string_utf16_set(m_d, reinterpret_cast<const ushort*>(v.data()), v.size());
+}
 quint16 Object::u16() const
 {
     return object_u16_get(m_d);
@@ -29,6 +29,7 @@ private:
     Q_PROPERTY(QVariant optionalU64 READ optionalU64 WRITE setOptionalU64 NOTIFY optionalU64Changed FINAL)
     Q_PROPERTY(QString string READ string WRITE setString NOTIFY stringChanged FINAL)
     Q_PROPERTY(QString stringByFunction READ stringByFunction WRITE setStringByFunction NOTIFY stringByFunctionChanged FINAL)
+    Q_PROPERTY(QString stringUtf16 READ stringUtf16 WRITE setStringUtf16 NOTIFY stringUtf16Changed FINAL)
     Q_PROPERTY(quint16 u16 READ u16 WRITE setU16 NOTIFY u16Changed FINAL)
     Q_PROPERTY(quint32 u32 READ u32 WRITE setU32 NOTIFY u32Changed FINAL)
     Q_PROPERTY(quint64 u64 READ u64 WRITE setU64 NOTIFY u64Changed FINAL)
@@ -65,6 +66,8 @@ public:
     void setString(const QString& v);
     QString stringByFunction() const;
     void setStringByFunction(const QString& v);
+    QString stringUtf16() const;
+    void setStringUtf16(const QString& v);
     quint16 u16() const;
     void setU16(quint16 v);
     quint32 u32() const;
@@ -88,6 +91,7 @@ Q_SIGNALS:
     void optionalU64Changed();
     void stringChanged();
     void stringByFunctionChanged();
+    void stringUtf16Changed();
     void u16Changed();
     void u32Changed();
     void u64Changed();
@@ -32,6 +32,7 @@ private slots:
     void testTwoLevelsConstructor();
     void testTwoLevelsStringGetter();
     void testTwoLevelsStringSetter();
+    void testCoalescedChanges();
 };
 
 void TestRustObjects::testOneLevelConstructor()
@@ -86,5 +87,29 @@ void TestRustObjects::testTwoLevelsStringSetter()
     QCOMPARE(group.person()->object()->description(), QString("Konqi"));
 }
 
+void TestRustObjects::testCoalescedChanges()
+{
+    // GIVEN
+    Progress progress;
+    QSignalSpy spy(&progress, &Progress::doneChanged);
+
+    // WHEN
+    progress.advance(1000);
+
+    // THEN
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(progress.done(), 1000u);
+
+    // WHEN
+    progress.advance(1);
+
+    // THEN the second change waits for the rate limit
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 1);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(progress.done(), 1001u);
+}
+
 QTEST_MAIN(TestRustObjects)
 #include "test_objects.moc"
@@ -1,5 +1,6 @@
 /* generated by rust_qt_binding_generator */
 #include "test_objects_rust.h"
+#include <QtCore/QTimer>
 
 namespace {
 
@@ -31,6 +32,15 @@ extern "C" {
     InnerObject::Private* person_object_get(const Person::Private*);
 };
 
+extern "C" {
+    Progress::Private* progress_new(Progress*, void (*)(Progress*));
+    void progress_free(Progress::Private*);
+    quint64 progress_take_changes(Progress::Private*);
+    void progress_apply_commands(Progress::Private*);
+    quint32 progress_done_get(const Progress::Private*);
+    void progress_advance(Progress::Private*, quint32);
+};
+
 Group::Group(bool /*owned*/, QObject *parent):
     QObject(parent),
     m_person(new Person(false, this)),
@@ -123,3 +133,54 @@ InnerObject* Person::object()
 {
     return m_object;
 }
+Progress::Progress(bool /*owned*/, QObject *parent):
+    QObject(parent),
+    m_d(nullptr),
+    m_ownsPrivate(false)
+{
+}
+
+Progress::Progress(QObject *parent):
+    QObject(parent),
+    m_d(progress_new(this,
+        [](Progress* o) {
+            QMetaObject::invokeMethod(o, "emitChanges", Qt::QueuedConnection);
+        })),
+    m_ownsPrivate(true)
+{
+}
+
+Progress::~Progress() {
+    if (m_ownsPrivate) {
+        progress_free(m_d);
+    }
+}
+quint32 Progress::done() const
+{
+    return progress_done_get(m_d);
+}
+void Progress::emitChanges()
+{
+    const qint64 wait = m_changesTimer.isValid() ? 500 - m_changesTimer.elapsed() : 0;
+    if (wait > 0) {
+        QTimer::singleShot(wait, this, SLOT(emitChanges()));
+        return;
+    }
+    m_changesTimer.start();
+    const quint64 changes = progress_take_changes(m_d);
+    if (changes & (quint64(1) << 0)) {
+        Q_EMIT doneChanged();
+    }
+}
+void Progress::applyCommands()
+{
+    progress_apply_commands(m_d);
+}
+void Progress::advance(quint32 steps)
+{
+    return progress_advance(m_d, steps);
+}
+extern "C" void progress_commands_pending(Progress* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
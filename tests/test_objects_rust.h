@@ -5,9 +5,12 @@
 #include <QtCore/QObject>
 #include <QtCore/QAbstractItemModel>
 
+#include <QtCore/QElapsedTimer>
+
 class Group;
 class InnerObject;
 class Person;
+class Progress;
 
 class Group : public QObject
 {
@@ -71,4 +74,31 @@ public:
 Q_SIGNALS:
     void objectChanged();
 };
+
+class Progress : public QObject
+{
+    Q_OBJECT
+    friend class Group;
+    friend class Person;
+public:
+    class Private;
+private:
+    Private * m_d;
+    bool m_ownsPrivate;
+    Q_PROPERTY(quint32 done READ done NOTIFY doneChanged FINAL)
+    explicit Progress(bool owned, QObject *parent);
+public:
+    explicit Progress(QObject *parent = nullptr);
+    ~Progress();
+    quint32 done() const;
+    Q_INVOKABLE void advance(quint32 steps);
+private Q_SLOTS:
+    void applyCommands();
+private Q_SLOTS:
+    void emitChanges();
+private:
+    QElapsedTimer m_changesTimer;
+Q_SIGNALS:
+    void doneChanged();
+};
 #endif // TEST_OBJECTS_RUST_H
@@ -18,7 +18,7 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "test_list_rust.h"
+#include "test_tree_rust.h"
 #include <QTest>
 #include <QSignalSpy>
 
@@ -29,6 +29,9 @@ private slots:
     void testConstructor();
     void testStringGetter();
     void testStringSetter();
+    void testIndex();
+    void testReplace();
+    void testSyncFrom();
 };
 
 void TestRustTree::testConstructor()
@@ -65,5 +68,63 @@ void TestRustTree::testStringSetter()
     QCOMPARE(value.toString(), QString("Konqi"));
 }
 
+void TestRustTree::testIndex()
+{
+    // GIVEN
+    Persons persons;
+
+    // THEN
+    QVERIFY(persons.hasChildren());
+    QVERIFY(persons.index(9, 0).isValid());
+    QVERIFY(!persons.index(10, 0).isValid());
+    QVERIFY(!persons.index(-1, 0).isValid());
+    QVERIFY(!persons.index(0, 1).isValid());
+}
+
+void TestRustTree::testReplace()
+{
+    // GIVEN
+    Persons persons;
+    persons.setData(persons.index(3, 0), "Konqi");
+    const quintptr id = persons.index(3, 0).internalId();
+    const QPersistentModelIndex replaced(persons.index(3, 0));
+    const QPersistentModelIndex next(persons.index(4, 0));
+
+    // WHEN
+    persons.replace(3);
+
+    // THEN
+    QCOMPARE(persons.rowCount(), 10);
+    QVERIFY(!replaced.isValid());
+    QCOMPARE(next.row(), 4);
+    // the slot is reused under a new id
+    QVERIFY(persons.index(3, 0).internalId() != id);
+    QCOMPARE(persons.data(persons.index(3, 0)).toString(), QString());
+}
+
+void TestRustTree::testSyncFrom()
+{
+    // GIVEN
+    Names names;
+    names.setNames("Konqi,Kate,Dolphin");
+    const QPersistentModelIndex kate(names.index(1, 0));
+    QSignalSpy removed(&names, &Names::rowsRemoved);
+    QSignalSpy moved(&names, &Names::rowsMoved);
+    QSignalSpy inserted(&names, &Names::rowsInserted);
+
+    // WHEN
+    names.setNames("Dolphin,Kate,Okular");
+
+    // THEN
+    QCOMPARE(names.rowCount(), 3);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(names.data(names.index(0, 0)).toString(), QString("Dolphin"));
+    QCOMPARE(names.data(names.index(2, 0)).toString(), QString("Okular"));
+    QCOMPARE(kate.row(), 1);
+    QCOMPARE(kate.data().toString(), QString("Kate"));
+}
+
 QTEST_MAIN(TestRustTree)
 #include "test_tree.moc"
@@ -1,5 +1,7 @@
 /* generated by rust_qt_binding_generator */
 #include "test_tree_rust.h"
+#include <algorithm>
+#include <iterator>
 
 namespace {
 
@@ -21,6 +23,15 @@ namespace {
         *val = QString::fromUtf8(utf8, nbytes);
     }
 
+    typedef void (*qstring_set_at)(QString* val, int i, const char* bytes, int nbytes);
+    void set_qstring_at(QString* val, int i, const char* bytes, int nbytes) {
+        val[i] = QString::fromUtf8(bytes, nbytes);
+    }
+
+    struct role_name_t {
+        const char* name;
+        int role;
+    };
     struct qmodelindex_t {
         int row;
         quintptr id;
@@ -29,18 +40,384 @@ namespace {
         return (v.isNull()) ?QVariant() :v;
     }
 }
+namespace {
+    struct names_data_range_t {
+        quintptr* id;
+        QString* name;
+    };
+    constexpr role_name_t names_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"name", Qt::UserRole + 0},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int names_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::UserRole + 0:
+                return 0;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void names_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
+extern "C" {
+    void names_data_range(const Names::Private*, option_quintptr, int, int, quint64, names_data_range_t*, qstring_set_at);
+    void names_data_name(const Names::Private*, quintptr, QString*, qstring_set);
+    void names_sort(Names::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    int names_row_count(const Names::Private*, option_quintptr);
+    bool names_has_children(const Names::Private*, option_quintptr);
+    bool names_can_fetch_more(const Names::Private*, option_quintptr);
+    void names_fetch_more(Names::Private*, option_quintptr);
+    quintptr names_index(const Names::Private*, option_quintptr, int);
+    option_quintptr names_index_checked(const Names::Private*, option_quintptr, int);
+    qmodelindex_t names_parent(const Names::Private*, quintptr);
+    int names_row(const Names::Private*, quintptr);
+    void names_check_rows(const Names::Private*, const quintptr*, int*, int);
+}
+int Names::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+bool Names::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.isValid() && parent.column() != 0) {
+        return false;
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    return names_has_children(m_d, rust_parent);
+}
+
+int Names::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() && parent.column() != 0) {
+        return 0;
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    return names_row_count(m_d, rust_parent);
+}
+
+bool Names::insertRows(int, int, const QModelIndex &)
+{
+    return false; // not supported yet
+}
+
+bool Names::removeRows(int, int, const QModelIndex &)
+{
+    return false; // not supported yet
+}
+
+QModelIndex Names::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column < 0 || column >= 1) {
+        return QModelIndex();
+    }
+    if (parent.isValid() && parent.column() != 0) {
+        return QModelIndex();
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    // checks the row and finds the item in one call
+    const option_quintptr id = names_index_checked(m_d, rust_parent, row);
+    return id.some ?createIndex(row, column, id.value) :QModelIndex();
+}
+
+QModelIndex Names::parent(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return QModelIndex();
+    }
+    const qmodelindex_t parent = names_parent(m_d, index.internalId());
+    return parent.row >= 0 ?createIndex(parent.row, 0, parent.id) :QModelIndex();
+}
+
+bool Names::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid() && parent.column() != 0) {
+        return false;
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    return names_can_fetch_more(m_d, rust_parent);
+}
+
+void Names::fetchMore(const QModelIndex &parent)
+{
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    names_fetch_more(m_d, rust_parent);
+}
+void Names::updatePersistentIndexes() {
+    const auto from = persistentIndexList();
+    const int len = from.size();
+    if (len == 0) {
+        return;
+    }
+    // ask Rust for the new rows of all persistent indexes at once
+    QVector<quintptr> ids(len);
+    QVector<int> rows(len);
+    for (int i = 0; i < len; ++i) {
+        ids[i] = from.at(i).internalId();
+        rows[i] = from.at(i).row();
+    }
+    names_check_rows(m_d, ids.constData(), rows.data(), len);
+    auto to = from;
+    for (int i = 0; i < len; ++i) {
+        if (rows.at(i) >= 0) {
+            to[i] = createIndex(rows.at(i), from.at(i).column(), ids.at(i));
+        } else {
+            to[i] = QModelIndex();
+        }
+    }
+    changePersistentIndexList(from, to);
+}
+
+void Names::sort(int column, Qt::SortOrder order)
+{
+    names_sort(m_d, column, order);
+}
+Qt::ItemFlags Names::flags(const QModelIndex &i) const
+{
+    auto flags = QAbstractItemModel::flags(i);
+    return flags;
+}
+
+QString Names::name(const QModelIndex& index) const
+{
+    QString s;
+    names_data_name(m_d, index.internalId(), &s, set_qstring);
+    return s;
+}
+
+struct Names::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    option_quintptr parent;
+    QVector<quintptr> id;
+    QVector<QString> name;
+};
+
+void Names::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int Names::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    bool fetchIds = false;
+    if (row < r->first || row >= r->first + r->count
+            || r->id.at(row - r->first) != index.internalId()) {
+        const QModelIndex parent = index.parent();
+        r->parent = { parent.internalId(), parent.isValid() };
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->id.resize(r->count);
+        fetchIds = true;
+        r->name.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        names_data_range_t columns = {
+            fetchIds ?r->id.data() :nullptr,
+            r->name.data()
+        };
+        names_data_range(m_d, r->parent, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
+QVariant Names::data(const QModelIndex &index, int role) const
+{
+    Q_ASSERT(rowCount(index.parent()) > index.row());
+    switch (names_property(index.column(), role)) {
+    case 0:
+        return QVariant::fromValue(m_dataRange->name.value(dataRangeRow(index, 0)));
+    }
+    return QVariant();
+}
+
+int Names::role(const char* name) const {
+    auto end = std::end(names_role_names);
+    auto i = std::lower_bound(std::begin(names_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
+}
+QHash<int, QByteArray> Names::roleNames() const {
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: names_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
+    return names;
+}
+QVariant Names::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+    return m_headerData.value(qMakePair(section, (Qt::ItemDataRole)role), role == Qt::DisplayRole ?QString::number(section + 1) :QVariant());
+}
+
+bool Names::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if (orientation != Qt::Horizontal) {
+        return false;
+    }
+    m_headerData.insert(qMakePair(section, (Qt::ItemDataRole)role), value);
+    return true;
+}
+
+void Names::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Names::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        names_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
+extern "C" {
+    Names::Private* names_new(Names*,
+        void (*)(const Names*, option_quintptr),
+        void (*)(Names*),
+        void (*)(Names*),
+        void (*)(Names*, quintptr, quintptr),
+        void (*)(Names*, quintptr, quintptr, quint64),
+        void (*)(Names*),
+        void (*)(Names*),
+        void (*)(Names*, option_quintptr, int, int),
+        void (*)(Names*),
+        void (*)(Names*, option_quintptr, int, int, option_quintptr, int),
+        void (*)(Names*),
+        void (*)(Names*, option_quintptr, int, int),
+        void (*)(Names*));
+    void names_free(Names::Private*);
+    void names_apply_commands(Names::Private*);
+    void names_set_names(Names::Private*, const ushort*, int);
+};
+
+namespace {
+    struct persons_data_range_t {
+        quintptr* id;
+        QString* userName;
+    };
+    constexpr role_name_t persons_role_names[] = {
+        {"decoration", Qt::DecorationRole},
+        {"display", Qt::DisplayRole},
+        {"edit", Qt::EditRole},
+        {"statusTip", Qt::StatusTipRole},
+        {"toolTip", Qt::ToolTipRole},
+        {"userName", Qt::UserRole + 0},
+        {"whatsThis", Qt::WhatsThisRole},
+    };
+    // index of the item property for a column and role or -1
+    int persons_property(int column, int role)
+    {
+        switch (column) {
+        case 0:
+            switch (role) {
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::UserRole + 0:
+                return 0;
+            }
+            break;
+        }
+        return -1;
+    }
+    // roles and last column that show the item properties in a mask
+    void persons_changed_roles(quint64 properties, QVector<int>& roles, int& lastColumn)
+    {
+        if (properties & (quint64(1) << 0)) {
+            roles.append(Qt::DisplayRole);
+            roles.append(Qt::EditRole);
+            roles.append(Qt::UserRole + 0);
+            lastColumn = qMax(lastColumn, 0);
+        }
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+    }
+}
 extern "C" {
+    void persons_data_range(const Persons::Private*, option_quintptr, int, int, quint64, persons_data_range_t*, qstring_set_at);
     void persons_data_user_name(const Persons::Private*, quintptr, QString*, qstring_set);
     bool persons_set_data_user_name(Persons::Private*, quintptr, const ushort* s, int len);
     void persons_sort(Persons::Private*, unsigned char column, Qt::SortOrder order = Qt::AscendingOrder);
 
     int persons_row_count(const Persons::Private*, option_quintptr);
+    bool persons_has_children(const Persons::Private*, option_quintptr);
     bool persons_can_fetch_more(const Persons::Private*, option_quintptr);
     void persons_fetch_more(Persons::Private*, option_quintptr);
     quintptr persons_index(const Persons::Private*, option_quintptr, int);
+    option_quintptr persons_index_checked(const Persons::Private*, option_quintptr, int);
     qmodelindex_t persons_parent(const Persons::Private*, quintptr);
     int persons_row(const Persons::Private*, quintptr);
-    option_quintptr persons_check_row(const Persons::Private*, quintptr, int);
+    void persons_check_rows(const Persons::Private*, const quintptr*, int*, int);
 }
 int Persons::columnCount(const QModelIndex &) const
 {
@@ -49,7 +426,14 @@ int Persons::columnCount(const QModelIndex &) const
 
 bool Persons::hasChildren(const QModelIndex &parent) const
 {
-    return rowCount(parent) > 0;
+    if (parent.isValid() && parent.column() != 0) {
+        return false;
+    }
+    const option_quintptr rust_parent = {
+        parent.internalId(),
+        parent.isValid()
+    };
+    return persons_has_children(m_d, rust_parent);
 }
 
 int Persons::rowCount(const QModelIndex &parent) const
@@ -82,15 +466,13 @@ QModelIndex Persons::index(int row, int column, const QModelIndex &parent) const
     if (parent.isValid() && parent.column() != 0) {
         return QModelIndex();
     }
-    if (row >= rowCount(parent)) {
-        return QModelIndex();
-    }
     const option_quintptr rust_parent = {
         parent.internalId(),
         parent.isValid()
     };
-    const quintptr id = persons_index(m_d, rust_parent, row);
-    return createIndex(row, column, id);
+    // checks the row and finds the item in one call
+    const option_quintptr id = persons_index_checked(m_d, rust_parent, row);
+    return id.some ?createIndex(row, column, id.value) :QModelIndex();
 }
 
 QModelIndex Persons::parent(const QModelIndex &index) const
@@ -124,13 +506,22 @@ void Persons::fetchMore(const QModelIndex &parent)
 }
 void Persons::updatePersistentIndexes() {
     const auto from = persistentIndexList();
+    const int len = from.size();
+    if (len == 0) {
+        return;
+    }
+    // ask Rust for the new rows of all persistent indexes at once
+    QVector<quintptr> ids(len);
+    QVector<int> rows(len);
+    for (int i = 0; i < len; ++i) {
+        ids[i] = from.at(i).internalId();
+        rows[i] = from.at(i).row();
+    }
+    persons_check_rows(m_d, ids.constData(), rows.data(), len);
     auto to = from;
-    auto len = to.size();
     for (int i = 0; i < len; ++i) {
-        auto index = to.at(i);
-        auto row = persons_check_row(m_d, index.internalId(), index.row());
-        if (row.some) {
-            to[i] = createIndex(row.value, index.column(), index.internalId());
+        if (rows.at(i) >= 0) {
+            to[i] = createIndex(rows.at(i), from.at(i).column(), ids.at(i));
         } else {
             to[i] = QModelIndex();
         }
@@ -163,41 +554,79 @@ bool Persons::setUserName(const QModelIndex& index, const QString& value)
     bool set = false;
     set = persons_set_data_user_name(m_d, index.internalId(), value.utf16(), value.length());
     if (set) {
+        clearDataRange();
         Q_EMIT dataChanged(index, index);
     }
     return set;
 }
 
+struct Persons::DataRange {
+    int first;
+    int count;
+    // bit i is set when item property i has been fetched
+    quint64 fetched;
+    option_quintptr parent;
+    QVector<quintptr> id;
+    QVector<QString> userName;
+};
+
+void Persons::clearDataRange() const
+{
+    m_dataRange->count = 0;
+}
+
+int Persons::dataRangeRow(const QModelIndex &index, int property) const
+{
+    DataRange* r = m_dataRange;
+    const int row = index.row();
+    bool fetchIds = false;
+    if (row < r->first || row >= r->first + r->count
+            || r->id.at(row - r->first) != index.internalId()) {
+        const QModelIndex parent = index.parent();
+        r->parent = { parent.internalId(), parent.isValid() };
+        // fetch the block of 64 rows that contains this row
+        r->first = row - row % 64;
+        r->count = qMax(0, qMin(64, rowCount(parent) - r->first));
+        r->fetched = 0;
+        r->id.resize(r->count);
+        fetchIds = true;
+        r->userName.resize(r->count);
+    }
+    const quint64 bit = quint64(1) << property;
+    if (r->count > 0 && !(r->fetched & bit)) {
+        persons_data_range_t columns = {
+            fetchIds ?r->id.data() :nullptr,
+            r->userName.data()
+        };
+        persons_data_range(m_d, r->parent, r->first, r->first + r->count - 1, bit, &columns, set_qstring_at);
+        r->fetched |= bit;
+    }
+    return row - r->first;
+}
 QVariant Persons::data(const QModelIndex &index, int role) const
 {
     Q_ASSERT(rowCount(index.parent()) > index.row());
-    switch (index.column()) {
+    switch (persons_property(index.column(), role)) {
     case 0:
-        switch (role) {
-        case Qt::DisplayRole:
-        case Qt::EditRole:
-        case Qt::UserRole + 0:
-            return QVariant::fromValue(userName(index));
-        }
-        break;
+        return QVariant::fromValue(m_dataRange->userName.value(dataRangeRow(index, 0)));
     }
     return QVariant();
 }
 
 int Persons::role(const char* name) const {
-    auto names = roleNames();
-    auto i = names.constBegin();
-    while (i != names.constEnd()) {
-        if (i.value() == name) {
-            return i.key();
-        }
-        ++i;
-    }
-    return -1;
+    auto end = std::end(persons_role_names);
+    auto i = std::lower_bound(std::begin(persons_role_names), end, name,
+        [](const role_name_t& r, const char* n) { return qstrcmp(r.name, n) < 0; });
+    return (i != end && qstrcmp(i->name, name) == 0) ?i->role :-1;
 }
 QHash<int, QByteArray> Persons::roleNames() const {
-    QHash<int, QByteArray> names = QAbstractItemModel::roleNames();
-    names.insert(Qt::UserRole + 0, "userName");
+    static const QHash<int, QByteArray> names = [] {
+        QHash<int, QByteArray> names;
+        for (const auto& r: persons_role_names) {
+            names.insert(r.role, r.name);
+        }
+        return names;
+    }();
     return names;
 }
 QVariant Persons::headerData(int section, Qt::Orientation orientation, int role) const
@@ -217,14 +646,47 @@ bool Persons::setHeaderData(int section, Qt::Orientation orientation, const QVar
     return true;
 }
 
+void Persons::queueDataChanged(const QModelIndex &parent, int first, int last, quint64 properties)
+{
+    if (m_dataChanges.isEmpty()) {
+        QMetaObject::invokeMethod(this, "emitDataChanged", Qt::QueuedConnection);
+    }
+    m_dataChanges.append({parent, first, last, properties});
+}
+
+void Persons::emitDataChanged()
+{
+    if (m_dataChanges.isEmpty()) {
+        return;
+    }
+    QVector<DataChange> changes;
+    changes.swap(m_dataChanges);
+    std::sort(changes.begin(), changes.end(), [](const DataChange& a, const DataChange& b) {
+        return a.parent < b.parent || (a.parent == b.parent && a.first < b.first);
+    });
+    int i = 0;
+    while (i < changes.size()) {
+        DataChange c = changes.at(i);
+        for (++i; i < changes.size() && changes.at(i).parent == c.parent
+                && changes.at(i).first <= c.last + 1; ++i) {
+            c.last = qMax(c.last, changes.at(i).last);
+            c.properties |= changes.at(i).properties;
+        }
+        QVector<int> roles;
+        int lastColumn = 0;
+        persons_changed_roles(c.properties, roles, lastColumn);
+        Q_EMIT dataChanged(index(c.first, 0, c.parent), index(c.last, lastColumn, c.parent), roles);
+    }
+}
+
 bool Persons::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (index.column() == 0) {
-        if (role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole + 0) {
-            if (value.canConvert(qMetaTypeId<QString>())) {
-                return setUserName(index, value.value<QString>());
-            }
+    switch (persons_property(index.column(), role)) {
+    case 0:
+        if (value.canConvert(qMetaTypeId<QString>())) {
+            return setUserName(index, value.value<QString>());
         }
+        break;
     }
     return false;
 }
@@ -235,6 +697,7 @@ extern "C" {
         void (*)(Persons*),
         void (*)(Persons*),
         void (*)(Persons*, quintptr, quintptr),
+        void (*)(Persons*, quintptr, quintptr, quint64),
         void (*)(Persons*),
         void (*)(Persons*),
         void (*)(Persons*, option_quintptr, int, int),
@@ -244,12 +707,141 @@ extern "C" {
         void (*)(Persons*, option_quintptr, int, int),
         void (*)(Persons*));
     void persons_free(Persons::Private*);
+    void persons_apply_commands(Persons::Private*);
+    void persons_replace(Persons::Private*, quint32);
 };
 
+Names::Names(bool /*owned*/, QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(nullptr),
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
+{
+    initHeaderData();
+}
+
+Names::Names(QObject *parent):
+    QAbstractItemModel(parent),
+    m_d(names_new(this,
+        [](const Names* o, option_quintptr id) {
+            if (id.some) {
+                int row = names_row(o->m_d, id.value);
+                Q_EMIT o->newDataReady(o->createIndex(row, 0, id.value));
+            } else {
+                Q_EMIT o->newDataReady(QModelIndex());
+            }
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            Q_EMIT o->layoutAboutToBeChanged();
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->updatePersistentIndexes();
+            Q_EMIT o->layoutChanged();
+        },
+        [](Names* o, quintptr first, quintptr last) {
+            o->clearDataRange();
+            quintptr frow = names_row(o->m_d, first);
+            quintptr lrow = names_row(o->m_d, last);
+            o->dataChanged(o->createIndex(frow, 0, first),
+                       o->createIndex(lrow, 0, last));
+        },
+        [](Names* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            const int frow = names_row(o->m_d, first);
+            const int lrow = names_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            o->beginResetModel();
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->endResetModel();
+        },
+        [](Names* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            if (id.some) {
+                int row = names_row(o->m_d, id.value);
+                o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
+            } else {
+                o->beginInsertRows(QModelIndex(), first, last);
+            }
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->endInsertRows();
+        },
+        [](Names* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            QModelIndex s;
+            if (sourceParent.some) {
+                int row = names_row(o->m_d, sourceParent.value);
+                s = o->createIndex(row, 0, sourceParent.value);
+            }
+            QModelIndex d;
+            if (destinationParent.some) {
+                int row = names_row(o->m_d, destinationParent.value);
+                d = o->createIndex(row, 0, destinationParent.value);
+            }
+            o->beginMoveRows(s, first, last, d, destination);
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->endMoveRows();
+        },
+        [](Names* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
+            if (id.some) {
+                int row = names_row(o->m_d, id.value);
+                o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
+            } else {
+                o->beginRemoveRows(QModelIndex(), first, last);
+            }
+        },
+        [](Names* o) {
+            o->clearDataRange();
+            o->endRemoveRows();
+        }
+)),
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
+{
+    connect(this, &Names::newDataReady, this, [this](const QModelIndex& i) {
+        this->fetchMore(i);
+    }, Qt::QueuedConnection);
+    initHeaderData();
+}
+
+Names::~Names() {
+    if (m_ownsPrivate) {
+        names_free(m_d);
+    }
+    delete m_dataRange;
+}
+void Names::initHeaderData() {
+    m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("name"));
+}
+void Names::applyCommands()
+{
+    names_apply_commands(m_d);
+}
+void Names::setNames(const QString& names)
+{
+    return names_set_names(m_d, names.utf16(), names.size());
+}
 Persons::Persons(bool /*owned*/, QObject *parent):
     QAbstractItemModel(parent),
     m_d(nullptr),
-    m_ownsPrivate(false)
+    m_ownsPrivate(false),
+    m_dataRange(new DataRange())
 {
     initHeaderData();
 }
@@ -266,25 +858,40 @@ Persons::Persons(QObject *parent):
             }
         },
         [](Persons* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             Q_EMIT o->layoutAboutToBeChanged();
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->updatePersistentIndexes();
             Q_EMIT o->layoutChanged();
         },
         [](Persons* o, quintptr first, quintptr last) {
+            o->clearDataRange();
             quintptr frow = persons_row(o->m_d, first);
-            quintptr lrow = persons_row(o->m_d, first);
+            quintptr lrow = persons_row(o->m_d, last);
             o->dataChanged(o->createIndex(frow, 0, first),
                        o->createIndex(lrow, 0, last));
         },
+        [](Persons* o, quintptr first, quintptr last, quint64 properties) {
+            o->clearDataRange();
+            const int frow = persons_row(o->m_d, first);
+            const int lrow = persons_row(o->m_d, last);
+            o->queueDataChanged(o->parent(o->createIndex(frow, 0, first)), frow, lrow, properties);
+        },
         [](Persons* o) {
+            o->clearDataRange();
+            o->emitDataChanged();
             o->beginResetModel();
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endResetModel();
         },
         [](Persons* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = persons_row(o->m_d, id.value);
                 o->beginInsertRows(o->createIndex(row, 0, id.value), first, last);
@@ -293,9 +900,12 @@ Persons::Persons(QObject *parent):
             }
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endInsertRows();
         },
         [](Persons* o, option_quintptr sourceParent, int first, int last, option_quintptr destinationParent, int destination) {
+            o->clearDataRange();
+            o->emitDataChanged();
             QModelIndex s;
             if (sourceParent.some) {
                 int row = persons_row(o->m_d, sourceParent.value);
@@ -309,9 +919,12 @@ Persons::Persons(QObject *parent):
             o->beginMoveRows(s, first, last, d, destination);
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endMoveRows();
         },
         [](Persons* o, option_quintptr id, int first, int last) {
+            o->clearDataRange();
+            o->emitDataChanged();
             if (id.some) {
                 int row = persons_row(o->m_d, id.value);
                 o->beginRemoveRows(o->createIndex(row, 0, id.value), first, last);
@@ -320,10 +933,12 @@ Persons::Persons(QObject *parent):
             }
         },
         [](Persons* o) {
+            o->clearDataRange();
             o->endRemoveRows();
         }
 )),
-    m_ownsPrivate(true)
+    m_ownsPrivate(true),
+    m_dataRange(new DataRange())
 {
     connect(this, &Persons::newDataReady, this, [this](const QModelIndex& i) {
         this->fetchMore(i);
@@ -335,7 +950,24 @@ Persons::~Persons() {
     if (m_ownsPrivate) {
         persons_free(m_d);
     }
+    delete m_dataRange;
 }
 void Persons::initHeaderData() {
     m_headerData.insert(qMakePair(0, Qt::DisplayRole), QVariant("userName"));
 }
+void Persons::applyCommands()
+{
+    persons_apply_commands(m_d);
+}
+void Persons::replace(quint32 row)
+{
+    return persons_replace(m_d, row);
+}
+extern "C" void names_commands_pending(Names* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}
+extern "C" void persons_commands_pending(Persons* o)
+{
+    QMetaObject::invokeMethod(o, "applyCommands", Qt::QueuedConnection);
+}